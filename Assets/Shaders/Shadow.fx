@@ -4,14 +4,24 @@
 cbuffer TransformBuffer : register(b0)
 {
     matrix wvp;
+    float3 positionScale;
+    float3 positionOffset;
 }
 
+// positions only, bound with MeshBuffer::RenderPositions
 struct VS_INPUT
 {
+#ifdef PACKED_VERTEX
+    float4 position : POSITION; // unorm against the mesh bounds
+#else
     float3 position : POSITION;
-    float3 normal : NORMAL;
-    float3 tangent : TANGENT;
-    float2 texCoord : TEXCOORD;
+#endif
+#ifdef INSTANCED
+    float4 instanceWorld0 : INSTANCE_WORLD0;
+    float4 instanceWorld1 : INSTANCE_WORLD1;
+    float4 instanceWorld2 : INSTANCE_WORLD2;
+    float4 instanceWorld3 : INSTANCE_WORLD3;
+#endif
 };
 
 struct VS_OUTPUT
@@ -23,7 +33,18 @@ struct VS_OUTPUT
 VS_OUTPUT VS(VS_INPUT input)
 {
     VS_OUTPUT output;
-    output.position = mul(float4(input.position, 1.0f), wvp);
+#ifdef PACKED_VERTEX
+    float3 localPosition = positionOffset + (input.position.xyz * positionScale);
+#else
+    float3 localPosition = input.position;
+#endif
+#ifdef INSTANCED
+    // wvp is only the light view projection, the world matrix comes with the instance
+    float4x4 instanceWorld = float4x4(input.instanceWorld0, input.instanceWorld1, input.instanceWorld2, input.instanceWorld3);
+    output.position = mul(mul(float4(localPosition, 1.0f), instanceWorld), wvp);
+#else
+    output.position = mul(float4(localPosition, 1.0f), wvp);
+#endif
     output.lightNDCPosition = output.position;
     
     return output;
@@ -4,8 +4,11 @@ cbuffer TransformBuffer : register(b0)
 {
     matrix wvp;
     matrix world;
+    matrix normalWorld;
     matrix lwvp;
     float3 viewPosition;
+    float3 positionScale;
+    float3 positionOffset;
 }
 
 cbuffer LightBuffer : register(b1)
@@ -25,6 +28,23 @@ cbuffer MaterialBuffer : register(b2)
     float materialShininess;
 }
 
+struct MaterialData
+{
+    float4 emissive;
+    float4 ambient;
+    float4 diffuse;
+    float4 specular;
+    float shininess;
+};
+
+#ifdef INSTANCED
+// instances pick their material by index, MaxInstanceMaterials in InstanceBuffer.h
+cbuffer InstanceMaterialBuffer : register(b4)
+{
+    MaterialData instanceMaterials[16];
+}
+#endif
+
 cbuffer SettingsBuffer : register(b3)
 {
     bool useDiffuseMap;
@@ -47,10 +67,23 @@ Texture2D shadowMap : register(t4);
 
 struct VS_INPUT
 {
+#ifdef PACKED_VERTEX
+    float4 position : POSITION; // unorm against the mesh bounds, w is the bitangent sign
+    float2 normal : NORMAL;     // octahedral
+    float2 tangent : TANGENT;
+#else
     float3 position : POSITION;
     float3 normal : NORMAL;
     float3 tangent : TANGENT;
+#endif
     float2 texCoord : TEXCOORD;
+#ifdef INSTANCED
+    float4 instanceWorld0 : INSTANCE_WORLD0;
+    float4 instanceWorld1 : INSTANCE_WORLD1;
+    float4 instanceWorld2 : INSTANCE_WORLD2;
+    float4 instanceWorld3 : INSTANCE_WORLD3;
+    uint materialIndex : INSTANCE_MATERIAL;
+#endif
 };
 
 struct VS_OUTPUT
@@ -62,31 +95,73 @@ struct VS_OUTPUT
     float3 dirToLight : TEXCOORD1;
     float3 dirToView : TEXCOORD2;
     float4 lightNDCPosition : TEXCOORD3;
+    float bitangentSign : TEXCOORD4;
+#ifdef INSTANCED
+    nointerpolation uint materialIndex : TEXCOORD5;
+#endif
 };
 
+float3 DecodeOctahedral(float2 e)
+{
+    float3 n = float3(e.x, e.y, 1.0f - abs(e.x) - abs(e.y));
+    float fold = saturate(-n.z);
+    n.xy += (n.xy >= 0.0f) ? -fold : fold;
+    return normalize(n);
+}
+
 VS_OUTPUT VS(VS_INPUT input)
 {
+#ifdef PACKED_VERTEX
+    float3 localPosition = positionOffset + (input.position.xyz * positionScale);
+    float3 normal = DecodeOctahedral(input.normal);
+    float3 tangent = DecodeOctahedral(input.tangent);
+    float bitangentSign = (input.position.w * 2.0f) - 1.0f;
+#else
     float3 localPosition = input.position;
+    float3 normal = input.normal;
+    float3 tangent = input.tangent;
+    float bitangentSign = 1.0f;
+#endif
     if(useBumpMap)
     {
         float4 bumpMapColor = bumpMap.SampleLevel(textureSampler, input.texCoord, 0.0f);
         float bumpHeight = (bumpMapColor.r * 2.0f) - 1.0f;
-        localPosition += (input.normal * bumpHeight * bumpMapWeight);
+        localPosition += (normal * bumpHeight * bumpMapWeight);
     }
     
     
     VS_OUTPUT output;
+#ifdef INSTANCED
+    // the world matrix comes with the instance, wvp and lwvp are only the view projections
+    float4x4 instanceWorld = float4x4(input.instanceWorld0, input.instanceWorld1, input.instanceWorld2, input.instanceWorld3);
+    float4 worldPosition = mul(float4(localPosition, 1.0f), instanceWorld);
+    output.position = mul(worldPosition, wvp);
+    // normals take the cofactor matrix, the inverse transpose up to a scale the pixel shader
+    // normalizes away, so instances can have non-uniform scale. Mirrored instances flip it back
+    float3x3 world3 = (float3x3) instanceWorld;
+    float3x3 cofactor = float3x3(cross(world3[1], world3[2]), cross(world3[2], world3[0]), cross(world3[0], world3[1]));
+    float determinant = dot(cofactor[2], world3[2]);
+    output.worldNormal = mul(normal, cofactor) * (determinant < 0.0f ? -1.0f : 1.0f);
+    output.worldTangent = mul(tangent, world3);
+    output.materialIndex = min(input.materialIndex, 15u);
+#else
+    float4 worldPosition = mul(float4(localPosition, 1.0f), world);
     output.position = mul(float4(localPosition, 1.0f), wvp);
-    output.worldNormal = mul(input.normal, (float3x3) world);
-    output.worldTangent = mul(input.tangent, (float3x3) world);
+    output.worldNormal = mul(normal, (float3x3) normalWorld);
+    output.worldTangent = mul(tangent, (float3x3) world);
+#endif
+    output.bitangentSign = bitangentSign;
     output.texCoord = input.texCoord;
     output.dirToLight = -lightDirection;
     
-    float4 worldPosition = mul(float4(localPosition, 1.0f), world);
     output.dirToView = normalize(viewPosition - worldPosition.xyz);
     if (useShadowMap)
     {
+#ifdef INSTANCED
+        output.lightNDCPosition = mul(worldPosition, lwvp);
+#else
         output.lightNDCPosition = mul(float4(localPosition, 1.0f), lwvp);
+#endif
     }
     
     return output;
@@ -102,28 +177,34 @@ float4 PS(VS_OUTPUT input) : SV_Target
     if(useNormalMap)
     {
         float3 t = normalize(input.worldTangent);
-        float3 b = normalize(cross(n, t));
+        float3 b = normalize(cross(n, t)) * input.bitangentSign;
         float3x3 tbnw = float3x3(t, b, n);
         float4 normalMapColor = normalMap.Sample(textureSampler, input.texCoord);
         float3 unpackedNormalMap = normalize(float3((normalMapColor.xy * 2.0f) - 1.0f, normalMapColor.z));
         n = normalize(mul(unpackedNormalMap, tbnw));
     }
     
+#ifdef INSTANCED
+    MaterialData material = instanceMaterials[input.materialIndex];
+#else
+    MaterialData material = { materialEmissive, materialAmbient, materialDiffuse, materialSpecular, materialShininess };
+#endif
+
     // Emissive
-    float4 emissive = materialEmissive;
+    float4 emissive = material.emissive;
     
     // Ambient
-    float4 ambient = lightAmbient * materialAmbient;
+    float4 ambient = lightAmbient * material.ambient;
     
     // Diffuse
     float d = saturate(dot(light, n));
-    float4 diffuse = d * lightDiffuse * materialDiffuse;
+    float4 diffuse = d * lightDiffuse * material.diffuse;
     
     // Specular
     float3 r = reflect(-light, n);
     float base = saturate(dot(r, view));
-    float s = pow(base, materialShininess);
-    float4 specular = s * lightSpecular * materialSpecular;
+    float s = pow(base, material.shininess);
+    float4 specular = s * lightSpecular * material.specular;
 
     // colors
     float4 diffuseMapColor = (useDiffuseMap)? diffuseMap.Sample(textureSampler, input.texCoord) : 1.0f;
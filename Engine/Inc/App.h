@@ -10,6 +10,13 @@ namespace ML_Engine
 		uint32_t winWidth = 1200;
 		uint32_t winHeight = 720;
         uint32_t maxVertexCount = 100000;
+
+        // no window or gpu, draws go to the null graphics backend at a fixed 60Hz step
+        bool headless = false;
+        // quits after this many frames when not 0
+        uint32_t maxFrameCount = 0;
+        // cpu frame times and draw counts are written here as json on quit
+        std::filesystem::path frameStatsFile;
     };
 
     class App final
@@ -7,22 +7,70 @@ using namespace ML_Engine::Core;
 using namespace ML_Engine::Graphics;
 using namespace ML_Engine::Input;
 
+namespace
+{
+    struct FrameStats
+    {
+        uint32_t frameCount = 0;
+        double totalCpuMs = 0.0;
+        double maxCpuMs = 0.0;
+        uint64_t drawCount = 0;
+        uint64_t bindCount = 0;
+        uint64_t vertexCount = 0;
+        uint64_t issuedStateCount = 0;
+        uint64_t filteredStateCount = 0;
+    };
+
+    void SaveFrameStats(const std::filesystem::path& fileName, const FrameStats& stats, bool headless)
+    {
+        FILE* file = nullptr;
+        fopen_s(&file, fileName.u8string().c_str(), "w");
+        if (file == nullptr)
+        {
+            LOG("App: failed to open %s for frame stats", fileName.u8string().c_str());
+            return;
+        }
+
+        const double frames = static_cast<double>(std::max(stats.frameCount, 1u));
+        fprintf(file, "{\n");
+        fprintf(file, "  \"backend\": \"%s\",\n", headless ? "null" : "d3d11");
+        fprintf(file, "  \"frames\": %u,\n", stats.frameCount);
+        fprintf(file, "  \"cpu_ms_avg\": %.4f,\n", stats.totalCpuMs / frames);
+        fprintf(file, "  \"cpu_ms_max\": %.4f,\n", stats.maxCpuMs);
+        fprintf(file, "  \"draws_per_frame\": %.1f,\n", static_cast<double>(stats.drawCount) / frames);
+        fprintf(file, "  \"binds_per_frame\": %.1f,\n", static_cast<double>(stats.bindCount) / frames);
+        fprintf(file, "  \"vertices_per_frame\": %.1f,\n", static_cast<double>(stats.vertexCount) / frames);
+        fprintf(file, "  \"state_calls_issued_per_frame\": %.1f,\n", static_cast<double>(stats.issuedStateCount) / frames);
+        fprintf(file, "  \"state_calls_filtered_per_frame\": %.1f\n", static_cast<double>(stats.filteredStateCount) / frames);
+        fprintf(file, "}\n");
+        fclose(file);
+    }
+}
+
 void App::Run(const AppConfig& config)
 {
     LOG("App Started");
 
 	// Initialize everything
     Window myWindow;
-    myWindow.Initialize(
-        GetModuleHandle(nullptr),
-        config.appName,
-        config.winWidth,
-		config.winHeight
-    );
+    if (config.headless)
+    {
+        GraphicsSystem::StaticInitializeHeadless(config.winWidth, config.winHeight);
+    }
+    else
+    {
+        myWindow.Initialize(
+            GetModuleHandle(nullptr),
+            config.appName,
+            config.winWidth,
+            config.winHeight
+        );
+        GraphicsSystem::StaticInitialize(myWindow.GetWindowHandle(), false);
+    }
+    // the window handle is null when headless
     auto handle = myWindow.GetWindowHandle();
-    GraphicsSystem::StaticInitialize(handle, false);
     InputSystem::StaticInitialize(handle);
-    DebugUI::StaticInitialize(handle, false, true);
+    DebugUI::StaticInitialize(handle, false, !config.headless);
     SimpleDraw::StaticInitialize(config.maxVertexCount);
     TextureManager::StaticInitialize(L"../../Assets/Textures");
     ModelManager::StaticInitialize(L"../../Assets/Models");
@@ -34,13 +82,20 @@ void App::Run(const AppConfig& config)
     // Process updates
 
     InputSystem* input = InputSystem::Get();
+    GraphicsSystem* gs = GraphicsSystem::Get();
+    FrameStats frameStats;
     mRunning = true;
     while (mRunning)
     {
-		myWindow.ProcessMessage();
+        if (!config.headless)
+        {
+            myWindow.ProcessMessage();
+        }
         input->Update();
 
-		if (!myWindow.IsActive() || input->IsKeyPressed(KeyCode::ESCAPE))
+        const bool windowClosed = !config.headless && !myWindow.IsActive();
+        const bool framesDone = config.maxFrameCount > 0 && frameStats.frameCount >= config.maxFrameCount;
+		if (windowClosed || framesDone || input->IsKeyPressed(KeyCode::ESCAPE))
 		{
             Quit();
             continue;
@@ -54,7 +109,9 @@ void App::Run(const AppConfig& config)
 			mNextState = nullptr;
 		}
 
-		float deltaTime = TimeUtil::GetDeltaTime();
+        const auto frameStart = std::chrono::steady_clock::now();
+        // a fixed step keeps headless runs repeatable
+		float deltaTime = config.headless ? (1.0f / 60.0f) : TimeUtil::GetDeltaTime();
 #if defined(_DEBUG)
         if (deltaTime < 0.5f) // primarily for handling breakpoints
 #endif
@@ -62,13 +119,29 @@ void App::Run(const AppConfig& config)
 			mCurrentState->Update(deltaTime);
         }
 
-        GraphicsSystem* gs = GraphicsSystem::Get();
         gs->BeginRender();
             mCurrentState->Render();
 			DebugUI::BeginRender();
 				mCurrentState->DebugUI();
 			DebugUI::EndRender();
         gs->EndRender();
+
+        const std::chrono::duration<double, std::milli> cpuTime = std::chrono::steady_clock::now() - frameStart;
+        const GraphicsStats& graphicsStats = gs->GetBackend()->GetFrameStats();
+        ++frameStats.frameCount;
+        frameStats.totalCpuMs += cpuTime.count();
+        frameStats.maxCpuMs = std::max(frameStats.maxCpuMs, cpuTime.count());
+        frameStats.drawCount += graphicsStats.GetDrawCount();
+        frameStats.bindCount += graphicsStats.GetBindCount();
+        frameStats.vertexCount += graphicsStats.vertexCount;
+        const StateCacheStats& cacheStats = gs->GetStateCache()->GetFrameStats();
+        frameStats.issuedStateCount += cacheStats.GetIssuedCount();
+        frameStats.filteredStateCount += cacheStats.GetFilteredCount();
+    }
+
+    if (!config.frameStatsFile.empty())
+    {
+        SaveFrameStats(config.frameStatsFile, frameStats, config.headless);
     }
 
     // Terminate everything
@@ -81,7 +154,10 @@ void App::Run(const AppConfig& config)
     DebugUI::StaticTerminate();
     InputSystem::StaticTerminate();
     GraphicsSystem::StaticTerminate();
-    myWindow.Terminate();
+    if (!config.headless)
+    {
+        myWindow.Terminate();
+    }
 }
 
 void ML_Engine::App::Quit()
@@ -3,6 +3,14 @@
 #include "Common.h"
 
 #include "DebugUtil.h"
+#include "HashUtil.h"
+#include "MappedFile.h"
+#include "SlotMap.h"
+#include "ThreadPool.h"
+#include "ThreadUtil.h"
 #include "TimeUtil.h"
+// the window classes are win32 only, everything else builds on any platform
+#if defined(_WIN32)
 #include "Window.h"
-#include "WindowMessageHandler.h"
\ No newline at end of file
+#include "WindowMessageHandler.h"
+#endif
\ No newline at end of file
@@ -22,6 +22,6 @@ using namespace ML_Engine::Core;
         }\
     }while(false)
 #else
-#define_Log(format, ...)
+#define LOG(format, ...)
 #define ASSERT(condition, format, ...) do{ (void)sizeof(condition);} while(false)
 #endif
\ No newline at end of file
@@ -0,0 +1,30 @@
+#pragma once
+
+namespace ML_Engine::Core
+{
+	// Read only view of a whole file mapped into memory, pages are read in on first access
+	class MappedFile final
+	{
+	public:
+		MappedFile() = default;
+		~MappedFile();
+
+		MappedFile(const MappedFile&) = delete;
+		MappedFile& operator=(const MappedFile&) = delete;
+
+		// false when the file is missing or empty
+		bool Open(const std::filesystem::path& filePath);
+		void Close();
+
+		const uint8_t* GetData() const { return mData; }
+		size_t GetSize() const { return mSize; }
+
+	private:
+		const uint8_t* mData = nullptr;
+		size_t mSize = 0;
+#if defined(_WIN32)
+		HANDLE mFile = INVALID_HANDLE_VALUE;
+		HANDLE mMapping = nullptr;
+#endif
+	};
+}
@@ -0,0 +1,146 @@
+#pragma once
+
+namespace ML_Engine::Core
+{
+	// slot index in the low 32 bits, generation in the high 32 bits, 0 is never valid
+	using SlotHandle = uint64_t;
+	constexpr SlotHandle InvalidSlotHandle = 0;
+
+	// Values in a flat array addressed by handle. A lookup is an index and a generation
+	// compare. Removing a value bumps the generation of its slot, so old handles stop
+	// resolving instead of reaching whatever reuses the slot. Pointers returned by Get()
+	// are invalidated by Emplace().
+	template<class T>
+	class SlotMap final
+	{
+	public:
+		template<class... Args>
+		SlotHandle Emplace(Args&&... args)
+		{
+			uint32_t index = 0;
+			if (!mFreeSlots.empty())
+			{
+				index = mFreeSlots.back();
+				mFreeSlots.pop_back();
+			}
+			else
+			{
+				ASSERT(mSlots.size() < UINT32_MAX, "SlotMap: out of slots");
+				index = static_cast<uint32_t>(mSlots.size());
+				mSlots.emplace_back();
+			}
+
+			Slot& slot = mSlots[index];
+			slot.value.emplace(std::forward<Args>(args)...);
+			++mSize;
+			return MakeHandle(index, slot.generation);
+		}
+
+		bool Remove(SlotHandle handle)
+		{
+			Slot* slot = GetSlot(handle);
+			if (slot == nullptr)
+			{
+				return false;
+			}
+
+			slot->value.reset();
+			// generation 0 would let a handle of 0 resolve
+			slot->generation = (slot->generation == UINT32_MAX) ? 1 : slot->generation + 1;
+			mFreeSlots.push_back(GetIndex(handle));
+			--mSize;
+			return true;
+		}
+
+		void Clear()
+		{
+			for (uint32_t i = 0; i < mSlots.size(); ++i)
+			{
+				if (mSlots[i].value.has_value())
+				{
+					Remove(MakeHandle(i, mSlots[i].generation));
+				}
+			}
+		}
+
+		T* Get(SlotHandle handle)
+		{
+			Slot* slot = GetSlot(handle);
+			return (slot != nullptr) ? &slot->value.value() : nullptr;
+		}
+
+		const T* Get(SlotHandle handle) const
+		{
+			return const_cast<SlotMap*>(this)->Get(handle);
+		}
+
+		bool IsValid(SlotHandle handle) const
+		{
+			return Get(handle) != nullptr;
+		}
+
+		size_t Size() const { return mSize; }
+		bool Empty() const { return mSize == 0; }
+
+		// calls func(handle, value) for every value, in slot order
+		template<class Func>
+		void ForEach(Func&& func)
+		{
+			for (uint32_t i = 0; i < mSlots.size(); ++i)
+			{
+				if (mSlots[i].value.has_value())
+				{
+					func(MakeHandle(i, mSlots[i].generation), mSlots[i].value.value());
+				}
+			}
+		}
+
+		template<class Func>
+		void ForEach(Func&& func) const
+		{
+			for (uint32_t i = 0; i < mSlots.size(); ++i)
+			{
+				if (mSlots[i].value.has_value())
+				{
+					func(MakeHandle(i, mSlots[i].generation), mSlots[i].value.value());
+				}
+			}
+		}
+
+	private:
+		struct Slot
+		{
+			std::optional<T> value;
+			uint32_t generation = 1;
+		};
+
+		static SlotHandle MakeHandle(uint32_t index, uint32_t generation)
+		{
+			return (static_cast<SlotHandle>(generation) << 32) | index;
+		}
+
+		static uint32_t GetIndex(SlotHandle handle)
+		{
+			return static_cast<uint32_t>(handle);
+		}
+
+		Slot* GetSlot(SlotHandle handle)
+		{
+			const uint32_t index = GetIndex(handle);
+			if (index >= mSlots.size())
+			{
+				return nullptr;
+			}
+			Slot& slot = mSlots[index];
+			if (slot.generation != static_cast<uint32_t>(handle >> 32) || !slot.value.has_value())
+			{
+				return nullptr;
+			}
+			return &slot;
+		}
+
+		std::vector<Slot> mSlots;
+		std::vector<uint32_t> mFreeSlots;
+		size_t mSize = 0;
+	};
+}
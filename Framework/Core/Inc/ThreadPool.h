@@ -0,0 +1,42 @@
+#pragma once
+
+namespace ML_Engine::Core
+{
+	// Long lived worker threads for background jobs such as file loading. Jobs run in the
+	// order they were submitted, Terminate() finishes the queued ones before joining.
+	class ThreadPool final
+	{
+	public:
+		ThreadPool() = default;
+		~ThreadPool();
+
+		ThreadPool(const ThreadPool&) = delete;
+		ThreadPool& operator=(const ThreadPool&) = delete;
+
+		void Initialize(uint32_t threadCount);
+		void Terminate();
+
+		// runs job on a worker, the future receives its result
+		template<class Job>
+		std::future<std::invoke_result_t<Job>> Submit(Job job)
+		{
+			using Result = std::invoke_result_t<Job>;
+			auto task = std::make_shared<std::packaged_task<Result()>>(std::move(job));
+			std::future<Result> result = task->get_future();
+			Enqueue([task]() { (*task)(); });
+			return result;
+		}
+
+		uint32_t GetThreadCount() const { return static_cast<uint32_t>(mThreads.size()); }
+
+	private:
+		void Enqueue(std::function<void()> job);
+		void WorkerLoop();
+
+		std::vector<std::thread> mThreads;
+		std::deque<std::function<void()>> mJobs;
+		std::mutex mMutex;
+		std::condition_variable mJobAdded;
+		bool mStopping = false;
+	};
+}
@@ -0,0 +1,11 @@
+#pragma once
+
+namespace ML_Engine::Core::ThreadUtil
+{
+	// number of threads ParallelFor splits work across, including the caller
+	uint32_t GetWorkerCount();
+
+	// Calls work(begin, end) on disjoint ranges covering [0, count). Ranges are at least
+	// minBatchSize long, so small inputs run inline on the calling thread.
+	void ParallelFor(size_t count, size_t minBatchSize, const std::function<void(size_t, size_t)>& work);
+}
\ No newline at end of file
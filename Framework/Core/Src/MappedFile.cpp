@@ -0,0 +1,115 @@
+#include "Precompiled.h"
+#include "MappedFile.h"
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace ML_Engine;
+using namespace ML_Engine::Core;
+
+MappedFile::~MappedFile()
+{
+	Close();
+}
+
+#if defined(_WIN32)
+
+bool MappedFile::Open(const std::filesystem::path& filePath)
+{
+	Close();
+
+	mFile = CreateFileW(filePath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (mFile == INVALID_HANDLE_VALUE)
+	{
+		return false;
+	}
+
+	LARGE_INTEGER fileSize{};
+	if (!GetFileSizeEx(mFile, &fileSize) || fileSize.QuadPart == 0)
+	{
+		Close();
+		return false;
+	}
+
+	mMapping = CreateFileMappingW(mFile, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (mMapping == nullptr)
+	{
+		Close();
+		return false;
+	}
+
+	mData = static_cast<const uint8_t*>(MapViewOfFile(mMapping, FILE_MAP_READ, 0, 0, 0));
+	if (mData == nullptr)
+	{
+		Close();
+		return false;
+	}
+	mSize = static_cast<size_t>(fileSize.QuadPart);
+	return true;
+}
+
+void MappedFile::Close()
+{
+	if (mData != nullptr)
+	{
+		UnmapViewOfFile(mData);
+		mData = nullptr;
+	}
+	if (mMapping != nullptr)
+	{
+		CloseHandle(mMapping);
+		mMapping = nullptr;
+	}
+	if (mFile != INVALID_HANDLE_VALUE)
+	{
+		CloseHandle(mFile);
+		mFile = INVALID_HANDLE_VALUE;
+	}
+	mSize = 0;
+}
+
+#else
+
+bool MappedFile::Open(const std::filesystem::path& filePath)
+{
+	Close();
+
+	const int file = open(filePath.c_str(), O_RDONLY);
+	if (file < 0)
+	{
+		return false;
+	}
+
+	// the mapping keeps the file alive, the descriptor is not needed past this point
+	struct stat fileStat{};
+	void* data = MAP_FAILED;
+	if (fstat(file, &fileStat) == 0 && fileStat.st_size > 0)
+	{
+		data = mmap(nullptr, static_cast<size_t>(fileStat.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+	}
+	close(file);
+	if (data == MAP_FAILED)
+	{
+		return false;
+	}
+
+	mData = static_cast<const uint8_t*>(data);
+	mSize = static_cast<size_t>(fileStat.st_size);
+	return true;
+}
+
+void MappedFile::Close()
+{
+	if (mData != nullptr)
+	{
+		munmap(const_cast<uint8_t*>(mData), mSize);
+		mData = nullptr;
+	}
+	mSize = 0;
+}
+
+#endif
@@ -0,0 +1,66 @@
+#include "Precompiled.h"
+#include "ThreadPool.h"
+#include "DebugUtil.h"
+
+using namespace ML_Engine;
+using namespace ML_Engine::Core;
+
+ThreadPool::~ThreadPool()
+{
+	Terminate();
+}
+
+void ThreadPool::Initialize(uint32_t threadCount)
+{
+	ASSERT(mThreads.empty(), "ThreadPool: is already initialized");
+	mStopping = false;
+	threadCount = std::max(threadCount, 1u);
+	mThreads.reserve(threadCount);
+	for (uint32_t i = 0; i < threadCount; ++i)
+	{
+		mThreads.emplace_back(&ThreadPool::WorkerLoop, this);
+	}
+}
+
+void ThreadPool::Terminate()
+{
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		mStopping = true;
+	}
+	mJobAdded.notify_all();
+	for (std::thread& thread : mThreads)
+	{
+		thread.join();
+	}
+	mThreads.clear();
+}
+
+void ThreadPool::Enqueue(std::function<void()> job)
+{
+	ASSERT(!mThreads.empty(), "ThreadPool: is not initialized");
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		mJobs.push_back(std::move(job));
+	}
+	mJobAdded.notify_one();
+}
+
+void ThreadPool::WorkerLoop()
+{
+	while (true)
+	{
+		std::function<void()> job;
+		{
+			std::unique_lock<std::mutex> lock(mMutex);
+			mJobAdded.wait(lock, [this]() { return mStopping || !mJobs.empty(); });
+			if (mJobs.empty())
+			{
+				return;
+			}
+			job = std::move(mJobs.front());
+			mJobs.pop_front();
+		}
+		job();
+	}
+}
@@ -0,0 +1,41 @@
+#include "Precompiled.h"
+#include "ThreadUtil.h"
+
+using namespace ML_Engine;
+using namespace ML_Engine::Core;
+
+uint32_t ThreadUtil::GetWorkerCount()
+{
+	static const uint32_t workerCount = std::max(std::thread::hardware_concurrency(), 1u);
+	return workerCount;
+}
+
+void ThreadUtil::ParallelFor(size_t count, size_t minBatchSize, const std::function<void(size_t, size_t)>& work)
+{
+	if (count == 0)
+	{
+		return;
+	}
+
+	const size_t maxBatches = (count + minBatchSize - 1) / std::max<size_t>(minBatchSize, 1);
+	const size_t batchCount = std::min<size_t>(GetWorkerCount(), maxBatches);
+	if (batchCount <= 1)
+	{
+		work(0, count);
+		return;
+	}
+
+	// the caller takes the first range
+	const size_t batchSize = (count + batchCount - 1) / batchCount;
+	std::vector<std::thread> threads;
+	threads.reserve(batchCount - 1);
+	for (size_t begin = batchSize; begin < count; begin += batchSize)
+	{
+		threads.emplace_back(work, begin, std::min(begin + batchSize, count));
+	}
+	work(0, std::min(batchSize, count));
+	for (std::thread& thread : threads)
+	{
+		thread.join();
+	}
+}
@@ -8,6 +8,11 @@ using namespace ML_Engine::Core;
 
 void WindowMessageHandler::Hook(HWND window, Callback cb)
 {
+	// headless apps have no window to hook
+	if (window == nullptr)
+	{
+		return;
+	}
 	mWindow = window;
 	mPreviousCallback = (Callback)GetWindowLongPtrA(window, GWLP_WNDPROC);
 	SetWindowLongPtrA(window, GWLP_WNDPROC, (LONG_PTR)cb);
@@ -15,6 +20,10 @@ void WindowMessageHandler::Hook(HWND window, Callback cb)
 
 void WindowMessageHandler::Unhook()
 {
+	if (mWindow == nullptr)
+	{
+		return;
+	}
 	SetWindowLongPtrA(mWindow, GWLP_WNDPROC, (LONG_PTR)mPreviousCallback);
 	mWindow = nullptr;
 }
@@ -41,8 +41,11 @@ namespace ML_Engine::Graphics
 		void Zoom(float amount);
 
 		// getters
+		ProjectionMode GetMode() const;
 		const Math::Vector3& GetPosition() const;
 		const Math::Vector3& GetDirection() const;
+		float GetNearPlane() const;
+		float GetFarPlane() const;
 
 		Math::Matrix4 GetViewMatrix() const;
 		Math::Matrix4 GetProjectionMatrix() const;
@@ -50,6 +53,9 @@ namespace ML_Engine::Graphics
 		Math::Matrix4 GetPerspectiveMatrix() const;
 		Math::Matrix4 GetOrthographicMatrix() const;
 
+		// view frustum in world space, for culling
+		Math::Frustum GetFrustum() const;
+
 	private:
 		ProjectionMode mProjectionMode = ProjectionMode::Perspective;
 
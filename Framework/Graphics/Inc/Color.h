@@ -159,6 +159,49 @@ namespace ML_Engine::Graphics {
         constexpr Color YellowGreen{ 0.603921592f, 0.803921640f, 0.196078449f, 1.000000000f };
 
     } // namespace Colors
+
+    // 8 bits per channel in r, g, b, a byte order, reads as DXGI_FORMAT_R8G8B8A8_UNORM
+    struct PackedColor
+    {
+        uint8_t r = 0;
+        uint8_t g = 0;
+        uint8_t b = 0;
+        uint8_t a = 0;
+    };
+
+    // clamps each channel to [0, 1] and rounds to the nearest of the 256 levels
+    inline PackedColor PackColor(const Color& color)
+    {
+        PackedColor packed;
+#if ML_MATH_SIMD != ML_MATH_SIMD_SCALAR
+        // max with zero first so nan channels become 0, the packs saturate to bytes
+        __m128 v = _mm_loadu_ps(&color.x);
+        v = _mm_min_ps(_mm_max_ps(v, _mm_setzero_ps()), _mm_set1_ps(1.0f));
+        const __m128i words = _mm_cvtps_epi32(_mm_mul_ps(v, _mm_set1_ps(255.0f)));
+        const __m128i shorts = _mm_packs_epi32(words, words);
+        const uint32_t bytes = static_cast<uint32_t>(_mm_cvtsi128_si32(_mm_packus_epi16(shorts, shorts)));
+        packed.r = static_cast<uint8_t>(bytes);
+        packed.g = static_cast<uint8_t>(bytes >> 8);
+        packed.b = static_cast<uint8_t>(bytes >> 16);
+        packed.a = static_cast<uint8_t>(bytes >> 24);
+#else
+        auto ToByte = [](float channel)
+        {
+            return static_cast<uint8_t>(lrintf((channel > 0.0f) ? ML_Engine::Math::Min(channel, 1.0f) * 255.0f : 0.0f));
+        };
+        packed.r = ToByte(color.x);
+        packed.g = ToByte(color.y);
+        packed.b = ToByte(color.z);
+        packed.a = ToByte(color.w);
+#endif
+        return packed;
+    }
+
+    inline Color UnpackColor(PackedColor packed)
+    {
+        constexpr float scale = 1.0f / 255.0f;
+        return { packed.r * scale, packed.g * scale, packed.b * scale, packed.a * scale };
+    }
 } // namespace X
 
 #endif // #ifndef INCLUDED_XENGINE_COLORS_H
\ No newline at end of file
@@ -17,6 +17,7 @@ namespace ML_Engine::Graphics
 		void BindPS(uint32_t slot) const;
 	private:
 		ID3D11Buffer* mConstantBuffer = nullptr;
+		uint32_t mSize = 0;
 	};
 
 	template<class DataType>
@@ -8,18 +8,29 @@
 #include "BlendState.h"
 #include "Camera.h"
 #include "ConstantBuffer.h"
+#include "D3D11Backend.h"
 #include "DebugUI.h"
 #include "DirectionalLight.h"
+#include "GraphicsBackend.h"
+#include "GraphicsStateCache.h"
+#include "InstanceBuffer.h"
 #include "Material.h"
 #include "MeshBuffer.h"
 #include "MeshBuilder.h"
+#include "Meshlet.h"
+#include "MeshLod.h"
+#include "MeshOptimizer.h"
+#include "MeshStreams.h"
 #include "MeshTypes.h"
 #include "Model.h"
+#include "ModelFile.h"
 #include "ModelManager.h"
 #include "ModelIO.h"
+#include "NullBackend.h"
 #include "PixelShader.h"
 #include "PostProcessingEffect.h"
 #include "RenderObject.h"
+#include "RenderQueue.h"
 #include "RenderTarget.h"
 #include "Sampler.h"
 #include "SimpleTextureEffect.h"
@@ -27,7 +38,9 @@
 #include "Texture.h"
 #include "TextureManager.h"
 #include "Transform.h"
+#include "TransformHierarchy.h"
 #include "ShadowEffect.h"
 #include "SimpleDraw.h"
+#include "VertexPacking.h"
 #include "VertexShader.h"
 #include "VertexTypes.h"
\ No newline at end of file
@@ -0,0 +1,117 @@
+#pragma once
+
+namespace ML_Engine::Graphics
+{
+	enum class GraphicsCommand : uint8_t
+	{
+		CreateBuffer,
+		CreateShader,
+		CreateInputLayout,
+		CreateState,
+		CreateTexture,
+		CreateView,
+		UpdateBuffer,
+		BindConstantBuffer,
+		BindTexture,
+		BindSampler,
+		BindShader,
+		BindInputLayout,
+		BindTopology,
+		BindVertexBuffer,
+		BindIndexBuffer,
+		BindState,
+		BindRenderTarget,
+		SetViewport,
+		Clear,
+		Draw,
+		DrawIndexed,
+		DrawInstanced,
+		DrawIndexedInstanced,
+		Count
+	};
+
+	struct GraphicsStats
+	{
+		std::array<uint32_t, static_cast<size_t>(GraphicsCommand::Count)> commandCounts{};
+		uint64_t vertexCount = 0;   // vertices of plain draws plus indices of indexed ones, times the instances
+		uint64_t bytesUploaded = 0; // initial data and updates
+
+		uint32_t GetCount(GraphicsCommand command) const { return commandCounts[static_cast<size_t>(command)]; }
+		uint32_t GetDrawCount() const;
+		uint32_t GetBindCount() const;
+	};
+
+	// The device and context calls the graphics classes make, with the D3D11 signatures.
+	// Every backend counts the calls per frame and in total, and can record the order of
+	// the current frame. The null backend stops there: it hands out null resources and
+	// executes nothing, so the cpu side of the render path runs without a gpu.
+	class GraphicsBackend
+	{
+	public:
+		virtual ~GraphicsBackend() = default;
+
+		virtual HRESULT CreateBuffer(const D3D11_BUFFER_DESC* desc, const D3D11_SUBRESOURCE_DATA* initData, ID3D11Buffer** buffer) = 0;
+		virtual HRESULT CreateVertexShader(const void* byteCode, SIZE_T byteCodeLength, ID3D11VertexShader** shader) = 0;
+		virtual HRESULT CreatePixelShader(const void* byteCode, SIZE_T byteCodeLength, ID3D11PixelShader** shader) = 0;
+		virtual HRESULT CreateInputLayout(const D3D11_INPUT_ELEMENT_DESC* elements, UINT elementCount, const void* byteCode, SIZE_T byteCodeLength, ID3D11InputLayout** inputLayout) = 0;
+		virtual HRESULT CreateSamplerState(const D3D11_SAMPLER_DESC* desc, ID3D11SamplerState** sampler) = 0;
+		virtual HRESULT CreateBlendState(const D3D11_BLEND_DESC* desc, ID3D11BlendState** blendState) = 0;
+		virtual HRESULT CreateDepthStencilState(const D3D11_DEPTH_STENCIL_DESC* desc, ID3D11DepthStencilState** depthStencilState) = 0;
+		virtual HRESULT CreateTexture2D(const D3D11_TEXTURE2D_DESC* desc, const D3D11_SUBRESOURCE_DATA* initData, ID3D11Texture2D** texture) = 0;
+		virtual HRESULT CreateShaderResourceView(ID3D11Resource* resource, const D3D11_SHADER_RESOURCE_VIEW_DESC* desc, ID3D11ShaderResourceView** view) = 0;
+		virtual HRESULT CreateRenderTargetView(ID3D11Resource* resource, const D3D11_RENDER_TARGET_VIEW_DESC* desc, ID3D11RenderTargetView** view) = 0;
+		virtual HRESULT CreateDepthStencilView(ID3D11Resource* resource, const D3D11_DEPTH_STENCIL_VIEW_DESC* desc, ID3D11DepthStencilView** view) = 0;
+		// decodes an image file with WIC
+		virtual HRESULT CreateTextureFromFile(const std::filesystem::path& fileName, ID3D11ShaderResourceView** view) = 0;
+
+		// replaces the whole resource, size is only used for the stats
+		virtual void UpdateSubresource(ID3D11Resource* resource, const void* data, size_t size) = 0;
+		// map with discard, copy and unmap
+		virtual void UpdateDynamicBuffer(ID3D11Buffer* buffer, const void* data, size_t size) = 0;
+
+		virtual void VSSetConstantBuffers(UINT slot, UINT count, ID3D11Buffer* const* buffers) = 0;
+		virtual void PSSetConstantBuffers(UINT slot, UINT count, ID3D11Buffer* const* buffers) = 0;
+		virtual void VSSetShaderResources(UINT slot, UINT count, ID3D11ShaderResourceView* const* views) = 0;
+		virtual void PSSetShaderResources(UINT slot, UINT count, ID3D11ShaderResourceView* const* views) = 0;
+		virtual void VSSetSamplers(UINT slot, UINT count, ID3D11SamplerState* const* samplers) = 0;
+		virtual void PSSetSamplers(UINT slot, UINT count, ID3D11SamplerState* const* samplers) = 0;
+		virtual void VSSetShader(ID3D11VertexShader* shader) = 0;
+		virtual void PSSetShader(ID3D11PixelShader* shader) = 0;
+		virtual void IASetInputLayout(ID3D11InputLayout* inputLayout) = 0;
+		virtual void IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY topology) = 0;
+		virtual void IASetVertexBuffers(UINT slot, UINT count, ID3D11Buffer* const* buffers, const UINT* strides, const UINT* offsets) = 0;
+		virtual void IASetIndexBuffer(ID3D11Buffer* buffer, DXGI_FORMAT format, UINT offset) = 0;
+		virtual void OMSetBlendState(ID3D11BlendState* blendState) = 0;
+		virtual void OMSetDepthStencilState(ID3D11DepthStencilState* depthStencilState) = 0;
+		virtual void OMSetRenderTargets(UINT count, ID3D11RenderTargetView* const* views, ID3D11DepthStencilView* depthStencilView) = 0;
+		// adds a reference to the returned views like D3D11 does
+		virtual void OMGetRenderTargets(UINT count, ID3D11RenderTargetView** views, ID3D11DepthStencilView** depthStencilView) = 0;
+		virtual void RSSetViewports(UINT count, const D3D11_VIEWPORT* viewports) = 0;
+		virtual void RSGetViewports(UINT* count, D3D11_VIEWPORT* viewports) = 0;
+		virtual void ClearRenderTargetView(ID3D11RenderTargetView* view, const FLOAT color[4]) = 0;
+		virtual void ClearDepthStencilView(ID3D11DepthStencilView* view, UINT flags, FLOAT depth, UINT8 stencil) = 0;
+		virtual void Draw(UINT vertexCount, UINT startVertex) = 0;
+		virtual void DrawIndexed(UINT indexCount, UINT startIndex, INT baseVertex) = 0;
+		virtual void DrawInstanced(UINT vertexCount, UINT instanceCount, UINT startVertex, UINT startInstance) = 0;
+		virtual void DrawIndexedInstanced(UINT indexCount, UINT instanceCount, UINT startIndex, INT baseVertex, UINT startInstance) = 0;
+
+		// clears the frame stats and the recording
+		void BeginFrame();
+
+		const GraphicsStats& GetFrameStats() const { return mFrameStats; }
+		const GraphicsStats& GetTotalStats() const { return mTotalStats; }
+
+		// keeps the commands of the current frame in order
+		void SetRecording(bool recording);
+		const std::vector<GraphicsCommand>& GetRecording() const { return mRecording; }
+
+	protected:
+		void Record(GraphicsCommand command, uint64_t vertexCount = 0, uint64_t bytes = 0);
+
+	private:
+		GraphicsStats mFrameStats;
+		GraphicsStats mTotalStats;
+		std::vector<GraphicsCommand> mRecording;
+		bool mRecordingEnabled = false;
+	};
+}
@@ -0,0 +1,111 @@
+#pragma once
+
+namespace ML_Engine::Graphics
+{
+	enum class ShaderStage : uint8_t
+	{
+		Vertex,
+		Pixel,
+		Count
+	};
+
+	enum class StateCall : uint8_t
+	{
+		Shader,
+		InputLayout,
+		BlendState,
+		Sampler,
+		ShaderResource,
+		ConstantBuffer,
+		BufferUpdate,
+		Topology,
+		VertexBuffer,
+		IndexBuffer,
+		Count
+	};
+
+	struct StateCacheStats
+	{
+		std::array<uint32_t, static_cast<size_t>(StateCall::Count)> issuedCounts{};
+		std::array<uint32_t, static_cast<size_t>(StateCall::Count)> filteredCounts{};
+
+		uint32_t GetIssued(StateCall call) const { return issuedCounts[static_cast<size_t>(call)]; }
+		uint32_t GetFiltered(StateCall call) const { return filteredCounts[static_cast<size_t>(call)]; }
+		uint32_t GetIssuedCount() const;
+		uint32_t GetFilteredCount() const;
+	};
+
+	// Remembers what the graphics classes last bound and drops calls that would bind it again.
+	// Bindings are keyed by the engine object that made them, not by the d3d pointer, since
+	// the null backend hands out nullptr for everything. Every Set/Update returns true when
+	// the caller has to issue the call. Anything that binds around the graphics classes has
+	// to Invalidate(), GraphicsSystem does it at the start of every frame.
+	class GraphicsStateCache final
+	{
+	public:
+		static constexpr uint32_t MaxSlots = 16;
+
+		GraphicsStateCache();
+
+		bool SetVertexShader(const void* shader);
+		// variant tells apart the layouts one shader owns
+		bool SetInputLayout(const void* shader, uint32_t variant);
+		bool SetPixelShader(const void* shader);
+		// blend and depth stencil state go together, nullptr for the default state
+		bool SetBlendState(const void* blendState);
+		bool SetSampler(ShaderStage stage, uint32_t slot, const void* sampler);
+		// nullptr to unbind
+		bool SetShaderResource(ShaderStage stage, uint32_t slot, const void* texture);
+		bool SetConstantBuffer(ShaderStage stage, uint32_t slot, const void* buffer);
+		// skips an upload with the same contents as the last one to this buffer, by 64 bit hash
+		bool UpdateConstantBuffer(const void* buffer, const void* data, size_t size);
+		bool SetTopology(uint32_t topology);
+		// streams tells apart the positions only binding of a split mesh buffer
+		bool SetVertexBuffers(const void* meshBuffer, uint32_t streams);
+		bool SetIndexBuffer(const void* meshBuffer);
+		bool SetInstanceBuffer(const void* instanceBuffer);
+
+		// drops every binding and the upload hash of object, call when it releases or
+		// changes its resources, or when d3d unbinds them
+		void Forget(const void* object);
+		// forgets all bindings, upload hashes stay valid
+		void Invalidate();
+
+		// disabled, every call is issued and only counted
+		void SetEnabled(bool enabled);
+		bool IsEnabled() const { return mEnabled; }
+
+		// clears the frame stats and invalidates
+		void BeginFrame();
+
+		const StateCacheStats& GetFrameStats() const { return mFrameStats; }
+		const StateCacheStats& GetTotalStats() const { return mTotalStats; }
+
+	private:
+		using SlotArray = std::array<const void*, MaxSlots>;
+
+		bool Set(StateCall call, const void*& current, const void* value);
+		bool SetSlot(StateCall call, SlotArray& slots, uint32_t slot, const void* value);
+		bool Count(StateCall call, bool issued);
+
+		const void* mVertexShader;
+		const void* mInputLayout;
+		uint32_t mInputLayoutVariant = 0;
+		const void* mPixelShader;
+		const void* mBlendState;
+		std::array<SlotArray, static_cast<size_t>(ShaderStage::Count)> mSamplers;
+		std::array<SlotArray, static_cast<size_t>(ShaderStage::Count)> mShaderResources;
+		std::array<SlotArray, static_cast<size_t>(ShaderStage::Count)> mConstantBuffers;
+		std::unordered_map<const void*, uint64_t> mBufferHashes;
+		uint32_t mTopology = 0;
+		bool mHasTopology = false;
+		const void* mVertexBuffers;
+		uint32_t mVertexStreams = 0;
+		const void* mIndexBuffer;
+		const void* mInstanceBuffer;
+
+		StateCacheStats mFrameStats;
+		StateCacheStats mTotalStats;
+		bool mEnabled = true;
+	};
+}
@@ -1,6 +1,8 @@
 #pragma once
 
 #include "Color.h"
+#include "GraphicsBackend.h"
+#include "GraphicsStateCache.h"
 
 namespace ML_Engine::Graphics
 {
@@ -8,6 +10,8 @@ namespace ML_Engine::Graphics
     {
     public:
         static void StaticInitialize(HWND window, bool fullscreen);
+        // no window, device or swap chain, every call goes to a NullBackend
+        static void StaticInitializeHeadless(uint32_t width, uint32_t height);
         static void StaticTerminate();
         static GraphicsSystem* Get();
 
@@ -20,6 +24,7 @@ namespace ML_Engine::Graphics
         GraphicsSystem& operator=(const GraphicsSystem&&) = delete;
 
         void Initialize(HWND window, bool fullscreen);
+        void InitializeHeadless(uint32_t width, uint32_t height);
         void Terminate();
 
         void BeginRender();
@@ -38,6 +43,14 @@ namespace ML_Engine::Graphics
         uint32_t GetBackBufferHeight() const;
         float GetBackBufferAspectRatio() const;
 
+        bool IsHeadless() const;
+
+        // all graphics classes create, bind and draw through the backend
+        GraphicsBackend* GetBackend();
+        // the graphics classes ask it before binding or uploading, see GraphicsStateCache
+        GraphicsStateCache* GetStateCache();
+
+        // nullptr when headless
         ID3D11Device* GetDevice();
         ID3D11DeviceContext* GetContext();
     private:
@@ -45,6 +58,8 @@ namespace ML_Engine::Graphics
 
         ID3D11Device* mD3DDevice = nullptr;
         ID3D11DeviceContext* mImmediateContext = nullptr;
+        std::unique_ptr<GraphicsBackend> mBackend;
+        GraphicsStateCache mStateCache;
 
         IDXGISwapChain* mSwapChain = nullptr;
         ID3D11RenderTargetView* mRenderTargetView = nullptr;
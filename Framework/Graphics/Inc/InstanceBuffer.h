@@ -0,0 +1,45 @@
+#pragma once
+
+namespace ML_Engine::Graphics
+{
+	// entries of the material palette an instance can pick, the shaders size their arrays to match
+	constexpr uint32_t MaxInstanceMaterials = 16;
+
+	// world may scale non-uniformly or mirror, the standard shader builds the normal matrix
+	// from it per vertex. It must stay affine and invertible, the last column is not read
+	// for normals and a singular matrix gives zero normals.
+	struct InstanceData
+	{
+		Math::Matrix4 world;        // not transposed, the shaders rebuild it from rows
+		uint32_t materialIndex = 0;
+	};
+
+	// Per instance data in its own vertex stream, bound to Slot next to the mesh streams.
+	// One MeshBuffer::RenderInstanced() draws the mesh once for every instance in it.
+	class InstanceBuffer final
+	{
+	public:
+		static constexpr uint32_t Slot = 2;
+
+		InstanceBuffer() = default;
+		~InstanceBuffer();
+
+		InstanceBuffer(const InstanceBuffer&) = delete;
+		InstanceBuffer& operator=(const InstanceBuffer&) = delete;
+
+		void Initialize(uint32_t maxInstanceCount);
+		void Terminate();
+
+		// replaces the instances, at most the count given to Initialize
+		void Update(const InstanceData* instances, uint32_t instanceCount);
+		void Bind() const;
+
+		uint32_t GetInstanceCount() const { return mInstanceCount; }
+		uint32_t GetMaxInstanceCount() const { return mMaxInstanceCount; }
+
+	private:
+		ID3D11Buffer* mInstanceBuffer = nullptr;
+		uint32_t mMaxInstanceCount = 0;
+		uint32_t mInstanceCount = 0;
+	};
+}
@@ -1,8 +1,11 @@
 #pragma once
 
+#include "MeshTypes.h"
 
 namespace ML_Engine::Graphics
 {
+	class InstanceBuffer;
+
 	class MeshBuffer final
 	{
 	public:
@@ -23,24 +26,70 @@ namespace ML_Engine::Graphics
 				static_cast<uint32_t>(mesh.indices.size()));
 		}
 
+		// Uploads positions and the remaining attributes as two vertex streams, in slots 0 and 1,
+		// so depth only passes fetch just the positions. Draw with VertexShader::BindSplit().
+		template<class MeshType>
+		void InitializeSplit(const MeshType& mesh)
+		{
+			using VertexType = typename MeshType::VertexType;
+			static_assert(offsetof(VertexType, position) == 0, "MeshBuffer: split streams need the position first");
+			InitializeSplit(mesh.vertices.data(),
+				static_cast<uint32_t>(sizeof(VertexType)),
+				static_cast<uint32_t>(sizeof(VertexType::position)),
+				static_cast<uint32_t>(mesh.vertices.size()),
+				mesh.indices.data(),
+				static_cast<uint32_t>(mesh.indices.size()),
+				static_cast<uint32_t>(mesh.indices.size()));
+		}
+
 		void Initialize(const void* vertices, uint32_t vertexSize, uint32_t vertexCount);
-		void Initialize(const void* vertices, uint32_t vertexSize, uint32_t vertexCount, const void* indices, uint32_t indexCount);
+		// indices are uploaded as 16 bit when vertexCount allows it
+		void Initialize(const void* vertices, uint32_t vertexSize, uint32_t vertexCount, const uint32_t* indices, uint32_t indexCount);
+		// Render() draws the first indexCount indices, the rest of the bufferIndexCount indices
+		// hold extra ranges for Render(startIndex, indexCount), e.g. the levels of a lod chain
+		void Initialize(const void* vertices, uint32_t vertexSize, uint32_t vertexCount, const uint32_t* indices, uint32_t indexCount, uint32_t bufferIndexCount);
+		// every vertex starts with positionSize bytes of position
+		void InitializeSplit(const void* vertices, uint32_t vertexSize, uint32_t positionSize, uint32_t vertexCount, const uint32_t* indices, uint32_t indexCount, uint32_t bufferIndexCount);
+		// the same from streams that are already apart, e.g. the stored blocks of a split model mesh
+		void InitializeStreams(const void* positions, uint32_t positionSize, const void* attributes, uint32_t attributeSize, uint32_t vertexCount, const uint32_t* indices, uint32_t indexCount, uint32_t bufferIndexCount);
+		// indices already in indexFormat are uploaded as they are, e.g. the stored index block of a model file
+		void InitializeStreams(const void* positions, uint32_t positionSize, const void* attributes, uint32_t attributeSize, uint32_t vertexCount, const void* indices, IndexFormat indexFormat, uint32_t indexCount, uint32_t bufferIndexCount);
 		void Terminate();
 
 		void SetTopology(Topology topology);
 		void Update(const void* vertices, uint32_t vertexCount);
 		void Render() const;
+		// draws part of the index buffer, e.g. the visible meshlets of a mesh
+		void Render(uint32_t startIndex, uint32_t indexCount) const;
+		// Binds only the positions to slot 0, for shaders whose input is just POSITION. Works
+		// on interleaved buffers too, their vertices start with the position.
+		void RenderPositions() const;
+		// draws the whole mesh once for every instance, with a VE_Instanced vertex shader bound
+		void RenderInstanced(const InstanceBuffer& instances) const;
+		void RenderPositionsInstanced(const InstanceBuffer& instances) const;
+
+		IndexFormat GetIndexFormat() const { return mIndexFormat; }
+		bool HasPositionStream() const { return mPositionSize > 0; }
 
 	private:
+		void BindVertexBuffers(bool positionsOnly) const;
+		void Draw() const;
+		void DrawInstanced(const InstanceBuffer& instances) const;
 		void CreateVertexBuffer(const void* vertices, uint32_t vertexSize, uint32_t vertexCount);
-		void CreateIndexBuffer(const void* indices, uint32_t indexCount);
+		void CreatePositionBuffer(const void* positions, uint32_t positionSize, uint32_t vertexCount);
+		void CreateIndexBuffer(const uint32_t* indices, uint32_t indexCount);
+		void CreateIndexBuffer(const void* indices, IndexFormat indexFormat, uint32_t indexCount);
 
-		ID3D11Buffer* mVertexBuffer = nullptr;
+		ID3D11Buffer* mVertexBuffer = nullptr; // attributes only when split
+		ID3D11Buffer* mPositionBuffer = nullptr;
 		ID3D11Buffer* mIndexBuffer = nullptr;
 		D3D11_PRIMITIVE_TOPOLOGY mTopology = D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST;
 
 		uint32_t mVertexSize;
+		uint32_t mPositionSize = 0;
 		uint32_t mVertexCount;
-		uint32_t mIndexCount;
+		uint32_t mIndexCount = 0; // drawn by Render()
+		uint32_t mBufferIndexCount = 0; // all ranges, for Render(startIndex, indexCount)
+		IndexFormat mIndexFormat = IndexFormat::UInt32;
 	};
 }
\ No newline at end of file
@@ -0,0 +1,92 @@
+#pragma once
+
+#include "MeshTypes.h"
+
+namespace ML_Engine::Graphics
+{
+	class Camera;
+
+	// A reduced detail index list over the vertices of the full mesh. error is the largest
+	// distance the simplified surface moved, in mesh units, used to pick it at runtime.
+	struct MeshLod
+	{
+		std::vector<uint32_t> indices;
+		float error = 0.0f;
+	};
+
+	// One level of a lod chain packed into a single index buffer, level 0 is the full mesh
+	struct MeshLodRange
+	{
+		uint32_t indexOffset = 0;
+		uint32_t indexCount = 0;
+		float error = 0.0f;
+	};
+
+	namespace MeshSimplifier
+	{
+		constexpr uint32_t DefaultLodCount = 3;
+		constexpr float DefaultLodReduction = 0.5f;
+
+		// Quadric error edge collapse (Garland and Heckbert 1997) down to targetIndexCount.
+		// Vertices are collapsed onto a neighbour, never moved, so the result indexes the
+		// original vertex buffer. Vertices sharing a position collapse together and
+		// attributeDistance() weighs how far their normals and uvs get pulled, which keeps
+		// uv seams and hard edges in place until nothing cheaper is left. Returns the largest
+		// distance from an original position to the result, in mesh units.
+		float Simplify(const uint32_t* indices, size_t indexCount, const Math::Vector3* positions, size_t vertexCount, size_t stride,
+			const std::function<float(uint32_t, uint32_t)>& attributeDistance, size_t targetIndexCount, std::vector<uint32_t>& result);
+
+		// Simplifies once through up to lodCount levels, each with reduction times the
+		// triangles of the one before it, and cache optimizes them. The chain ends early when
+		// a level can not be reduced any further.
+		void BuildLods(const uint32_t* indices, size_t indexCount, const Math::Vector3* positions, size_t vertexCount, size_t stride,
+			const std::function<float(uint32_t, uint32_t)>& attributeDistance, uint32_t lodCount, float reduction, std::vector<MeshLod>& lods);
+
+		// squared attribute difference of two vertices, uv differences weigh the most
+		template<class VertexT>
+		float AttributeDistance(const VertexT& a, const VertexT& b)
+		{
+			float distance = 0.0f;
+			if constexpr ((VertexT::Format & VE_Normal) != 0)
+			{
+				distance += Math::MagnitudeSqr(a.normal - b.normal);
+			}
+			if constexpr ((VertexT::Format & VE_Color) != 0)
+			{
+				const Color d = a.color - b.color;
+				distance += d.x * d.x + d.y * d.y + d.z * d.z + d.w * d.w;
+			}
+			if constexpr ((VertexT::Format & VE_TexCoord) != 0)
+			{
+				const float du = a.uvCoord.x - b.uvCoord.x;
+				const float dv = a.uvCoord.y - b.uvCoord.y;
+				distance += 10.0f * (du * du + dv * dv);
+			}
+			return distance;
+		}
+
+		template<class VertexT>
+		std::vector<MeshLod> BuildLods(const MeshBase<VertexT>& mesh, uint32_t lodCount = DefaultLodCount, float reduction = DefaultLodReduction)
+		{
+			std::vector<MeshLod> lods;
+			if (!mesh.vertices.empty())
+			{
+				const std::vector<VertexT>& vertices = mesh.vertices;
+				BuildLods(mesh.indices.data(), mesh.indices.size(), &vertices[0].position, vertices.size(), sizeof(VertexT),
+					[&vertices](uint32_t a, uint32_t b)
+					{
+						return AttributeDistance(vertices[a], vertices[b]);
+					}, lodCount, reduction, lods);
+			}
+			return lods;
+		}
+	}
+
+	namespace LodSelector
+	{
+		// Picks the coarsest level whose error projects to at most pixelError pixels on
+		// screen. bounds are in object space, world may scale them.
+		uint32_t Select(const std::vector<MeshLodRange>& lods, const Math::Sphere& bounds, const Math::Matrix4& world,
+			const Camera& camera, float screenHeight, float pixelError = 1.0f);
+	}
+}
@@ -0,0 +1,211 @@
+#pragma once
+
+#include "MeshTypes.h"
+
+namespace ML_Engine::Graphics
+{
+	// Reorders mesh data for the GPU: triangles for the post-transform vertex cache
+	// and for overdraw, vertices for fetch locality. Each pass keeps the mesh
+	// rendering identically, only the order of the data changes.
+	namespace MeshOptimizer
+	{
+		constexpr uint32_t DefaultCacheSize = 16;
+
+		struct VertexCacheStats
+		{
+			uint32_t vertexTransforms = 0;  // cache misses
+			float acmr = 0.0f;              // transforms per triangle, 0.5 is ideal, 3 is worst
+			float atvr = 0.0f;              // transforms per vertex, 1 is ideal
+		};
+
+		// FIFO cache simulation
+		VertexCacheStats AnalyzeVertexCache(const uint32_t* indices, size_t indexCount, size_t vertexCount, uint32_t cacheSize = DefaultCacheSize);
+
+		// Tipsify (Sander et al. 2007) triangle reorder for the post-transform cache
+		void OptimizeVertexCache(uint32_t* indices, size_t indexCount, size_t vertexCount, uint32_t cacheSize = DefaultCacheSize);
+
+		// Splits a cache optimized index list into clusters and sorts them outside-in so
+		// front facing geometry tends to draw first. threshold is the ACMR increase allowed
+		// by the extra cluster splits (1.05 = 5% more vertex transforms).
+		void OptimizeOverdraw(uint32_t* indices, size_t indexCount, const Math::Vector3* positions, size_t vertexCount, size_t stride = sizeof(Math::Vector3), float threshold = 1.05f, uint32_t cacheSize = DefaultCacheSize);
+
+		// Builds a remap table that orders vertices by first use, unreferenced vertices get
+		// UINT32_MAX. Rewrites the indices and returns the new vertex count.
+		uint32_t OptimizeVertexFetchRemap(uint32_t* indices, size_t indexCount, size_t vertexCount, std::vector<uint32_t>& remap);
+
+		template<class VertexT>
+		void OptimizeVertexFetch(MeshBase<VertexT>& mesh)
+		{
+			std::vector<uint32_t> remap;
+			const uint32_t vertexCount = OptimizeVertexFetchRemap(mesh.indices.data(), mesh.indices.size(), mesh.vertices.size(), remap);
+			std::vector<VertexT> vertices(vertexCount);
+			for (size_t i = 0; i < remap.size(); ++i)
+			{
+				if (remap[i] != UINT32_MAX)
+				{
+					vertices[remap[i]] = mesh.vertices[i];
+				}
+			}
+			mesh.vertices = std::move(vertices);
+		}
+
+		struct Report
+		{
+			VertexCacheStats original;
+			VertexCacheStats afterVertexCache;
+			VertexCacheStats afterOverdraw;
+			VertexCacheStats afterVertexFetch;
+		};
+
+		// Runs all three passes in order and records the cache stats after each one
+		template<class VertexT>
+		Report Optimize(MeshBase<VertexT>& mesh, float overdrawThreshold = 1.05f)
+		{
+			Report report;
+			const size_t indexCount = mesh.indices.size();
+			if (indexCount == 0 || mesh.vertices.empty())
+			{
+				return report;
+			}
+
+			uint32_t* indices = mesh.indices.data();
+			report.original = AnalyzeVertexCache(indices, indexCount, mesh.vertices.size());
+
+			OptimizeVertexCache(indices, indexCount, mesh.vertices.size());
+			report.afterVertexCache = AnalyzeVertexCache(indices, indexCount, mesh.vertices.size());
+
+			OptimizeOverdraw(indices, indexCount, &mesh.vertices[0].position, mesh.vertices.size(), sizeof(VertexT), overdrawThreshold);
+			report.afterOverdraw = AnalyzeVertexCache(indices, indexCount, mesh.vertices.size());
+
+			OptimizeVertexFetch(mesh);
+			report.afterVertexFetch = AnalyzeVertexCache(mesh.indices.data(), indexCount, mesh.vertices.size());
+			return report;
+		}
+
+		// Part of a mesh, vertices holds the source vertex of each chunk vertex
+		struct MeshChunk
+		{
+			std::vector<uint32_t> vertices;
+			std::vector<uint32_t> indices;
+		};
+
+		// Walks the triangles in order and starts a new chunk whenever the next one would
+		// need more than maxVertices vertices, so each chunk can use 16 bit indices. Run it
+		// on cache optimized indices, their locality keeps the duplicated vertices few.
+		void SplitIndices(const uint32_t* indices, size_t indexCount, size_t vertexCount, size_t maxVertices, std::vector<MeshChunk>& chunks);
+
+		template<class VertexT>
+		std::vector<MeshBase<VertexT>> SplitMesh(const MeshBase<VertexT>& mesh, size_t maxVertices = MaxIndex16VertexCount)
+		{
+			std::vector<MeshBase<VertexT>> meshes;
+			if (mesh.vertices.size() <= maxVertices)
+			{
+				meshes.push_back(mesh);
+				return meshes;
+			}
+
+			std::vector<MeshChunk> chunks;
+			SplitIndices(mesh.indices.data(), mesh.indices.size(), mesh.vertices.size(), maxVertices, chunks);
+			meshes.resize(chunks.size());
+			for (size_t i = 0; i < chunks.size(); ++i)
+			{
+				MeshBase<VertexT>& part = meshes[i];
+				part.vertices.reserve(chunks[i].vertices.size());
+				for (const uint32_t vertex : chunks[i].vertices)
+				{
+					part.vertices.push_back(mesh.vertices[vertex]);
+				}
+				part.indices = std::move(chunks[i].indices);
+			}
+			return meshes;
+		}
+
+		// Largest per component difference for two vertices to weld, 0 welds bit identical values only
+		struct WeldSettings
+		{
+			float positionEpsilon = 0.0f;
+			float normalEpsilon = 0.0f;
+			float tangentEpsilon = 0.0f;
+			float colorEpsilon = 0.0f;
+			float uvEpsilon = 0.0f;
+		};
+
+		// Builds a remap from each vertex to its welded vertex. Vertices are bucketed by
+		// position on a grid of positionEpsilon cells, equal() compares the other attributes
+		// of two candidates. Each vertex welds to the first earlier vertex that matches, so
+		// welded vertices are never further than the epsilons from the one they keep.
+		// Returns the welded vertex count.
+		uint32_t WeldVertexRemap(const Math::Vector3* positions, size_t vertexCount, size_t stride, float positionEpsilon, const std::function<bool(uint32_t, uint32_t)>& equal, std::vector<uint32_t>& remap);
+
+		template<class VertexT>
+		bool AreVerticesEqual(const VertexT& a, const VertexT& b, const WeldSettings& settings)
+		{
+			auto Near = [](const float* u, const float* v, size_t count, float epsilon)
+			{
+				for (size_t i = 0; i < count; ++i)
+				{
+					if (!(fabsf(u[i] - v[i]) <= epsilon))
+					{
+						return false;
+					}
+				}
+				return true;
+			};
+
+			if constexpr ((VertexT::Format & VE_Normal) != 0)
+			{
+				if (!Near(&a.normal.x, &b.normal.x, 3, settings.normalEpsilon)) return false;
+			}
+			if constexpr ((VertexT::Format & VE_Tangent) != 0)
+			{
+				if (!Near(&a.tangent.x, &b.tangent.x, 3, settings.tangentEpsilon)) return false;
+			}
+			if constexpr ((VertexT::Format & VE_Color) != 0)
+			{
+				if (!Near(&a.color.x, &b.color.x, 4, settings.colorEpsilon)) return false;
+			}
+			if constexpr ((VertexT::Format & VE_TexCoord) != 0)
+			{
+				if (!Near(&a.uvCoord.x, &b.uvCoord.x, 2, settings.uvEpsilon)) return false;
+			}
+			return true;
+		}
+
+		// Merges duplicate vertices and rebuilds the index buffer, keeps the first vertex of
+		// each group. Runs in parallel over large meshes. Returns the number of vertices removed.
+		template<class VertexT>
+		size_t WeldVertices(MeshBase<VertexT>& mesh, const WeldSettings& settings = {})
+		{
+			const size_t vertexCount = mesh.vertices.size();
+			if (vertexCount == 0)
+			{
+				return 0;
+			}
+
+			const std::vector<VertexT>& vertices = mesh.vertices;
+			std::vector<uint32_t> remap;
+			const uint32_t weldedCount = WeldVertexRemap(&vertices[0].position, vertexCount, sizeof(VertexT), settings.positionEpsilon,
+				[&vertices, &settings](uint32_t a, uint32_t b)
+				{
+					return AreVerticesEqual(vertices[a], vertices[b], settings);
+				}, remap);
+
+			// welded vertices are numbered in order of their first (kept) vertex
+			std::vector<VertexT> welded;
+			welded.reserve(weldedCount);
+			for (size_t i = 0; i < vertexCount; ++i)
+			{
+				if (remap[i] == welded.size())
+				{
+					welded.push_back(vertices[i]);
+				}
+			}
+			for (uint32_t& index : mesh.indices)
+			{
+				index = remap[index];
+			}
+			mesh.vertices = std::move(welded);
+			return vertexCount - weldedCount;
+		}
+	}
+}
@@ -0,0 +1,101 @@
+#pragma once
+
+#include "MeshTypes.h"
+
+namespace ML_Engine::Graphics
+{
+	// Helpers to move vertex attributes between a mesh and Math::Vector3Stream
+	// so the batch kernels in Math/BatchMath.h can run over whole meshes.
+	template<class VertexT>
+	void GetPositions(const MeshBase<VertexT>& mesh, Math::Vector3Stream& positions)
+	{
+		if (mesh.vertices.empty())
+		{
+			positions.Clear();
+			return;
+		}
+		Math::LoadStream(&mesh.vertices[0].position, mesh.vertices.size(), sizeof(VertexT), positions);
+	}
+
+	template<class VertexT>
+	void SetPositions(MeshBase<VertexT>& mesh, const Math::Vector3Stream& positions)
+	{
+		ASSERT(mesh.vertices.size() == positions.Size(), "MeshStreams: vertex count does not match");
+		if (!mesh.vertices.empty())
+		{
+			Math::StoreStream(positions, &mesh.vertices[0].position, sizeof(VertexT));
+		}
+	}
+
+	template<class VertexT>
+	void GetNormals(const MeshBase<VertexT>& mesh, Math::Vector3Stream& normals)
+	{
+		static_assert((VertexT::Format & VE_Normal) != 0, "MeshStreams: vertex type has no normal");
+		if (mesh.vertices.empty())
+		{
+			normals.Clear();
+			return;
+		}
+		Math::LoadStream(&mesh.vertices[0].normal, mesh.vertices.size(), sizeof(VertexT), normals);
+	}
+
+	template<class VertexT>
+	void SetNormals(MeshBase<VertexT>& mesh, const Math::Vector3Stream& normals)
+	{
+		static_assert((VertexT::Format & VE_Normal) != 0, "MeshStreams: vertex type has no normal");
+		ASSERT(mesh.vertices.size() == normals.Size(), "MeshStreams: vertex count does not match");
+		if (!mesh.vertices.empty())
+		{
+			Math::StoreStream(normals, &mesh.vertices[0].normal, sizeof(VertexT));
+		}
+	}
+
+	template<class VertexT>
+	void GetTangents(const MeshBase<VertexT>& mesh, Math::Vector3Stream& tangents)
+	{
+		static_assert((VertexT::Format & VE_Tangent) != 0, "MeshStreams: vertex type has no tangent");
+		if (mesh.vertices.empty())
+		{
+			tangents.Clear();
+			return;
+		}
+		Math::LoadStream(&mesh.vertices[0].tangent, mesh.vertices.size(), sizeof(VertexT), tangents);
+	}
+
+	template<class VertexT>
+	void SetTangents(MeshBase<VertexT>& mesh, const Math::Vector3Stream& tangents)
+	{
+		static_assert((VertexT::Format & VE_Tangent) != 0, "MeshStreams: vertex type has no tangent");
+		ASSERT(mesh.vertices.size() == tangents.Size(), "MeshStreams: vertex count does not match");
+		if (!mesh.vertices.empty())
+		{
+			Math::StoreStream(tangents, &mesh.vertices[0].tangent, sizeof(VertexT));
+		}
+	}
+
+	// Bakes a transform into the mesh. Normals and tangents are renormalized,
+	// so non uniform scale should be applied with the inverse transpose.
+	template<class VertexT>
+	void TransformMesh(MeshBase<VertexT>& mesh, const Math::Matrix4& transform)
+	{
+		Math::Vector3Stream stream;
+		GetPositions(mesh, stream);
+		Math::TransformCoord(stream, transform, stream);
+		SetPositions(mesh, stream);
+
+		if constexpr ((VertexT::Format & VE_Normal) != 0)
+		{
+			GetNormals(mesh, stream);
+			Math::TransformNormal(stream, transform, stream);
+			Math::Normalize(stream, stream);
+			SetNormals(mesh, stream);
+		}
+		if constexpr ((VertexT::Format & VE_Tangent) != 0)
+		{
+			GetTangents(mesh, stream);
+			Math::TransformNormal(stream, transform, stream);
+			Math::Normalize(stream, stream);
+			SetTangents(mesh, stream);
+		}
+	}
+}
@@ -4,16 +4,41 @@
 
 namespace ML_Engine::Graphics
 {
+	enum class IndexFormat
+	{
+		UInt16,
+		UInt32
+	};
+
+	// 16 bit indices address up to 65536 vertices, half the memory and bandwidth of 32 bit
+	constexpr size_t MaxIndex16VertexCount = 65536;
+
+	inline IndexFormat GetIndexFormat(size_t vertexCount)
+	{
+		return (vertexCount <= MaxIndex16VertexCount) ? IndexFormat::UInt16 : IndexFormat::UInt32;
+	}
+
+	inline uint32_t GetIndexSize(IndexFormat format)
+	{
+		return (format == IndexFormat::UInt16) ? sizeof(uint16_t) : sizeof(uint32_t);
+	}
+
 	template<class VertexT>
 	struct MeshBase
 	{
 		using VertexType = VertexT;
 		std::vector<VertexType> vertices;
-		std::vector<uint32_t> indices;
+		std::vector<uint32_t> indices; // 32 bit while processing, uploaded as GetIndexFormat(vertices.size())
 	};
 
 	using MeshP = MeshBase<VertexP>;
 	using MeshPC = MeshBase<VertexPC>;
 	using MeshPX = MeshBase<VertexPX>;
 	using Mesh = MeshBase<Vertex>;
+
+	// positions are quantized against positionBounds, VertexPacking decodes them
+	struct MeshPacked : MeshBase<VertexPacked>
+	{
+		Math::AABB positionBounds;
+	};
 }
\ No newline at end of file
@@ -0,0 +1,63 @@
+#pragma once
+
+#include "MeshTypes.h"
+
+namespace ML_Engine::Graphics
+{
+	class Camera;
+
+	// A cluster of at most MaxVertices unique vertices and MaxTriangles triangles. The
+	// builder reorders the mesh index buffer so every meshlet is one contiguous index range,
+	// which lets a culled mesh draw its visible clusters with plain indexed draws.
+	struct Meshlet
+	{
+		static constexpr uint32_t MaxVertices = 64;
+		static constexpr uint32_t MaxTriangles = 124;
+
+		uint32_t indexOffset = 0;
+		uint32_t indexCount = 0;
+		uint32_t vertexCount = 0;
+
+		Math::Sphere bounds;
+
+		// every triangle normal lies within the cone, coneCutoff is the sine of its half
+		// angle and 1 when the cone is too wide to ever be back facing
+		Math::Vector3 coneAxis = Math::Vector3::ZAxis;
+		float coneCutoff = 1.0f;
+	};
+
+	struct MeshletCullStats
+	{
+		uint32_t meshletCount = 0;
+		uint32_t frustumCulled = 0;
+		uint32_t backfaceCulled = 0;
+		uint32_t visibleIndexCount = 0;
+		uint32_t totalIndexCount = 0;
+	};
+
+	namespace MeshletBuilder
+	{
+		// Groups triangles into meshlets and rewrites indices in meshlet order. Triangles are
+		// grown from a seed through shared positions, preferring few new vertices and similar normals.
+		// Small neighbouring clusters are then merged, and the meshlets are ordered by the heading
+		// of their normals so that visible ones tend to be consecutive.
+		void Build(uint32_t* indices, size_t indexCount, const Math::Vector3* positions, size_t vertexCount, size_t stride,
+			std::vector<Meshlet>& meshlets, uint32_t maxVertices = Meshlet::MaxVertices, uint32_t maxTriangles = Meshlet::MaxTriangles);
+
+		template<class VertexT>
+		std::vector<Meshlet> Build(MeshBase<VertexT>& mesh, uint32_t maxVertices = Meshlet::MaxVertices, uint32_t maxTriangles = Meshlet::MaxTriangles)
+		{
+			std::vector<Meshlet> meshlets;
+			if (!mesh.vertices.empty())
+			{
+				Build(mesh.indices.data(), mesh.indices.size(), &mesh.vertices[0].position, mesh.vertices.size(), sizeof(VertexT), meshlets, maxVertices, maxTriangles);
+			}
+			return meshlets;
+		}
+
+		// Appends the indices of the meshlets that may be visible from the camera. world is the
+		// object to world matrix, rotation and uniform scale keep the normal cones exact.
+		void Cull(const std::vector<Meshlet>& meshlets, const Math::Matrix4& world, const Camera& camera,
+			std::vector<uint32_t>& visible, MeshletCullStats* stats = nullptr);
+	}
+}
@@ -1,6 +1,8 @@
 #pragma once
 
 #include "MeshTypes.h"
+#include "Meshlet.h"
+#include "MeshLod.h"
 #include "Material.h"
 
 namespace ML_Engine::Graphics
@@ -10,7 +12,23 @@ namespace ML_Engine::Graphics
 		struct MeshData
 		{
 			Mesh mesh;
+			std::vector<Meshlet> meshlets; // index ranges of mesh, empty if not built
+			std::vector<MeshLod> lods;     // reduced index lists over mesh.vertices, most detailed first
 			uint32_t materialIndex = 0;
+			bool packed = false;           // stored and uploaded as VertexPacked, mesh holds the decoded vertices
+			bool splitStreams = false;     // stored as a position block followed by an attribute block
+			// the stored blocks of a split mesh, in VertexPacked layout when packed, filled by the
+			// loaders so RenderObject uploads them as they are. Not updated when mesh changes.
+			// A .modelbin loaded without decoding fills them for every mesh.
+			std::vector<uint8_t> positionStream;
+			std::vector<uint8_t> attributeStream;
+			// A .modelbin loaded without decoding leaves mesh and the lod indices empty and keeps
+			// the stored indices here at indexSize bytes each, the mesh first and then every lod,
+			// indexRanges[0] being the mesh. ModelIO::DecodeMesh() fills mesh and lods from them.
+			std::vector<uint8_t> indexStream;
+			std::vector<MeshLodRange> indexRanges;
+			uint32_t indexSize = 0;
+			Math::AABB positionBounds;     // what the stored positions of a packed mesh are quantized against
 		};
 
 		struct MaterialData
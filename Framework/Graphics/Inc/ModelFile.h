@@ -0,0 +1,97 @@
+#pragma once
+
+#include "Model.h"
+
+namespace ML_Engine::Graphics
+{
+	// Binary .modelbin layout, written by ModelIO::SaveModelBinary. Everything is little
+	// endian and every table and blob starts on a ModelFileAlignment boundary, so the
+	// vertices and indices of a mapped file are copied out as they are, without parsing.
+	constexpr uint32_t ModelFileMagic = 0x424d4c4d; // "MLMB"
+	constexpr uint32_t ModelFileVersion = 2;
+	constexpr uint64_t ModelFileAlignment = 16;
+
+	struct ModelFileHeader
+	{
+		uint32_t magic = ModelFileMagic;
+		uint32_t version = ModelFileVersion;
+		uint32_t meshCount = 0;
+		uint32_t materialCount = 0;
+		uint64_t meshTableOffset = 0;     // meshCount ModelFileMesh
+		uint64_t materialTableOffset = 0; // materialCount ModelFileMaterial
+		uint64_t stringTableOffset = 0;   // null terminated texture names
+		uint64_t fileSize = 0;
+	};
+
+	struct ModelFileMesh
+	{
+		static constexpr uint32_t Packed = 0x1 << 0;       // vertices are VertexPacked
+		static constexpr uint32_t SplitStreams = 0x1 << 1; // all positions, then all other attributes
+
+		uint32_t materialIndex = 0;
+		uint32_t flags = 0;
+		uint32_t vertexCount = 0;
+		uint32_t vertexSize = 0;      // sizeof(Vertex) or sizeof(VertexPacked)
+		uint32_t positionSize = 0;    // leading bytes of a vertex that are the position
+		uint32_t indexCount = 0;
+		uint32_t meshletCount = 0;
+		uint32_t lodCount = 0;
+		uint32_t indexSize = sizeof(uint32_t); // 2 when GetIndexFormat(vertexCount) allows it, lods too
+		Math::AABB positionBounds;    // packed meshes only
+		uint32_t padding = 0;
+		uint64_t vertexOffset = 0;
+		uint64_t indexOffset = 0;     // indexCount indices of indexSize bytes
+		uint64_t meshletOffset = 0;   // meshletCount Meshlet
+		uint64_t lodOffset = 0;       // lodCount ModelFileLod
+	};
+
+	struct ModelFileLod
+	{
+		uint32_t indexCount = 0;
+		float error = 0.0f;
+		uint64_t indexOffset = 0;
+	};
+
+	struct ModelFileMaterial
+	{
+		static constexpr uint32_t NoTexture = 0xffffffff;
+
+		Material material;
+		// diffuse, spec, normal and bump map names in the string table
+		uint32_t textureNameOffsets[4] = { NoTexture, NoTexture, NoTexture, NoTexture };
+	};
+
+	// A mapped .modelbin file. Open() validates every table and range, the getters return
+	// pointers into the mapping which stay valid until Close().
+	class ModelFile final
+	{
+	public:
+		bool Open(const std::filesystem::path& filePath);
+		void Close();
+
+		uint32_t GetMeshCount() const;
+		const ModelFileMesh& GetMesh(uint32_t meshIndex) const;
+		const void* GetVertices(uint32_t meshIndex) const;
+		// indexSize bytes per index, see ModelFileMesh
+		const void* GetIndices(uint32_t meshIndex) const;
+		const Meshlet* GetMeshlets(uint32_t meshIndex) const;
+		const ModelFileLod& GetLod(uint32_t meshIndex, uint32_t lodIndex) const;
+		const void* GetLodIndices(uint32_t meshIndex, uint32_t lodIndex) const;
+
+		uint32_t GetMaterialCount() const;
+		const ModelFileMaterial& GetMaterial(uint32_t materialIndex) const;
+		// nullptr when the material has no texture in that slot
+		const char* GetTextureName(uint32_t materialIndex, uint32_t slot) const;
+
+	private:
+		template<class T>
+		const T* At(uint64_t offset) const
+		{
+			return reinterpret_cast<const T*>(mFile.GetData() + offset);
+		}
+		bool IsInFile(uint64_t offset, uint64_t count, uint64_t elementSize) const;
+
+		Core::MappedFile mFile;
+		const ModelFileHeader* mHeader = nullptr;
+	};
+}
@@ -1,16 +1,30 @@
 #pragma once
 
+#include "Model.h"
 
 namespace ML_Engine::Graphics
 {
-	struct Model;
-
 	namespace ModelIO
 	{
 		void SaveModel(std::filesystem::path filePath, const Model& model);
+		// Reads the whole file at once and parses the vertex and index lines in parallel
+		// batches with std::from_chars, independent of the C locale. A malformed file logs
+		// and leaves no meshes.
 		void LoadModel(std::filesystem::path filePath, Model& model);
+		// the original line by line fscanf_s loader, kept to check LoadModel against
+		void LoadModelReference(std::filesystem::path filePath, Model& model);
 
 		void SaveMaterial(std::filesystem::path filePath, const Model& model);
 		void LoadMaterial(std::filesystem::path filePath, Model& model);
+
+		// .modelbin holds the meshes and the materials, see ModelFile.h. Nothing is parsed.
+		// decodeMeshes unpacks the vertices to floats and widens the indices to 32 bit for code
+		// that works on the mesh, without it the vertex and index blocks are copied out of the
+		// mapped file as they are for RenderObject to upload, see Model::MeshData.
+		void SaveModelBinary(std::filesystem::path filePath, const Model& model);
+		bool LoadModelBinary(std::filesystem::path filePath, Model& model, bool decodeMeshes = true);
+		// the float vertices and 32 bit indices of a mesh loaded without decoding, once the cpu
+		// needs them, e.g. to build lods. Its vertex blocks are kept, its index block is not.
+		void DecodeMesh(Model::MeshData& meshData);
 	}
 }
\ No newline at end of file
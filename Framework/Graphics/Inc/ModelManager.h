@@ -4,7 +4,8 @@
 
 namespace ML_Engine::Graphics
 {
-	using ModelId = std::size_t;
+	// generational handle, 0 is never a valid model
+	using ModelId = Core::SlotHandle;
 
 	class ModelManager final
 	{
@@ -13,8 +14,8 @@ namespace ML_Engine::Graphics
 		static void StaticTerminate();
 		static ModelManager* Get();
 
-		ModelManager() = default;
-		~ModelManager() = default;
+		ModelManager();
+		~ModelManager();
 
 		ModelManager(const ModelManager&) = delete;
 		ModelManager(const ModelManager&&) = delete;
@@ -22,13 +23,69 @@ namespace ML_Engine::Graphics
 		ModelManager& operator=(const ModelManager&&) = delete;
 
 		void SetRootDirectory(const std::filesystem::path& rootPath);
-		ModelId GetModelId(const std::filesystem::path& filePath);
+		// id of a loaded or loading model, 0 when the path is not in the manager
+		ModelId GetModelId(const std::filesystem::path& filePath) const;
+
+		// Loads on the calling thread, waits instead if the model is already being loaded.
+		// Every load adds a reference that ReleaseModel() gives back.
 		ModelId LoadModel(const std::filesystem::path& filePath);
-		const Model* GetModel(ModelId id);
+
+		// Queues the file read and parse on the load threads and returns at once. GetModel()
+		// returns nullptr until IsReady() does.
+		ModelId LoadModelAsync(const std::filesystem::path& filePath);
+		bool IsReady(ModelId id) const;
+		void WaitForModel(ModelId id) const;
+
+		// safe from any thread, a ready model is never modified and stays valid while a
+		// reference to it is held
+		const Model* GetModel(ModelId id) const;
+
+		// A model without references stays cached until the ones released longest ago have
+		// to go to bring the memory usage back under the budget
+		void ReleaseModel(ModelId id);
+		void SetMemoryBudget(size_t bytes);
+		size_t GetMemoryBudget() const;
+		size_t GetMemoryUsage() const;
+
+		// Models cooked without lods or meshlets only get them at load time when this is set,
+		// otherwise loading them logs a warning. Off by default, building is slow.
+		void SetBuildMissingMeshData(bool build);
+
+		void DebugUI();
 
 	private:
-		using Inventory = std::map<ModelId, std::unique_ptr<Model>>;
+		using LruList = std::list<ModelId>;
+
+		struct Entry
+		{
+			std::unique_ptr<Model> model;
+			std::shared_future<void> loaded;
+			std::filesystem::path filePath;
+			std::string pathKey;
+			LruList::iterator lruPosition;
+			size_t memoryUsage = 0;
+			uint32_t refCount = 0;
+			bool ready = false;
+		};
+
+		std::string GetPathKey(const std::filesystem::path& filePath) const;
+		// adds a reference, returns the model to fill when the entry is new
+		Model* AddReference(const std::filesystem::path& filePath, ModelId& id);
+		void LoadModelData(const std::filesystem::path& fullPath, Model& model) const;
+		void MarkReady(ModelId id, size_t memoryUsage);
+		void EvictToBudget();
+
+		using Inventory = Core::SlotMap<Entry>;
 		Inventory mInventory;
+		// only consulted when loading, lookups by id never hash
+		std::unordered_map<std::string, ModelId> mIdsByPath;
+		LruList mUnreferenced; // ready models without references, least recently released first
+		size_t mMemoryUsage = 0;
+		size_t mMemoryBudget;
+		std::atomic<bool> mBuildMissingMeshData = false;
+		mutable std::mutex mMutex;
+
+		Core::ThreadPool mLoadThreads;
 
 		std::filesystem::path mRootDirectory;
 	};
@@ -0,0 +1,56 @@
+#pragma once
+
+#include "GraphicsBackend.h"
+
+namespace ML_Engine::Graphics
+{
+	// Counts the calls and does nothing else. Every resource it creates is nullptr.
+	class NullBackend final : public GraphicsBackend
+	{
+	public:
+		HRESULT CreateBuffer(const D3D11_BUFFER_DESC* desc, const D3D11_SUBRESOURCE_DATA* initData, ID3D11Buffer** buffer) override;
+		HRESULT CreateVertexShader(const void* byteCode, SIZE_T byteCodeLength, ID3D11VertexShader** shader) override;
+		HRESULT CreatePixelShader(const void* byteCode, SIZE_T byteCodeLength, ID3D11PixelShader** shader) override;
+		HRESULT CreateInputLayout(const D3D11_INPUT_ELEMENT_DESC* elements, UINT elementCount, const void* byteCode, SIZE_T byteCodeLength, ID3D11InputLayout** inputLayout) override;
+		HRESULT CreateSamplerState(const D3D11_SAMPLER_DESC* desc, ID3D11SamplerState** sampler) override;
+		HRESULT CreateBlendState(const D3D11_BLEND_DESC* desc, ID3D11BlendState** blendState) override;
+		HRESULT CreateDepthStencilState(const D3D11_DEPTH_STENCIL_DESC* desc, ID3D11DepthStencilState** depthStencilState) override;
+		HRESULT CreateTexture2D(const D3D11_TEXTURE2D_DESC* desc, const D3D11_SUBRESOURCE_DATA* initData, ID3D11Texture2D** texture) override;
+		HRESULT CreateShaderResourceView(ID3D11Resource* resource, const D3D11_SHADER_RESOURCE_VIEW_DESC* desc, ID3D11ShaderResourceView** view) override;
+		HRESULT CreateRenderTargetView(ID3D11Resource* resource, const D3D11_RENDER_TARGET_VIEW_DESC* desc, ID3D11RenderTargetView** view) override;
+		HRESULT CreateDepthStencilView(ID3D11Resource* resource, const D3D11_DEPTH_STENCIL_VIEW_DESC* desc, ID3D11DepthStencilView** view) override;
+		HRESULT CreateTextureFromFile(const std::filesystem::path& fileName, ID3D11ShaderResourceView** view) override;
+
+		void UpdateSubresource(ID3D11Resource* resource, const void* data, size_t size) override;
+		void UpdateDynamicBuffer(ID3D11Buffer* buffer, const void* data, size_t size) override;
+
+		void VSSetConstantBuffers(UINT slot, UINT count, ID3D11Buffer* const* buffers) override;
+		void PSSetConstantBuffers(UINT slot, UINT count, ID3D11Buffer* const* buffers) override;
+		void VSSetShaderResources(UINT slot, UINT count, ID3D11ShaderResourceView* const* views) override;
+		void PSSetShaderResources(UINT slot, UINT count, ID3D11ShaderResourceView* const* views) override;
+		void VSSetSamplers(UINT slot, UINT count, ID3D11SamplerState* const* samplers) override;
+		void PSSetSamplers(UINT slot, UINT count, ID3D11SamplerState* const* samplers) override;
+		void VSSetShader(ID3D11VertexShader* shader) override;
+		void PSSetShader(ID3D11PixelShader* shader) override;
+		void IASetInputLayout(ID3D11InputLayout* inputLayout) override;
+		void IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY topology) override;
+		void IASetVertexBuffers(UINT slot, UINT count, ID3D11Buffer* const* buffers, const UINT* strides, const UINT* offsets) override;
+		void IASetIndexBuffer(ID3D11Buffer* buffer, DXGI_FORMAT format, UINT offset) override;
+		void OMSetBlendState(ID3D11BlendState* blendState) override;
+		void OMSetDepthStencilState(ID3D11DepthStencilState* depthStencilState) override;
+		void OMSetRenderTargets(UINT count, ID3D11RenderTargetView* const* views, ID3D11DepthStencilView* depthStencilView) override;
+		void OMGetRenderTargets(UINT count, ID3D11RenderTargetView** views, ID3D11DepthStencilView** depthStencilView) override;
+		void RSSetViewports(UINT count, const D3D11_VIEWPORT* viewports) override;
+		void RSGetViewports(UINT* count, D3D11_VIEWPORT* viewports) override;
+		void ClearRenderTargetView(ID3D11RenderTargetView* view, const FLOAT color[4]) override;
+		void ClearDepthStencilView(ID3D11DepthStencilView* view, UINT flags, FLOAT depth, UINT8 stencil) override;
+		void Draw(UINT vertexCount, UINT startVertex) override;
+		void DrawIndexed(UINT indexCount, UINT startIndex, INT baseVertex) override;
+		void DrawInstanced(UINT vertexCount, UINT instanceCount, UINT startVertex, UINT startInstance) override;
+		void DrawIndexedInstanced(UINT indexCount, UINT instanceCount, UINT startIndex, INT baseVertex, UINT startInstance) override;
+
+	private:
+		// kept so render targets can save and restore it
+		D3D11_VIEWPORT mViewport{};
+	};
+}
@@ -6,7 +6,8 @@ namespace ML_Engine::Graphics
 	class PixelShader final
 	{
 	public:
-		void Initialize(const std::filesystem::path& shaderPath);
+		// format picks the same variant of the shader file as for VertexShader, only VE_Instanced matters
+		void Initialize(const std::filesystem::path& shaderPath, uint32_t format = 0);
 		void Terminate();
 		void Bind();
 	private:
@@ -2,7 +2,11 @@
 
 #include "MeshBuffer.h"
 #include "Transform.h"
+#include "TransformHierarchy.h"
 #include "Material.h"
+#include "Meshlet.h"
+#include "MeshLod.h"
+#include "VertexPacking.h"
 #include "TextureManager.h"
 #include "ModelManager.h"
 
@@ -11,25 +15,96 @@ namespace ML_Engine::Graphics
 	class RenderObject
 	{
 	public:
+		// creates meshBuffer with the lod levels packed after the full index list and the
+		// positions split from the other attributes, see MeshBuffer::InitializeSplit
+		template<class MeshType>
+		void InitializeMesh(const MeshType& mesh, const std::vector<MeshLod>& meshLods = {})
+		{
+			using VertexType = typename MeshType::VertexType;
+			vertexFormat = VertexType::Format;
+			if constexpr ((VertexType::Format & VE_Packed) != 0)
+			{
+				bounds = Math::ComputeSphere(mesh.positionBounds);
+				positionScale = VertexPacking::GetPositionScale(mesh.positionBounds);
+				positionOffset = VertexPacking::GetPositionOffset(mesh.positionBounds);
+			}
+			else
+			{
+				bounds = Math::ComputeSphere(Math::ComputeAABB(&mesh.vertices[0].position, mesh.vertices.size(), sizeof(VertexType)));
+			}
+
+			std::vector<uint32_t> indices;
+			BuildLodRanges(mesh.indices, meshLods, indices);
+			if constexpr (sizeof(VertexType) > sizeof(VertexType::position))
+			{
+				// positions in their own stream for the depth and shadow passes
+				meshBuffer.InitializeSplit(mesh.vertices.data(),
+					static_cast<uint32_t>(sizeof(VertexType)),
+					static_cast<uint32_t>(sizeof(VertexType::position)),
+					static_cast<uint32_t>(mesh.vertices.size()),
+					indices.data(),
+					static_cast<uint32_t>(mesh.indices.size()),
+					static_cast<uint32_t>(indices.size()));
+			}
+			else
+			{
+				meshBuffer.Initialize(mesh.vertices.data(),
+					static_cast<uint32_t>(sizeof(VertexType)),
+					static_cast<uint32_t>(mesh.vertices.size()),
+					indices.data(),
+					static_cast<uint32_t>(mesh.indices.size()),
+					static_cast<uint32_t>(indices.size()));
+			}
+		}
+		// a mesh of a loaded model, split meshes upload the streams the file stored with
+		// MeshBuffer::InitializeStreams, the others go through InitializeMesh above. The
+		// index block of an undecoded .modelbin is uploaded at its stored width.
+		void InitializeMesh(const Model::MeshData& meshData);
 		void Terminate();
 
 		Transform transform;      // location
+		TransformId transformId = InvalidTransformId; // cached world matrix in a TransformHierarchy, overrides transform
 		MeshBuffer meshBuffer;    // shape
+		std::vector<Meshlet> meshlets; // index ranges of meshBuffer for culling, optional
+		std::vector<MeshLodRange> lods; // index ranges of meshBuffer per detail level, optional
+		Math::Sphere bounds;      // object space, for lod selection
+		uint32_t vertexFormat = Vertex::Format; // VE_Packed meshes decode positions with the scale and offset
+		Math::Vector3 positionScale = Math::Vector3::One;
+		Math::Vector3 positionOffset = Math::Vector3::Zero;
 		Material material;        // light data
-		TextureId diffuseMapId;   // diffuse texture for an object
-		TextureId specMapId;
-		TextureId normalMapId;
-		TextureId bumpMapId;
+		TextureId diffuseMapId = 0; // diffuse texture for an object
+		TextureId specMapId = 0;
+		TextureId normalMapId = 0;
+		TextureId bumpMapId = 0;
+
+	private:
+		void BuildLodRanges(const std::vector<uint32_t>& meshIndices, const std::vector<MeshLod>& meshLods, std::vector<uint32_t>& indices);
 	};
 
 	class RenderGroup
 	{
 	public:
 		void Initialize(const std::filesystem::path& modelFilePath);
+
+		// Starts loading the model in the background and shows placeholderMesh, or a small
+		// sphere, until Update() finds it resident and swaps in the real render objects
+		void InitializeAsync(const std::filesystem::path& modelFilePath);
+		void InitializeAsync(const std::filesystem::path& modelFilePath, const Mesh& placeholderMesh);
 		void Terminate();
 
-		ModelId modelId;
+		// creates the render objects of a finished async load, returns true once loaded
+		bool Update();
+		bool IsLoaded() const { return !mLoading; }
+
+		ModelId modelId = 0;      // referenced until Terminate()
 		Transform transform;
+		TransformId transformId = InvalidTransformId;
 		std::vector<RenderObject> renderObjects;
+
+	private:
+		void CreateRenderObjects(const Model& model);
+		void TerminateRenderObjects();
+
+		bool mLoading = false;
 	};
 }
\ No newline at end of file
@@ -0,0 +1,56 @@
+#pragma once
+
+namespace ML_Engine::Graphics
+{
+	class RenderObject;
+	struct Material;
+
+	// the effect in the top bits of a sort key, effects sharing a queue draw in this order
+	enum class QueueEffect : uint32_t
+	{
+		Standard
+	};
+
+	// one draw of a render object, the world matrix is resolved when it is queued
+	struct DrawPacket
+	{
+		uint64_t sortKey = 0;
+		const RenderObject* renderObject = nullptr;
+		Math::Matrix4 matWorld;
+	};
+
+	// Collects the draws of a pass so they can be submitted in an order that keeps state
+	// changes down. Sort key from the high bits:
+	//   effect 4 | shader variant 4 | material 16 | texture set 24 | depth 16
+	// Material and texture set are hashes, a collision only costs a state change since
+	// the effects compare the real state before skipping it.
+	class RenderQueue final
+	{
+	public:
+		// depth is 0 at the near plane and 1 at the far plane, nearer draws sort first
+		static uint64_t MakeSortKey(QueueEffect effect, uint32_t shaderVariant, const RenderObject& renderObject, float depth);
+		static QueueEffect GetEffect(uint64_t sortKey);
+
+		void Clear();
+		void Add(uint64_t sortKey, const RenderObject& renderObject, const Math::Matrix4& matWorld);
+
+		// stable lsd radix sort, 8 bits a pass, passes where every key has the same digit are skipped
+		void Sort();
+
+		const std::vector<DrawPacket>& GetPackets() const;
+		size_t Size() const;
+		bool Empty() const;
+
+	private:
+		struct SortEntry
+		{
+			uint64_t sortKey;
+			uint32_t packetIndex;
+		};
+
+		std::vector<DrawPacket> mPackets;
+		std::vector<DrawPacket> mSortedPackets;
+		std::vector<SortEntry> mEntries;
+		std::vector<SortEntry> mScratch;
+	};
+}
@@ -5,12 +5,14 @@
 #include "VertexShader.h"
 #include "DirectionalLight.h"
 #include "Camera.h"
+#include "InstanceBuffer.h"
 #include "RenderTarget.h"
 
 namespace ML_Engine::Graphics
 {
 	class RenderObject;
 	class RenderGroup;
+	class TransformHierarchy;
 
 	class ShadowEffect
 	{
@@ -23,27 +25,39 @@ namespace ML_Engine::Graphics
 
 		void Render(const RenderObject& renderObject);
 		void Render(const RenderGroup& renderGroup);
+		// every instance in one draw, see StandardEffect::RenderInstanced
+		void RenderInstanced(const RenderObject& renderObject, const InstanceBuffer& instances);
 
 		void DebugUI();
 
 		void SetDirectionalLight(const DirectionalLight& directionalLight);
 		void SetFocus(const Math::Vector3& focusPoint);
 		void SetSize(float size);
+		// objects with a transformId read their world matrix from here
+		void SetTransformHierarchy(const TransformHierarchy* hierarchy);
 		const Camera& GetLightCamera() const;
 		const Texture& GetDepthMap() const;
 
 	private:
 		void UpdateLightCamera();
+		void BindVertexShader(const RenderObject& renderObject, bool instanced = false);
 
 		struct TransformData
 		{
 			Math::Matrix4 wvp;
+			Math::Vector3 positionScale = Math::Vector3::One;   // packed vertex position decode
+			float padding = 0.0f;
+			Math::Vector3 positionOffset = Math::Vector3::Zero;
+			float padding1 = 0.0f;
 		};
 
 		using TransformBuffer = TypedConstantBuffer<TransformData>;
 		TransformBuffer mTransformBuffer;
 
 		VertexShader mVertexShader;
+		VertexShader mPackedVertexShader;
+		VertexShader mInstancedVertexShader;
+		VertexShader mInstancedPackedVertexShader;
 		PixelShader mPixelShader;
 
 		Camera mLightCamera;
@@ -52,5 +66,6 @@ namespace ML_Engine::Graphics
 		const DirectionalLight* mDirectionalLight = nullptr;
 		Math::Vector3 mFocusPoint = Math::Vector3::Zero;
 		float mSize = 100.0f;
+		const TransformHierarchy* mTransformHierarchy = nullptr;
 	};
 }
\ No newline at end of file
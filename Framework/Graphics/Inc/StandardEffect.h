@@ -4,7 +4,10 @@
 #include "PixelShader.h"
 #include "VertexShader.h"
 #include "DirectionalLight.h"
+#include "InstanceBuffer.h"
 #include "Material.h"
+#include "Meshlet.h"
+#include "RenderQueue.h"
 #include "Sampler.h"
 
 namespace ML_Engine::Graphics
@@ -12,6 +15,7 @@ namespace ML_Engine::Graphics
 	class Camera;
 	class RenderObject;
 	class RenderGroup;
+	class TransformHierarchy;
 	class Texture;
 
 	class StandardEffect final
@@ -25,22 +29,52 @@ namespace ML_Engine::Graphics
 
 		void Render(const RenderObject& renderObject);
 		void Render(const RenderGroup& renderGroup);
+
+		// adds the draws to the queue instead, Render(queue) draws them once it is sorted
+		void Submit(RenderQueue& renderQueue, const RenderObject& renderObject) const;
+		void Submit(RenderQueue& renderQueue, const RenderGroup& renderGroup) const;
+		// draws the standard effect packets of a sorted queue and skips the light, material,
+		// settings, texture and shader changes that would rebind what is already bound
+		void Render(const RenderQueue& renderQueue);
+		// draws every instance with the mesh, textures and settings of renderObject in one call,
+		// always the full mesh since lods and meshlet culling are per world matrix
+		void RenderInstanced(const RenderObject& renderObject, const InstanceBuffer& instances);
+		// the palette InstanceData::materialIndex picks from, without one every instance
+		// uses the material of the object it is drawn with
+		void SetInstanceMaterials(const Material* materials, uint32_t materialCount);
 		
 		void SetCamera(const Camera& camera);
 		void SetDirectionalLight(const DirectionalLight& directionalLight);
 		void SetLightCamera(const Camera& camera);
 		void SetShadowMap(const Texture& shadowMap);
+		// objects with a transformId read their world matrix from here
+		void SetTransformHierarchy(const TransformHierarchy* hierarchy);
 
 		void DebugUI();
 
+		// meshlet culling totals since the last Begin()
+		const MeshletCullStats& GetMeshletCullStats() const;
+
 	private:
+		// draws the lod level the object needs at its screen size, or only the meshlets that
+		// can be visible from the camera when it is close enough for full detail
+		void RenderMeshBuffer(const RenderObject& renderObject, const Math::Matrix4& matWorld, bool useBumpMap);
+		void BindVertexShader(const RenderObject& renderObject, bool instanced = false);
+		// which vertex shader and input layout BindVertexShader picks
+		static uint32_t GetShaderVariant(const RenderObject& renderObject);
+
 		struct TransformData
 		{
 			Math::Matrix4 wvp;          // world view projection matrix
 			Math::Matrix4 world;        // world matrix
+			Math::Matrix4 normalWorld;  // inverse transpose of world, for normals under non uniform scale
 			Math::Matrix4 lwvp;         // light view projection of the light object for shadows
 			Math::Vector3 viewPosition; // position of the view item (camera)
 			float padding = 0.0f;       // padding to mantain 16 byte alignment
+			Math::Vector3 positionScale = Math::Vector3::One;   // packed vertex position decode
+			float padding1 = 0.0f;
+			Math::Vector3 positionOffset = Math::Vector3::Zero;
+			float padding2 = 0.0f;
 		};
 
 		struct SettingsData
@@ -55,6 +89,13 @@ namespace ML_Engine::Graphics
 			float padding = 0.0f;
 		};
 
+		struct InstanceMaterialData
+		{
+			Material materials[MaxInstanceMaterials];
+		};
+
+		SettingsData GetObjectSettings(const RenderObject& renderObject) const;
+
 		using TransformBuffer = TypedConstantBuffer<TransformData>;
 		TransformBuffer mTransformBuffer;
 
@@ -67,15 +108,34 @@ namespace ML_Engine::Graphics
 		using SettingsBuffer = TypedConstantBuffer<SettingsData>;
 		SettingsBuffer mSettingsBuffer;
 
+		using InstanceMaterialBuffer = TypedConstantBuffer<InstanceMaterialData>;
+		InstanceMaterialBuffer mInstanceMaterialBuffer;
 
 		VertexShader mVertexShader;
+		VertexShader mPackedVertexShader;
+		VertexShader mInstancedVertexShader;
+		VertexShader mInstancedPackedVertexShader;
 		PixelShader mPixelShader;
+		PixelShader mInstancedPixelShader;
 		Sampler mSampler;
 
 		SettingsData mSettingsData;
+		bool mCullMeshlets = false; // the extra draws only pay off for large meshes partly in view
+		MeshletCullStats mMeshletCullStats;
+		std::vector<uint32_t> mVisibleMeshlets;
+		bool mUseLods = true;
+		float mLodPixelError = 1.0f;
+		uint32_t mLodObjectCount = 0;     // objects drawn below full detail since Begin()
+		uint32_t mLodTriangleCount = 0;   // triangles drawn for objects with lods
+		uint32_t mFullTriangleCount = 0;  // triangles those objects have at full detail
+		InstanceMaterialData mInstanceMaterials;
+		uint32_t mInstanceMaterialCount = 0;
+		uint32_t mInstancedDrawCount = 0; // since Begin()
+		uint32_t mInstanceCount = 0;
 		const Camera* mCamera = nullptr;
 		const DirectionalLight* mDirectionalLight = nullptr;
 		const Camera* mLightCamera = nullptr;
 		const Texture* mShadowMap = nullptr;
+		const TransformHierarchy* mTransformHierarchy = nullptr;
 	};
 }
\ No newline at end of file
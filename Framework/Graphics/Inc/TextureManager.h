@@ -5,7 +5,8 @@
 
 namespace ML_Engine::Graphics
 {
-	using TextureId = std::size_t;
+	// generational handle, 0 is never a valid texture
+	using TextureId = Core::SlotHandle;
 
 	class TextureManager final
 	{
@@ -34,10 +35,13 @@ namespace ML_Engine::Graphics
 		struct Entry
 		{
 			std::unique_ptr<Texture> texture;
+			std::string filePath;
 			uint32_t refCount = 0;
 		};
-		using Inventory = std::unordered_map<TextureId, Entry>;
+		using Inventory = Core::SlotMap<Entry>;
 		Inventory mInventory;
+		// only consulted when loading, lookups by id never hash
+		std::unordered_map<std::string, TextureId> mIdsByPath;
 		std::filesystem::path mRootDirectory;
 	};
 }
\ No newline at end of file
@@ -10,13 +10,33 @@ namespace ML_Engine::Graphics
 
 		Math::Matrix4 GetMatrix4() const
 		{
-			// scale * rotation * translation/position
-			return
-			{
-				Math::Matrix4::Scaling(scale) *
-			    Math::Matrix4::MatrixRotationQuaternion(rotation) *
-				Math::Matrix4::Translation(position)
-			};
+			// scale * rotation * translation/position, composed directly: scaling
+			// multiplies the rotation rows and the translation fills the last row
+			Math::Matrix4 m = Math::Matrix4::MatrixRotationQuaternion(rotation);
+			m._11 *= scale.x; m._12 *= scale.x; m._13 *= scale.x;
+			m._21 *= scale.y; m._22 *= scale.y; m._23 *= scale.y;
+			m._31 *= scale.z; m._32 *= scale.z; m._33 *= scale.z;
+			m._41 = position.x;
+			m._42 = position.y;
+			m._43 = position.z;
+			return m;
+		}
+
+		Math::Matrix4 GetInverseMatrix4() const
+		{
+			// inverse translation * inverse rotation * inverse scale, built directly
+			// instead of inverting GetMatrix4(). Assumes rotation is normalized.
+			Math::Matrix4 inv = Math::Matrix4::MatrixRotationQuaternion(Math::Quaternion::Conjugate(rotation));
+			const Math::Vector3 invScale = { 1.0f / scale.x, 1.0f / scale.y, 1.0f / scale.z };
+			inv._11 *= invScale.x; inv._12 *= invScale.y; inv._13 *= invScale.z;
+			inv._21 *= invScale.x; inv._22 *= invScale.y; inv._23 *= invScale.z;
+			inv._31 *= invScale.x; inv._32 *= invScale.y; inv._33 *= invScale.z;
+
+			const Math::Vector3 t = -Math::TransformNormal(position, inv);
+			inv._41 = t.x;
+			inv._42 = t.y;
+			inv._43 = t.z;
+			return inv;
 		}
 	};
 }
\ No newline at end of file
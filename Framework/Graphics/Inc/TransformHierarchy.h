@@ -0,0 +1,71 @@
+#pragma once
+
+#include "Transform.h"
+
+namespace ML_Engine::Graphics
+{
+	using TransformId = uint32_t;
+	constexpr TransformId InvalidTransformId = UINT32_MAX;
+
+	// Parent/child transforms stored in flat arrays sorted by depth, so every parent
+	// comes before its children. Update() recomputes the world matrices of the dirty
+	// nodes and their subtrees in one linear pass; clean nodes keep their cached matrix.
+	// Ids stay valid until the node is destroyed, the storage order may change.
+	class TransformHierarchy final
+	{
+	public:
+		TransformId Create(TransformId parent = InvalidTransformId);
+		TransformId Create(const Transform& local, TransformId parent = InvalidTransformId);
+		// destroys the node and all of its children
+		void Destroy(TransformId id);
+		void Clear();
+
+		void SetParent(TransformId id, TransformId parent);
+		TransformId GetParent(TransformId id) const;
+
+		void SetLocal(TransformId id, const Transform& local);
+		const Transform& GetLocal(TransformId id) const;
+		// world matrix as of the last Update()
+		const Math::Matrix4& GetWorldMatrix(TransformId id) const;
+
+		bool IsValid(TransformId id) const;
+		size_t Size() const;
+
+		void Update();
+		// number of world matrices recomputed by the last Update()
+		size_t GetUpdatedCount() const;
+
+	private:
+		static constexpr uint32_t InvalidSlot = UINT32_MAX;
+
+		void Sort();
+		uint32_t GetSlot(TransformId id) const;
+
+		// indexed by slot, parents before children
+		std::vector<Transform> mLocal;
+		std::vector<Math::Matrix4> mLocalMatrix;
+		std::vector<Math::Matrix4> mWorld;
+		std::vector<uint32_t> mParentSlot;
+		std::vector<uint8_t> mDirty;
+		std::vector<TransformId> mSlotToId;
+
+		// indexed by id
+		std::vector<uint32_t> mIdToSlot;
+		std::vector<TransformId> mParentId;
+		std::vector<TransformId> mFreeIds;
+
+		std::vector<uint32_t> mUpdateSlots;
+		size_t mUpdatedCount = 0;
+		bool mNeedsSort = false;
+	};
+
+	// cached world matrix when the object is bound to a hierarchy, otherwise built from its own transform
+	inline Math::Matrix4 GetWorldMatrix(const TransformHierarchy* hierarchy, TransformId id, const Transform& transform)
+	{
+		if (hierarchy != nullptr && id != InvalidTransformId)
+		{
+			return hierarchy->GetWorldMatrix(id);
+		}
+		return transform.GetMatrix4();
+	}
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include "MeshTypes.h"
+
+namespace ML_Engine::Graphics
+{
+	// Encodes Vertex into VertexPacked and back. The decode functions match what the
+	// input assembler and the PACKED_VERTEX path of the shaders compute on the GPU.
+	namespace VertexPacking
+	{
+		// IEEE half, round to nearest even, out of range values become infinity
+		uint16_t FloatToHalf(float value);
+		float HalfToFloat(uint16_t value);
+
+		// Octahedral mapping (Meyer et al. 2010) of a direction to two snorm16 values.
+		// A zero vector encodes to +z.
+		void EncodeOctahedral(const Math::Vector3& direction, int16_t encoded[2]);
+		Math::Vector3 DecodeOctahedral(const int16_t encoded[2]);
+
+		// unorm positions map back to mesh units as offset + unorm * scale
+		Math::Vector3 GetPositionScale(const Math::AABB& positionBounds);
+		Math::Vector3 GetPositionOffset(const Math::AABB& positionBounds);
+
+		VertexPacked Pack(const Vertex& vertex, const Math::AABB& positionBounds, float bitangentSign = 1.0f);
+		Vertex Unpack(const VertexPacked& vertex, const Math::AABB& positionBounds);
+		float GetBitangentSign(const VertexPacked& vertex);
+
+		MeshPacked PackMesh(const Mesh& mesh);
+		Mesh UnpackMesh(const MeshPacked& mesh);
+
+		// Largest differences between a mesh and its packed copy
+		struct PackingError
+		{
+			float position = 0.0f;    // mesh units
+			float normalAngle = 0.0f; // degrees, tangents included
+			float uvCoord = 0.0f;
+		};
+		PackingError MeasureError(const Mesh& mesh, const MeshPacked& packedMesh);
+	}
+}
@@ -14,9 +14,13 @@ namespace ML_Engine::Graphics
 		void Initialize(const std::filesystem::path& shaderPath, uint32_t format);
 		void Terminate();
 		void Bind();
+		// for mesh buffers with a separate position stream, see MeshBuffer::InitializeSplit
+		void BindSplit();
 
 	private:
 		ID3D11VertexShader* mVertexShader = nullptr;
 		ID3D11InputLayout* mInputLayout = nullptr;
+		ID3D11InputLayout* mSplitInputLayout = nullptr;
+		bool mHasSplitLayout = false; // the layout is null under the null backend
 	};
 }
\ No newline at end of file
@@ -12,6 +12,10 @@ namespace ML_Engine::Graphics
 	constexpr uint32_t VE_Tangent        = 0x1 << 2;
 	constexpr uint32_t VE_Color          = 0x1 << 3;
 	constexpr uint32_t VE_TexCoord       = 0x1 << 4;
+	constexpr uint32_t VE_Packed         = 0x1 << 5; // quantized elements, see VertexPacking.h
+	constexpr uint32_t VE_PackedColor    = 0x1 << 6; // color is a PackedColor
+	constexpr uint32_t VE_PositionStream = 0x1 << 7; // position in its own vertex buffer, see MeshBuffer::InitializeSplit
+	constexpr uint32_t VE_Instanced      = 0x1 << 8; // world matrix and material index per instance, see InstanceBuffer
 
     #define VERTEX_FORMAT(fmt)\
         static constexpr uint32_t Format = fmt
@@ -30,6 +34,14 @@ namespace ML_Engine::Graphics
 		Color color;
 	};
 
+	// 16 bytes against the 28 of VertexPC, for vertices rebuilt every frame
+	struct VertexPCPacked
+	{
+		VERTEX_FORMAT(VE_Position | VE_Color | VE_PackedColor);
+		Math::Vector3 position;
+		PackedColor color;
+	};
+
 	struct VertexPX
 	{
 		VERTEX_FORMAT(VE_Position | VE_TexCoord);
@@ -45,4 +57,15 @@ namespace ML_Engine::Graphics
 		Math::Vector3 tangent;
 		Math::Vector2 uvCoord;
 	};
+
+	// 20 bytes against the 44 of Vertex. position is unorm16 against the mesh bounds with
+	// the bitangent sign in w, normal and tangent are octahedral snorm16, uvs are halfs.
+	struct VertexPacked
+	{
+		VERTEX_FORMAT(VE_Position | VE_Normal | VE_Tangent | VE_TexCoord | VE_Packed);
+		uint16_t position[4];
+		int16_t normal[2];
+		int16_t tangent[2];
+		uint16_t uvCoord[2];
+	};
 }
\ No newline at end of file
@@ -41,9 +41,13 @@ namespace
 
 void BlendState::ClearState()
 {
-	auto context = GraphicsSystem::Get()->GetContext();
-	context->OMSetBlendState(nullptr, nullptr, UINT_MAX);
-	context->OMSetDepthStencilState(nullptr, 0);
+	GraphicsSystem* gs = GraphicsSystem::Get();
+	if (gs->GetStateCache()->SetBlendState(nullptr))
+	{
+		auto backend = gs->GetBackend();
+		backend->OMSetBlendState(nullptr);
+		backend->OMSetDepthStencilState(nullptr);
+	}
 }
 
 BlendState::~BlendState()
@@ -66,27 +70,32 @@ void BlendState::Initialize(Mode mode)
 	desc.RenderTarget[0].BlendOpAlpha = D3D11_BLEND_OP_ADD;
 	desc.RenderTarget[0].RenderTargetWriteMask = D3D11_COLOR_WRITE_ENABLE_ALL;
 
-	auto device = GraphicsSystem::Get()->GetDevice();
-	HRESULT hr = device->CreateBlendState(&desc, &mBlendState);
+	auto backend = GraphicsSystem::Get()->GetBackend();
+	HRESULT hr = backend->CreateBlendState(&desc, &mBlendState);
 	ASSERT(SUCCEEDED(hr), "BlendState: failed to create blend state");
 
 	D3D11_DEPTH_STENCIL_DESC dsDesc{};
 	dsDesc.DepthEnable = true;
 	dsDesc.DepthWriteMask = D3D11_DEPTH_WRITE_MASK_ALL;
 	dsDesc.DepthFunc = D3D11_COMPARISON_NOT_EQUAL;
-	hr = device->CreateDepthStencilState(&dsDesc, &mDepthStencilState);
+	hr = backend->CreateDepthStencilState(&dsDesc, &mDepthStencilState);
 	ASSERT(SUCCEEDED(hr), "BlendState: failed to create depth stencil state");
 }
 
 void BlendState::Terminate()
 {
+	GraphicsSystem::Get()->GetStateCache()->Forget(this);
 	SafeRelease(mBlendState);
 	SafeRelease(mDepthStencilState);
 }
 
 void BlendState::Set()
 {
-	auto context = GraphicsSystem::Get()->GetContext();
-	context->OMSetBlendState(mBlendState, nullptr, UINT_MAX);
-	context->OMSetDepthStencilState(mDepthStencilState, 0);
+	GraphicsSystem* gs = GraphicsSystem::Get();
+	if (gs->GetStateCache()->SetBlendState(this))
+	{
+		auto backend = gs->GetBackend();
+		backend->OMSetBlendState(mBlendState);
+		backend->OMSetDepthStencilState(mDepthStencilState);
+	}
 }
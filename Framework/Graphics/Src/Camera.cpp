@@ -98,6 +98,11 @@ void Camera::Zoom(float amount)
 	SetFOV(mFov - amount);
 }
 
+Camera::ProjectionMode Camera::GetMode() const
+{
+	return mProjectionMode;
+}
+
 const Math::Vector3& Camera::GetPosition() const
 {
 	return mPosition;
@@ -108,6 +113,16 @@ const Math::Vector3& Camera::GetDirection() const
 	return mDirection;
 }
 
+float Camera::GetNearPlane() const
+{
+	return mNearPlane;
+}
+
+float Camera::GetFarPlane() const
+{
+	return mFarPlane;
+}
+
 Math::Matrix4 Camera::GetViewMatrix() const
 {
 	const Math::Vector3 l = mDirection;
@@ -161,3 +176,8 @@ Math::Matrix4 Camera::GetOrthographicMatrix() const
 		    0.0f,     0.0f,    n / (n - f), 1.0f
 	};
 }
+
+Math::Frustum Camera::GetFrustum() const
+{
+	return Math::Frustum::FromMatrix(GetViewMatrix() * GetProjectionMatrix());
+}
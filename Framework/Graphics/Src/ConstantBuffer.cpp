@@ -13,7 +13,8 @@ ConstantBuffer::~ConstantBuffer()
 
 void ConstantBuffer::Initialize(uint32_t bufferSize)
 {
-	auto device = GraphicsSystem::Get()->GetDevice();
+	auto backend = GraphicsSystem::Get()->GetBackend();
+	mSize = bufferSize;
 
 	D3D11_BUFFER_DESC desc{};
 	desc.ByteWidth = bufferSize;
@@ -23,29 +24,39 @@ void ConstantBuffer::Initialize(uint32_t bufferSize)
 	desc.MiscFlags = 0;
 	desc.StructureByteStride = 0;
 	
-	HRESULT hr = device->CreateBuffer(&desc, nullptr, &mConstantBuffer);
+	HRESULT hr = backend->CreateBuffer(&desc, nullptr, &mConstantBuffer);
 	ASSERT(SUCCEEDED(hr), "ConstantBuffer: failed to create constant buffer");
 }
 
 void ConstantBuffer::Terminate()
 {
+	GraphicsSystem::Get()->GetStateCache()->Forget(this);
 	SafeRelease(mConstantBuffer);
 }
 
 void ConstantBuffer::Update(const void* data) const
 {
-	auto context = GraphicsSystem::Get()->GetContext();
-	context->UpdateSubresource(mConstantBuffer, 0, nullptr, data, 0, 0);
+	GraphicsSystem* gs = GraphicsSystem::Get();
+	if (gs->GetStateCache()->UpdateConstantBuffer(this, data, mSize))
+	{
+		gs->GetBackend()->UpdateSubresource(mConstantBuffer, data, mSize);
+	}
 }
 
 void ConstantBuffer::BindVS(uint32_t slot) const
 {
-	auto context = GraphicsSystem::Get()->GetContext();
-	context->VSSetConstantBuffers(slot, 1, &mConstantBuffer);
+	GraphicsSystem* gs = GraphicsSystem::Get();
+	if (gs->GetStateCache()->SetConstantBuffer(ShaderStage::Vertex, slot, this))
+	{
+		gs->GetBackend()->VSSetConstantBuffers(slot, 1, &mConstantBuffer);
+	}
 }
 
 void ConstantBuffer::BindPS(uint32_t slot) const
 {
-	auto context = GraphicsSystem::Get()->GetContext();
-	context->PSSetConstantBuffers(slot, 1, &mConstantBuffer);
+	GraphicsSystem* gs = GraphicsSystem::Get();
+	if (gs->GetStateCache()->SetConstantBuffer(ShaderStage::Pixel, slot, this))
+	{
+		gs->GetBackend()->PSSetConstantBuffers(slot, 1, &mConstantBuffer);
+	}
 }
@@ -0,0 +1,242 @@
+#include "Precompiled.h"
+#include "D3D11Backend.h"
+
+#include <DirectXTK/Inc/WICTextureLoader.h>
+
+using namespace ML_Engine;
+using namespace ML_Engine::Graphics;
+
+D3D11Backend::D3D11Backend(ID3D11Device* device, ID3D11DeviceContext* context)
+	: mDevice(device)
+	, mContext(context)
+{
+}
+
+HRESULT D3D11Backend::CreateBuffer(const D3D11_BUFFER_DESC* desc, const D3D11_SUBRESOURCE_DATA* initData, ID3D11Buffer** buffer)
+{
+	Record(GraphicsCommand::CreateBuffer, 0, (initData != nullptr) ? desc->ByteWidth : 0);
+	return mDevice->CreateBuffer(desc, initData, buffer);
+}
+
+HRESULT D3D11Backend::CreateVertexShader(const void* byteCode, SIZE_T byteCodeLength, ID3D11VertexShader** shader)
+{
+	Record(GraphicsCommand::CreateShader);
+	return mDevice->CreateVertexShader(byteCode, byteCodeLength, nullptr, shader);
+}
+
+HRESULT D3D11Backend::CreatePixelShader(const void* byteCode, SIZE_T byteCodeLength, ID3D11PixelShader** shader)
+{
+	Record(GraphicsCommand::CreateShader);
+	return mDevice->CreatePixelShader(byteCode, byteCodeLength, nullptr, shader);
+}
+
+HRESULT D3D11Backend::CreateInputLayout(const D3D11_INPUT_ELEMENT_DESC* elements, UINT elementCount, const void* byteCode, SIZE_T byteCodeLength, ID3D11InputLayout** inputLayout)
+{
+	Record(GraphicsCommand::CreateInputLayout);
+	return mDevice->CreateInputLayout(elements, elementCount, byteCode, byteCodeLength, inputLayout);
+}
+
+HRESULT D3D11Backend::CreateSamplerState(const D3D11_SAMPLER_DESC* desc, ID3D11SamplerState** sampler)
+{
+	Record(GraphicsCommand::CreateState);
+	return mDevice->CreateSamplerState(desc, sampler);
+}
+
+HRESULT D3D11Backend::CreateBlendState(const D3D11_BLEND_DESC* desc, ID3D11BlendState** blendState)
+{
+	Record(GraphicsCommand::CreateState);
+	return mDevice->CreateBlendState(desc, blendState);
+}
+
+HRESULT D3D11Backend::CreateDepthStencilState(const D3D11_DEPTH_STENCIL_DESC* desc, ID3D11DepthStencilState** depthStencilState)
+{
+	Record(GraphicsCommand::CreateState);
+	return mDevice->CreateDepthStencilState(desc, depthStencilState);
+}
+
+HRESULT D3D11Backend::CreateTexture2D(const D3D11_TEXTURE2D_DESC* desc, const D3D11_SUBRESOURCE_DATA* initData, ID3D11Texture2D** texture)
+{
+	Record(GraphicsCommand::CreateTexture);
+	return mDevice->CreateTexture2D(desc, initData, texture);
+}
+
+HRESULT D3D11Backend::CreateShaderResourceView(ID3D11Resource* resource, const D3D11_SHADER_RESOURCE_VIEW_DESC* desc, ID3D11ShaderResourceView** view)
+{
+	Record(GraphicsCommand::CreateView);
+	return mDevice->CreateShaderResourceView(resource, desc, view);
+}
+
+HRESULT D3D11Backend::CreateRenderTargetView(ID3D11Resource* resource, const D3D11_RENDER_TARGET_VIEW_DESC* desc, ID3D11RenderTargetView** view)
+{
+	Record(GraphicsCommand::CreateView);
+	return mDevice->CreateRenderTargetView(resource, desc, view);
+}
+
+HRESULT D3D11Backend::CreateDepthStencilView(ID3D11Resource* resource, const D3D11_DEPTH_STENCIL_VIEW_DESC* desc, ID3D11DepthStencilView** view)
+{
+	Record(GraphicsCommand::CreateView);
+	return mDevice->CreateDepthStencilView(resource, desc, view);
+}
+
+HRESULT D3D11Backend::CreateTextureFromFile(const std::filesystem::path& fileName, ID3D11ShaderResourceView** view)
+{
+	Record(GraphicsCommand::CreateTexture);
+	return DirectX::CreateWICTextureFromFile(mDevice, mContext, fileName.c_str(), nullptr, view);
+}
+
+void D3D11Backend::UpdateSubresource(ID3D11Resource* resource, const void* data, size_t size)
+{
+	Record(GraphicsCommand::UpdateBuffer, 0, size);
+	mContext->UpdateSubresource(resource, 0, nullptr, data, 0, 0);
+}
+
+void D3D11Backend::UpdateDynamicBuffer(ID3D11Buffer* buffer, const void* data, size_t size)
+{
+	Record(GraphicsCommand::UpdateBuffer, 0, size);
+	D3D11_MAPPED_SUBRESOURCE resource;
+	mContext->Map(buffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &resource);
+	memcpy(resource.pData, data, size);
+	mContext->Unmap(buffer, 0);
+}
+
+void D3D11Backend::VSSetConstantBuffers(UINT slot, UINT count, ID3D11Buffer* const* buffers)
+{
+	Record(GraphicsCommand::BindConstantBuffer);
+	mContext->VSSetConstantBuffers(slot, count, buffers);
+}
+
+void D3D11Backend::PSSetConstantBuffers(UINT slot, UINT count, ID3D11Buffer* const* buffers)
+{
+	Record(GraphicsCommand::BindConstantBuffer);
+	mContext->PSSetConstantBuffers(slot, count, buffers);
+}
+
+void D3D11Backend::VSSetShaderResources(UINT slot, UINT count, ID3D11ShaderResourceView* const* views)
+{
+	Record(GraphicsCommand::BindTexture);
+	mContext->VSSetShaderResources(slot, count, views);
+}
+
+void D3D11Backend::PSSetShaderResources(UINT slot, UINT count, ID3D11ShaderResourceView* const* views)
+{
+	Record(GraphicsCommand::BindTexture);
+	mContext->PSSetShaderResources(slot, count, views);
+}
+
+void D3D11Backend::VSSetSamplers(UINT slot, UINT count, ID3D11SamplerState* const* samplers)
+{
+	Record(GraphicsCommand::BindSampler);
+	mContext->VSSetSamplers(slot, count, samplers);
+}
+
+void D3D11Backend::PSSetSamplers(UINT slot, UINT count, ID3D11SamplerState* const* samplers)
+{
+	Record(GraphicsCommand::BindSampler);
+	mContext->PSSetSamplers(slot, count, samplers);
+}
+
+void D3D11Backend::VSSetShader(ID3D11VertexShader* shader)
+{
+	Record(GraphicsCommand::BindShader);
+	mContext->VSSetShader(shader, nullptr, 0);
+}
+
+void D3D11Backend::PSSetShader(ID3D11PixelShader* shader)
+{
+	Record(GraphicsCommand::BindShader);
+	mContext->PSSetShader(shader, nullptr, 0);
+}
+
+void D3D11Backend::IASetInputLayout(ID3D11InputLayout* inputLayout)
+{
+	Record(GraphicsCommand::BindInputLayout);
+	mContext->IASetInputLayout(inputLayout);
+}
+
+void D3D11Backend::IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY topology)
+{
+	Record(GraphicsCommand::BindTopology);
+	mContext->IASetPrimitiveTopology(topology);
+}
+
+void D3D11Backend::IASetVertexBuffers(UINT slot, UINT count, ID3D11Buffer* const* buffers, const UINT* strides, const UINT* offsets)
+{
+	Record(GraphicsCommand::BindVertexBuffer);
+	mContext->IASetVertexBuffers(slot, count, buffers, strides, offsets);
+}
+
+void D3D11Backend::IASetIndexBuffer(ID3D11Buffer* buffer, DXGI_FORMAT format, UINT offset)
+{
+	Record(GraphicsCommand::BindIndexBuffer);
+	mContext->IASetIndexBuffer(buffer, format, offset);
+}
+
+void D3D11Backend::OMSetBlendState(ID3D11BlendState* blendState)
+{
+	Record(GraphicsCommand::BindState);
+	mContext->OMSetBlendState(blendState, nullptr, UINT_MAX);
+}
+
+void D3D11Backend::OMSetDepthStencilState(ID3D11DepthStencilState* depthStencilState)
+{
+	Record(GraphicsCommand::BindState);
+	mContext->OMSetDepthStencilState(depthStencilState, 0);
+}
+
+void D3D11Backend::OMSetRenderTargets(UINT count, ID3D11RenderTargetView* const* views, ID3D11DepthStencilView* depthStencilView)
+{
+	Record(GraphicsCommand::BindRenderTarget);
+	mContext->OMSetRenderTargets(count, views, depthStencilView);
+}
+
+void D3D11Backend::OMGetRenderTargets(UINT count, ID3D11RenderTargetView** views, ID3D11DepthStencilView** depthStencilView)
+{
+	mContext->OMGetRenderTargets(count, views, depthStencilView);
+}
+
+void D3D11Backend::RSSetViewports(UINT count, const D3D11_VIEWPORT* viewports)
+{
+	Record(GraphicsCommand::SetViewport);
+	mContext->RSSetViewports(count, viewports);
+}
+
+void D3D11Backend::RSGetViewports(UINT* count, D3D11_VIEWPORT* viewports)
+{
+	mContext->RSGetViewports(count, viewports);
+}
+
+void D3D11Backend::ClearRenderTargetView(ID3D11RenderTargetView* view, const FLOAT color[4])
+{
+	Record(GraphicsCommand::Clear);
+	mContext->ClearRenderTargetView(view, color);
+}
+
+void D3D11Backend::ClearDepthStencilView(ID3D11DepthStencilView* view, UINT flags, FLOAT depth, UINT8 stencil)
+{
+	Record(GraphicsCommand::Clear);
+	mContext->ClearDepthStencilView(view, flags, depth, stencil);
+}
+
+void D3D11Backend::Draw(UINT vertexCount, UINT startVertex)
+{
+	Record(GraphicsCommand::Draw, vertexCount);
+	mContext->Draw(vertexCount, startVertex);
+}
+
+void D3D11Backend::DrawIndexed(UINT indexCount, UINT startIndex, INT baseVertex)
+{
+	Record(GraphicsCommand::DrawIndexed, indexCount);
+	mContext->DrawIndexed(indexCount, startIndex, baseVertex);
+}
+
+void D3D11Backend::DrawInstanced(UINT vertexCount, UINT instanceCount, UINT startVertex, UINT startInstance)
+{
+	Record(GraphicsCommand::DrawInstanced, static_cast<uint64_t>(vertexCount) * instanceCount);
+	mContext->DrawInstanced(vertexCount, instanceCount, startVertex, startInstance);
+}
+
+void D3D11Backend::DrawIndexedInstanced(UINT indexCount, UINT instanceCount, UINT startIndex, INT baseVertex, UINT startInstance)
+{
+	Record(GraphicsCommand::DrawIndexedInstanced, static_cast<uint64_t>(indexCount) * instanceCount);
+	mContext->DrawIndexedInstanced(indexCount, instanceCount, startIndex, baseVertex, startInstance);
+}
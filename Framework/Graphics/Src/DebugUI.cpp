@@ -15,6 +15,8 @@ extern IMGUI_IMPL_API LRESULT ImGui_ImplWin32_WndProcHandler(HWND hWnd, UINT msg
 namespace
 {
 	WindowMessageHandler sWindowMessageHandler;
+	// no platform or renderer backend, frames are built and thrown away
+	bool sHeadless = false;
 
 	bool IsMouseInput(UINT msg)
 	{
@@ -84,6 +86,20 @@ void DebugUI::StaticInitialize(HWND window, bool docking, bool multiViewport)
 	ImGui::CreateContext();
 
 	ImGuiIO& io = ImGui::GetIO();
+	sHeadless = (window == nullptr);
+	if (sHeadless)
+	{
+		const GraphicsSystem* gs = GraphicsSystem::Get();
+		io.DisplaySize.x = static_cast<float>(gs->GetBackBufferWidth());
+		io.DisplaySize.y = static_cast<float>(gs->GetBackBufferHeight());
+		// NewFrame needs a built font atlas, nothing uploads it
+		unsigned char* pixels = nullptr;
+		int width = 0;
+		int height = 0;
+		io.Fonts->GetTexDataAsRGBA32(&pixels, &width, &height);
+		return;
+	}
+
 	if (docking)
 	{
 		io.ConfigFlags |= ImGuiConfigFlags_DockingEnable;
@@ -104,9 +120,12 @@ void DebugUI::StaticInitialize(HWND window, bool docking, bool multiViewport)
 
 void DebugUI::StaticTerminate()
 {
-	sWindowMessageHandler.Unhook();
-	ImGui_ImplDX11_Shutdown();
-	ImGui_ImplWin32_Shutdown();
+	if (!sHeadless)
+	{
+		sWindowMessageHandler.Unhook();
+		ImGui_ImplDX11_Shutdown();
+		ImGui_ImplWin32_Shutdown();
+	}
 	ImGui::DestroyContext();
 }
 
@@ -137,14 +156,25 @@ void DebugUI::SetTheme(Theme theme)
 
 void DebugUI::BeginRender()
 {
-	ImGui_ImplDX11_NewFrame();
-	ImGui_ImplWin32_NewFrame();
+	if (sHeadless)
+	{
+		ImGui::GetIO().DeltaTime = 1.0f / 60.0f;
+	}
+	else
+	{
+		ImGui_ImplDX11_NewFrame();
+		ImGui_ImplWin32_NewFrame();
+	}
 	ImGui::NewFrame();
 }
 
 void DebugUI::EndRender()
 {
 	ImGui::Render();
+	if (sHeadless)
+	{
+		return;
+	}
 	ImGui_ImplDX11_RenderDrawData(ImGui::GetDrawData());
 	
 	ImGuiIO& io = ImGui::GetIO();
@@ -0,0 +1,48 @@
+#include "Precompiled.h"
+#include "GraphicsBackend.h"
+
+using namespace ML_Engine;
+using namespace ML_Engine::Graphics;
+
+uint32_t GraphicsStats::GetDrawCount() const
+{
+	return GetCount(GraphicsCommand::Draw) + GetCount(GraphicsCommand::DrawIndexed)
+		+ GetCount(GraphicsCommand::DrawInstanced) + GetCount(GraphicsCommand::DrawIndexedInstanced);
+}
+
+uint32_t GraphicsStats::GetBindCount() const
+{
+	uint32_t count = 0;
+	for (size_t i = static_cast<size_t>(GraphicsCommand::BindConstantBuffer); i <= static_cast<size_t>(GraphicsCommand::BindRenderTarget); ++i)
+	{
+		count += commandCounts[i];
+	}
+	return count;
+}
+
+void GraphicsBackend::BeginFrame()
+{
+	mFrameStats = {};
+	mRecording.clear();
+}
+
+void GraphicsBackend::SetRecording(bool recording)
+{
+	mRecordingEnabled = recording;
+	mRecording.clear();
+}
+
+void GraphicsBackend::Record(GraphicsCommand command, uint64_t vertexCount, uint64_t bytes)
+{
+	const size_t index = static_cast<size_t>(command);
+	++mFrameStats.commandCounts[index];
+	++mTotalStats.commandCounts[index];
+	mFrameStats.vertexCount += vertexCount;
+	mTotalStats.vertexCount += vertexCount;
+	mFrameStats.bytesUploaded += bytes;
+	mTotalStats.bytesUploaded += bytes;
+	if (mRecordingEnabled)
+	{
+		mRecording.push_back(command);
+	}
+}
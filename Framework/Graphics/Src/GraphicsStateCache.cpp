@@ -0,0 +1,232 @@
+#include "Precompiled.h"
+#include "GraphicsStateCache.h"
+
+using namespace ML_Engine;
+using namespace ML_Engine::Graphics;
+
+namespace
+{
+	// stands for "not known", nullptr is a binding of its own
+	const char sUnknownTag = 0;
+	const void* const Unknown = &sUnknownTag;
+
+	size_t GetStageIndex(ShaderStage stage)
+	{
+		ASSERT(stage < ShaderStage::Count, "GraphicsStateCache: invalid shader stage");
+		return static_cast<size_t>(stage);
+	}
+}
+
+uint32_t StateCacheStats::GetIssuedCount() const
+{
+	uint32_t count = 0;
+	for (uint32_t issued : issuedCounts)
+	{
+		count += issued;
+	}
+	return count;
+}
+
+uint32_t StateCacheStats::GetFilteredCount() const
+{
+	uint32_t count = 0;
+	for (uint32_t filtered : filteredCounts)
+	{
+		count += filtered;
+	}
+	return count;
+}
+
+GraphicsStateCache::GraphicsStateCache()
+{
+	Invalidate();
+}
+
+bool GraphicsStateCache::SetVertexShader(const void* shader)
+{
+	return Set(StateCall::Shader, mVertexShader, shader);
+}
+
+bool GraphicsStateCache::SetInputLayout(const void* shader, uint32_t variant)
+{
+	if (mEnabled && mInputLayout == shader && mInputLayoutVariant == variant)
+	{
+		return Count(StateCall::InputLayout, false);
+	}
+	mInputLayout = shader;
+	mInputLayoutVariant = variant;
+	return Count(StateCall::InputLayout, true);
+}
+
+bool GraphicsStateCache::SetPixelShader(const void* shader)
+{
+	return Set(StateCall::Shader, mPixelShader, shader);
+}
+
+bool GraphicsStateCache::SetBlendState(const void* blendState)
+{
+	return Set(StateCall::BlendState, mBlendState, blendState);
+}
+
+bool GraphicsStateCache::SetSampler(ShaderStage stage, uint32_t slot, const void* sampler)
+{
+	return SetSlot(StateCall::Sampler, mSamplers[GetStageIndex(stage)], slot, sampler);
+}
+
+bool GraphicsStateCache::SetShaderResource(ShaderStage stage, uint32_t slot, const void* texture)
+{
+	return SetSlot(StateCall::ShaderResource, mShaderResources[GetStageIndex(stage)], slot, texture);
+}
+
+bool GraphicsStateCache::SetConstantBuffer(ShaderStage stage, uint32_t slot, const void* buffer)
+{
+	return SetSlot(StateCall::ConstantBuffer, mConstantBuffers[GetStageIndex(stage)], slot, buffer);
+}
+
+bool GraphicsStateCache::UpdateConstantBuffer(const void* buffer, const void* data, size_t size)
+{
+	// a collision would drop a real upload, at 64 bits that is not a practical concern
+	const uint64_t hash = Core::HashBytes(data, size, Core::HashBytes(&size, sizeof(size)));
+	auto [iter, inserted] = mBufferHashes.try_emplace(buffer, hash);
+	if (!inserted)
+	{
+		if (mEnabled && iter->second == hash)
+		{
+			return Count(StateCall::BufferUpdate, false);
+		}
+		iter->second = hash;
+	}
+	return Count(StateCall::BufferUpdate, true);
+}
+
+bool GraphicsStateCache::SetTopology(uint32_t topology)
+{
+	if (mEnabled && mHasTopology && mTopology == topology)
+	{
+		return Count(StateCall::Topology, false);
+	}
+	mTopology = topology;
+	mHasTopology = true;
+	return Count(StateCall::Topology, true);
+}
+
+bool GraphicsStateCache::SetVertexBuffers(const void* meshBuffer, uint32_t streams)
+{
+	if (mEnabled && mVertexBuffers == meshBuffer && mVertexStreams == streams)
+	{
+		return Count(StateCall::VertexBuffer, false);
+	}
+	mVertexBuffers = meshBuffer;
+	mVertexStreams = streams;
+	return Count(StateCall::VertexBuffer, true);
+}
+
+bool GraphicsStateCache::SetIndexBuffer(const void* meshBuffer)
+{
+	return Set(StateCall::IndexBuffer, mIndexBuffer, meshBuffer);
+}
+
+bool GraphicsStateCache::SetInstanceBuffer(const void* instanceBuffer)
+{
+	return Set(StateCall::VertexBuffer, mInstanceBuffer, instanceBuffer);
+}
+
+void GraphicsStateCache::Forget(const void* object)
+{
+	auto forget = [object](const void*& current)
+	{
+		if (current == object)
+		{
+			current = Unknown;
+		}
+	};
+
+	forget(mVertexShader);
+	forget(mInputLayout);
+	forget(mPixelShader);
+	forget(mBlendState);
+	forget(mVertexBuffers);
+	forget(mIndexBuffer);
+	forget(mInstanceBuffer);
+	for (size_t stage = 0; stage < static_cast<size_t>(ShaderStage::Count); ++stage)
+	{
+		for (uint32_t slot = 0; slot < MaxSlots; ++slot)
+		{
+			forget(mSamplers[stage][slot]);
+			forget(mShaderResources[stage][slot]);
+			forget(mConstantBuffers[stage][slot]);
+		}
+	}
+	mBufferHashes.erase(object);
+}
+
+void GraphicsStateCache::Invalidate()
+{
+	mVertexShader = Unknown;
+	mInputLayout = Unknown;
+	mPixelShader = Unknown;
+	mBlendState = Unknown;
+	for (size_t stage = 0; stage < static_cast<size_t>(ShaderStage::Count); ++stage)
+	{
+		mSamplers[stage].fill(Unknown);
+		mShaderResources[stage].fill(Unknown);
+		mConstantBuffers[stage].fill(Unknown);
+	}
+	mHasTopology = false;
+	mVertexBuffers = Unknown;
+	mIndexBuffer = Unknown;
+	mInstanceBuffer = Unknown;
+}
+
+void GraphicsStateCache::SetEnabled(bool enabled)
+{
+	// nothing is tracked while disabled
+	if (enabled && !mEnabled)
+	{
+		Invalidate();
+		mBufferHashes.clear();
+	}
+	mEnabled = enabled;
+}
+
+void GraphicsStateCache::BeginFrame()
+{
+	mFrameStats = {};
+	Invalidate();
+}
+
+bool GraphicsStateCache::Set(StateCall call, const void*& current, const void* value)
+{
+	if (mEnabled && current == value)
+	{
+		return Count(call, false);
+	}
+	current = value;
+	return Count(call, true);
+}
+
+bool GraphicsStateCache::SetSlot(StateCall call, SlotArray& slots, uint32_t slot, const void* value)
+{
+	if (slot >= MaxSlots)
+	{
+		// not tracked
+		return Count(call, true);
+	}
+	return Set(call, slots[slot], value);
+}
+
+bool GraphicsStateCache::Count(StateCall call, bool issued)
+{
+	const size_t index = static_cast<size_t>(call);
+	if (issued)
+	{
+		++mFrameStats.issuedCounts[index];
+		++mTotalStats.issuedCounts[index];
+	}
+	else
+	{
+		++mFrameStats.filteredCounts[index];
+		++mTotalStats.filteredCounts[index];
+	}
+	return issued;
+}
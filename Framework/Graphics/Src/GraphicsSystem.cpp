@@ -1,6 +1,9 @@
 #include "Precompiled.h"
 #include "GraphicsSystem.h"
 
+#include "D3D11Backend.h"
+#include "NullBackend.h"
+
 using namespace ML_Engine;
 using namespace ML_Engine::Graphics;
 
@@ -36,6 +39,13 @@ void GraphicsSystem::StaticInitialize(HWND window, bool fullscreen)
     sGraphicsSystem->Initialize(window, fullscreen);
 }
 
+void GraphicsSystem::StaticInitializeHeadless(uint32_t width, uint32_t height)
+{
+    ASSERT(sGraphicsSystem == nullptr, "GraphicsSystem: is already installed.");
+    sGraphicsSystem = std::make_unique<GraphicsSystem>();
+    sGraphicsSystem->InitializeHeadless(width, height);
+}
+
 void GraphicsSystem::StaticTerminate()
 {
     if (sGraphicsSystem != nullptr)
@@ -53,7 +63,7 @@ GraphicsSystem* GraphicsSystem::Get()
 
 GraphicsSystem::~GraphicsSystem()
 {
-    ASSERT(mD3DDevice == nullptr, "GraphicsSystem: must be terminated.");
+    ASSERT(mBackend == nullptr, "GraphicsSystem: must be terminated.");
 }
 
 void GraphicsSystem::Initialize(HWND window, bool fullscreen)
@@ -95,12 +105,21 @@ void GraphicsSystem::Initialize(HWND window, bool fullscreen)
 
     ASSERT(SUCCEEDED(hr), "GraphicsSystem: Failed to initialize device or swap chain.");
     mSwapChain->GetDesc(&mSwapChainDesc);
+    mBackend = std::make_unique<D3D11Backend>(mD3DDevice, mImmediateContext);
 
     Resize(GetBackBufferWidth(), GetBackBufferHeight());
 
     sWindowMessageHandler.Hook(window, GraphicsSystemMessageHandler);
 }
 
+void GraphicsSystem::InitializeHeadless(uint32_t width, uint32_t height)
+{
+    mSwapChainDesc.BufferDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+    mBackend = std::make_unique<NullBackend>();
+
+    Resize(width, height);
+}
+
 void GraphicsSystem::Terminate()
 {
     sWindowMessageHandler.Unhook();
@@ -108,24 +127,36 @@ void GraphicsSystem::Terminate()
     SafeRelease(mDepthStencilBuffer);
     SafeRelease(mRenderTargetView);
     SafeRelease(mSwapChain);
+    mBackend.reset();
     SafeRelease(mImmediateContext);
     SafeRelease(mD3DDevice);
 }
 
 void GraphicsSystem::BeginRender()
 {
-    mImmediateContext->OMSetRenderTargets(1, &mRenderTargetView, mDepthStencilView);
-    mImmediateContext->ClearRenderTargetView(mRenderTargetView, (FLOAT*)(&mClearColor));
-    mImmediateContext->ClearDepthStencilView(mDepthStencilView, D3D11_CLEAR_DEPTH | D3D11_CLEAR_STENCIL, 1.0f, 0.0f);
+    mBackend->BeginFrame();
+    // imgui and samples that use the context directly bind around the cache
+    mStateCache.BeginFrame();
+    mBackend->OMSetRenderTargets(1, &mRenderTargetView, mDepthStencilView);
+    mBackend->ClearRenderTargetView(mRenderTargetView, (FLOAT*)(&mClearColor));
+    mBackend->ClearDepthStencilView(mDepthStencilView, D3D11_CLEAR_DEPTH | D3D11_CLEAR_STENCIL, 1.0f, 0);
 }
 
 void GraphicsSystem::EndRender()
 {
-    mSwapChain->Present(mVSync, 0);
+    if (mSwapChain != nullptr)
+    {
+        mSwapChain->Present(mVSync, 0);
+    }
 }
 
 void GraphicsSystem::ToggleFullScreen()
 {
+    if (mSwapChain == nullptr)
+    {
+        return;
+    }
+
     BOOL fullscreen;
     mSwapChain->GetFullscreenState(&fullscreen, nullptr);
     mSwapChain->SetFullscreenState(!fullscreen, nullptr);
@@ -133,26 +164,35 @@ void GraphicsSystem::ToggleFullScreen()
 
 void GraphicsSystem::Resize(uint32_t width, uint32_t height)
 {
-    mImmediateContext -> OMSetRenderTargets(0, nullptr, nullptr);
+    mBackend->OMSetRenderTargets(0, nullptr, nullptr);
 
     SafeRelease(mRenderTargetView);
     SafeRelease(mDepthStencilView);
     SafeRelease(mDepthStencilBuffer);
 
     HRESULT hr;
-    if (width != GetBackBufferWidth() || height != GetBackBufferHeight())
+    ID3D11Texture2D* backBuffer = nullptr;
+    if (mSwapChain != nullptr)
     {
-        hr = mSwapChain->ResizeBuffers(0, 0, 0, DXGI_FORMAT_UNKNOWN, 0);
-        ASSERT(SUCCEEDED(hr), "GraphicsSystem: Failed to access swap chain view.");
+        if (width != GetBackBufferWidth() || height != GetBackBufferHeight())
+        {
+            hr = mSwapChain->ResizeBuffers(0, 0, 0, DXGI_FORMAT_UNKNOWN, 0);
+            ASSERT(SUCCEEDED(hr), "GraphicsSystem: Failed to access swap chain view.");
 
-        mSwapChain->GetDesc(&mSwapChainDesc);
-    }
+            mSwapChain->GetDesc(&mSwapChainDesc);
+        }
 
-    ID3D11Texture2D* backBuffer = nullptr;
-    hr = mSwapChain->GetBuffer(0, IID_PPV_ARGS(&backBuffer));
-    ASSERT(SUCCEEDED(hr), "GraphicsSystem: Failed to get back buffer.");
+        hr = mSwapChain->GetBuffer(0, IID_PPV_ARGS(&backBuffer));
+        ASSERT(SUCCEEDED(hr), "GraphicsSystem: Failed to get back buffer.");
+    }
+    else
+    {
+        // headless, the back buffer is only a size
+        mSwapChainDesc.BufferDesc.Width = width;
+        mSwapChainDesc.BufferDesc.Height = height;
+    }
 
-    hr = mD3DDevice->CreateRenderTargetView(backBuffer, nullptr, &mRenderTargetView);
+    hr = mBackend->CreateRenderTargetView(backBuffer, nullptr, &mRenderTargetView);
     SafeRelease(backBuffer);
     ASSERT(SUCCEEDED(hr), "GraphicsSystem: Failed to create render target.");
 
@@ -168,14 +208,14 @@ void GraphicsSystem::Resize(uint32_t width, uint32_t height)
     depthDesc.BindFlags = D3D11_BIND_DEPTH_STENCIL;
     depthDesc.CPUAccessFlags = 0;
     depthDesc.MiscFlags = 0;
-    hr = mD3DDevice->CreateTexture2D(&depthDesc, nullptr, &mDepthStencilBuffer);
+    hr = mBackend->CreateTexture2D(&depthDesc, nullptr, &mDepthStencilBuffer);
     ASSERT(SUCCEEDED(hr), "GraphicsSystem: Failed to create stencil buffer.");
 
     D3D11_DEPTH_STENCIL_VIEW_DESC dsvDesc = {};
     dsvDesc.Format = depthDesc.Format;
     dsvDesc.ViewDimension = D3D11_DSV_DIMENSION_TEXTURE2D;
     dsvDesc.Texture2D.MipSlice = 0;
-    hr = mD3DDevice->CreateDepthStencilView(mDepthStencilBuffer, &dsvDesc, &mDepthStencilView);
+    hr = mBackend->CreateDepthStencilView(mDepthStencilBuffer, &dsvDesc, &mDepthStencilView);
     ASSERT(SUCCEEDED(hr), "GraphicsSystem: Failed to create depth stencil view.");
 
     ResetRenderTarget();
@@ -191,12 +231,12 @@ void GraphicsSystem::Resize(uint32_t width, uint32_t height)
 
 void GraphicsSystem::ResetRenderTarget()
 {
-    mImmediateContext->OMSetRenderTargets(1, &mRenderTargetView, mDepthStencilView);
+    mBackend->OMSetRenderTargets(1, &mRenderTargetView, mDepthStencilView);
 }
 
 void GraphicsSystem::ResetViewport()
 {
-    mImmediateContext->RSSetViewports(1, &mViewport);
+    mBackend->RSSetViewports(1, &mViewport);
 }
 
 void GraphicsSystem::SetClearColor(const Color& color)
@@ -224,6 +264,21 @@ float GraphicsSystem::GetBackBufferAspectRatio() const
     return static_cast<float>(GetBackBufferWidth()) / static_cast<float>(GetBackBufferHeight());
 }
 
+bool GraphicsSystem::IsHeadless() const
+{
+    return mSwapChain == nullptr;
+}
+
+GraphicsBackend* GraphicsSystem::GetBackend()
+{
+    return mBackend.get();
+}
+
+GraphicsStateCache* GraphicsSystem::GetStateCache()
+{
+    return &mStateCache;
+}
+
 ID3D11Device* GraphicsSystem::GetDevice()
 {
     return mD3DDevice;
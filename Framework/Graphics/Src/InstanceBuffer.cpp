@@ -0,0 +1,61 @@
+#include "Precompiled.h"
+#include "InstanceBuffer.h"
+
+#include "GraphicsSystem.h"
+
+using namespace ML_Engine;
+using namespace ML_Engine::Graphics;
+
+InstanceBuffer::~InstanceBuffer()
+{
+	ASSERT(mInstanceBuffer == nullptr, "InstanceBuffer: terminate must be called");
+}
+
+void InstanceBuffer::Initialize(uint32_t maxInstanceCount)
+{
+	ASSERT(maxInstanceCount > 0, "InstanceBuffer: needs room for an instance");
+	mMaxInstanceCount = maxInstanceCount;
+	mInstanceCount = 0;
+
+	D3D11_BUFFER_DESC desc{};
+	desc.ByteWidth = static_cast<UINT>(sizeof(InstanceData)) * maxInstanceCount;
+	desc.Usage = D3D11_USAGE_DYNAMIC;
+	desc.BindFlags = D3D11_BIND_VERTEX_BUFFER;
+	desc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+	desc.MiscFlags = 0;
+	desc.StructureByteStride = 0;
+
+	auto backend = GraphicsSystem::Get()->GetBackend();
+	HRESULT hr = backend->CreateBuffer(&desc, nullptr, &mInstanceBuffer);
+	ASSERT(SUCCEEDED(hr), "InstanceBuffer: failed to create instance buffer");
+}
+
+void InstanceBuffer::Terminate()
+{
+	GraphicsSystem::Get()->GetStateCache()->Forget(this);
+	SafeRelease(mInstanceBuffer);
+	mMaxInstanceCount = 0;
+	mInstanceCount = 0;
+}
+
+void InstanceBuffer::Update(const InstanceData* instances, uint32_t instanceCount)
+{
+	ASSERT(instanceCount <= mMaxInstanceCount, "InstanceBuffer: %u instances do not fit in %u", instanceCount, mMaxInstanceCount);
+	mInstanceCount = instanceCount;
+	if (instanceCount > 0)
+	{
+		auto backend = GraphicsSystem::Get()->GetBackend();
+		backend->UpdateDynamicBuffer(mInstanceBuffer, instances, sizeof(InstanceData) * instanceCount);
+	}
+}
+
+void InstanceBuffer::Bind() const
+{
+	GraphicsSystem* gs = GraphicsSystem::Get();
+	if (gs->GetStateCache()->SetInstanceBuffer(this))
+	{
+		const UINT stride = sizeof(InstanceData);
+		const UINT offset = 0;
+		gs->GetBackend()->IASetVertexBuffers(Slot, 1, &mInstanceBuffer, &stride, &offset);
+	}
+}
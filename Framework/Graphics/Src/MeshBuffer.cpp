@@ -1,24 +1,84 @@
 #include "Precompiled.h"
 #include "MeshBuffer.h"
 #include "GraphicsSystem.h"
+#include "InstanceBuffer.h"
 
 using namespace ML_Engine;
 using namespace ML_Engine::Graphics;
 
+namespace
+{
+    DXGI_FORMAT GetDXGIFormat(IndexFormat format)
+    {
+        return (format == IndexFormat::UInt16) ? DXGI_FORMAT_R16_UINT : DXGI_FORMAT_R32_UINT;
+    }
+}
+
 void MeshBuffer::Initialize(const void* vertices, uint32_t vertexSize, uint32_t vertexCount)
 {
 	CreateVertexBuffer(vertices, vertexSize, vertexCount);
 }
 
-void MeshBuffer::Initialize(const void* vertices, uint32_t vertexSize, uint32_t vertexCount, const void* indices, uint32_t indexCount)
+void MeshBuffer::Initialize(const void* vertices, uint32_t vertexSize, uint32_t vertexCount, const uint32_t* indices, uint32_t indexCount)
 {
 	CreateVertexBuffer(vertices, vertexSize, vertexCount);
 	CreateIndexBuffer(indices, indexCount);
 }
 
+void MeshBuffer::Initialize(const void* vertices, uint32_t vertexSize, uint32_t vertexCount, const uint32_t* indices, uint32_t indexCount, uint32_t bufferIndexCount)
+{
+	ASSERT(indexCount <= bufferIndexCount, "MeshBuffer: draw range is larger than the index buffer");
+	CreateVertexBuffer(vertices, vertexSize, vertexCount);
+	CreateIndexBuffer(indices, bufferIndexCount);
+	mIndexCount = indexCount;
+}
+
+void MeshBuffer::InitializeSplit(const void* vertices, uint32_t vertexSize, uint32_t positionSize, uint32_t vertexCount, const uint32_t* indices, uint32_t indexCount, uint32_t bufferIndexCount)
+{
+	ASSERT(positionSize < vertexSize, "MeshBuffer: vertices have nothing besides the position to split off");
+
+	const uint32_t attributeSize = vertexSize - positionSize;
+	std::vector<uint8_t> positions(static_cast<size_t>(positionSize) * vertexCount);
+	std::vector<uint8_t> attributes(static_cast<size_t>(attributeSize) * vertexCount);
+	const uint8_t* vertex = static_cast<const uint8_t*>(vertices);
+	for (uint32_t i = 0; i < vertexCount; ++i, vertex += vertexSize)
+	{
+		memcpy(&positions[static_cast<size_t>(i) * positionSize], vertex, positionSize);
+		memcpy(&attributes[static_cast<size_t>(i) * attributeSize], vertex + positionSize, attributeSize);
+	}
+
+	InitializeStreams(positions.data(), positionSize, attributes.data(), attributeSize, vertexCount, indices, indexCount, bufferIndexCount);
+}
+
+void MeshBuffer::InitializeStreams(const void* positions, uint32_t positionSize, const void* attributes, uint32_t attributeSize, uint32_t vertexCount, const uint32_t* indices, uint32_t indexCount, uint32_t bufferIndexCount)
+{
+	ASSERT(positions != nullptr && attributes != nullptr, "MeshBuffer: split buffers are static");
+	ASSERT(indexCount <= bufferIndexCount, "MeshBuffer: draw range is larger than the index buffer");
+	CreatePositionBuffer(positions, positionSize, vertexCount);
+	CreateVertexBuffer(attributes, attributeSize, vertexCount);
+	CreateIndexBuffer(indices, bufferIndexCount);
+	mIndexCount = indexCount;
+}
+
+void MeshBuffer::InitializeStreams(const void* positions, uint32_t positionSize, const void* attributes, uint32_t attributeSize, uint32_t vertexCount, const void* indices, IndexFormat indexFormat, uint32_t indexCount, uint32_t bufferIndexCount)
+{
+	ASSERT(positions != nullptr && attributes != nullptr, "MeshBuffer: split buffers are static");
+	ASSERT(indexCount <= bufferIndexCount, "MeshBuffer: draw range is larger than the index buffer");
+	CreatePositionBuffer(positions, positionSize, vertexCount);
+	CreateVertexBuffer(attributes, attributeSize, vertexCount);
+	CreateIndexBuffer(indices, indexFormat, bufferIndexCount);
+	mIndexCount = indexCount;
+}
+
 void MeshBuffer::Terminate()
 {
+    GraphicsSystem::Get()->GetStateCache()->Forget(this);
+    SafeRelease(mIndexBuffer);
+    SafeRelease(mPositionBuffer);
     SafeRelease(mVertexBuffer);
+    mPositionSize = 0;
+    mIndexCount = 0;
+    mBufferIndexCount = 0;
 }
 
 void MeshBuffer::SetTopology(Topology topology)
@@ -35,34 +95,124 @@ void MeshBuffer::SetTopology(Topology topology)
 
 void MeshBuffer::Update(const void* vertices, uint32_t vertexCount)
 {
+    ASSERT(mPositionSize == 0, "MeshBuffer: split buffers are static");
     mVertexCount = vertexCount;
-	auto context = GraphicsSystem::Get()->GetContext();
-
-    D3D11_MAPPED_SUBRESOURCE resource;
-    context->Map(mVertexBuffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &resource);
-    memcpy(resource.pData, vertices, (vertexCount * mVertexSize));
-    context->Unmap(mVertexBuffer, 0);
+    auto backend = GraphicsSystem::Get()->GetBackend();
+    backend->UpdateDynamicBuffer(mVertexBuffer, vertices, (vertexCount * mVertexSize));
 }
 
 void MeshBuffer::Render() const
 {
-    
-    auto context = GraphicsSystem::Get()->GetContext();
+    BindVertexBuffers(false);
+    Draw();
+}
+
+void MeshBuffer::Render(uint32_t startIndex, uint32_t indexCount) const
+{
+    ASSERT(mBufferIndexCount > 0, "MeshBuffer: partial render needs an index buffer");
+    ASSERT(startIndex + indexCount <= mBufferIndexCount, "MeshBuffer: index range out of bounds");
+    GraphicsSystem* gs = GraphicsSystem::Get();
+    auto backend = gs->GetBackend();
+
+    BindVertexBuffers(false);
+    if (gs->GetStateCache()->SetIndexBuffer(this))
+    {
+        backend->IASetIndexBuffer(mIndexBuffer, GetDXGIFormat(mIndexFormat), 0);
+    }
+    backend->DrawIndexed(static_cast<UINT>(indexCount), static_cast<UINT>(startIndex), 0);
+}
+
+void MeshBuffer::RenderPositions() const
+{
+    BindVertexBuffers(true);
+    Draw();
+}
+
+void MeshBuffer::RenderInstanced(const InstanceBuffer& instances) const
+{
+    if (instances.GetInstanceCount() > 0)
+    {
+        BindVertexBuffers(false);
+        DrawInstanced(instances);
+    }
+}
+
+void MeshBuffer::RenderPositionsInstanced(const InstanceBuffer& instances) const
+{
+    if (instances.GetInstanceCount() > 0)
+    {
+        BindVertexBuffers(true);
+        DrawInstanced(instances);
+    }
+}
+
+void MeshBuffer::BindVertexBuffers(bool positionsOnly) const
+{
+    GraphicsSystem* gs = GraphicsSystem::Get();
+    GraphicsStateCache* stateCache = gs->GetStateCache();
+    auto backend = gs->GetBackend();
+
+    if (stateCache->SetTopology(static_cast<uint32_t>(mTopology)))
+    {
+        backend->IASetPrimitiveTopology(mTopology);
+    }
+    // a split buffer binds one or two streams, an interleaved one always the same
+    const uint32_t streams = (mPositionSize > 0 && positionsOnly) ? 1 : 2;
+    if (!stateCache->SetVertexBuffers(this, streams))
+    {
+        return;
+    }
+
+    const UINT offsets[] = { 0, 0 };
+    if (mPositionSize == 0)
+    {
+        // interleaved, a position only layout reads the start of each full vertex
+        backend->IASetVertexBuffers(0, 1, &mVertexBuffer, &mVertexSize, offsets);
+    }
+    else
+    {
+        ID3D11Buffer* buffers[] = { mPositionBuffer, mVertexBuffer };
+        const UINT strides[] = { mPositionSize, mVertexSize };
+        backend->IASetVertexBuffers(0, positionsOnly ? 1 : 2, buffers, strides, offsets);
+    }
+}
 
-    context->IASetPrimitiveTopology(mTopology);
-    UINT offset = 0;
-    context->IASetVertexBuffers(0, 1, &mVertexBuffer, &mVertexSize, &offset);
-    if (mIndexBuffer != nullptr)
+void MeshBuffer::Draw() const
+{
+    GraphicsSystem* gs = GraphicsSystem::Get();
+    auto backend = gs->GetBackend();
+    if (mIndexCount > 0)
 	{
-		context->IASetIndexBuffer(mIndexBuffer, DXGI_FORMAT_R32_UINT, 0);
-		context->DrawIndexed((UINT)mIndexCount, 0, 0);
+		if (gs->GetStateCache()->SetIndexBuffer(this))
+		{
+			backend->IASetIndexBuffer(mIndexBuffer, GetDXGIFormat(mIndexFormat), 0);
+		}
+		backend->DrawIndexed((UINT)mIndexCount, 0, 0);
 	}
     else
     {
-        context->Draw(static_cast<UINT>(mVertexCount), 0);
+        backend->Draw(static_cast<UINT>(mVertexCount), 0);
     }
+}
 
-    context->Draw(static_cast<UINT>(mVertexCount), 0);
+void MeshBuffer::DrawInstanced(const InstanceBuffer& instances) const
+{
+    GraphicsSystem* gs = GraphicsSystem::Get();
+    auto backend = gs->GetBackend();
+    instances.Bind();
+    const UINT instanceCount = static_cast<UINT>(instances.GetInstanceCount());
+    if (mIndexCount > 0)
+    {
+        if (gs->GetStateCache()->SetIndexBuffer(this))
+        {
+            backend->IASetIndexBuffer(mIndexBuffer, GetDXGIFormat(mIndexFormat), 0);
+        }
+        backend->DrawIndexedInstanced(static_cast<UINT>(mIndexCount), instanceCount, 0, 0, 0);
+    }
+    else
+    {
+        backend->DrawInstanced(static_cast<UINT>(mVertexCount), instanceCount, 0, 0);
+    }
 }
 
 void MeshBuffer::CreateVertexBuffer(const void* vertices, uint32_t vertexSize, uint32_t vertexCount)
@@ -70,7 +220,7 @@ void MeshBuffer::CreateVertexBuffer(const void* vertices, uint32_t vertexSize, u
     mVertexSize = vertexSize;
     mVertexCount = vertexCount;
 
-    auto device = GraphicsSystem::Get()->GetDevice();
+    auto backend = GraphicsSystem::Get()->GetBackend();
 
     const bool isDynamic = (vertices == nullptr);
     // need to create a buffer to store the vertices
@@ -86,24 +236,70 @@ void MeshBuffer::CreateVertexBuffer(const void* vertices, uint32_t vertexSize, u
     D3D11_SUBRESOURCE_DATA initData = {};
     initData.pSysMem = vertices;
 
-    HRESULT hr = device->CreateBuffer(&bufferDesc, (isDynamic ? nullptr : &initData), &mVertexBuffer);
+    HRESULT hr = backend->CreateBuffer(&bufferDesc, (isDynamic ? nullptr : &initData), &mVertexBuffer);
     ASSERT(SUCCEEDED(hr), "Failed to create vertex buffer");
 }
 
-void MeshBuffer::CreateIndexBuffer(const void* indices, uint32_t indexCount)
+void MeshBuffer::CreatePositionBuffer(const void* positions, uint32_t positionSize, uint32_t vertexCount)
+{
+    mPositionSize = positionSize;
+
+    auto backend = GraphicsSystem::Get()->GetBackend();
+
+    D3D11_BUFFER_DESC bufferDesc{};
+    bufferDesc.ByteWidth = positionSize * vertexCount;
+    bufferDesc.Usage = D3D11_USAGE_DEFAULT;
+    bufferDesc.BindFlags = D3D11_BIND_VERTEX_BUFFER;
+    bufferDesc.MiscFlags = 0;
+    bufferDesc.StructureByteStride = 0;
+
+    D3D11_SUBRESOURCE_DATA initData = {};
+    initData.pSysMem = positions;
+
+    HRESULT hr = backend->CreateBuffer(&bufferDesc, &initData, &mPositionBuffer);
+    ASSERT(SUCCEEDED(hr), "Failed to create position buffer");
+}
+
+void MeshBuffer::CreateIndexBuffer(const uint32_t* indices, uint32_t indexCount)
 {
     if(indexCount == 0)
 	{
 		return;
 	}
 
+    // narrow to 16 bit when every vertex is addressable, the 32 bit copy is not kept
+    const IndexFormat indexFormat = Graphics::GetIndexFormat(mVertexCount);
+    if (indexFormat == IndexFormat::UInt32)
+    {
+        CreateIndexBuffer(indices, indexFormat, indexCount);
+        return;
+    }
+
+    std::vector<uint16_t> compactIndices(indexCount);
+    for (uint32_t i = 0; i < indexCount; ++i)
+    {
+        ASSERT(indices[i] < mVertexCount, "MeshBuffer: index out of range");
+        compactIndices[i] = static_cast<uint16_t>(indices[i]);
+    }
+    CreateIndexBuffer(compactIndices.data(), indexFormat, indexCount);
+}
+
+void MeshBuffer::CreateIndexBuffer(const void* indices, IndexFormat indexFormat, uint32_t indexCount)
+{
+    if (indexCount == 0)
+    {
+        return;
+    }
+
     mIndexCount = indexCount;
+    mBufferIndexCount = indexCount;
+    mIndexFormat = indexFormat;
 
-    auto device = GraphicsSystem::Get()->GetDevice();
+    auto backend = GraphicsSystem::Get()->GetBackend();
 
     // index buffer
 	D3D11_BUFFER_DESC bufferDesc{};
-	bufferDesc.ByteWidth = static_cast<UINT>(indexCount) * sizeof(uint32_t);
+	bufferDesc.ByteWidth = static_cast<UINT>(indexCount) * GetIndexSize(mIndexFormat);
 	bufferDesc.Usage = D3D11_USAGE_DEFAULT;
 	bufferDesc.BindFlags = D3D11_BIND_INDEX_BUFFER;
 	bufferDesc.MiscFlags = 0;
@@ -112,6 +308,6 @@ void MeshBuffer::CreateIndexBuffer(const void* indices, uint32_t indexCount)
 	D3D11_SUBRESOURCE_DATA initData = {};
 	initData.pSysMem = indices;
 
-    HRESULT hr = device->CreateBuffer(&bufferDesc, &initData, &mIndexBuffer);
+    HRESULT hr = backend->CreateBuffer(&bufferDesc, &initData, &mIndexBuffer);
 	ASSERT(SUCCEEDED(hr), "Failed to create index buffer");
 }
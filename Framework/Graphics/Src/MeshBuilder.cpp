@@ -1,5 +1,6 @@
 #include "Precompiled.h"
 #include "MeshBuilder.h"
+#include "MeshOptimizer.h"
 
 using namespace ML_Engine;
 using namespace ML_Engine::Graphics;
@@ -81,6 +82,45 @@ namespace {
 			indices.push_back(topRowIndex);
         }
     }
+
+    // OBJ indices are 1 based, or negative to count back from the last element read so far.
+    // Returns the 1 based index, or 0 when it is out of range
+    uint32_t ResolveOBJIndex(long index, size_t count)
+    {
+        const long long resolved = (index < 0) ? static_cast<long long>(count) + 1 + index : index;
+        return (resolved >= 1 && resolved <= static_cast<long long>(count)) ? static_cast<uint32_t>(resolved) : 0;
+    }
+
+    // One face corner, "v", "v/vt", "v//vn" or "v/vt/vn". uv is left 0 when the corner has
+    // none or it is out of range, the normal is read but not used
+    bool ParseOBJCorner(const char* token, size_t positionCount, size_t uvCount, uint32_t& position, uint32_t& uv)
+    {
+        char* end = nullptr;
+        position = ResolveOBJIndex(strtol(token, &end, 10), positionCount);
+        if (end == token || position == 0)
+        {
+            return false;
+        }
+        uv = 0;
+        for (int field = 0; field < 2 && *end == '/'; ++field)
+        {
+            const char* start = end + 1;
+            const long index = strtol(start, &end, 10);
+            if (end == start)
+            {
+                // only the uv may be empty, as in "v//vn"
+                if (field != 0 || *end != '/')
+                {
+                    return false;
+                }
+            }
+            else if (field == 0)
+            {
+                uv = ResolveOBJIndex(index, uvCount);
+            }
+        }
+        return *end == '\0';
+    }
 }
 
 MeshPC MeshBuilder::CreateCubePC(float size, const Color& color)
@@ -532,6 +572,9 @@ MeshPX MeshBuilder::CreateOBJPX(const std::filesystem::path& filePath, float sca
     std::vector<Math::Vector2> uvCoords;
     std::vector<uint32_t> positionIndices;
     std::vector<uint32_t> uvIndices;
+    std::vector<uint32_t> cornerPositions;
+    std::vector<uint32_t> cornerUVs;
+    int faceCount = 0;
 
     while (true)
     {
@@ -555,53 +598,50 @@ MeshPX MeshBuilder::CreateOBJPX(const std::filesystem::path& filePath, float sca
         }
         else if (strcmp(buffer, "f") == 0)
         {
-            uint32_t p[4];
-            uint32_t uv[4];
-            int count = fscanf_s(file, "%d/%d/%*d %d/%d/%*d %d/%d/%*d %d/%d/%*d\n", &p[0], &uv[0], &p[1], &uv[1], &p[2], &uv[2], &p[3], &uv[3]);
-            if (count % 3 == 0)
+            // any number of corners, triangulated as a fan around the first
+            char line[1024] = {};
+            fgets(line, static_cast<int>(std::size(line)), file);
+            ++faceCount;
+            cornerPositions.clear();
+            cornerUVs.clear();
+            bool valid = true;
+            char* context = nullptr;
+            for (char* token = strtok_s(line, " \t\r\n", &context); token != nullptr && valid; token = strtok_s(nullptr, " \t\r\n", &context))
             {
-                for (uint32_t i = 0; i < 3; i++)
-                {
-                    positionIndices.push_back(p[i] - 1);
-                    uvIndices.push_back(uv[i] - 1);
-                }
+                uint32_t p = 0, uv = 0;
+                valid = ParseOBJCorner(token, positions.size(), uvCoords.size(), p, uv);
+                cornerPositions.push_back(p);
+                cornerUVs.push_back(uv);
             }
-            else
+            if (!valid || cornerPositions.size() < 3)
             {
-                // triangle 1
-                positionIndices.push_back(p[0] - 1);
-                positionIndices.push_back(p[1] - 1);
-                positionIndices.push_back(p[2] - 1);
-                // triangle 2
-                positionIndices.push_back(p[0] - 1);
-                positionIndices.push_back(p[2] - 1);
-                positionIndices.push_back(p[3] - 1);
-
-                // triangle 1
-                uvIndices.push_back(uv[0] - 1);
-                uvIndices.push_back(uv[1] - 1);
-                uvIndices.push_back(uv[2] - 1);
-                // triangle 2
-                uvIndices.push_back(uv[0] - 1);
-                uvIndices.push_back(uv[2] - 1);
-                uvIndices.push_back(uv[3] - 1);
+                LOG("MeshBuilder: %s face %d is malformed, skipping it", filePath.u8string().c_str(), faceCount);
+                continue;
+            }
+            for (size_t i = 1; i + 1 < cornerPositions.size(); ++i)
+            {
+                for (const size_t corner : { size_t(0), i, i + 1 })
+                {
+                    positionIndices.push_back(cornerPositions[corner] - 1);
+                    uvIndices.push_back(cornerUVs[corner] - 1); // a missing uv wraps past the end of uvCoords
+                }
             }
         }
     }
     fclose(file);
-    mesh.vertices.resize(positions.size());
-    for(uint32_t i = 0; i < positions.size(); i++)
-    {
-        mesh.vertices[i].position = positions[i] * scale;
-    }
-    if (uvCoords.size() > 0)
+
+    // one vertex per face corner so corners sharing a position keep their own uv,
+    // then weld the corners that are identical
+    mesh.vertices.resize(positionIndices.size());
+    mesh.indices.resize(positionIndices.size());
+    for (uint32_t i = 0; i < positionIndices.size(); i++)
     {
-        for (uint32_t i = 0; i < uvIndices.size(); i++)
-        {
-            mesh.vertices[positionIndices[i]].uvCoord = uvCoords[uvIndices[i]];
-        }
+        mesh.vertices[i].position = positions[positionIndices[i]] * scale;
+        // corners without a valid uv, or files without any, get a zero uv
+        mesh.vertices[i].uvCoord = (uvIndices[i] < uvCoords.size()) ? uvCoords[uvIndices[i]] : Math::Vector2::Zero;
+        mesh.indices[i] = i;
     }
-    mesh.indices = std::move(positionIndices);
+    MeshOptimizer::WeldVertices(mesh);
 
     return mesh;
 }
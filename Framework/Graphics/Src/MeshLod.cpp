@@ -0,0 +1,660 @@
+#include "Precompiled.h"
+#include "MeshLod.h"
+
+#include "Camera.h"
+#include "MeshOptimizer.h"
+
+using namespace ML_Engine;
+using namespace ML_Engine::Graphics;
+
+namespace
+{
+	constexpr uint32_t NoVertex = UINT32_MAX;
+
+	// open edges also get a plane through the edge, perpendicular to the triangle, so
+	// borders keep their outline
+	constexpr double BorderWeight = 10.0;
+
+	// triangles whose normal turns by more than ~75 degrees block a collapse
+	constexpr float MinNormalDot = 0.25f;
+
+	// symmetric 4x4 plane quadric, w is the total area it was built from
+	struct Quadric
+	{
+		double a00 = 0.0, a11 = 0.0, a22 = 0.0;
+		double a01 = 0.0, a02 = 0.0, a12 = 0.0;
+		double b0 = 0.0, b1 = 0.0, b2 = 0.0;
+		double c = 0.0;
+		double w = 0.0;
+
+		void AddPlane(const Math::Vector3& n, float d, double weight)
+		{
+			a00 += weight * n.x * n.x;
+			a11 += weight * n.y * n.y;
+			a22 += weight * n.z * n.z;
+			a01 += weight * n.x * n.y;
+			a02 += weight * n.x * n.z;
+			a12 += weight * n.y * n.z;
+			b0 += weight * n.x * d;
+			b1 += weight * n.y * d;
+			b2 += weight * n.z * d;
+			c += weight * d * d;
+			w += weight;
+		}
+
+		void Add(const Quadric& q)
+		{
+			a00 += q.a00; a11 += q.a11; a22 += q.a22;
+			a01 += q.a01; a02 += q.a02; a12 += q.a12;
+			b0 += q.b0; b1 += q.b1; b2 += q.b2;
+			c += q.c;
+			w += q.w;
+		}
+	};
+
+	// mean squared distance of v to the planes of a + b
+	double QuadricError(const Quadric& a, const Quadric& b, const Math::Vector3& v)
+	{
+		const double x = v.x, y = v.y, z = v.z;
+		const double error =
+			(a.a00 + b.a00) * x * x + (a.a11 + b.a11) * y * y + (a.a22 + b.a22) * z * z +
+			2.0 * ((a.a01 + b.a01) * x * y + (a.a02 + b.a02) * x * z + (a.a12 + b.a12) * y * z) +
+			2.0 * ((a.b0 + b.b0) * x + (a.b1 + b.b1) * y + (a.b2 + b.b2) * z) +
+			(a.c + b.c);
+		const double weight = a.w + b.w;
+		return (weight > 0.0) ? Math::Max(error, 0.0) / weight : 0.0;
+	}
+
+	// items grouped per key, stored as offsets into one flat array
+	struct Buckets
+	{
+		std::vector<uint32_t> offsets;
+		std::vector<uint32_t> items;
+
+		uint32_t Begin(uint32_t key) const { return offsets[key]; }
+		uint32_t End(uint32_t key) const { return offsets[key + 1]; }
+	};
+
+	struct Collapse
+	{
+		uint32_t from = 0;
+		uint32_t to = 0;
+		float cost = 0.0f;
+	};
+
+	uint64_t EdgeKey(uint32_t a, uint32_t b)
+	{
+		return (a < b) ? (static_cast<uint64_t>(a) << 32) | b : (static_cast<uint64_t>(b) << 32) | a;
+	}
+
+	// closest point on the triangle by region (Ericson, Real-Time Collision Detection 5.1.5)
+	float PointTriangleDistance(const Math::Vector3& p, const Math::Vector3& a, const Math::Vector3& b, const Math::Vector3& c)
+	{
+		const Math::Vector3 ab = b - a;
+		const Math::Vector3 ac = c - a;
+		const Math::Vector3 ap = p - a;
+		const float d1 = Math::Dot(ab, ap);
+		const float d2 = Math::Dot(ac, ap);
+		if (d1 <= 0.0f && d2 <= 0.0f)
+		{
+			return Math::Magnitude(ap);
+		}
+		const Math::Vector3 bp = p - b;
+		const float d3 = Math::Dot(ab, bp);
+		const float d4 = Math::Dot(ac, bp);
+		if (d3 >= 0.0f && d4 <= d3)
+		{
+			return Math::Magnitude(bp);
+		}
+		const float vc = d1 * d4 - d3 * d2;
+		if (vc <= 0.0f && d1 >= 0.0f && d3 <= 0.0f)
+		{
+			return Math::Magnitude(ap - ab * (d1 / (d1 - d3)));
+		}
+		const Math::Vector3 cp = p - c;
+		const float d5 = Math::Dot(ab, cp);
+		const float d6 = Math::Dot(ac, cp);
+		if (d6 >= 0.0f && d5 <= d6)
+		{
+			return Math::Magnitude(cp);
+		}
+		const float vb = d5 * d2 - d1 * d6;
+		if (vb <= 0.0f && d2 >= 0.0f && d6 <= 0.0f)
+		{
+			return Math::Magnitude(ap - ac * (d2 / (d2 - d6)));
+		}
+		const float va = d3 * d6 - d5 * d4;
+		if (va <= 0.0f && (d4 - d3) >= 0.0f && (d5 - d6) >= 0.0f)
+		{
+			return Math::Magnitude(bp - (c - b) * ((d4 - d3) / ((d4 - d3) + (d5 - d6))));
+		}
+		const float denom = va + vb + vc;
+		if (denom <= 0.0f)
+		{
+			return Math::Magnitude(ap);
+		}
+		return Math::Magnitude(ap - ab * (vb / denom) - ac * (vc / denom));
+	}
+
+	float MaxScale(const Math::Matrix4& m)
+	{
+		return sqrtf(Math::Max(m._11 * m._11 + m._12 * m._12 + m._13 * m._13,
+			Math::Max(m._21 * m._21 + m._22 * m._22 + m._23 * m._23,
+				m._31 * m._31 + m._32 * m._32 + m._33 * m._33)));
+	}
+
+	// Collapses down through each target in turn and snapshots the indices at each one, so
+	// a whole lod chain costs one simplification. Stops early when nothing can collapse.
+	void SimplifyLevels(const uint32_t* indices, size_t indexCount, const Math::Vector3* positions, size_t vertexCount, size_t stride,
+		const std::function<float(uint32_t, uint32_t)>& attributeDistance, const std::vector<size_t>& targetIndexCounts,
+		std::vector<MeshLod>& levels)
+	{
+		ASSERT(indexCount % 3 == 0, "MeshSimplifier: index count must be a multiple of 3");
+		levels.clear();
+		if (indexCount == 0 || vertexCount == 0)
+		{
+			return;
+		}
+		std::vector<uint32_t> result(indices, indices + indexCount);
+
+		// collapses work on positions, all vertices at one position move together
+		std::vector<uint32_t> positionIds;
+		const uint32_t positionCount = MeshOptimizer::WeldVertexRemap(positions, vertexCount, stride, 0.0f, [](uint32_t, uint32_t) { return true; }, positionIds);
+
+		// errors are measured in a unit box so the costs do not depend on the mesh size
+		const Math::AABB aabb = Math::ComputeAABB(positions, vertexCount, stride);
+		const float extent = 2.0f * Math::Max(aabb.extend.x, Math::Max(aabb.extend.y, aabb.extend.z));
+		const float invExtent = (extent > 0.0f) ? 1.0f / extent : 1.0f;
+		std::vector<Math::Vector3> points(positionCount);
+		for (size_t v = 0; v < vertexCount; ++v)
+		{
+			const Math::Vector3& p = *reinterpret_cast<const Math::Vector3*>(reinterpret_cast<const uint8_t*>(positions) + v * stride);
+			points[positionIds[v]] = (p - aabb.center) * invExtent;
+		}
+
+		std::vector<Quadric> quadrics(positionCount);
+		{
+			std::vector<uint64_t> edges;
+			edges.reserve(indexCount);
+			for (size_t i = 0; i < indexCount; i += 3)
+			{
+				const uint32_t a = positionIds[indices[i + 0]];
+				const uint32_t b = positionIds[indices[i + 1]];
+				const uint32_t c = positionIds[indices[i + 2]];
+				const Math::Vector3 n = Math::Cross(points[b] - points[a], points[c] - points[a]);
+				const float area = Math::Magnitude(n);
+				if (area > 0.0f)
+				{
+					const Math::Vector3 normal = n / area;
+					const float d = -Math::Dot(normal, points[a]);
+					quadrics[a].AddPlane(normal, d, area);
+					quadrics[b].AddPlane(normal, d, area);
+					quadrics[c].AddPlane(normal, d, area);
+				}
+				edges.push_back(EdgeKey(a, b));
+				edges.push_back(EdgeKey(b, c));
+				edges.push_back(EdgeKey(c, a));
+			}
+			std::sort(edges.begin(), edges.end());
+
+			for (size_t i = 0; i < indexCount; i += 3)
+			{
+				for (uint32_t k = 0; k < 3; ++k)
+				{
+					const uint32_t a = positionIds[indices[i + k]];
+					const uint32_t b = positionIds[indices[i + (k + 1) % 3]];
+					const uint32_t c = positionIds[indices[i + (k + 2) % 3]];
+					const auto range = std::equal_range(edges.begin(), edges.end(), EdgeKey(a, b));
+					if (range.second - range.first != 1)
+					{
+						continue;
+					}
+					const Math::Vector3 edge = points[b] - points[a];
+					const Math::Vector3 n = Math::Cross(edge, Math::Cross(edge, points[c] - points[a]));
+					const float length = Math::Magnitude(n);
+					if (length > 0.0f)
+					{
+						const Math::Vector3 normal = n / length;
+						const float d = -Math::Dot(normal, points[a]);
+						const double weight = BorderWeight * Math::MagnitudeSqr(edge);
+						quadrics[a].AddPlane(normal, d, weight);
+						quadrics[b].AddPlane(normal, d, weight);
+					}
+				}
+			}
+		}
+
+		std::vector<uint32_t> remap(vertexCount);
+		for (uint32_t v = 0; v < vertexCount; ++v)
+		{
+			remap[v] = v;
+		}
+		std::vector<uint32_t> collapsedTo(positionCount);
+		for (uint32_t p = 0; p < positionCount; ++p)
+		{
+			collapsedTo[p] = p;
+		}
+
+		Buckets triangles;
+		Buckets vertices;
+		std::vector<uint64_t> edges;
+		std::vector<uint8_t> isBorder(positionCount);
+		std::vector<uint8_t> locked(positionCount);
+		std::vector<uint32_t> seen(vertexCount, NoVertex);
+		std::vector<uint32_t> usedVertices;
+		std::vector<uint32_t> neighbourMark(positionCount, 0);
+		std::vector<uint32_t> apexMark(positionCount, 0);
+		uint32_t mark = 0;
+		std::vector<Collapse> collapses;
+
+		auto Bucket = [positionCount](Buckets& buckets, const auto& forEach)
+		{
+			buckets.offsets.assign(positionCount + 1, 0);
+			forEach([&](uint32_t key, uint32_t) { ++buckets.offsets[key + 1]; });
+			for (uint32_t p = 0; p < positionCount; ++p)
+			{
+				buckets.offsets[p + 1] += buckets.offsets[p];
+			}
+			buckets.items.resize(buckets.offsets[positionCount]);
+			std::vector<uint32_t> cursor(buckets.offsets.begin(), buckets.offsets.end() - 1);
+			forEach([&](uint32_t key, uint32_t item) { buckets.items[cursor[key]++] = item; });
+		};
+
+		// where vertex v at position from lands when from collapses onto to: the vertex it shares an
+		// edge with when there is one, so attributes stay continuous, else the closest attributes
+		auto MapVertex = [&](uint32_t from, uint32_t to, uint32_t v, float& distance)
+		{
+			uint32_t best = NoVertex;
+			distance = std::numeric_limits<float>::max();
+			for (uint32_t t = triangles.Begin(from); t < triangles.End(from); ++t)
+			{
+				const uint32_t* triangle = &result[triangles.items[t] * 3];
+				if (triangle[0] != v && triangle[1] != v && triangle[2] != v)
+				{
+					continue;
+				}
+				for (uint32_t k = 0; k < 3; ++k)
+				{
+					if (positionIds[triangle[k]] == to)
+					{
+						const float d = attributeDistance(v, triangle[k]);
+						if (d < distance)
+						{
+							best = triangle[k];
+							distance = d;
+						}
+					}
+				}
+			}
+			if (best != NoVertex)
+			{
+				return best;
+			}
+			for (uint32_t i = vertices.Begin(to); i < vertices.End(to); ++i)
+			{
+				const float d = attributeDistance(v, vertices.items[i]);
+				if (d < distance)
+				{
+					best = vertices.items[i];
+					distance = d;
+				}
+			}
+			return best;
+		};
+
+		auto Evaluate = [&](uint32_t from, uint32_t to, bool borderEdge, Collapse& collapse)
+		{
+			// border vertices only slide along the border
+			if (isBorder[from] && !borderEdge)
+			{
+				return false;
+			}
+
+			// link condition: the only neighbours both ends may share are the corners opposite
+			// the edge, anything else would fold the surface or collapse a part away
+			++mark;
+			for (uint32_t t = triangles.Begin(to); t < triangles.End(to); ++t)
+			{
+				const uint32_t* triangle = &result[triangles.items[t] * 3];
+				const uint32_t a = positionIds[triangle[0]];
+				const uint32_t b = positionIds[triangle[1]];
+				const uint32_t c = positionIds[triangle[2]];
+				neighbourMark[a] = neighbourMark[b] = neighbourMark[c] = mark;
+				if (a == from || b == from || c == from)
+				{
+					apexMark[a] = apexMark[b] = apexMark[c] = mark;
+				}
+			}
+
+			const Math::Vector3& target = points[to];
+			for (uint32_t t = triangles.Begin(from); t < triangles.End(from); ++t)
+			{
+				const uint32_t* triangle = &result[triangles.items[t] * 3];
+				const uint32_t a = positionIds[triangle[0]];
+				const uint32_t b = positionIds[triangle[1]];
+				const uint32_t c = positionIds[triangle[2]];
+				if (a == to || b == to || c == to)
+				{
+					continue;
+				}
+
+				const uint32_t r = (a == from) ? b : a;
+				const uint32_t q = (c == from) ? b : c;
+				const bool sharedR = neighbourMark[r] == mark;
+				const bool sharedQ = neighbourMark[q] == mark;
+				if ((sharedR && apexMark[r] != mark) || (sharedQ && apexMark[q] != mark))
+				{
+					return false;
+				}
+				if (sharedR && sharedQ)
+				{
+					for (uint32_t u = triangles.Begin(to); u < triangles.End(to); ++u)
+					{
+						const uint32_t* other = &result[triangles.items[u] * 3];
+						const uint32_t oa = positionIds[other[0]];
+						const uint32_t ob = positionIds[other[1]];
+						const uint32_t oc = positionIds[other[2]];
+						if ((oa == r || ob == r || oc == r) && (oa == q || ob == q || oc == q))
+						{
+							return false;
+						}
+					}
+				}
+				const Math::Vector3 before = Math::Cross(points[b] - points[a], points[c] - points[a]);
+				const Math::Vector3& pa = (a == from) ? target : points[a];
+				const Math::Vector3& pb = (b == from) ? target : points[b];
+				const Math::Vector3& pc = (c == from) ? target : points[c];
+				const Math::Vector3 after = Math::Cross(pb - pa, pc - pa);
+				if (Math::Dot(before, after) < MinNormalDot * Math::Magnitude(before) * Math::Magnitude(after))
+				{
+					return false;
+				}
+			}
+
+			float attributeError = 0.0f;
+			for (uint32_t i = vertices.Begin(from); i < vertices.End(from); ++i)
+			{
+				float distance = 0.0f;
+				if (MapVertex(from, to, vertices.items[i], distance) == NoVertex)
+				{
+					return false;
+				}
+				attributeError += distance;
+			}
+
+			// attribute changes are scaled by the edge so they compare with the distance error
+			const double error = QuadricError(quadrics[from], quadrics[to], target);
+			collapse.from = from;
+			collapse.to = to;
+			collapse.cost = static_cast<float>(error + attributeError * Math::MagnitudeSqr(target - points[from]));
+			return true;
+		};
+
+		auto BucketTriangles = [&]()
+		{
+			Bucket(triangles, [&](const auto& add)
+			{
+				for (uint32_t i = 0; i < result.size(); ++i)
+				{
+					add(positionIds[result[i]], i / 3);
+				}
+			});
+		};
+
+		// the quadrics only give an average, measure how far each original position ended up
+		// from the triangles around the position it collapsed into
+		auto MeasureError = [&]()
+		{
+			BucketTriangles();
+			float maxDistance = 0.0f;
+			for (uint32_t p = 0; p < positionCount; ++p)
+			{
+				uint32_t target = p;
+				while (collapsedTo[target] != target)
+				{
+					target = collapsedTo[target];
+				}
+				collapsedTo[p] = target;
+
+				float distance = std::numeric_limits<float>::max();
+				for (uint32_t t = triangles.Begin(target); t < triangles.End(target); ++t)
+				{
+					const uint32_t* triangle = &result[triangles.items[t] * 3];
+					distance = Math::Min(distance, PointTriangleDistance(points[p],
+						points[positionIds[triangle[0]]], points[positionIds[triangle[1]]], points[positionIds[triangle[2]]]));
+				}
+				if (triangles.Begin(target) == triangles.End(target))
+				{
+					// a small closed part can collapse away entirely
+					distance = Math::Magnitude(points[p] - points[target]);
+				}
+				maxDistance = Math::Max(maxDistance, distance);
+			}
+			return maxDistance * extent;
+		};
+
+		for (const size_t targetIndexCount : targetIndexCounts)
+		{
+			const size_t targetTriangles = targetIndexCount / 3;
+			bool stalled = false;
+			while (result.size() / 3 > targetTriangles)
+			{
+				const uint32_t triangleCount = static_cast<uint32_t>(result.size() / 3);
+				BucketTriangles();
+				usedVertices.clear();
+				for (const uint32_t v : result)
+				{
+					if (seen[v] != triangleCount)
+					{
+						seen[v] = triangleCount;
+						usedVertices.push_back(v);
+					}
+				}
+				Bucket(vertices, [&](const auto& add)
+				{
+					for (const uint32_t v : usedVertices)
+					{
+						add(positionIds[v], v);
+					}
+				});
+
+				// an edge used by a single triangle is on a border
+				edges.clear();
+				for (uint32_t i = 0; i < result.size(); i += 3)
+				{
+					for (uint32_t k = 0; k < 3; ++k)
+					{
+						edges.push_back(EdgeKey(positionIds[result[i + k]], positionIds[result[i + (k + 1) % 3]]));
+					}
+				}
+				std::sort(edges.begin(), edges.end());
+				std::fill(isBorder.begin(), isBorder.end(), 0);
+				collapses.clear();
+				for (size_t i = 0; i < edges.size();)
+				{
+					size_t j = i + 1;
+					while (j < edges.size() && edges[j] == edges[i])
+					{
+						++j;
+					}
+					if (j - i == 1)
+					{
+						isBorder[edges[i] >> 32] = 1;
+						isBorder[edges[i] & 0xffffffff] = 1;
+					}
+					i = j;
+				}
+				for (size_t i = 0; i < edges.size();)
+				{
+					size_t j = i + 1;
+					while (j < edges.size() && edges[j] == edges[i])
+					{
+						++j;
+					}
+					const uint32_t a = static_cast<uint32_t>(edges[i] >> 32);
+					const uint32_t b = static_cast<uint32_t>(edges[i] & 0xffffffff);
+					const bool borderEdge = (j - i == 1);
+					Collapse ab, ba;
+					const bool validAB = a != b && Evaluate(a, b, borderEdge, ab);
+					const bool validBA = a != b && Evaluate(b, a, borderEdge, ba);
+					if (validAB || validBA)
+					{
+						collapses.push_back((validAB && (!validBA || ab.cost <= ba.cost)) ? ab : ba);
+					}
+					i = j;
+				}
+				std::sort(collapses.begin(), collapses.end(), [](const Collapse& a, const Collapse& b)
+				{
+					return a.cost < b.cost;
+				});
+
+				// cheapest first, a collapse locks its neighbourhood so every cost stays valid this pass
+				std::fill(locked.begin(), locked.end(), 0);
+				size_t removed = 0;
+				size_t applied = 0;
+				for (const Collapse& collapse : collapses)
+				{
+					if (triangleCount - removed <= targetTriangles)
+					{
+						break;
+					}
+					if (locked[collapse.from] || locked[collapse.to])
+					{
+						continue;
+					}
+
+					for (uint32_t i = vertices.Begin(collapse.from); i < vertices.End(collapse.from); ++i)
+					{
+						float distance = 0.0f;
+						const uint32_t v = vertices.items[i];
+						remap[v] = MapVertex(collapse.from, collapse.to, v, distance);
+					}
+					for (uint32_t t = triangles.Begin(collapse.from); t < triangles.End(collapse.from); ++t)
+					{
+						const uint32_t* triangle = &result[triangles.items[t] * 3];
+						bool hasTo = false;
+						for (uint32_t k = 0; k < 3; ++k)
+						{
+							const uint32_t p = positionIds[triangle[k]];
+							locked[p] = 1;
+							hasTo |= (p == collapse.to);
+						}
+						removed += hasTo ? 1 : 0;
+					}
+					quadrics[collapse.to].Add(quadrics[collapse.from]);
+					collapsedTo[collapse.from] = collapse.to;
+					++applied;
+				}
+				if (applied == 0)
+				{
+					stalled = true;
+					break;
+				}
+
+				// drop the triangles that collapsed to a line
+				size_t write = 0;
+				for (size_t i = 0; i < result.size(); i += 3)
+				{
+					const uint32_t a = remap[result[i + 0]];
+					const uint32_t b = remap[result[i + 1]];
+					const uint32_t c = remap[result[i + 2]];
+					const uint32_t pa = positionIds[a];
+					const uint32_t pb = positionIds[b];
+					const uint32_t pc = positionIds[c];
+					if (pa != pb && pb != pc && pc != pa)
+					{
+						result[write++] = a;
+						result[write++] = b;
+						result[write++] = c;
+					}
+				}
+				result.resize(write);
+			}
+
+			MeshLod& level = levels.emplace_back();
+			level.indices = result;
+			level.error = MeasureError();
+			if (stalled)
+			{
+				break;
+			}
+		}
+	}
+}
+
+float MeshSimplifier::Simplify(const uint32_t* indices, size_t indexCount, const Math::Vector3* positions, size_t vertexCount, size_t stride,
+	const std::function<float(uint32_t, uint32_t)>& attributeDistance, size_t targetIndexCount, std::vector<uint32_t>& result)
+{
+	std::vector<MeshLod> levels;
+	SimplifyLevels(indices, indexCount, positions, vertexCount, stride, attributeDistance, { targetIndexCount }, levels);
+	if (levels.empty())
+	{
+		result.assign(indices, indices + indexCount);
+		return 0.0f;
+	}
+	result = std::move(levels[0].indices);
+	return levels[0].error;
+}
+
+void MeshSimplifier::BuildLods(const uint32_t* indices, size_t indexCount, const Math::Vector3* positions, size_t vertexCount, size_t stride,
+	const std::function<float(uint32_t, uint32_t)>& attributeDistance, uint32_t lodCount, float reduction, std::vector<MeshLod>& lods)
+{
+	std::vector<size_t> targets;
+	float targetCount = static_cast<float>(indexCount);
+	for (uint32_t i = 0; i < lodCount; ++i)
+	{
+		targetCount *= reduction;
+		targets.push_back(static_cast<size_t>(targetCount) / 3 * 3);
+	}
+	SimplifyLevels(indices, indexCount, positions, vertexCount, stride, attributeDistance, targets, lods);
+
+	// a level that barely reduced the one before it is not worth a switch
+	size_t previousCount = indexCount;
+	for (size_t i = 0; i < lods.size(); ++i)
+	{
+		if (lods[i].indices.empty() || lods[i].indices.size() * 10 > previousCount * 9)
+		{
+			lods.resize(i);
+			break;
+		}
+		if (i > 0)
+		{
+			lods[i].error = Math::Max(lods[i].error, lods[i - 1].error);
+		}
+		MeshOptimizer::OptimizeVertexCache(lods[i].indices.data(), lods[i].indices.size(), vertexCount);
+		previousCount = lods[i].indices.size();
+	}
+}
+
+uint32_t LodSelector::Select(const std::vector<MeshLodRange>& lods, const Math::Sphere& bounds, const Math::Matrix4& world,
+	const Camera& camera, float screenHeight, float pixelError)
+{
+	if (lods.size() <= 1)
+	{
+		return 0;
+	}
+
+	// pixels covered by one world unit at the front of the bounds
+	const float scale = MaxScale(world);
+	const float projectionScale = camera.GetProjectionMatrix()._22 * 0.5f * screenHeight;
+	float pixelsPerUnit = projectionScale;
+	if (camera.GetMode() == Camera::ProjectionMode::Perspective)
+	{
+		const Math::Vector3 center = Math::TransformCoord(bounds.center, world);
+		const float distance = Math::Magnitude(center - camera.GetPosition()) - bounds.radius * scale;
+		if (distance <= 0.0f)
+		{
+			return 0;
+		}
+		pixelsPerUnit /= distance;
+	}
+
+	for (uint32_t i = static_cast<uint32_t>(lods.size()) - 1; i > 0; --i)
+	{
+		if (lods[i].error * scale * pixelsPerUnit <= pixelError)
+		{
+			return i;
+		}
+	}
+	return 0;
+}
@@ -0,0 +1,525 @@
+#include "Precompiled.h"
+#include "MeshOptimizer.h"
+
+using namespace ML_Engine;
+using namespace ML_Engine::Graphics;
+
+namespace
+{
+	// triangles using each vertex, stored as offsets into one flat array
+	struct Adjacency
+	{
+		std::vector<uint32_t> offsets;
+		std::vector<uint32_t> triangles;
+	};
+
+	void BuildAdjacency(const uint32_t* indices, size_t indexCount, size_t vertexCount, Adjacency& adjacency)
+	{
+		adjacency.offsets.assign(vertexCount + 1, 0);
+		for (size_t i = 0; i < indexCount; ++i)
+		{
+			++adjacency.offsets[indices[i] + 1];
+		}
+		for (size_t v = 0; v < vertexCount; ++v)
+		{
+			adjacency.offsets[v + 1] += adjacency.offsets[v];
+		}
+
+		adjacency.triangles.resize(indexCount);
+		std::vector<uint32_t> cursor(adjacency.offsets.begin(), adjacency.offsets.end() - 1);
+		for (size_t i = 0; i < indexCount; ++i)
+		{
+			adjacency.triangles[cursor[indices[i]]++] = static_cast<uint32_t>(i / 3);
+		}
+	}
+
+	// fixed size FIFO, same model the cache stats use
+	class FifoCache
+	{
+	public:
+		FifoCache(size_t vertexCount, uint32_t cacheSize)
+			: mTimestamps(vertexCount, 0)
+			, mCacheSize(cacheSize)
+		{
+		}
+
+		// returns true on a miss
+		bool Access(uint32_t vertex)
+		{
+			if (mTimestamps[vertex] != 0 && mTime - mTimestamps[vertex] <= mCacheSize)
+			{
+				return false;
+			}
+			mTimestamps[vertex] = mTime++;
+			return true;
+		}
+
+		void Flush()
+		{
+			mTime += mCacheSize + 1;
+		}
+
+	private:
+		std::vector<uint32_t> mTimestamps;
+		uint32_t mTime = 1;
+		uint32_t mCacheSize = 0;
+	};
+
+	int32_t SkipDeadEnd(std::vector<uint32_t>& deadEnds, const std::vector<uint32_t>& liveCount, uint32_t& cursor, size_t vertexCount)
+	{
+		while (!deadEnds.empty())
+		{
+			const uint32_t vertex = deadEnds.back();
+			deadEnds.pop_back();
+			if (liveCount[vertex] > 0)
+			{
+				return static_cast<int32_t>(vertex);
+			}
+		}
+		while (cursor < vertexCount)
+		{
+			if (liveCount[cursor] > 0)
+			{
+				return static_cast<int32_t>(cursor);
+			}
+			++cursor;
+		}
+		return -1;
+	}
+}
+
+MeshOptimizer::VertexCacheStats MeshOptimizer::AnalyzeVertexCache(const uint32_t* indices, size_t indexCount, size_t vertexCount, uint32_t cacheSize)
+{
+	VertexCacheStats stats;
+	if (indexCount == 0 || vertexCount == 0)
+	{
+		return stats;
+	}
+
+	FifoCache cache(vertexCount, cacheSize);
+	std::vector<uint8_t> used(vertexCount, 0);
+	size_t uniqueCount = 0;
+	for (size_t i = 0; i < indexCount; ++i)
+	{
+		const uint32_t vertex = indices[i];
+		ASSERT(vertex < vertexCount, "MeshOptimizer: index out of range");
+		stats.vertexTransforms += cache.Access(vertex) ? 1 : 0;
+		if (used[vertex] == 0)
+		{
+			used[vertex] = 1;
+			++uniqueCount;
+		}
+	}
+	stats.acmr = static_cast<float>(stats.vertexTransforms) / static_cast<float>(indexCount / 3);
+	stats.atvr = static_cast<float>(stats.vertexTransforms) / static_cast<float>(uniqueCount);
+	return stats;
+}
+
+void MeshOptimizer::OptimizeVertexCache(uint32_t* indices, size_t indexCount, size_t vertexCount, uint32_t cacheSize)
+{
+	ASSERT(indexCount % 3 == 0, "MeshOptimizer: index count must be a multiple of 3");
+	const size_t triangleCount = indexCount / 3;
+	if (triangleCount == 0)
+	{
+		return;
+	}
+
+	Adjacency adjacency;
+	BuildAdjacency(indices, indexCount, vertexCount, adjacency);
+
+	std::vector<uint32_t> liveCount(vertexCount);
+	for (size_t v = 0; v < vertexCount; ++v)
+	{
+		liveCount[v] = adjacency.offsets[v + 1] - adjacency.offsets[v];
+	}
+
+	std::vector<uint32_t> cacheTime(vertexCount, 0);
+	std::vector<uint8_t> emitted(triangleCount, 0);
+	std::vector<uint32_t> deadEnds;
+	std::vector<uint32_t> candidates;
+	std::vector<uint32_t> output;
+	output.reserve(indexCount);
+
+	uint32_t time = cacheSize + 1;
+	uint32_t cursor = 0;
+	int32_t fanning = SkipDeadEnd(deadEnds, liveCount, cursor, vertexCount);
+	while (fanning >= 0)
+	{
+		// emit every remaining triangle around the fanning vertex
+		candidates.clear();
+		for (uint32_t a = adjacency.offsets[fanning]; a < adjacency.offsets[fanning + 1]; ++a)
+		{
+			const uint32_t triangle = adjacency.triangles[a];
+			if (emitted[triangle])
+			{
+				continue;
+			}
+			for (uint32_t k = 0; k < 3; ++k)
+			{
+				const uint32_t vertex = indices[triangle * 3 + k];
+				output.push_back(vertex);
+				deadEnds.push_back(vertex);
+				candidates.push_back(vertex);
+				--liveCount[vertex];
+				if (time - cacheTime[vertex] > cacheSize)
+				{
+					cacheTime[vertex] = time++;
+				}
+			}
+			emitted[triangle] = 1;
+		}
+
+		// next fanning vertex: the candidate that stays in cache longest after its fan is emitted
+		int32_t next = -1;
+		int32_t best = -1;
+		for (const uint32_t vertex : candidates)
+		{
+			if (liveCount[vertex] == 0)
+			{
+				continue;
+			}
+			int32_t priority = 0;
+			if (time - cacheTime[vertex] + 2 * liveCount[vertex] <= cacheSize)
+			{
+				priority = static_cast<int32_t>(time - cacheTime[vertex]);
+			}
+			if (priority > best)
+			{
+				best = priority;
+				next = static_cast<int32_t>(vertex);
+			}
+		}
+		fanning = (next >= 0) ? next : SkipDeadEnd(deadEnds, liveCount, cursor, vertexCount);
+	}
+
+	ASSERT(output.size() == indexCount, "MeshOptimizer: vertex cache pass lost triangles");
+	std::copy(output.begin(), output.end(), indices);
+}
+
+void MeshOptimizer::OptimizeOverdraw(uint32_t* indices, size_t indexCount, const Math::Vector3* positions, size_t vertexCount, size_t stride, float threshold, uint32_t cacheSize)
+{
+	ASSERT(indexCount % 3 == 0, "MeshOptimizer: index count must be a multiple of 3");
+	const uint32_t triangleCount = static_cast<uint32_t>(indexCount / 3);
+	if (triangleCount == 0)
+	{
+		return;
+	}
+
+	auto GetPosition = [positions, stride](uint32_t vertex) -> const Math::Vector3&
+	{
+		return *reinterpret_cast<const Math::Vector3*>(reinterpret_cast<const uint8_t*>(positions) + vertex * stride);
+	};
+
+	// hard boundaries: triangles where the cache restarts (all three vertices miss),
+	// moving those clusters around costs little
+	std::vector<uint32_t> hardBoundaries;
+	std::vector<uint8_t> triangleMisses(triangleCount);
+	uint32_t inputMisses = 0;
+	{
+		FifoCache cache(vertexCount, cacheSize);
+		for (uint32_t t = 0; t < triangleCount; ++t)
+		{
+			uint8_t misses = 0;
+			for (uint32_t k = 0; k < 3; ++k)
+			{
+				misses += cache.Access(indices[t * 3 + k]) ? 1 : 0;
+			}
+			triangleMisses[t] = misses;
+			inputMisses += misses;
+			if (misses == 3 || t == 0)
+			{
+				hardBoundaries.push_back(t);
+			}
+		}
+	}
+	hardBoundaries.push_back(triangleCount);
+
+	Math::Vector3 meshCentroid = Math::Vector3::Zero;
+	for (size_t i = 0; i < indexCount; ++i)
+	{
+		meshCentroid += GetPosition(indices[i]);
+	}
+	meshCentroid /= static_cast<float>(indexCount);
+
+	std::vector<uint32_t> clusters;
+	std::vector<float> sortKeys;
+	std::vector<uint32_t> order;
+	std::vector<uint32_t> output(indexCount);
+
+	// soft boundaries split hard clusters further where the running ACMR of the new cluster
+	// drops to softThreshold times the input ACMR of its hard cluster. The splits flush the
+	// cache, so the limit is tightened until the whole mesh stays within threshold, a limit
+	// of 0 keeps only the hard boundaries.
+	const float maxMisses = threshold * static_cast<float>(inputMisses);
+	for (float softThreshold = threshold; ; softThreshold -= 0.05f)
+	{
+		if (softThreshold < 0.5f)
+		{
+			softThreshold = 0.0f;
+		}
+
+		clusters.clear();
+		FifoCache cache(vertexCount, cacheSize);
+		for (size_t h = 0; h + 1 < hardBoundaries.size(); ++h)
+		{
+			const uint32_t begin = hardBoundaries[h];
+			const uint32_t end = hardBoundaries[h + 1];
+
+			uint32_t clusterMisses = 0;
+			for (uint32_t t = begin; t < end; ++t)
+			{
+				clusterMisses += triangleMisses[t];
+			}
+			const float clusterThreshold = softThreshold * static_cast<float>(clusterMisses) / static_cast<float>(end - begin);
+
+			clusters.push_back(begin);
+			cache.Flush();
+			uint32_t runningMisses = 0;
+			uint32_t runningTriangles = 0;
+			for (uint32_t t = begin; t + 1 < end; ++t)
+			{
+				for (uint32_t k = 0; k < 3; ++k)
+				{
+					runningMisses += cache.Access(indices[t * 3 + k]) ? 1 : 0;
+				}
+				++runningTriangles;
+				if (static_cast<float>(runningMisses) <= clusterThreshold * static_cast<float>(runningTriangles))
+				{
+					clusters.push_back(t + 1);
+					cache.Flush();
+					runningMisses = 0;
+					runningTriangles = 0;
+				}
+			}
+		}
+		clusters.push_back(triangleCount);
+
+		// sort key: how far the cluster faces away from the mesh center, outer clusters draw first
+		const size_t clusterCount = clusters.size() - 1;
+		sortKeys.assign(clusterCount, 0.0f);
+		for (size_t c = 0; c < clusterCount; ++c)
+		{
+			Math::Vector3 centroid = Math::Vector3::Zero;
+			Math::Vector3 normal = Math::Vector3::Zero;
+			float area = 0.0f;
+			for (uint32_t t = clusters[c]; t < clusters[c + 1]; ++t)
+			{
+				const Math::Vector3& p0 = GetPosition(indices[t * 3 + 0]);
+				const Math::Vector3& p1 = GetPosition(indices[t * 3 + 1]);
+				const Math::Vector3& p2 = GetPosition(indices[t * 3 + 2]);
+				const Math::Vector3 n = Math::Cross(p1 - p0, p2 - p0);
+				const float triangleArea = Math::Magnitude(n);
+				centroid += (p0 + p1 + p2) * (triangleArea / 3.0f);
+				normal += n;
+				area += triangleArea;
+			}
+			const float normalLength = Math::Magnitude(normal);
+			if (area > 0.0f && normalLength > 0.0f)
+			{
+				sortKeys[c] = Math::Dot(centroid / area - meshCentroid, normal / normalLength);
+			}
+		}
+
+		order.resize(clusterCount);
+		for (uint32_t c = 0; c < clusterCount; ++c)
+		{
+			order[c] = c;
+		}
+		std::stable_sort(order.begin(), order.end(), [&sortKeys](uint32_t a, uint32_t b)
+		{
+			return sortKeys[a] > sortKeys[b];
+		});
+
+		uint32_t* write = output.data();
+		for (const uint32_t c : order)
+		{
+			write = std::copy(indices + clusters[c] * 3, indices + clusters[c + 1] * 3, write);
+		}
+
+		const VertexCacheStats stats = AnalyzeVertexCache(output.data(), indexCount, vertexCount, cacheSize);
+		if (softThreshold == 0.0f || static_cast<float>(stats.vertexTransforms) <= maxMisses)
+		{
+			break;
+		}
+	}
+	std::copy(output.begin(), output.end(), indices);
+}
+
+uint32_t MeshOptimizer::OptimizeVertexFetchRemap(uint32_t* indices, size_t indexCount, size_t vertexCount, std::vector<uint32_t>& remap)
+{
+	remap.assign(vertexCount, UINT32_MAX);
+	uint32_t nextVertex = 0;
+	for (size_t i = 0; i < indexCount; ++i)
+	{
+		uint32_t& target = remap[indices[i]];
+		if (target == UINT32_MAX)
+		{
+			target = nextVertex++;
+		}
+		indices[i] = target;
+	}
+	return nextVertex;
+}
+
+uint32_t MeshOptimizer::WeldVertexRemap(const Math::Vector3* positions, size_t vertexCount, size_t stride, float positionEpsilon, const std::function<bool(uint32_t, uint32_t)>& equal, std::vector<uint32_t>& remap)
+{
+	constexpr size_t MinBatchSize = 4096;
+	auto GetPosition = [positions, stride](size_t vertex) -> const Math::Vector3&
+	{
+		return *reinterpret_cast<const Math::Vector3*>(reinterpret_cast<const uint8_t*>(positions) + vertex * stride);
+	};
+
+	// grid cell of each vertex, with epsilon 0 the cell is the exact bit pattern
+	const bool exact = positionEpsilon <= 0.0f;
+	const double invCellSize = exact ? 0.0 : 1.0 / static_cast<double>(positionEpsilon);
+	auto GetCell = [&](const Math::Vector3& p) -> std::array<int64_t, 3>
+	{
+		if (exact)
+		{
+			std::array<uint32_t, 3> bits;
+			memcpy(bits.data(), &p.x, sizeof(bits));
+			return { bits[0], bits[1], bits[2] };
+		}
+		return {
+			static_cast<int64_t>(std::floor(p.x * invCellSize)),
+			static_cast<int64_t>(std::floor(p.y * invCellSize)),
+			static_cast<int64_t>(std::floor(p.z * invCellSize))
+		};
+	};
+	auto HashCell = [](int64_t x, int64_t y, int64_t z)
+	{
+		uint64_t h = static_cast<uint64_t>(x) * 0x9E3779B97F4A7C15ull;
+		h ^= static_cast<uint64_t>(y) * 0xC2B2AE3D27D4EB4Full + (h << 6) + (h >> 2);
+		h ^= static_cast<uint64_t>(z) * 0x165667B19E3779F9ull + (h << 6) + (h >> 2);
+		return h;
+	};
+
+	// (cell hash, vertex) sorted so each cell is a contiguous run in vertex order,
+	// different cells sharing a hash only cost extra comparisons
+	std::vector<std::pair<uint64_t, uint32_t>> cells(vertexCount);
+	Core::ThreadUtil::ParallelFor(vertexCount, MinBatchSize, [&](size_t begin, size_t end)
+	{
+		for (size_t i = begin; i < end; ++i)
+		{
+			const std::array<int64_t, 3> cell = GetCell(GetPosition(i));
+			cells[i] = { HashCell(cell[0], cell[1], cell[2]), static_cast<uint32_t>(i) };
+		}
+	});
+	std::sort(cells.begin(), cells.end());
+
+	std::unordered_map<uint64_t, std::pair<uint32_t, uint32_t>> cellRanges;
+	cellRanges.reserve(vertexCount);
+	for (uint32_t begin = 0, end = 0; begin < vertexCount; begin = end)
+	{
+		for (end = begin + 1; end < vertexCount && cells[end].first == cells[begin].first; ++end)
+		{
+		}
+		cellRanges.emplace(cells[begin].first, std::make_pair(begin, end));
+	}
+
+	// smallest earlier vertex j within epsilon of i that accept(j) and equal(i, j), or i itself
+	const int64_t neighbors = exact ? 0 : 1;
+	auto FindMatch = [&](uint32_t i, const auto& accept) -> uint32_t
+	{
+		const Math::Vector3& p = GetPosition(i);
+		const std::array<int64_t, 3> cell = GetCell(p);
+		uint32_t best = i;
+		for (int64_t dz = -neighbors; dz <= neighbors; ++dz)
+		{
+			for (int64_t dy = -neighbors; dy <= neighbors; ++dy)
+			{
+				for (int64_t dx = -neighbors; dx <= neighbors; ++dx)
+				{
+					const auto range = cellRanges.find(HashCell(cell[0] + dx, cell[1] + dy, cell[2] + dz));
+					if (range == cellRanges.end())
+					{
+						continue;
+					}
+					for (uint32_t c = range->second.first; c < range->second.second && cells[c].second < best; ++c)
+					{
+						const uint32_t j = cells[c].second;
+						const Math::Vector3& q = GetPosition(j);
+						if (fabsf(p.x - q.x) <= positionEpsilon && fabsf(p.y - q.y) <= positionEpsilon && fabsf(p.z - q.z) <= positionEpsilon
+							&& accept(j) && equal(i, j))
+						{
+							best = j;
+							break;
+						}
+					}
+				}
+			}
+		}
+		return best;
+	};
+
+	// a vertex with no earlier match starts a group, others join the first group start
+	// that matches them. Both passes only read results of the pass before, so they split
+	// across threads freely.
+	std::vector<uint8_t> isFirst(vertexCount);
+	Core::ThreadUtil::ParallelFor(vertexCount, MinBatchSize, [&](size_t begin, size_t end)
+	{
+		for (size_t i = begin; i < end; ++i)
+		{
+			const uint32_t vertex = static_cast<uint32_t>(i);
+			isFirst[i] = FindMatch(vertex, [](uint32_t) { return true; }) == vertex ? 1 : 0;
+		}
+	});
+
+	std::vector<uint32_t> representative(vertexCount);
+	Core::ThreadUtil::ParallelFor(vertexCount, MinBatchSize, [&](size_t begin, size_t end)
+	{
+		for (size_t i = begin; i < end; ++i)
+		{
+			const uint32_t vertex = static_cast<uint32_t>(i);
+			representative[i] = isFirst[i] ? vertex : FindMatch(vertex, [&isFirst](uint32_t j) { return isFirst[j] != 0; });
+		}
+	});
+
+	remap.resize(vertexCount);
+	uint32_t weldedCount = 0;
+	for (size_t i = 0; i < vertexCount; ++i)
+	{
+		remap[i] = (representative[i] == i) ? weldedCount++ : remap[representative[i]];
+	}
+	return weldedCount;
+}
+
+void MeshOptimizer::SplitIndices(const uint32_t* indices, size_t indexCount, size_t vertexCount, size_t maxVertices, std::vector<MeshChunk>& chunks)
+{
+	ASSERT(indexCount % 3 == 0, "MeshOptimizer: index count must be a multiple of 3");
+	ASSERT(maxVertices >= 3, "MeshOptimizer: chunks need room for a triangle");
+	chunks.clear();
+
+	std::vector<uint32_t> localIndex(vertexCount, UINT32_MAX);
+	MeshChunk* chunk = nullptr;
+	for (size_t t = 0; t < indexCount; t += 3)
+	{
+		uint32_t newVertices = 0;
+		for (size_t k = 0; k < 3; ++k)
+		{
+			newVertices += (localIndex[indices[t + k]] == UINT32_MAX) ? 1 : 0;
+		}
+		if (chunk == nullptr || chunk->vertices.size() + newVertices > maxVertices)
+		{
+			if (chunk != nullptr)
+			{
+				for (const uint32_t vertex : chunk->vertices)
+				{
+					localIndex[vertex] = UINT32_MAX;
+				}
+			}
+			chunk = &chunks.emplace_back();
+		}
+
+		for (size_t k = 0; k < 3; ++k)
+		{
+			const uint32_t vertex = indices[t + k];
+			if (localIndex[vertex] == UINT32_MAX)
+			{
+				localIndex[vertex] = static_cast<uint32_t>(chunk->vertices.size());
+				chunk->vertices.push_back(vertex);
+			}
+			chunk->indices.push_back(localIndex[vertex]);
+		}
+	}
+}
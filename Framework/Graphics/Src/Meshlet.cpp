@@ -0,0 +1,370 @@
+#include "Precompiled.h"
+#include "Meshlet.h"
+
+#include "Camera.h"
+#include "MeshOptimizer.h"
+
+using namespace ML_Engine;
+using namespace ML_Engine::Graphics;
+
+namespace
+{
+	constexpr uint32_t NotInMeshlet = UINT32_MAX;
+
+	// triangles more than 60 degrees off the meshlet normal start a new meshlet, more
+	// meshlets but narrow enough cones for back face culling to reject whole clusters
+	constexpr float MinNormalDot = 0.5f;
+
+	struct MeshletState
+	{
+		std::vector<uint32_t> vertices;
+		std::vector<uint32_t> triangles;
+		Math::Vector3 normalSum = Math::Vector3::Zero;
+	};
+
+	Meshlet FinishMeshlet(const MeshletState& state, const uint32_t* indices, const std::vector<Math::Vector3>& triangleNormals,
+		const std::function<const Math::Vector3&(uint32_t)>& getPosition, std::vector<uint32_t>& output)
+	{
+		Meshlet meshlet;
+		meshlet.indexOffset = static_cast<uint32_t>(output.size());
+		meshlet.indexCount = static_cast<uint32_t>(state.triangles.size() * 3);
+		meshlet.vertexCount = static_cast<uint32_t>(state.vertices.size());
+		for (const uint32_t triangle : state.triangles)
+		{
+			output.insert(output.end(), indices + triangle * 3, indices + triangle * 3 + 3);
+		}
+
+		// sphere around the box center, tighter than the box corners
+		Math::Vector3 minPoint = getPosition(state.vertices[0]);
+		Math::Vector3 maxPoint = minPoint;
+		for (const uint32_t vertex : state.vertices)
+		{
+			const Math::Vector3& p = getPosition(vertex);
+			minPoint = { Math::Min(minPoint.x, p.x), Math::Min(minPoint.y, p.y), Math::Min(minPoint.z, p.z) };
+			maxPoint = { Math::Max(maxPoint.x, p.x), Math::Max(maxPoint.y, p.y), Math::Max(maxPoint.z, p.z) };
+		}
+		meshlet.bounds.center = (minPoint + maxPoint) * 0.5f;
+		float radiusSqr = 0.0f;
+		for (const uint32_t vertex : state.vertices)
+		{
+			radiusSqr = Math::Max(radiusSqr, Math::MagnitudeSqr(getPosition(vertex) - meshlet.bounds.center));
+		}
+		meshlet.bounds.radius = sqrtf(radiusSqr);
+
+		// normal cone around the average normal, degenerate triangles do not constrain it
+		const float axisLength = Math::Magnitude(state.normalSum);
+		if (axisLength > 0.0f)
+		{
+			meshlet.coneAxis = state.normalSum / axisLength;
+			float minDot = 1.0f;
+			for (const uint32_t triangle : state.triangles)
+			{
+				const Math::Vector3& n = triangleNormals[triangle];
+				if (Math::MagnitudeSqr(n) > 0.0f)
+				{
+					minDot = Math::Min(minDot, Math::Dot(n, meshlet.coneAxis));
+				}
+			}
+			meshlet.coneCutoff = (minDot <= 0.0f) ? 1.0f : sqrtf(1.0f - minDot * minDot);
+		}
+		return meshlet;
+	}
+
+	// appends source to target when the union fits the limits and every normal stays within
+	// MinNormalDot of the combined axis
+	bool TryMerge(MeshletState& target, const MeshletState& source, const std::vector<Math::Vector3>& triangleNormals,
+		uint32_t maxVertices, uint32_t maxTriangles)
+	{
+		if (target.triangles.size() + source.triangles.size() > maxTriangles)
+		{
+			return false;
+		}
+
+		std::vector<uint32_t> newVertices;
+		for (const uint32_t vertex : source.vertices)
+		{
+			if (std::find(target.vertices.begin(), target.vertices.end(), vertex) == target.vertices.end())
+			{
+				newVertices.push_back(vertex);
+			}
+		}
+		if (target.vertices.size() + newVertices.size() > maxVertices)
+		{
+			return false;
+		}
+
+		const Math::Vector3 normalSum = target.normalSum + source.normalSum;
+		const float axisLength = Math::Magnitude(normalSum);
+		if (axisLength <= 0.0f)
+		{
+			return false;
+		}
+		const Math::Vector3 axis = normalSum / axisLength;
+		const MeshletState* clusters[] = { &target, &source };
+		for (const MeshletState* cluster : clusters)
+		{
+			for (const uint32_t triangle : cluster->triangles)
+			{
+				const Math::Vector3& n = triangleNormals[triangle];
+				if (Math::MagnitudeSqr(n) > 0.0f && Math::Dot(n, axis) < MinNormalDot)
+				{
+					return false;
+				}
+			}
+		}
+
+		target.vertices.insert(target.vertices.end(), newVertices.begin(), newVertices.end());
+		target.triangles.insert(target.triangles.end(), source.triangles.begin(), source.triangles.end());
+		target.normalSum = normalSum;
+		return true;
+	}
+}
+
+void MeshletBuilder::Build(uint32_t* indices, size_t indexCount, const Math::Vector3* positions, size_t vertexCount, size_t stride,
+	std::vector<Meshlet>& meshlets, uint32_t maxVertices, uint32_t maxTriangles)
+{
+	ASSERT(indexCount % 3 == 0, "MeshletBuilder: index count must be a multiple of 3");
+	ASSERT(maxVertices >= 3 && maxTriangles >= 1, "MeshletBuilder: meshlet limits are too small");
+	meshlets.clear();
+	const uint32_t triangleCount = static_cast<uint32_t>(indexCount / 3);
+	if (triangleCount == 0)
+	{
+		return;
+	}
+
+	auto GetPosition = [positions, stride](uint32_t vertex) -> const Math::Vector3&
+	{
+		return *reinterpret_cast<const Math::Vector3*>(reinterpret_cast<const uint8_t*>(positions) + vertex * stride);
+	};
+
+	// triangles touching each position, keyed by position so meshes split on uv or normal
+	// seams (or not welded at all) still grow connected meshlets
+	std::vector<uint32_t> positionIds;
+	const uint32_t positionCount = MeshOptimizer::WeldVertexRemap(positions, vertexCount, stride, 0.0f, [](uint32_t, uint32_t) { return true; }, positionIds);
+	std::vector<uint32_t> adjacencyOffsets(positionCount + 1, 0);
+	for (size_t i = 0; i < indexCount; ++i)
+	{
+		++adjacencyOffsets[positionIds[indices[i]] + 1];
+	}
+	for (uint32_t p = 0; p < positionCount; ++p)
+	{
+		adjacencyOffsets[p + 1] += adjacencyOffsets[p];
+	}
+	std::vector<uint32_t> adjacency(indexCount);
+	{
+		std::vector<uint32_t> cursor(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+		for (size_t i = 0; i < indexCount; ++i)
+		{
+			adjacency[cursor[positionIds[indices[i]]]++] = static_cast<uint32_t>(i / 3);
+		}
+	}
+
+	std::vector<Math::Vector3> triangleNormals(triangleCount);
+	for (uint32_t t = 0; t < triangleCount; ++t)
+	{
+		const Math::Vector3& a = GetPosition(indices[t * 3 + 0]);
+		const Math::Vector3& b = GetPosition(indices[t * 3 + 1]);
+		const Math::Vector3& c = GetPosition(indices[t * 3 + 2]);
+		const Math::Vector3 n = Math::Cross(b - a, c - a);
+		const float length = Math::Magnitude(n);
+		triangleNormals[t] = (length > 0.0f) ? n / length : Math::Vector3::Zero;
+	}
+
+	std::vector<uint8_t> used(triangleCount, 0);
+	std::vector<uint32_t> localIndex(vertexCount, NotInMeshlet);
+	std::vector<uint32_t> output;
+	output.reserve(indexCount);
+
+	MeshletState state;
+	auto NewVertexCount = [&](uint32_t triangle)
+	{
+		uint32_t count = 0;
+		for (uint32_t k = 0; k < 3; ++k)
+		{
+			count += (localIndex[indices[triangle * 3 + k]] == NotInMeshlet) ? 1 : 0;
+		}
+		return count;
+	};
+	auto AddTriangle = [&](uint32_t triangle)
+	{
+		used[triangle] = 1;
+		for (uint32_t k = 0; k < 3; ++k)
+		{
+			const uint32_t vertex = indices[triangle * 3 + k];
+			if (localIndex[vertex] == NotInMeshlet)
+			{
+				localIndex[vertex] = static_cast<uint32_t>(state.vertices.size());
+				state.vertices.push_back(vertex);
+			}
+		}
+		state.triangles.push_back(triangle);
+		state.normalSum += triangleNormals[triangle];
+	};
+	std::vector<MeshletState> clusters;
+	auto Flush = [&]()
+	{
+		for (const uint32_t vertex : state.vertices)
+		{
+			localIndex[vertex] = NotInMeshlet;
+		}
+		clusters.push_back(std::move(state));
+		state = MeshletState();
+	};
+
+	uint32_t seedCursor = 0;
+	while (true)
+	{
+		if (state.triangles.empty())
+		{
+			while (seedCursor < triangleCount && used[seedCursor])
+			{
+				++seedCursor;
+			}
+			if (seedCursor == triangleCount)
+			{
+				break;
+			}
+			AddTriangle(seedCursor);
+			continue;
+		}
+
+		// grow through the triangles touching the meshlet: fewest new vertices first,
+		// then the normal closest to the meshlet average to keep the cone narrow
+		uint32_t best = NotInMeshlet;
+		uint32_t bestNewVertices = 4;
+		float bestDot = -2.0f;
+		if (state.triangles.size() < maxTriangles)
+		{
+			const float axisLength = Math::Magnitude(state.normalSum);
+			const Math::Vector3 axis = (axisLength > 0.0f) ? state.normalSum / axisLength : Math::Vector3::Zero;
+			for (const uint32_t vertex : state.vertices)
+			{
+				const uint32_t position = positionIds[vertex];
+				for (uint32_t a = adjacencyOffsets[position]; a < adjacencyOffsets[position + 1]; ++a)
+				{
+					const uint32_t triangle = adjacency[a];
+					if (used[triangle])
+					{
+						continue;
+					}
+					const uint32_t newVertices = NewVertexCount(triangle);
+					if (state.vertices.size() + newVertices > maxVertices)
+					{
+						continue;
+					}
+					const float dot = Math::Dot(triangleNormals[triangle], axis);
+					if (dot < MinNormalDot)
+					{
+						continue;
+					}
+					if (newVertices < bestNewVertices || (newVertices == bestNewVertices && dot > bestDot))
+					{
+						best = triangle;
+						bestNewVertices = newVertices;
+						bestDot = dot;
+					}
+				}
+			}
+		}
+
+		if (best == NotInMeshlet)
+		{
+			Flush();
+		}
+		else
+		{
+			AddTriangle(best);
+		}
+	}
+	if (!state.triangles.empty())
+	{
+		Flush();
+	}
+
+	// growth stops at every crease and seam, so merge each cluster into the one built
+	// before it while the result still fits the limits and keeps the normal cone
+	std::vector<MeshletState> merged;
+	for (MeshletState& cluster : clusters)
+	{
+		if (!merged.empty() && TryMerge(merged.back(), cluster, triangleNormals, maxVertices, maxTriangles))
+		{
+			continue;
+		}
+		merged.push_back(std::move(cluster));
+	}
+
+	// order the meshlets by the heading of their normals around the up axis, so the back
+	// facing ones of a view are mostly consecutive and the visible ones merge into few draws
+	std::stable_sort(merged.begin(), merged.end(), [](const MeshletState& a, const MeshletState& b)
+	{
+		return atan2f(a.normalSum.x, a.normalSum.z) < atan2f(b.normalSum.x, b.normalSum.z);
+	});
+	for (const MeshletState& cluster : merged)
+	{
+		meshlets.push_back(FinishMeshlet(cluster, indices, triangleNormals, GetPosition, output));
+	}
+
+	ASSERT(output.size() == indexCount, "MeshletBuilder: triangles were lost");
+	std::copy(output.begin(), output.end(), indices);
+}
+
+void MeshletBuilder::Cull(const std::vector<Meshlet>& meshlets, const Math::Matrix4& world, const Camera& camera,
+	std::vector<uint32_t>& visible, MeshletCullStats* stats)
+{
+	const Math::Frustum frustum = camera.GetFrustum();
+	const bool isPerspective = camera.GetMode() == Camera::ProjectionMode::Perspective;
+	const Math::Vector3& eye = camera.GetPosition();
+	const Math::Vector3& viewDirection = camera.GetDirection();
+
+	const float scale = sqrtf(Math::Max(world._11 * world._11 + world._12 * world._12 + world._13 * world._13,
+		Math::Max(world._21 * world._21 + world._22 * world._22 + world._23 * world._23,
+			world._31 * world._31 + world._32 * world._32 + world._33 * world._33)));
+
+	MeshletCullStats localStats;
+	localStats.meshletCount = static_cast<uint32_t>(meshlets.size());
+	for (uint32_t i = 0; i < meshlets.size(); ++i)
+	{
+		const Meshlet& meshlet = meshlets[i];
+		localStats.totalIndexCount += meshlet.indexCount;
+
+		const Math::Sphere bounds = { Math::TransformCoord(meshlet.bounds.center, world), meshlet.bounds.radius * scale };
+		if (!Math::Intersect(frustum, bounds))
+		{
+			++localStats.frustumCulled;
+			continue;
+		}
+
+		// back facing when every normal in the cone points away from the eye, for any point in the sphere
+		if (meshlet.coneCutoff < 1.0f)
+		{
+			const Math::Vector3 axis = Math::Normalize(Math::TransformNormal(meshlet.coneAxis, world));
+			bool backFacing = false;
+			if (isPerspective)
+			{
+				const Math::Vector3 toCenter = bounds.center - eye;
+				backFacing = Math::Dot(toCenter, axis) >= meshlet.coneCutoff * Math::Magnitude(toCenter) + bounds.radius;
+			}
+			else
+			{
+				backFacing = Math::Dot(viewDirection, axis) >= meshlet.coneCutoff;
+			}
+			if (backFacing)
+			{
+				++localStats.backfaceCulled;
+				continue;
+			}
+		}
+
+		visible.push_back(i);
+		localStats.visibleIndexCount += meshlet.indexCount;
+	}
+
+	if (stats != nullptr)
+	{
+		stats->meshletCount += localStats.meshletCount;
+		stats->frustumCulled += localStats.frustumCulled;
+		stats->backfaceCulled += localStats.backfaceCulled;
+		stats->visibleIndexCount += localStats.visibleIndexCount;
+		stats->totalIndexCount += localStats.totalIndexCount;
+	}
+}
@@ -0,0 +1,178 @@
+#include "Precompiled.h"
+#include "ModelFile.h"
+
+using namespace ML_Engine;
+using namespace ML_Engine::Graphics;
+
+static_assert(std::is_trivially_copyable_v<ModelFileHeader>, "ModelFile: tables are copied as raw bytes");
+static_assert(std::is_trivially_copyable_v<ModelFileMesh>, "ModelFile: tables are copied as raw bytes");
+static_assert(std::is_trivially_copyable_v<ModelFileMaterial>, "ModelFile: tables are copied as raw bytes");
+static_assert(std::is_trivially_copyable_v<Meshlet>, "ModelFile: meshlets are copied as raw bytes");
+
+bool ModelFile::Open(const std::filesystem::path& filePath)
+{
+	Close();
+	if (!mFile.Open(filePath))
+	{
+		return false;
+	}
+
+	auto Fail = [&](const char* reason)
+	{
+		LOG("ModelFile: %s is not a valid model file, %s", filePath.u8string().c_str(), reason);
+		Close();
+		return false;
+	};
+
+	if (!IsInFile(0, 1, sizeof(ModelFileHeader)))
+	{
+		return Fail("too small");
+	}
+	mHeader = At<ModelFileHeader>(0);
+	if (mHeader->magic != ModelFileMagic)
+	{
+		return Fail("bad magic");
+	}
+	if (mHeader->version != ModelFileVersion)
+	{
+		return Fail("unsupported version");
+	}
+	if (mHeader->fileSize != mFile.GetSize())
+	{
+		return Fail("truncated");
+	}
+	if (!IsInFile(mHeader->meshTableOffset, mHeader->meshCount, sizeof(ModelFileMesh)) ||
+		!IsInFile(mHeader->materialTableOffset, mHeader->materialCount, sizeof(ModelFileMaterial)) ||
+		!IsInFile(mHeader->stringTableOffset, 0, 1))
+	{
+		return Fail("table out of range");
+	}
+
+	// checked once here so the getters can stay plain pointer math
+	for (uint32_t m = 0; m < mHeader->meshCount; ++m)
+	{
+		const ModelFileMesh& mesh = GetMesh(m);
+		if (mesh.indexSize != sizeof(uint32_t) && (mesh.indexSize != sizeof(uint16_t) || mesh.vertexCount > MaxIndex16VertexCount))
+		{
+			return Fail("bad index size");
+		}
+		// the readers copy whole vertices into Vertex and VertexPacked, so only those two layouts are accepted
+		const bool packed = (mesh.flags & ModelFileMesh::Packed) != 0;
+		const uint32_t vertexSize = packed ? sizeof(VertexPacked) : sizeof(Vertex);
+		const uint32_t positionSize = packed ? sizeof(VertexPacked::position) : sizeof(Vertex::position);
+		if (mesh.vertexSize != vertexSize || mesh.positionSize != positionSize)
+		{
+			return Fail("unknown vertex layout");
+		}
+		if (!IsInFile(mesh.vertexOffset, mesh.vertexCount, mesh.vertexSize) ||
+			!IsInFile(mesh.indexOffset, mesh.indexCount, mesh.indexSize) ||
+			!IsInFile(mesh.meshletOffset, mesh.meshletCount, sizeof(Meshlet)) ||
+			!IsInFile(mesh.lodOffset, mesh.lodCount, sizeof(ModelFileLod)))
+		{
+			return Fail("mesh out of range");
+		}
+		for (uint32_t l = 0; l < mesh.lodCount; ++l)
+		{
+			const ModelFileLod& lod = GetLod(m, l);
+			if (!IsInFile(lod.indexOffset, lod.indexCount, mesh.indexSize))
+			{
+				return Fail("lod out of range");
+			}
+		}
+	}
+
+	const uint64_t stringTableSize = mFile.GetSize() - mHeader->stringTableOffset;
+	for (uint32_t m = 0; m < mHeader->materialCount; ++m)
+	{
+		for (uint32_t nameOffset : GetMaterial(m).textureNameOffsets)
+		{
+			if (nameOffset == ModelFileMaterial::NoTexture)
+			{
+				continue;
+			}
+			if (nameOffset >= stringTableSize ||
+				memchr(At<char>(mHeader->stringTableOffset + nameOffset), '\0', stringTableSize - nameOffset) == nullptr)
+			{
+				return Fail("texture name out of range");
+			}
+		}
+	}
+	return true;
+}
+
+void ModelFile::Close()
+{
+	mHeader = nullptr;
+	mFile.Close();
+}
+
+uint32_t ModelFile::GetMeshCount() const
+{
+	return (mHeader != nullptr) ? mHeader->meshCount : 0;
+}
+
+const ModelFileMesh& ModelFile::GetMesh(uint32_t meshIndex) const
+{
+	ASSERT(meshIndex < GetMeshCount(), "ModelFile: invalid mesh index %d", meshIndex);
+	return At<ModelFileMesh>(mHeader->meshTableOffset)[meshIndex];
+}
+
+const void* ModelFile::GetVertices(uint32_t meshIndex) const
+{
+	return At<uint8_t>(GetMesh(meshIndex).vertexOffset);
+}
+
+const void* ModelFile::GetIndices(uint32_t meshIndex) const
+{
+	return At<uint8_t>(GetMesh(meshIndex).indexOffset);
+}
+
+const Meshlet* ModelFile::GetMeshlets(uint32_t meshIndex) const
+{
+	return At<Meshlet>(GetMesh(meshIndex).meshletOffset);
+}
+
+const ModelFileLod& ModelFile::GetLod(uint32_t meshIndex, uint32_t lodIndex) const
+{
+	const ModelFileMesh& mesh = GetMesh(meshIndex);
+	ASSERT(lodIndex < mesh.lodCount, "ModelFile: invalid lod index %d", lodIndex);
+	return At<ModelFileLod>(mesh.lodOffset)[lodIndex];
+}
+
+const void* ModelFile::GetLodIndices(uint32_t meshIndex, uint32_t lodIndex) const
+{
+	return At<uint8_t>(GetLod(meshIndex, lodIndex).indexOffset);
+}
+
+uint32_t ModelFile::GetMaterialCount() const
+{
+	return (mHeader != nullptr) ? mHeader->materialCount : 0;
+}
+
+const ModelFileMaterial& ModelFile::GetMaterial(uint32_t materialIndex) const
+{
+	ASSERT(materialIndex < GetMaterialCount(), "ModelFile: invalid material index %d", materialIndex);
+	return At<ModelFileMaterial>(mHeader->materialTableOffset)[materialIndex];
+}
+
+const char* ModelFile::GetTextureName(uint32_t materialIndex, uint32_t slot) const
+{
+	ASSERT(slot < std::size(GetMaterial(materialIndex).textureNameOffsets), "ModelFile: invalid texture slot %d", slot);
+	const uint32_t nameOffset = GetMaterial(materialIndex).textureNameOffsets[slot];
+	if (nameOffset == ModelFileMaterial::NoTexture)
+	{
+		return nullptr;
+	}
+	return At<char>(mHeader->stringTableOffset + nameOffset);
+}
+
+bool ModelFile::IsInFile(uint64_t offset, uint64_t count, uint64_t elementSize) const
+{
+	// aligned and without overflow, counts come from the file and can not be trusted
+	const uint64_t fileSize = mFile.GetSize();
+	if (offset > fileSize || offset % ModelFileAlignment != 0)
+	{
+		return false;
+	}
+	return elementSize == 0 || count <= (fileSize - offset) / elementSize;
+}
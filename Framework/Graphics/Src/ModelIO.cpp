@@ -1,10 +1,469 @@
 #include "Precompiled.h"
 #include "ModelIO.h"
 #include "Model.h"
+#include "ModelFile.h"
+#include "VertexPacking.h"
 
 using namespace ML_Engine;
 using namespace ML_Engine::Graphics;
 
+namespace
+{
+	// appends size bytes at the next aligned offset of buffer and returns that offset,
+	// a null data leaves the bytes zeroed for the caller to fill
+	uint64_t AppendBlob(std::vector<uint8_t>& buffer, const void* data, size_t size)
+	{
+		const uint64_t offset = (buffer.size() + ModelFileAlignment - 1) & ~(ModelFileAlignment - 1);
+		buffer.resize(offset + size);
+		if (data != nullptr && size > 0)
+		{
+			memcpy(&buffer[offset], data, size);
+		}
+		return offset;
+	}
+
+	uint64_t AppendVertices(std::vector<uint8_t>& buffer, const void* vertices, uint32_t vertexSize, uint32_t positionSize, uint32_t vertexCount, bool splitStreams)
+	{
+		const size_t size = static_cast<size_t>(vertexSize) * vertexCount;
+		if (!splitStreams)
+		{
+			return AppendBlob(buffer, vertices, size);
+		}
+
+		const uint32_t attributeSize = vertexSize - positionSize;
+		const uint64_t offset = AppendBlob(buffer, nullptr, size);
+		uint8_t* positions = &buffer[offset];
+		uint8_t* attributes = positions + static_cast<size_t>(positionSize) * vertexCount;
+		const uint8_t* vertex = static_cast<const uint8_t*>(vertices);
+		for (uint32_t i = 0; i < vertexCount; ++i, vertex += vertexSize)
+		{
+			memcpy(positions + static_cast<size_t>(i) * positionSize, vertex, positionSize);
+			memcpy(attributes + static_cast<size_t>(i) * attributeSize, vertex + positionSize, attributeSize);
+		}
+		return offset;
+	}
+
+	// narrowed to indexSize bytes, 2 when the mesh is small enough for MeshBuffer to upload 16 bit
+	uint64_t AppendIndices(std::vector<uint8_t>& buffer, const std::vector<uint32_t>& indices, uint32_t indexSize)
+	{
+		if (indexSize == sizeof(uint32_t))
+		{
+			return AppendBlob(buffer, indices.data(), indices.size() * sizeof(uint32_t));
+		}
+
+		const uint64_t offset = AppendBlob(buffer, nullptr, indices.size() * sizeof(uint16_t));
+		uint16_t* narrow = reinterpret_cast<uint16_t*>(&buffer[offset]);
+		for (size_t i = 0; i < indices.size(); ++i)
+		{
+			narrow[i] = static_cast<uint16_t>(indices[i]);
+		}
+		return offset;
+	}
+
+	void ReadIndices(const void* data, uint32_t indexSize, uint32_t indexCount, std::vector<uint32_t>& indices)
+	{
+		if (indexSize == sizeof(uint32_t))
+		{
+			const uint32_t* wide = static_cast<const uint32_t*>(data);
+			indices.assign(wide, wide + indexCount);
+		}
+		else
+		{
+			const uint16_t* narrow = static_cast<const uint16_t*>(data);
+			indices.assign(narrow, narrow + indexCount);
+		}
+	}
+
+	// vertices receives vertexCount interleaved vertices from a position and an attribute block
+	void InterleaveStreams(const uint8_t* positions, const uint8_t* attributes, uint32_t vertexSize, uint32_t positionSize, uint32_t vertexCount, void* vertices)
+	{
+		const uint32_t attributeSize = vertexSize - positionSize;
+		uint8_t* vertex = static_cast<uint8_t*>(vertices);
+		for (uint32_t i = 0; i < vertexCount; ++i, vertex += vertexSize)
+		{
+			memcpy(vertex, positions + static_cast<size_t>(i) * positionSize, positionSize);
+			memcpy(vertex + positionSize, attributes + static_cast<size_t>(i) * attributeSize, attributeSize);
+		}
+	}
+
+	// the inverse of AppendVertices, vertices receives vertexCount interleaved vertices
+	void ReadVertices(const void* data, uint32_t vertexSize, uint32_t positionSize, uint32_t vertexCount, bool splitStreams, void* vertices)
+	{
+		if (!splitStreams)
+		{
+			memcpy(vertices, data, static_cast<size_t>(vertexSize) * vertexCount);
+			return;
+		}
+
+		const uint8_t* positions = static_cast<const uint8_t*>(data);
+		InterleaveStreams(positions, positions + static_cast<size_t>(positionSize) * vertexCount, vertexSize, positionSize, vertexCount, vertices);
+	}
+
+	// keeps the position and attribute blocks of a split mesh as they are stored, so the
+	// render objects upload them without splitting the vertices again
+	void KeepStreams(const void* data, uint32_t vertexSize, uint32_t positionSize, uint32_t vertexCount, Model::MeshData& meshData)
+	{
+		const uint8_t* positions = static_cast<const uint8_t*>(data);
+		const uint8_t* attributes = positions + static_cast<size_t>(positionSize) * vertexCount;
+		meshData.positionStream.assign(positions, attributes);
+		meshData.attributeStream.assign(attributes, positions + static_cast<size_t>(vertexSize) * vertexCount);
+	}
+
+	// the same blocks from the interleaved vertices the text formats are parsed into
+	void SplitStreams(const void* vertices, uint32_t vertexSize, uint32_t positionSize, uint32_t vertexCount, Model::MeshData& meshData)
+	{
+		const uint32_t attributeSize = vertexSize - positionSize;
+		meshData.positionStream.resize(static_cast<size_t>(positionSize) * vertexCount);
+		meshData.attributeStream.resize(static_cast<size_t>(attributeSize) * vertexCount);
+		const uint8_t* vertex = static_cast<const uint8_t*>(vertices);
+		for (uint32_t i = 0; i < vertexCount; ++i, vertex += vertexSize)
+		{
+			memcpy(&meshData.positionStream[static_cast<size_t>(i) * positionSize], vertex, positionSize);
+			memcpy(&meshData.attributeStream[static_cast<size_t>(i) * attributeSize], vertex + positionSize, attributeSize);
+		}
+	}
+
+	// keeps the indices of mesh m and of its lods at the width the file stores them, one
+	// block for the whole lod chain, the way RenderObject uploads them
+	void KeepIndices(const ModelFile& file, uint32_t m, Model::MeshData& meshData)
+	{
+		const ModelFileMesh& fileMesh = file.GetMesh(m);
+		uint32_t indexCount = fileMesh.indexCount;
+		for (uint32_t l = 0; l < fileMesh.lodCount; ++l)
+		{
+			indexCount += file.GetLod(m, l).indexCount;
+		}
+
+		meshData.indexSize = fileMesh.indexSize;
+		meshData.indexStream.resize(static_cast<size_t>(indexCount) * fileMesh.indexSize);
+		meshData.indexRanges.resize(fileMesh.lodCount + 1);
+		uint32_t indexOffset = 0;
+		for (uint32_t r = 0; r < meshData.indexRanges.size(); ++r)
+		{
+			MeshLodRange& range = meshData.indexRanges[r];
+			range.indexOffset = indexOffset;
+			range.indexCount = (r == 0) ? fileMesh.indexCount : file.GetLod(m, r - 1).indexCount;
+			range.error = (r == 0) ? 0.0f : file.GetLod(m, r - 1).error;
+			const void* indices = (r == 0) ? file.GetIndices(m) : file.GetLodIndices(m, r - 1);
+			memcpy(&meshData.indexStream[static_cast<size_t>(indexOffset) * fileMesh.indexSize], indices, static_cast<size_t>(range.indexCount) * fileMesh.indexSize);
+			indexOffset += range.indexCount;
+		}
+	}
+
+	// Reads the whitespace separated values of the text formats straight from memory. Unlike
+	// fscanf it does not depend on the C locale and never reads past end.
+	class TextReader
+	{
+	public:
+		TextReader(const char* begin, const char* end)
+			: mPosition(begin)
+			, mEnd(end)
+		{
+		}
+
+		// consumes label when it is the next token, otherwise nothing is read
+		bool ReadLabel(std::string_view label)
+		{
+			SkipSpace();
+			if (static_cast<size_t>(mEnd - mPosition) < label.size() || memcmp(mPosition, label.data(), label.size()) != 0)
+			{
+				return false;
+			}
+			mPosition += label.size();
+			return true;
+		}
+
+		template<class... T>
+		bool Read(T&... values)
+		{
+			return (ReadValue(values) && ...);
+		}
+
+		std::string_view ReadToken()
+		{
+			SkipSpace();
+			const char* begin = mPosition;
+			while (mPosition < mEnd && !IsSpace(*mPosition))
+			{
+				++mPosition;
+			}
+			return { begin, static_cast<size_t>(mPosition - begin) };
+		}
+
+		// moves past count lines and collects where every linesPerBatch-th one starts, a
+		// newline scan is far cheaper than parsing the lines
+		bool SkipLines(size_t count, size_t linesPerBatch, std::vector<const char*>& batchStarts)
+		{
+			SkipSpace();
+			for (size_t line = 0; line < count; ++line)
+			{
+				if (mPosition == mEnd)
+				{
+					return false;
+				}
+				if (line % linesPerBatch == 0)
+				{
+					batchStarts.push_back(mPosition);
+				}
+				const char* lineEnd = static_cast<const char*>(memchr(mPosition, '\n', mEnd - mPosition));
+				mPosition = (lineEnd != nullptr) ? lineEnd + 1 : mEnd;
+			}
+			return true;
+		}
+
+		const char* GetPosition() const { return mPosition; }
+
+	private:
+		static bool IsSpace(char c)
+		{
+			return c == ' ' || c == '\n' || c == '\r' || c == '\t';
+		}
+
+		void SkipSpace()
+		{
+			while (mPosition < mEnd && IsSpace(*mPosition))
+			{
+				++mPosition;
+			}
+		}
+
+		template<class T>
+		bool ReadValue(T& value)
+		{
+			SkipSpace();
+			const std::from_chars_result result = std::from_chars(mPosition, mEnd, value);
+			if (result.ec != std::errc())
+			{
+				return false;
+			}
+			mPosition = result.ptr;
+			return true;
+		}
+
+		const char* mPosition = nullptr;
+		const char* mEnd = nullptr;
+	};
+
+	// Runs parseLine(reader, lineIndex) over the next count lines of reader. Lines are
+	// handed out in batches and the batches are parsed in parallel.
+	template<class ParseLine>
+	bool ParseLines(TextReader& reader, size_t count, const ParseLine& parseLine)
+	{
+		constexpr size_t linesPerBatch = 1024;
+		constexpr size_t minBatchesPerThread = 4;
+		std::vector<const char*> batchStarts;
+		if (!reader.SkipLines(count, linesPerBatch, batchStarts))
+		{
+			return false;
+		}
+
+		std::atomic<bool> success{ true };
+		Core::ThreadUtil::ParallelFor(batchStarts.size(), minBatchesPerThread, [&](size_t begin, size_t end)
+		{
+			for (size_t b = begin; b < end && success; ++b)
+			{
+				TextReader batchReader(batchStarts[b], reader.GetPosition());
+				const size_t lastLine = std::min((b + 1) * linesPerBatch, count);
+				for (size_t line = b * linesPerBatch; line < lastLine; ++line)
+				{
+					if (!parseLine(batchReader, line))
+					{
+						success = false;
+						break;
+					}
+				}
+			}
+		});
+		return success;
+	}
+
+	bool ParseTriangles(TextReader& reader, std::vector<uint32_t>& indices)
+	{
+		return ParseLines(reader, indices.size() / 3, [&](TextReader& lineReader, size_t line)
+		{
+			return lineReader.Read(indices[line * 3], indices[line * 3 + 1], indices[line * 3 + 2]);
+		});
+	}
+
+	bool ParseVertices(TextReader& reader, Model::MeshData& meshData)
+	{
+		std::vector<Vertex>& vertices = meshData.mesh.vertices;
+		const size_t vertexCount = vertices.size();
+		if (!meshData.packed)
+		{
+			if (!meshData.splitStreams)
+			{
+				return ParseLines(reader, vertexCount, [&](TextReader& lineReader, size_t i)
+				{
+					Vertex& v = vertices[i];
+					return lineReader.Read(v.position.x, v.position.y, v.position.z,
+						v.normal.x, v.normal.y, v.normal.z,
+						v.tangent.x, v.tangent.y, v.tangent.z,
+						v.uvCoord.x, v.uvCoord.y);
+				});
+			}
+			const bool success = ParseLines(reader, vertexCount, [&](TextReader& lineReader, size_t i)
+			{
+				Vertex& v = vertices[i];
+				return lineReader.Read(v.position.x, v.position.y, v.position.z);
+			}) && ParseLines(reader, vertexCount, [&](TextReader& lineReader, size_t i)
+			{
+				Vertex& v = vertices[i];
+				return lineReader.Read(v.normal.x, v.normal.y, v.normal.z,
+					v.tangent.x, v.tangent.y, v.tangent.z,
+					v.uvCoord.x, v.uvCoord.y);
+			});
+			if (success)
+			{
+				SplitStreams(vertices.data(), sizeof(Vertex), sizeof(Vertex::position), static_cast<uint32_t>(vertexCount), meshData);
+			}
+			return success;
+		}
+
+		std::vector<VertexPacked> packedVertices(vertexCount);
+		bool success = false;
+		if (!meshData.splitStreams)
+		{
+			success = ParseLines(reader, vertexCount, [&](TextReader& lineReader, size_t i)
+			{
+				VertexPacked& p = packedVertices[i];
+				return lineReader.Read(p.position[0], p.position[1], p.position[2], p.position[3],
+					p.normal[0], p.normal[1], p.tangent[0], p.tangent[1], p.uvCoord[0], p.uvCoord[1]);
+			});
+		}
+		else
+		{
+			success = ParseLines(reader, vertexCount, [&](TextReader& lineReader, size_t i)
+			{
+				VertexPacked& p = packedVertices[i];
+				return lineReader.Read(p.position[0], p.position[1], p.position[2], p.position[3]);
+			}) && ParseLines(reader, vertexCount, [&](TextReader& lineReader, size_t i)
+			{
+				VertexPacked& p = packedVertices[i];
+				return lineReader.Read(p.normal[0], p.normal[1], p.tangent[0], p.tangent[1], p.uvCoord[0], p.uvCoord[1]);
+			});
+		}
+		if (success)
+		{
+			const Math::AABB& positionBounds = meshData.positionBounds;
+			Core::ThreadUtil::ParallelFor(vertexCount, 4096, [&](size_t begin, size_t end)
+			{
+				for (size_t i = begin; i < end; ++i)
+				{
+					vertices[i] = VertexPacking::Unpack(packedVertices[i], positionBounds);
+				}
+			});
+			if (meshData.splitStreams)
+			{
+				SplitStreams(packedVertices.data(), sizeof(VertexPacked), sizeof(VertexPacked::position), static_cast<uint32_t>(vertexCount), meshData);
+			}
+		}
+		return success;
+	}
+
+	// the same sections LoadModelReference reads, optional ones are recognized by their label
+	bool ParseModel(TextReader& reader, Model& model)
+	{
+		uint32_t meshCount = 0;
+		if (!reader.ReadLabel("MeshCount:") || !reader.Read(meshCount))
+		{
+			return false;
+		}
+		model.meshData.resize(meshCount);
+		for (uint32_t m = 0; m < meshCount; ++m)
+		{
+			Model::MeshData& meshData = model.meshData[m];
+			if (!reader.ReadLabel("MaterialIndex:") || !reader.Read(meshData.materialIndex))
+			{
+				return false;
+			}
+
+			uint32_t streamCount = 1;
+			if (reader.ReadLabel("VertexStreams:") && (!reader.Read(streamCount) || (streamCount != 1 && streamCount != 2)))
+			{
+				return false;
+			}
+			meshData.splitStreams = (streamCount == 2);
+
+			Math::AABB& positionBounds = meshData.positionBounds;
+			meshData.packed = reader.ReadLabel("PositionBounds:");
+			if (meshData.packed && !reader.Read(positionBounds.center.x, positionBounds.center.y, positionBounds.center.z,
+				positionBounds.extend.x, positionBounds.extend.y, positionBounds.extend.z))
+			{
+				return false;
+			}
+
+			uint32_t vertexCount = 0;
+			if (!reader.ReadLabel("VertexCount:") || !reader.Read(vertexCount))
+			{
+				return false;
+			}
+			meshData.mesh.vertices.resize(vertexCount);
+			if (!ParseVertices(reader, meshData))
+			{
+				return false;
+			}
+
+			uint32_t indexBits = 32;
+			if (reader.ReadLabel("IndexFormat:") && !reader.Read(indexBits))
+			{
+				return false;
+			}
+			ASSERT(indexBits == 32 || vertexCount <= MaxIndex16VertexCount, "ModelIO: mesh %d has too many vertices for 16 bit indices", m);
+
+			uint32_t indexCount = 0;
+			if (!reader.ReadLabel("IndexCount:") || !reader.Read(indexCount))
+			{
+				return false;
+			}
+			meshData.mesh.indices.resize(indexCount);
+			if (!ParseTriangles(reader, meshData.mesh.indices))
+			{
+				return false;
+			}
+
+			uint32_t meshletCount = 0;
+			if (reader.ReadLabel("MeshletCount:") && !reader.Read(meshletCount))
+			{
+				return false;
+			}
+			meshData.meshlets.resize(meshletCount);
+			const bool meshletsRead = ParseLines(reader, meshletCount, [&](TextReader& lineReader, size_t i)
+			{
+				Meshlet& meshlet = meshData.meshlets[i];
+				return lineReader.Read(meshlet.indexOffset, meshlet.indexCount, meshlet.vertexCount,
+					meshlet.bounds.center.x, meshlet.bounds.center.y, meshlet.bounds.center.z, meshlet.bounds.radius,
+					meshlet.coneAxis.x, meshlet.coneAxis.y, meshlet.coneAxis.z, meshlet.coneCutoff);
+			});
+			if (!meshletsRead)
+			{
+				return false;
+			}
+
+			uint32_t lodCount = 0;
+			if (reader.ReadLabel("LodCount:") && !reader.Read(lodCount))
+			{
+				return false;
+			}
+			meshData.lods.resize(lodCount);
+			for (MeshLod& lod : meshData.lods)
+			{
+				uint32_t lodIndexCount = 0;
+				if (!reader.ReadLabel("LodIndexCount:") || !reader.Read(lodIndexCount, lod.error))
+				{
+					return false;
+				}
+				lod.indices.resize(lodIndexCount);
+				if (!ParseTriangles(reader, lod.indices))
+				{
+					return false;
+				}
+			}
+		}
+		return true;
+	}
+}
+
 void ModelIO::SaveModel(std::filesystem::path filePath, const Model& model)
 {
 	if (model.meshData.empty())
@@ -30,22 +489,115 @@ void ModelIO::SaveModel(std::filesystem::path filePath, const Model& model)
 
 		const Mesh& mesh = meshData.mesh;
 		const uint32_t vertexCount = static_cast<uint32_t>(mesh.vertices.size());
-		fprintf_s(file, "VertexCount: %d\n", vertexCount);
-		for (const Vertex& v : mesh.vertices)
+		if (meshData.splitStreams)
 		{
-			fprintf_s(file, "%f %f %f %f %f %f %f %f %f %f %f\n",
-				v.position.x, v.position.y, v.position.z,
-				v.normal.x, v.normal.y, v.normal.z,
-				v.tangent.x, v.tangent.y, v.tangent.z,
-				v.uvCoord.x, v.uvCoord.y);
+			// all positions first, then everything else, the layout MeshBuffer::InitializeSplit uploads
+			fprintf_s(file, "VertexStreams: 2\n");
+		}
+		if (meshData.packed)
+		{
+			// the bounds mark a packed mesh, its vertices are written as the integers the GPU reads
+			const MeshPacked packedMesh = VertexPacking::PackMesh(mesh);
+			const Math::AABB& bounds = packedMesh.positionBounds;
+			fprintf_s(file, "PositionBounds: %f %f %f %f %f %f\n",
+				bounds.center.x, bounds.center.y, bounds.center.z,
+				bounds.extend.x, bounds.extend.y, bounds.extend.z);
+			fprintf_s(file, "VertexCount: %d\n", vertexCount);
+			if (meshData.splitStreams)
+			{
+				for (const VertexPacked& v : packedMesh.vertices)
+				{
+					fprintf_s(file, "%hu %hu %hu %hu\n",
+						v.position[0], v.position[1], v.position[2], v.position[3]);
+				}
+				for (const VertexPacked& v : packedMesh.vertices)
+				{
+					fprintf_s(file, "%hd %hd %hd %hd %hu %hu\n",
+						v.normal[0], v.normal[1],
+						v.tangent[0], v.tangent[1],
+						v.uvCoord[0], v.uvCoord[1]);
+				}
+			}
+			else
+			{
+				for (const VertexPacked& v : packedMesh.vertices)
+				{
+					fprintf_s(file, "%hu %hu %hu %hu %hd %hd %hd %hd %hu %hu\n",
+						v.position[0], v.position[1], v.position[2], v.position[3],
+						v.normal[0], v.normal[1],
+						v.tangent[0], v.tangent[1],
+						v.uvCoord[0], v.uvCoord[1]);
+				}
+			}
+		}
+		else
+		{
+			fprintf_s(file, "VertexCount: %d\n", vertexCount);
+			if (meshData.splitStreams)
+			{
+				for (const Vertex& v : mesh.vertices)
+				{
+					fprintf_s(file, "%f %f %f\n", v.position.x, v.position.y, v.position.z);
+				}
+				for (const Vertex& v : mesh.vertices)
+				{
+					fprintf_s(file, "%f %f %f %f %f %f %f %f\n",
+						v.normal.x, v.normal.y, v.normal.z,
+						v.tangent.x, v.tangent.y, v.tangent.z,
+						v.uvCoord.x, v.uvCoord.y);
+				}
+			}
+			else
+			{
+				for (const Vertex& v : mesh.vertices)
+				{
+					fprintf_s(file, "%f %f %f %f %f %f %f %f %f %f %f\n",
+						v.position.x, v.position.y, v.position.z,
+						v.normal.x, v.normal.y, v.normal.z,
+						v.tangent.x, v.tangent.y, v.tangent.z,
+						v.uvCoord.x, v.uvCoord.y);
+				}
+			}
 		}
 
+		// the width the mesh buffer will upload the indices with
+		const IndexFormat indexFormat = GetIndexFormat(vertexCount);
+		fprintf_s(file, "IndexFormat: %d\n", (indexFormat == IndexFormat::UInt16) ? 16 : 32);
+
 		const uint32_t indexCount = static_cast<uint32_t>(mesh.indices.size());
 		fprintf_s(file, "IndexCount: %d\n", indexCount);
 		for (uint32_t i = 2; i < indexCount; i += 3)
 		{
 			fprintf_s(file, "%d %d %d\n", mesh.indices[i - 2], mesh.indices[i - 1], mesh.indices[i]);
 		}
+
+		const uint32_t meshletCount = static_cast<uint32_t>(meshData.meshlets.size());
+		if (meshletCount > 0)
+		{
+			fprintf_s(file, "MeshletCount: %d\n", meshletCount);
+			for (const Meshlet& meshlet : meshData.meshlets)
+			{
+				fprintf_s(file, "%d %d %d %f %f %f %f %f %f %f %f\n",
+					meshlet.indexOffset, meshlet.indexCount, meshlet.vertexCount,
+					meshlet.bounds.center.x, meshlet.bounds.center.y, meshlet.bounds.center.z, meshlet.bounds.radius,
+					meshlet.coneAxis.x, meshlet.coneAxis.y, meshlet.coneAxis.z, meshlet.coneCutoff);
+			}
+		}
+
+		const uint32_t lodCount = static_cast<uint32_t>(meshData.lods.size());
+		if (lodCount > 0)
+		{
+			fprintf_s(file, "LodCount: %d\n", lodCount);
+			for (const MeshLod& lod : meshData.lods)
+			{
+				const uint32_t lodIndexCount = static_cast<uint32_t>(lod.indices.size());
+				fprintf_s(file, "LodIndexCount: %d %f\n", lodIndexCount, lod.error);
+				for (uint32_t i = 2; i < lodIndexCount; i += 3)
+				{
+					fprintf_s(file, "%d %d %d\n", lod.indices[i - 2], lod.indices[i - 1], lod.indices[i]);
+				}
+			}
+		}
 	}
 	fclose(file);
 }
@@ -54,6 +606,25 @@ void ModelIO::LoadModel(std::filesystem::path filePath, Model& model)
 {
 	filePath.replace_extension("model");
 
+	Core::MappedFile file;
+	if (!file.Open(filePath))
+	{
+		return;
+	}
+
+	const char* text = reinterpret_cast<const char*>(file.GetData());
+	TextReader reader(text, text + file.GetSize());
+	if (!ParseModel(reader, model))
+	{
+		LOG("ModelIO: %s is not a valid model file", filePath.u8string().c_str());
+		model.meshData.clear();
+	}
+}
+
+void ModelIO::LoadModelReference(std::filesystem::path filePath, Model& model)
+{
+	filePath.replace_extension("model");
+
 	FILE* file = nullptr;
 	fopen_s(&file, filePath.u8string().c_str(), "r");
 	if (file == nullptr)
@@ -71,16 +642,101 @@ void ModelIO::LoadModel(std::filesystem::path filePath, Model& model)
 
 		Mesh& mesh = meshData.mesh;
 		uint32_t vertexCount = 0;
+		uint32_t streamCount = 1;
+		const long streamsPosition = ftell(file);
+		if (fscanf_s(file, "VertexStreams: %d\n", &streamCount) != 1)
+		{
+			fseek(file, streamsPosition, SEEK_SET);
+			streamCount = 1;
+		}
+		ASSERT(streamCount == 1 || streamCount == 2, "ModelIO: mesh %d has %d vertex streams", m, streamCount);
+		meshData.splitStreams = (streamCount == 2);
+
+		Math::AABB& positionBounds = meshData.positionBounds;
+		const long boundsPosition = ftell(file);
+		meshData.packed = fscanf_s(file, "PositionBounds: %f %f %f %f %f %f\n",
+			&positionBounds.center.x, &positionBounds.center.y, &positionBounds.center.z,
+			&positionBounds.extend.x, &positionBounds.extend.y, &positionBounds.extend.z) == 6;
+		if (!meshData.packed)
+		{
+			fseek(file, boundsPosition, SEEK_SET);
+		}
 		fscanf_s(file, "VertexCount: %d\n", &vertexCount);
 		mesh.vertices.resize(vertexCount);
-		for (Vertex& v : mesh.vertices)
+		if (meshData.packed)
+		{
+			std::vector<VertexPacked> packedVertices(vertexCount);
+			if (meshData.splitStreams)
+			{
+				for (VertexPacked& p : packedVertices)
+				{
+					fscanf_s(file, "%hu %hu %hu %hu\n",
+						&p.position[0], &p.position[1], &p.position[2], &p.position[3]);
+				}
+				for (VertexPacked& p : packedVertices)
+				{
+					fscanf_s(file, "%hd %hd %hd %hd %hu %hu\n",
+						&p.normal[0],   &p.normal[1],
+						&p.tangent[0],  &p.tangent[1],
+						&p.uvCoord[0],  &p.uvCoord[1]);
+				}
+			}
+			else
+			{
+				for (VertexPacked& p : packedVertices)
+				{
+					fscanf_s(file, "%hu %hu %hu %hu %hd %hd %hd %hd %hu %hu\n",
+						&p.position[0], &p.position[1], &p.position[2], &p.position[3],
+						&p.normal[0],   &p.normal[1],
+						&p.tangent[0],  &p.tangent[1],
+						&p.uvCoord[0],  &p.uvCoord[1]);
+				}
+			}
+			for (uint32_t i = 0; i < vertexCount; ++i)
+			{
+				mesh.vertices[i] = VertexPacking::Unpack(packedVertices[i], positionBounds);
+			}
+			if (meshData.splitStreams)
+			{
+				SplitStreams(packedVertices.data(), sizeof(VertexPacked), sizeof(VertexPacked::position), vertexCount, meshData);
+			}
+		}
+		else if (meshData.splitStreams)
+		{
+			for (Vertex& v : mesh.vertices)
+			{
+				fscanf_s(file, "%f %f %f\n", &v.position.x, &v.position.y, &v.position.z);
+			}
+			for (Vertex& v : mesh.vertices)
+			{
+				fscanf_s(file, "%f %f %f %f %f %f %f %f\n",
+					&v.normal.x,   &v.normal.y,   &v.normal.z,
+					&v.tangent.x,  &v.tangent.y,  &v.tangent.z,
+					&v.uvCoord.x,  &v.uvCoord.y);
+			}
+			SplitStreams(mesh.vertices.data(), sizeof(Vertex), sizeof(Vertex::position), vertexCount, meshData);
+		}
+		else
+		{
+			for (Vertex& v : mesh.vertices)
+			{
+				fscanf_s(file, "%f %f %f %f %f %f %f %f %f %f %f\n",
+					&v.position.x, &v.position.y, &v.position.z,
+					&v.normal.x,   &v.normal.y,   &v.normal.z,
+					&v.tangent.x,  &v.tangent.y,  &v.tangent.z,
+					&v.uvCoord.x,  &v.uvCoord.y);
+			}
+		}
+
+		// older files have no index format, it follows from the vertex count either way
+		uint32_t indexBits = 0;
+		const long indexFormatPosition = ftell(file);
+		if (fscanf_s(file, "IndexFormat: %d\n", &indexBits) != 1)
 		{
-			fscanf_s(file, "%f %f %f %f %f %f %f %f %f %f %f\n",
-				&v.position.x, &v.position.y, &v.position.z,
-				&v.normal.x,   &v.normal.y,   &v.normal.z,
-				&v.tangent.x,  &v.tangent.y,  &v.tangent.z,
-				&v.uvCoord.x,  &v.uvCoord.y);
+			fseek(file, indexFormatPosition, SEEK_SET);
+			indexBits = (GetIndexFormat(vertexCount) == IndexFormat::UInt16) ? 16 : 32;
 		}
+		ASSERT(indexBits == 32 || vertexCount <= MaxIndex16VertexCount, "ModelIO: mesh %d has too many vertices for 16 bit indices", m);
 
 		uint32_t indexCount = 0;
 		fscanf_s(file, "IndexCount: %d\n", &indexCount);
@@ -89,6 +745,43 @@ void ModelIO::LoadModel(std::filesystem::path filePath, Model& model)
 		{
 			fscanf_s(file, "%d %d %d\n", &mesh.indices[i - 2], &mesh.indices[i - 1], &mesh.indices[i]);
 		}
+
+		// meshlets are optional, rewind when the next mesh starts instead
+		uint32_t meshletCount = 0;
+		const long meshletPosition = ftell(file);
+		if (fscanf_s(file, "MeshletCount: %d\n", &meshletCount) != 1)
+		{
+			fseek(file, meshletPosition, SEEK_SET);
+			meshletCount = 0;
+		}
+		meshData.meshlets.resize(meshletCount);
+		for (Meshlet& meshlet : meshData.meshlets)
+		{
+			fscanf_s(file, "%d %d %d %f %f %f %f %f %f %f %f\n",
+				&meshlet.indexOffset, &meshlet.indexCount, &meshlet.vertexCount,
+				&meshlet.bounds.center.x, &meshlet.bounds.center.y, &meshlet.bounds.center.z, &meshlet.bounds.radius,
+				&meshlet.coneAxis.x, &meshlet.coneAxis.y, &meshlet.coneAxis.z, &meshlet.coneCutoff);
+		}
+
+		// lods are optional as well
+		uint32_t lodCount = 0;
+		const long lodPosition = ftell(file);
+		if (fscanf_s(file, "LodCount: %d\n", &lodCount) != 1)
+		{
+			fseek(file, lodPosition, SEEK_SET);
+			lodCount = 0;
+		}
+		meshData.lods.resize(lodCount);
+		for (MeshLod& lod : meshData.lods)
+		{
+			uint32_t lodIndexCount = 0;
+			fscanf_s(file, "LodIndexCount: %d %f\n", &lodIndexCount, &lod.error);
+			lod.indices.resize(lodIndexCount);
+			for (uint32_t i = 2; i < lodIndexCount; i += 3)
+			{
+				fscanf_s(file, "%d %d %d\n", &lod.indices[i - 2], &lod.indices[i - 1], &lod.indices[i]);
+			}
+		}
 	}
 
 	fclose(file);
@@ -118,10 +811,15 @@ void ModelIO::SaveMaterial(std::filesystem::path filePath, const Model& model)
 		fprintf_s(file, "%f %f %f %f\n", m.specular.r, m.specular.g, m.specular.b, m.specular.a);
 		fprintf_s(file, "Shininess: %f\n", m.shininess);
 
-		fprintf_s(file, "%s\n", materialData.diffuseMapName.empty() ? "<NONE>" : materialData.diffuseMapName.c_str());
-		fprintf_s(file, "%s\n", materialData.specMapName.empty() ? "<NONE>" : materialData.specMapName.c_str());
-		fprintf_s(file, "%s\n", materialData.normalMapName.empty() ? "<NONE>" : materialData.normalMapName.c_str());
-		fprintf_s(file, "%s\n", materialData.bumpMapName.empty() ? "<NONE>" : materialData.bumpMapName.c_str());
+		// loaded names carry the model directory, LoadMaterial adds it back
+		auto WriteTextureName = [&](const std::string& fileName)
+		{
+			fprintf_s(file, "%s\n", fileName.empty() ? "<NONE>" : std::filesystem::path(fileName).filename().u8string().c_str());
+		};
+		WriteTextureName(materialData.diffuseMapName);
+		WriteTextureName(materialData.specMapName);
+		WriteTextureName(materialData.normalMapName);
+		WriteTextureName(materialData.bumpMapName);
 	}
 
 	fclose(file);
@@ -131,38 +829,272 @@ void ModelIO::LoadMaterial(std::filesystem::path filePath, Model& model)
 {
 	filePath.replace_extension("material");
 
-	FILE* file = nullptr;
-	fopen_s(&file, filePath.u8string().c_str(), "r");
-	if (file == nullptr)
+	Core::MappedFile file;
+	if (!file.Open(filePath))
+	{
 		return;
+	}
 
-	auto TryReadTextureName = [&](auto& fileName)
+	const char* text = reinterpret_cast<const char*>(file.GetData());
+	TextReader reader(text, text + file.GetSize());
+	auto ReadColor = [&](Color& color)
+	{
+		return reader.Read(color.r, color.g, color.b, color.a);
+	};
+	auto ReadTextureName = [&](std::string& fileName)
 	{
-		char buffer[MAX_PATH];
-		fscanf_s(file, "%s\n", &buffer, (uint32_t)sizeof(buffer));
-		if (strcmp(buffer, "<NONE>") != 0)
+		const std::string_view name = reader.ReadToken();
+		if (!name.empty() && name != "<NONE>")
 		{
-			fileName = filePath.replace_filename(buffer).string();
+			fileName = filePath.replace_filename(std::string(name)).string();
 		}
+		return !name.empty();
 	};
 
 	uint32_t materialCount = 0;
-	fscanf_s(file, "MaterialCount: %d\n", &materialCount);
-	model.materialData.resize(materialCount);
+	bool success = reader.ReadLabel("MaterialCount:") && reader.Read(materialCount);
+	model.materialData.resize(success ? materialCount : 0);
 	for (Model::MaterialData& materialData : model.materialData)
 	{
 		Material& m = materialData.material;
-		fscanf_s(file, "%f %f %f %f\n", &m.emissive.r, &m.emissive.g, &m.emissive.b, &m.emissive.a);
-		fscanf_s(file, "%f %f %f %f\n", &m.ambient.r, &m.ambient.g, &m.ambient.b, &m.ambient.a);
-		fscanf_s(file, "%f %f %f %f\n", &m.diffuse.r, &m.diffuse.g, &m.diffuse.b, &m.diffuse.a);
-		fscanf_s(file, "%f %f %f %f\n", &m.specular.r, &m.specular.g, &m.specular.b, &m.specular.a);
-		fscanf_s(file, "Shininess: %f\n", &m.shininess);
+		success = success &&
+			ReadColor(m.emissive) && ReadColor(m.ambient) && ReadColor(m.diffuse) && ReadColor(m.specular) &&
+			reader.ReadLabel("Shininess:") && reader.Read(m.shininess) &&
+			ReadTextureName(materialData.diffuseMapName) &&
+			ReadTextureName(materialData.specMapName) &&
+			ReadTextureName(materialData.normalMapName) &&
+			ReadTextureName(materialData.bumpMapName);
+	}
+	if (!success)
+	{
+		LOG("ModelIO: %s is not a valid material file", filePath.u8string().c_str());
+		model.materialData.clear();
+	}
+}
 
-		TryReadTextureName(materialData.diffuseMapName);
-		TryReadTextureName(materialData.specMapName);
-		TryReadTextureName(materialData.normalMapName);
-		TryReadTextureName(materialData.bumpMapName);
+void ModelIO::SaveModelBinary(std::filesystem::path filePath, const Model& model)
+{
+	if (model.meshData.empty())
+	{
+		return;
 	}
 
+	filePath.replace_extension("modelbin");
+
+	// built in memory and written at once, the tables go after the blobs they point to
+	std::vector<uint8_t> buffer(sizeof(ModelFileHeader));
+	std::vector<ModelFileMesh> meshTable;
+	for (const Model::MeshData& meshData : model.meshData)
+	{
+		const Mesh& mesh = meshData.mesh;
+		ModelFileMesh& fileMesh = meshTable.emplace_back();
+		fileMesh.materialIndex = meshData.materialIndex;
+		fileMesh.flags = (meshData.packed ? ModelFileMesh::Packed : 0) | (meshData.splitStreams ? ModelFileMesh::SplitStreams : 0);
+		fileMesh.vertexCount = static_cast<uint32_t>(mesh.vertices.size());
+		fileMesh.indexCount = static_cast<uint32_t>(mesh.indices.size());
+		fileMesh.meshletCount = static_cast<uint32_t>(meshData.meshlets.size());
+		fileMesh.lodCount = static_cast<uint32_t>(meshData.lods.size());
+		fileMesh.indexSize = (GetIndexFormat(mesh.vertices.size()) == IndexFormat::UInt16) ? sizeof(uint16_t) : sizeof(uint32_t);
+		if (meshData.splitStreams && !meshData.positionStream.empty())
+		{
+			// the blocks as they were loaded, packing the decoded vertices again is not lossless
+			fileMesh.positionSize = static_cast<uint32_t>(meshData.positionStream.size() / mesh.vertices.size());
+			fileMesh.vertexSize = fileMesh.positionSize + static_cast<uint32_t>(meshData.attributeStream.size() / mesh.vertices.size());
+			fileMesh.positionBounds = meshData.positionBounds;
+			fileMesh.vertexOffset = AppendBlob(buffer, nullptr, meshData.positionStream.size() + meshData.attributeStream.size());
+			memcpy(&buffer[fileMesh.vertexOffset], meshData.positionStream.data(), meshData.positionStream.size());
+			memcpy(&buffer[fileMesh.vertexOffset + meshData.positionStream.size()], meshData.attributeStream.data(), meshData.attributeStream.size());
+		}
+		else if (meshData.packed)
+		{
+			const MeshPacked packedMesh = VertexPacking::PackMesh(mesh);
+			fileMesh.vertexSize = static_cast<uint32_t>(sizeof(VertexPacked));
+			fileMesh.positionSize = static_cast<uint32_t>(sizeof(VertexPacked::position));
+			fileMesh.positionBounds = packedMesh.positionBounds;
+			fileMesh.vertexOffset = AppendVertices(buffer, packedMesh.vertices.data(), fileMesh.vertexSize, fileMesh.positionSize, fileMesh.vertexCount, meshData.splitStreams);
+		}
+		else
+		{
+			fileMesh.vertexSize = static_cast<uint32_t>(sizeof(Vertex));
+			fileMesh.positionSize = static_cast<uint32_t>(sizeof(Vertex::position));
+			fileMesh.vertexOffset = AppendVertices(buffer, mesh.vertices.data(), fileMesh.vertexSize, fileMesh.positionSize, fileMesh.vertexCount, meshData.splitStreams);
+		}
+		fileMesh.indexOffset = AppendIndices(buffer, mesh.indices, fileMesh.indexSize);
+		fileMesh.meshletOffset = AppendBlob(buffer, meshData.meshlets.data(), meshData.meshlets.size() * sizeof(Meshlet));
+
+		std::vector<ModelFileLod> lodTable;
+		for (const MeshLod& lod : meshData.lods)
+		{
+			ModelFileLod& fileLod = lodTable.emplace_back();
+			fileLod.indexCount = static_cast<uint32_t>(lod.indices.size());
+			fileLod.error = lod.error;
+			fileLod.indexOffset = AppendIndices(buffer, lod.indices, fileMesh.indexSize);
+		}
+		fileMesh.lodOffset = AppendBlob(buffer, lodTable.data(), lodTable.size() * sizeof(ModelFileLod));
+	}
+
+	std::string stringTable;
+	std::vector<ModelFileMaterial> materialTable;
+	for (const Model::MaterialData& materialData : model.materialData)
+	{
+		ModelFileMaterial& fileMaterial = materialTable.emplace_back();
+		fileMaterial.material = materialData.material;
+		const std::string* textureNames[] = { &materialData.diffuseMapName, &materialData.specMapName, &materialData.normalMapName, &materialData.bumpMapName };
+		for (size_t i = 0; i < std::size(textureNames); ++i)
+		{
+			if (!textureNames[i]->empty())
+			{
+				// names are stored without the directory, like the text material
+				fileMaterial.textureNameOffsets[i] = static_cast<uint32_t>(stringTable.size());
+				stringTable += std::filesystem::path(*textureNames[i]).filename().u8string();
+				stringTable += '\0';
+			}
+		}
+	}
+
+	ModelFileHeader header;
+	header.meshCount = static_cast<uint32_t>(meshTable.size());
+	header.materialCount = static_cast<uint32_t>(materialTable.size());
+	header.meshTableOffset = AppendBlob(buffer, meshTable.data(), meshTable.size() * sizeof(ModelFileMesh));
+	header.materialTableOffset = AppendBlob(buffer, materialTable.data(), materialTable.size() * sizeof(ModelFileMaterial));
+	header.stringTableOffset = AppendBlob(buffer, stringTable.data(), stringTable.size());
+	header.fileSize = buffer.size();
+	memcpy(buffer.data(), &header, sizeof(header));
+
+	FILE* file = nullptr;
+	fopen_s(&file, filePath.u8string().c_str(), "wb");
+	if (file == nullptr)
+	{
+		return;
+	}
+	fwrite(buffer.data(), 1, buffer.size(), file);
 	fclose(file);
-}
\ No newline at end of file
+}
+
+bool ModelIO::LoadModelBinary(std::filesystem::path filePath, Model& model, bool decodeMeshes)
+{
+	filePath.replace_extension("modelbin");
+
+	ModelFile file;
+	if (!file.Open(filePath))
+	{
+		return false;
+	}
+
+	model.meshData.resize(file.GetMeshCount());
+	for (uint32_t m = 0; m < file.GetMeshCount(); ++m)
+	{
+		const ModelFileMesh& fileMesh = file.GetMesh(m);
+		Model::MeshData& meshData = model.meshData[m];
+		meshData.materialIndex = fileMesh.materialIndex;
+		meshData.packed = (fileMesh.flags & ModelFileMesh::Packed) != 0;
+		meshData.splitStreams = (fileMesh.flags & ModelFileMesh::SplitStreams) != 0;
+
+		if (meshData.packed)
+		{
+			meshData.positionBounds = fileMesh.positionBounds;
+		}
+		const Meshlet* meshlets = file.GetMeshlets(m);
+		meshData.meshlets.assign(meshlets, meshlets + fileMesh.meshletCount);
+
+		const uint32_t vertexCount = fileMesh.vertexCount;
+		if (meshData.splitStreams)
+		{
+			KeepStreams(file.GetVertices(m), fileMesh.vertexSize, fileMesh.positionSize, vertexCount, meshData);
+		}
+		if (!decodeMeshes)
+		{
+			// the same split InitializeSplit would do at upload, done here on the loading thread
+			if (!meshData.splitStreams)
+			{
+				SplitStreams(file.GetVertices(m), fileMesh.vertexSize, fileMesh.positionSize, vertexCount, meshData);
+			}
+			KeepIndices(file, m, meshData);
+			continue;
+		}
+
+		Mesh& mesh = meshData.mesh;
+		mesh.vertices.resize(vertexCount);
+		if (meshData.packed)
+		{
+			std::vector<VertexPacked> packedVertices(vertexCount);
+			ReadVertices(file.GetVertices(m), fileMesh.vertexSize, fileMesh.positionSize, vertexCount, meshData.splitStreams, packedVertices.data());
+			for (uint32_t i = 0; i < vertexCount; ++i)
+			{
+				mesh.vertices[i] = VertexPacking::Unpack(packedVertices[i], fileMesh.positionBounds);
+			}
+		}
+		else
+		{
+			ReadVertices(file.GetVertices(m), fileMesh.vertexSize, fileMesh.positionSize, vertexCount, meshData.splitStreams, mesh.vertices.data());
+		}
+
+		ReadIndices(file.GetIndices(m), fileMesh.indexSize, fileMesh.indexCount, mesh.indices);
+		meshData.lods.resize(fileMesh.lodCount);
+		for (uint32_t l = 0; l < fileMesh.lodCount; ++l)
+		{
+			const ModelFileLod& fileLod = file.GetLod(m, l);
+			ReadIndices(file.GetLodIndices(m, l), fileMesh.indexSize, fileLod.indexCount, meshData.lods[l].indices);
+			meshData.lods[l].error = fileLod.error;
+		}
+	}
+
+	model.materialData.resize(file.GetMaterialCount());
+	for (uint32_t m = 0; m < file.GetMaterialCount(); ++m)
+	{
+		Model::MaterialData& materialData = model.materialData[m];
+		materialData.material = file.GetMaterial(m).material;
+		std::string* textureNames[] = { &materialData.diffuseMapName, &materialData.specMapName, &materialData.normalMapName, &materialData.bumpMapName };
+		for (uint32_t i = 0; i < std::size(textureNames); ++i)
+		{
+			const char* textureName = file.GetTextureName(m, i);
+			if (textureName != nullptr)
+			{
+				*textureNames[i] = std::filesystem::path(filePath).replace_filename(textureName).string();
+			}
+		}
+	}
+	return true;
+}
+
+void ModelIO::DecodeMesh(Model::MeshData& meshData)
+{
+	const uint32_t positionSize = static_cast<uint32_t>(meshData.packed ? sizeof(VertexPacked::position) : sizeof(Vertex::position));
+	const uint32_t vertexSize = static_cast<uint32_t>(meshData.packed ? sizeof(VertexPacked) : sizeof(Vertex));
+	const uint32_t vertexCount = static_cast<uint32_t>(meshData.positionStream.size() / positionSize);
+	Mesh& mesh = meshData.mesh;
+	mesh.vertices.resize(vertexCount);
+	if (meshData.packed)
+	{
+		std::vector<VertexPacked> packedVertices(vertexCount);
+		InterleaveStreams(meshData.positionStream.data(), meshData.attributeStream.data(), vertexSize, positionSize, vertexCount, packedVertices.data());
+		for (uint32_t i = 0; i < vertexCount; ++i)
+		{
+			mesh.vertices[i] = VertexPacking::Unpack(packedVertices[i], meshData.positionBounds);
+		}
+	}
+	else
+	{
+		InterleaveStreams(meshData.positionStream.data(), meshData.attributeStream.data(), vertexSize, positionSize, vertexCount, mesh.vertices.data());
+	}
+
+	if (meshData.indexRanges.empty())
+	{
+		return;
+	}
+	meshData.lods.resize(meshData.indexRanges.size() - 1);
+	for (size_t r = 0; r < meshData.indexRanges.size(); ++r)
+	{
+		const MeshLodRange& range = meshData.indexRanges[r];
+		const uint8_t* indices = &meshData.indexStream[static_cast<size_t>(range.indexOffset) * meshData.indexSize];
+		ReadIndices(indices, meshData.indexSize, range.indexCount, (r == 0) ? mesh.indices : meshData.lods[r - 1].indices);
+		if (r > 0)
+		{
+			meshData.lods[r - 1].error = range.error;
+		}
+	}
+	meshData.indexStream.clear();
+	meshData.indexStream.shrink_to_fit();
+	meshData.indexRanges.clear();
+	meshData.indexSize = 0;
+}
@@ -8,8 +8,66 @@ using namespace ML_Engine::Graphics;
 namespace
 {
 	std::unique_ptr<ModelManager> sModelManager;
+
+	constexpr uint32_t LoadThreadCount = 2;
+	constexpr size_t DefaultMemoryBudget = 512 * 1024 * 1024;
+
+	template<class T>
+	size_t VectorBytes(const std::vector<T>& values)
+	{
+		return values.capacity() * sizeof(T);
+	}
+
+	// cpu side bytes the model holds, its gpu copies belong to the render objects
+	size_t ComputeMemoryUsage(const Model& model)
+	{
+		size_t bytes = sizeof(Model) + VectorBytes(model.meshData) + VectorBytes(model.materialData);
+		for (const Model::MeshData& meshData : model.meshData)
+		{
+			bytes += VectorBytes(meshData.mesh.vertices) + VectorBytes(meshData.mesh.indices) + VectorBytes(meshData.meshlets) + VectorBytes(meshData.lods) +
+				VectorBytes(meshData.positionStream) + VectorBytes(meshData.attributeStream) +
+				VectorBytes(meshData.indexStream) + VectorBytes(meshData.indexRanges);
+			for (const MeshLod& lod : meshData.lods)
+			{
+				bytes += VectorBytes(lod.indices);
+			}
+		}
+		for (const Model::MaterialData& materialData : model.materialData)
+		{
+			bytes += materialData.diffuseMapName.capacity() + materialData.specMapName.capacity() +
+				materialData.normalMapName.capacity() + materialData.bumpMapName.capacity();
+		}
+		return bytes;
+	}
+
+	// a .modelbin next to the text model is used unless the text file was saved after it
+	bool LoadBinaryIfCurrent(std::filesystem::path filePath, Model& model)
+	{
+		std::error_code error;
+		const auto textTime = std::filesystem::last_write_time(filePath.replace_extension("model"), error);
+		const bool hasText = !error;
+		const auto binaryTime = std::filesystem::last_write_time(filePath.replace_extension("modelbin"), error);
+		if (error || (hasText && textTime > binaryTime))
+		{
+			return false;
+		}
+		// the render objects upload the stored blocks, only building missing lods decodes them
+		return ModelIO::LoadModelBinary(filePath, model, false);
+	}
 }
 
+ModelManager::ModelManager()
+	: mMemoryBudget(DefaultMemoryBudget)
+{
+	// loading is mostly file reads and parsing that fans out over ThreadUtil itself, so a
+	// couple of threads keep several models in flight without starving the frame
+	mLoadThreads.Initialize(LoadThreadCount);
+}
+ModelManager::~ModelManager()
+{
+	// finishes the queued loads, their jobs point into mInventory
+	mLoadThreads.Terminate();
+}
 void ModelManager::StaticInitialize(const std::filesystem::path& rootPath)
 {
 	ASSERT(sModelManager == nullptr, "ModelManager: is already initialized");
@@ -29,30 +87,237 @@ void ModelManager::SetRootDirectory(const std::filesystem::path& rootPath)
 {
 	mRootDirectory = rootPath;
 }
-ModelId ModelManager::GetModelId(const std::filesystem::path& filePath)
+ModelId ModelManager::GetModelId(const std::filesystem::path& filePath) const
 {
-	return std::filesystem::hash_value(mRootDirectory / filePath);
+	std::lock_guard<std::mutex> lock(mMutex);
+	auto iter = mIdsByPath.find(GetPathKey(filePath));
+	return (iter != mIdsByPath.end()) ? iter->second : 0;
 }
 ModelId ModelManager::LoadModel(const std::filesystem::path& filePath)
 {
-	const ModelId modelId = GetModelId(filePath);
-	auto [iter, success] = mInventory.insert({ modelId, nullptr });
-	if (success)
+	ModelId modelId = 0;
+	std::promise<void> loaded;
+	Model* model = nullptr;
+	std::shared_future<void> pending;
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		model = AddReference(filePath, modelId);
+		Entry* entry = mInventory.Get(modelId);
+		if (model != nullptr)
+		{
+			entry->loaded = loaded.get_future().share();
+		}
+		else
+		{
+			pending = entry->loaded;
+		}
+	}
+
+	if (model != nullptr)
+	{
+		LoadModelData(mRootDirectory / filePath, *model);
+		MarkReady(modelId, ComputeMemoryUsage(*model));
+		loaded.set_value();
+	}
+	else
+	{
+		pending.wait();
+	}
+	return modelId;
+}
+ModelId ModelManager::LoadModelAsync(const std::filesystem::path& filePath)
+{
+	ModelId modelId = 0;
+	std::lock_guard<std::mutex> lock(mMutex);
+	Model* model = AddReference(filePath, modelId);
+	if (model != nullptr)
 	{
+		// the model is heap allocated, the job fills it in place while slots move around
 		std::filesystem::path fullPath = mRootDirectory / filePath;
-		auto& modelPtr = iter->second;
-		modelPtr = std::make_unique<Model>();
-		ModelIO::LoadModel(fullPath, *modelPtr);
-		ModelIO::LoadMaterial(fullPath, *modelPtr);
+		mInventory.Get(modelId)->loaded = mLoadThreads.Submit([this, modelId, model, fullPath]()
+		{
+			LoadModelData(fullPath, *model);
+			MarkReady(modelId, ComputeMemoryUsage(*model));
+		}).share();
 	}
 	return modelId;
 }
-const Model* ModelManager::GetModel(ModelId id)
+bool ModelManager::IsReady(ModelId id) const
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+	const Entry* entry = mInventory.Get(id);
+	return entry != nullptr && entry->ready;
+}
+void ModelManager::WaitForModel(ModelId id) const
+{
+	std::shared_future<void> loaded;
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		const Entry* entry = mInventory.Get(id);
+		if (entry == nullptr)
+		{
+			return;
+		}
+		loaded = entry->loaded;
+	}
+	loaded.wait();
+}
+const Model* ModelManager::GetModel(ModelId id) const
 {
-	auto model = mInventory.find(id);
-	if (model != mInventory.end())
+	std::lock_guard<std::mutex> lock(mMutex);
+	const Entry* entry = mInventory.Get(id);
+	if (entry != nullptr && entry->ready)
 	{
-		return model->second.get();
+		return entry->model.get();
 	}
 	return nullptr;
-}
\ No newline at end of file
+}
+void ModelManager::LoadModelData(const std::filesystem::path& fullPath, Model& model) const
+{
+	if (!LoadBinaryIfCurrent(fullPath, model))
+	{
+		ModelIO::LoadModel(fullPath, model);
+		ModelIO::LoadMaterial(fullPath, model);
+	}
+
+	// building what the cook left out takes around 100 ms per character sized mesh, so it
+	// is only done when asked for, otherwise the mesh is drawn at full detail and unculled
+	for (Model::MeshData& meshData : model.meshData)
+	{
+		const bool hasLods = !meshData.lods.empty() || meshData.indexRanges.size() > 1;
+		if (hasLods && !meshData.meshlets.empty())
+		{
+			continue;
+		}
+		if (!mBuildMissingMeshData)
+		{
+			LOG("ModelManager: %s has no lods or meshlets, cook it with ModelConverter -optimize -lods 3 -meshlets", fullPath.u8string().c_str());
+			break;
+		}
+		if (meshData.mesh.vertices.empty())
+		{
+			ModelIO::DecodeMesh(meshData);
+		}
+		if (meshData.lods.empty())
+		{
+			meshData.lods = MeshSimplifier::BuildLods(meshData.mesh);
+		}
+		if (meshData.meshlets.empty())
+		{
+			meshData.meshlets = MeshletBuilder::Build(meshData.mesh);
+		}
+	}
+}
+void ModelManager::ReleaseModel(ModelId id)
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+	Entry* entry = mInventory.Get(id);
+	if (entry == nullptr || entry->refCount == 0)
+	{
+		return;
+	}
+
+	--entry->refCount;
+	if (entry->refCount == 0 && entry->ready)
+	{
+		entry->lruPosition = mUnreferenced.insert(mUnreferenced.end(), id);
+		EvictToBudget();
+	}
+}
+void ModelManager::SetMemoryBudget(size_t bytes)
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+	mMemoryBudget = bytes;
+	EvictToBudget();
+}
+size_t ModelManager::GetMemoryBudget() const
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+	return mMemoryBudget;
+}
+void ModelManager::SetBuildMissingMeshData(bool build)
+{
+	mBuildMissingMeshData = build;
+}
+size_t ModelManager::GetMemoryUsage() const
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+	return mMemoryUsage;
+}
+void ModelManager::DebugUI()
+{
+	if (ImGui::CollapsingHeader("Model Manager", ImGuiTreeNodeFlags_DefaultOpen))
+	{
+		constexpr float Megabyte = 1024.0f * 1024.0f;
+		std::lock_guard<std::mutex> lock(mMutex);
+		ImGui::Text("Memory: %.2f / %.2f MB", mMemoryUsage / Megabyte, mMemoryBudget / Megabyte);
+		ImGui::Text("Models: %zu, unreferenced: %zu", mInventory.Size(), mUnreferenced.size());
+		mInventory.ForEach([Megabyte](ModelId id, const Entry& entry)
+		{
+			if (entry.ready)
+			{
+				ImGui::Text("%s: %.2f MB, %u refs", entry.filePath.u8string().c_str(), entry.memoryUsage / Megabyte, entry.refCount);
+			}
+			else
+			{
+				ImGui::Text("%s: loading, %u refs", entry.filePath.u8string().c_str(), entry.refCount);
+			}
+		});
+	}
+}
+std::string ModelManager::GetPathKey(const std::filesystem::path& filePath) const
+{
+	return (mRootDirectory / filePath).lexically_normal().generic_u8string();
+}
+Model* ModelManager::AddReference(const std::filesystem::path& filePath, ModelId& id)
+{
+	auto [iter, success] = mIdsByPath.insert({ GetPathKey(filePath), 0 });
+	if (!success)
+	{
+		id = iter->second;
+		Entry* entry = mInventory.Get(id);
+		if (entry->refCount == 0 && entry->ready)
+		{
+			mUnreferenced.erase(entry->lruPosition);
+		}
+		++entry->refCount;
+		return nullptr;
+	}
+
+	Entry entry;
+	entry.model = std::make_unique<Model>();
+	entry.filePath = filePath;
+	entry.pathKey = iter->first;
+	entry.refCount = 1;
+	Model* model = entry.model.get();
+	id = mInventory.Emplace(std::move(entry));
+	iter->second = id;
+	return model;
+}
+void ModelManager::MarkReady(ModelId id, size_t memoryUsage)
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+	Entry* entry = mInventory.Get(id);
+	ASSERT(entry != nullptr, "ModelManager: a loading model was removed");
+	entry->ready = true;
+	entry->memoryUsage = memoryUsage;
+	mMemoryUsage += memoryUsage;
+	if (entry->refCount == 0)
+	{
+		// released while it was still loading
+		entry->lruPosition = mUnreferenced.insert(mUnreferenced.end(), id);
+	}
+	EvictToBudget();
+}
+void ModelManager::EvictToBudget()
+{
+	while (mMemoryUsage > mMemoryBudget && !mUnreferenced.empty())
+	{
+		const ModelId id = mUnreferenced.front();
+		mUnreferenced.pop_front();
+		Entry* entry = mInventory.Get(id);
+		mMemoryUsage -= entry->memoryUsage;
+		mIdsByPath.erase(entry->pathKey);
+		mInventory.Remove(id);
+	}
+}
@@ -0,0 +1,235 @@
+#include "Precompiled.h"
+#include "NullBackend.h"
+
+using namespace ML_Engine;
+using namespace ML_Engine::Graphics;
+
+HRESULT NullBackend::CreateBuffer(const D3D11_BUFFER_DESC* desc, const D3D11_SUBRESOURCE_DATA* initData, ID3D11Buffer** buffer)
+{
+	Record(GraphicsCommand::CreateBuffer, 0, (initData != nullptr) ? desc->ByteWidth : 0);
+	*buffer = nullptr;
+	return S_OK;
+}
+
+HRESULT NullBackend::CreateVertexShader(const void* byteCode, SIZE_T byteCodeLength, ID3D11VertexShader** shader)
+{
+	Record(GraphicsCommand::CreateShader);
+	*shader = nullptr;
+	return S_OK;
+}
+
+HRESULT NullBackend::CreatePixelShader(const void* byteCode, SIZE_T byteCodeLength, ID3D11PixelShader** shader)
+{
+	Record(GraphicsCommand::CreateShader);
+	*shader = nullptr;
+	return S_OK;
+}
+
+HRESULT NullBackend::CreateInputLayout(const D3D11_INPUT_ELEMENT_DESC* elements, UINT elementCount, const void* byteCode, SIZE_T byteCodeLength, ID3D11InputLayout** inputLayout)
+{
+	Record(GraphicsCommand::CreateInputLayout);
+	*inputLayout = nullptr;
+	return S_OK;
+}
+
+HRESULT NullBackend::CreateSamplerState(const D3D11_SAMPLER_DESC* desc, ID3D11SamplerState** sampler)
+{
+	Record(GraphicsCommand::CreateState);
+	*sampler = nullptr;
+	return S_OK;
+}
+
+HRESULT NullBackend::CreateBlendState(const D3D11_BLEND_DESC* desc, ID3D11BlendState** blendState)
+{
+	Record(GraphicsCommand::CreateState);
+	*blendState = nullptr;
+	return S_OK;
+}
+
+HRESULT NullBackend::CreateDepthStencilState(const D3D11_DEPTH_STENCIL_DESC* desc, ID3D11DepthStencilState** depthStencilState)
+{
+	Record(GraphicsCommand::CreateState);
+	*depthStencilState = nullptr;
+	return S_OK;
+}
+
+HRESULT NullBackend::CreateTexture2D(const D3D11_TEXTURE2D_DESC* desc, const D3D11_SUBRESOURCE_DATA* initData, ID3D11Texture2D** texture)
+{
+	Record(GraphicsCommand::CreateTexture);
+	*texture = nullptr;
+	return S_OK;
+}
+
+HRESULT NullBackend::CreateShaderResourceView(ID3D11Resource* resource, const D3D11_SHADER_RESOURCE_VIEW_DESC* desc, ID3D11ShaderResourceView** view)
+{
+	Record(GraphicsCommand::CreateView);
+	*view = nullptr;
+	return S_OK;
+}
+
+HRESULT NullBackend::CreateRenderTargetView(ID3D11Resource* resource, const D3D11_RENDER_TARGET_VIEW_DESC* desc, ID3D11RenderTargetView** view)
+{
+	Record(GraphicsCommand::CreateView);
+	*view = nullptr;
+	return S_OK;
+}
+
+HRESULT NullBackend::CreateDepthStencilView(ID3D11Resource* resource, const D3D11_DEPTH_STENCIL_VIEW_DESC* desc, ID3D11DepthStencilView** view)
+{
+	Record(GraphicsCommand::CreateView);
+	*view = nullptr;
+	return S_OK;
+}
+
+HRESULT NullBackend::CreateTextureFromFile(const std::filesystem::path& fileName, ID3D11ShaderResourceView** view)
+{
+	Record(GraphicsCommand::CreateTexture);
+	*view = nullptr;
+	// a missing file still fails so asset errors show up headless too
+	return std::filesystem::exists(fileName) ? S_OK : E_FAIL;
+}
+
+void NullBackend::UpdateSubresource(ID3D11Resource* resource, const void* data, size_t size)
+{
+	Record(GraphicsCommand::UpdateBuffer, 0, size);
+}
+
+void NullBackend::UpdateDynamicBuffer(ID3D11Buffer* buffer, const void* data, size_t size)
+{
+	Record(GraphicsCommand::UpdateBuffer, 0, size);
+}
+
+void NullBackend::VSSetConstantBuffers(UINT slot, UINT count, ID3D11Buffer* const* buffers)
+{
+	Record(GraphicsCommand::BindConstantBuffer);
+}
+
+void NullBackend::PSSetConstantBuffers(UINT slot, UINT count, ID3D11Buffer* const* buffers)
+{
+	Record(GraphicsCommand::BindConstantBuffer);
+}
+
+void NullBackend::VSSetShaderResources(UINT slot, UINT count, ID3D11ShaderResourceView* const* views)
+{
+	Record(GraphicsCommand::BindTexture);
+}
+
+void NullBackend::PSSetShaderResources(UINT slot, UINT count, ID3D11ShaderResourceView* const* views)
+{
+	Record(GraphicsCommand::BindTexture);
+}
+
+void NullBackend::VSSetSamplers(UINT slot, UINT count, ID3D11SamplerState* const* samplers)
+{
+	Record(GraphicsCommand::BindSampler);
+}
+
+void NullBackend::PSSetSamplers(UINT slot, UINT count, ID3D11SamplerState* const* samplers)
+{
+	Record(GraphicsCommand::BindSampler);
+}
+
+void NullBackend::VSSetShader(ID3D11VertexShader* shader)
+{
+	Record(GraphicsCommand::BindShader);
+}
+
+void NullBackend::PSSetShader(ID3D11PixelShader* shader)
+{
+	Record(GraphicsCommand::BindShader);
+}
+
+void NullBackend::IASetInputLayout(ID3D11InputLayout* inputLayout)
+{
+	Record(GraphicsCommand::BindInputLayout);
+}
+
+void NullBackend::IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY topology)
+{
+	Record(GraphicsCommand::BindTopology);
+}
+
+void NullBackend::IASetVertexBuffers(UINT slot, UINT count, ID3D11Buffer* const* buffers, const UINT* strides, const UINT* offsets)
+{
+	Record(GraphicsCommand::BindVertexBuffer);
+}
+
+void NullBackend::IASetIndexBuffer(ID3D11Buffer* buffer, DXGI_FORMAT format, UINT offset)
+{
+	Record(GraphicsCommand::BindIndexBuffer);
+}
+
+void NullBackend::OMSetBlendState(ID3D11BlendState* blendState)
+{
+	Record(GraphicsCommand::BindState);
+}
+
+void NullBackend::OMSetDepthStencilState(ID3D11DepthStencilState* depthStencilState)
+{
+	Record(GraphicsCommand::BindState);
+}
+
+void NullBackend::OMSetRenderTargets(UINT count, ID3D11RenderTargetView* const* views, ID3D11DepthStencilView* depthStencilView)
+{
+	Record(GraphicsCommand::BindRenderTarget);
+}
+
+void NullBackend::OMGetRenderTargets(UINT count, ID3D11RenderTargetView** views, ID3D11DepthStencilView** depthStencilView)
+{
+	for (UINT i = 0; i < count; ++i)
+	{
+		views[i] = nullptr;
+	}
+	if (depthStencilView != nullptr)
+	{
+		*depthStencilView = nullptr;
+	}
+}
+
+void NullBackend::RSSetViewports(UINT count, const D3D11_VIEWPORT* viewports)
+{
+	Record(GraphicsCommand::SetViewport);
+	if (count > 0)
+	{
+		mViewport = viewports[0];
+	}
+}
+
+void NullBackend::RSGetViewports(UINT* count, D3D11_VIEWPORT* viewports)
+{
+	if (*count > 0)
+	{
+		viewports[0] = mViewport;
+		*count = 1;
+	}
+}
+
+void NullBackend::ClearRenderTargetView(ID3D11RenderTargetView* view, const FLOAT color[4])
+{
+	Record(GraphicsCommand::Clear);
+}
+
+void NullBackend::ClearDepthStencilView(ID3D11DepthStencilView* view, UINT flags, FLOAT depth, UINT8 stencil)
+{
+	Record(GraphicsCommand::Clear);
+}
+
+void NullBackend::Draw(UINT vertexCount, UINT startVertex)
+{
+	Record(GraphicsCommand::Draw, vertexCount);
+}
+
+void NullBackend::DrawIndexed(UINT indexCount, UINT startIndex, INT baseVertex)
+{
+	Record(GraphicsCommand::DrawIndexed, indexCount);
+}
+
+void NullBackend::DrawInstanced(UINT vertexCount, UINT instanceCount, UINT startVertex, UINT startInstance)
+{
+	Record(GraphicsCommand::DrawInstanced, static_cast<uint64_t>(vertexCount) * instanceCount);
+}
+
+void NullBackend::DrawIndexedInstanced(UINT indexCount, UINT instanceCount, UINT startIndex, INT baseVertex, UINT startInstance)
+{
+	Record(GraphicsCommand::DrawIndexedInstanced, static_cast<uint64_t>(indexCount) * instanceCount);
+}
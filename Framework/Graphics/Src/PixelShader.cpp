@@ -2,22 +2,25 @@
 #include "PixelShader.h"
 
 #include "GraphicsSystem.h"
+#include "VertexTypes.h"
 
 using namespace ML_Engine;
 using namespace ML_Engine::Graphics;
 
 
-void PixelShader::Initialize(const std::filesystem::path& shaderPath)
+void PixelShader::Initialize(const std::filesystem::path& shaderPath, uint32_t format)
 {
-    auto device = GraphicsSystem::Get()->GetDevice();
+    auto backend = GraphicsSystem::Get()->GetBackend();
     DWORD shaderFlags = D3DCOMPILE_ENABLE_STRICTNESS | D3DCOMPILE_DEBUG;
     ID3DBlob* shaderBlob = nullptr;
     ID3DBlob* errorBlob = nullptr;
 
+    const D3D_SHADER_MACRO instancedDefines[] = { { "INSTANCED", "1" }, { nullptr, nullptr } };
+
     // BIND TO PIXEL FUNCTION IN SPECIFIED SHADER FILE
     HRESULT hr = D3DCompileFromFile(
         shaderPath.c_str(),
-        nullptr,
+        (format & VE_Instanced) ? instancedDefines : nullptr,
         D3D_COMPILE_STANDARD_FILE_INCLUDE,
         "PS", "ps_5_0",
         shaderFlags, 0,
@@ -29,10 +32,9 @@ void PixelShader::Initialize(const std::filesystem::path& shaderPath)
     }
     ASSERT(SUCCEEDED(hr), "Failed to compile pixel shader");
 
-    hr = device->CreatePixelShader(
+    hr = backend->CreatePixelShader(
         shaderBlob->GetBufferPointer(),
         shaderBlob->GetBufferSize(),
-        nullptr,
         &mPixelShader);
     ASSERT(SUCCEEDED(hr), "Failed to create pixel shader");
     SafeRelease(shaderBlob);
@@ -40,10 +42,14 @@ void PixelShader::Initialize(const std::filesystem::path& shaderPath)
 }
 void PixelShader::Terminate()
 {
+    GraphicsSystem::Get()->GetStateCache()->Forget(this);
     SafeRelease(mPixelShader);
 }
 void PixelShader::Bind()
 {
-    auto context = GraphicsSystem::Get()->GetContext();
-    context->PSSetShader(mPixelShader, nullptr, 0);
+    GraphicsSystem* gs = GraphicsSystem::Get();
+    if (gs->GetStateCache()->SetPixelShader(this))
+    {
+        gs->GetBackend()->PSSetShader(mPixelShader);
+    }
 }
\ No newline at end of file
@@ -1,9 +1,81 @@
 #include "Precompiled.h"
 #include "RenderObject.h"
+#include "MeshBuilder.h"
 
 using namespace ML_Engine;
 using namespace ML_Engine::Graphics;
 
+void RenderObject::InitializeMesh(const Model::MeshData& meshData)
+{
+	if (meshData.positionStream.empty())
+	{
+		if (meshData.packed)
+		{
+			InitializeMesh(VertexPacking::PackMesh(meshData.mesh), meshData.lods);
+		}
+		else
+		{
+			InitializeMesh(meshData.mesh, meshData.lods);
+		}
+		return;
+	}
+
+	uint32_t positionSize = 0;
+	uint32_t vertexSize = 0;
+	if (meshData.packed)
+	{
+		vertexFormat = VertexPacked::Format;
+		positionSize = static_cast<uint32_t>(sizeof(VertexPacked::position));
+		vertexSize = static_cast<uint32_t>(sizeof(VertexPacked));
+		bounds = Math::ComputeSphere(meshData.positionBounds);
+		positionScale = VertexPacking::GetPositionScale(meshData.positionBounds);
+		positionOffset = VertexPacking::GetPositionOffset(meshData.positionBounds);
+	}
+	else
+	{
+		vertexFormat = Vertex::Format;
+		positionSize = static_cast<uint32_t>(sizeof(Vertex::position));
+		vertexSize = static_cast<uint32_t>(sizeof(Vertex));
+	}
+	const uint32_t attributeSize = vertexSize - positionSize;
+	const uint32_t vertexCount = static_cast<uint32_t>(meshData.positionStream.size() / positionSize);
+	ASSERT(meshData.positionStream.size() == static_cast<size_t>(positionSize) * vertexCount &&
+		meshData.attributeStream.size() == static_cast<size_t>(attributeSize) * vertexCount &&
+		(meshData.mesh.vertices.empty() || meshData.mesh.vertices.size() == vertexCount),
+		"RenderObject: the stored streams do not match the mesh");
+	if (!meshData.packed)
+	{
+		const Math::Vector3* positions = reinterpret_cast<const Math::Vector3*>(meshData.positionStream.data());
+		bounds = Math::ComputeSphere(Math::ComputeAABB(positions, vertexCount));
+	}
+
+	if (!meshData.indexStream.empty())
+	{
+		// the stored index block, already at its upload width with the lods after the mesh
+		const IndexFormat indexFormat = (meshData.indexSize == sizeof(uint16_t)) ? IndexFormat::UInt16 : IndexFormat::UInt32;
+		lods.clear();
+		if (meshData.indexRanges.size() > 1)
+		{
+			lods = meshData.indexRanges;
+		}
+		meshBuffer.InitializeStreams(meshData.positionStream.data(), positionSize,
+			meshData.attributeStream.data(), attributeSize,
+			vertexCount,
+			meshData.indexStream.data(), indexFormat,
+			meshData.indexRanges[0].indexCount,
+			static_cast<uint32_t>(meshData.indexStream.size() / meshData.indexSize));
+		return;
+	}
+
+	std::vector<uint32_t> indices;
+	BuildLodRanges(meshData.mesh.indices, meshData.lods, indices);
+	meshBuffer.InitializeStreams(meshData.positionStream.data(), positionSize,
+		meshData.attributeStream.data(), attributeSize,
+		vertexCount,
+		indices.data(),
+		static_cast<uint32_t>(meshData.mesh.indices.size()),
+		static_cast<uint32_t>(indices.size()));
+}
 void RenderObject::Terminate()
 {
 	meshBuffer.Terminate();
@@ -14,11 +86,63 @@ void RenderObject::Terminate()
 	tm->ReleaseTexture(bumpMapId);
 }
 
+void RenderObject::BuildLodRanges(const std::vector<uint32_t>& meshIndices, const std::vector<MeshLod>& meshLods, std::vector<uint32_t>& indices)
+{
+	lods.clear();
+	indices = meshIndices;
+	if (meshLods.empty())
+	{
+		return;
+	}
+
+	lods.push_back({ 0, static_cast<uint32_t>(meshIndices.size()), 0.0f });
+	for (const MeshLod& meshLod : meshLods)
+	{
+		lods.push_back({ static_cast<uint32_t>(indices.size()), static_cast<uint32_t>(meshLod.indices.size()), meshLod.error });
+		indices.insert(indices.end(), meshLod.indices.begin(), meshLod.indices.end());
+	}
+}
+
 void RenderGroup::Initialize(const std::filesystem::path& modelFilePath)
 {
 	modelId = ModelManager::Get()->LoadModel(modelFilePath);
 	const Model* model = ModelManager::Get()->GetModel(modelId);
 	ASSERT(model != nullptr, "RenderGroup: model %s did not load", modelFilePath.u8string().c_str());
+	CreateRenderObjects(*model);
+}
+void RenderGroup::InitializeAsync(const std::filesystem::path& modelFilePath)
+{
+	InitializeAsync(modelFilePath, MeshBuilder::CreateSphere(8, 8, 0.25f));
+}
+void RenderGroup::InitializeAsync(const std::filesystem::path& modelFilePath, const Mesh& placeholderMesh)
+{
+	modelId = ModelManager::Get()->LoadModelAsync(modelFilePath);
+	mLoading = true;
+	RenderObject& placeholder = renderObjects.emplace_back();
+	placeholder.InitializeMesh(placeholderMesh);
+	Update();
+}
+bool RenderGroup::Update()
+{
+	if (!mLoading)
+	{
+		return true;
+	}
+
+	const Model* model = ModelManager::Get()->GetModel(modelId);
+	if (model == nullptr)
+	{
+		return false;
+	}
+
+	// gpu buffers and textures are created here on the render thread
+	TerminateRenderObjects();
+	CreateRenderObjects(*model);
+	return true;
+}
+void RenderGroup::CreateRenderObjects(const Model& model)
+{
+	mLoading = false;
 
 	auto TryLoadTexture = [](const auto& textureName)->TextureId
 	{
@@ -30,14 +154,15 @@ void RenderGroup::Initialize(const std::filesystem::path& modelFilePath)
 		return TextureManager::Get()->LoadTexture(textureName, false);
 	};
 
-	for (const Model::MeshData& meshData : model->meshData)
+	for (const Model::MeshData& meshData : model.meshData)
 	{
 		RenderObject& renderObject = renderObjects.emplace_back();
-		renderObject.meshBuffer.Initialize(meshData.mesh);
-		if (meshData.materialIndex < model->materialData.size())
+		renderObject.InitializeMesh(meshData);
+		renderObject.meshlets = meshData.meshlets;
+		if (meshData.materialIndex < model.materialData.size())
 		{
 			// add material data
-			const Model::MaterialData& materialData = model->materialData[meshData.materialIndex];
+			const Model::MaterialData& materialData = model.materialData[meshData.materialIndex];
 			renderObject.material = materialData.material;
 
 			renderObject.diffuseMapId = TryLoadTexture(materialData.diffuseMapName);
@@ -48,6 +173,16 @@ void RenderGroup::Initialize(const std::filesystem::path& modelFilePath)
 	}
 }
 void RenderGroup::Terminate()
+{
+	TerminateRenderObjects();
+	if (modelId != 0)
+	{
+		ModelManager::Get()->ReleaseModel(modelId);
+		modelId = 0;
+	}
+	mLoading = false;
+}
+void RenderGroup::TerminateRenderObjects()
 {
 	for (RenderObject& renderObject : renderObjects)
 	{
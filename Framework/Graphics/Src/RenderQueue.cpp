@@ -0,0 +1,128 @@
+#include "Precompiled.h"
+#include "RenderQueue.h"
+
+#include "RenderObject.h"
+
+using namespace ML_Engine;
+using namespace ML_Engine::Graphics;
+
+namespace
+{
+	constexpr uint32_t EffectShift = 60;
+	constexpr uint32_t ShaderVariantShift = 56;
+	constexpr uint32_t MaterialShift = 40;
+	constexpr uint32_t TextureSetShift = 16;
+
+	constexpr uint64_t ShaderVariantMask = 0xf;
+	constexpr uint64_t MaterialMask = 0xffff;
+	constexpr uint64_t TextureSetMask = 0xffffff;
+	constexpr float DepthRange = 65535.0f;
+
+	// folds the high bits in so the truncated hash still depends on all of them
+	uint64_t FoldHash(uint64_t hash, uint32_t bits)
+	{
+		uint64_t folded = 0;
+		for (uint32_t shift = 0; shift < 64; shift += bits)
+		{
+			folded ^= hash >> shift;
+		}
+		return folded & ((1ull << bits) - 1);
+	}
+}
+
+uint64_t RenderQueue::MakeSortKey(QueueEffect effect, uint32_t shaderVariant, const RenderObject& renderObject, float depth)
+{
+	const TextureId textures[] = { renderObject.diffuseMapId, renderObject.specMapId, renderObject.normalMapId, renderObject.bumpMapId };
+	const uint64_t material = FoldHash(Core::HashBytes(&renderObject.material, sizeof(Material)), 16);
+	const uint64_t textureSet = FoldHash(Core::HashBytes(textures, sizeof(textures)), 24);
+	const uint64_t depthBits = static_cast<uint64_t>(Math::Clamp(depth, 0.0f, 1.0f) * DepthRange);
+
+	return (static_cast<uint64_t>(effect) << EffectShift)
+		| ((shaderVariant & ShaderVariantMask) << ShaderVariantShift)
+		| ((material & MaterialMask) << MaterialShift)
+		| ((textureSet & TextureSetMask) << TextureSetShift)
+		| depthBits;
+}
+
+QueueEffect RenderQueue::GetEffect(uint64_t sortKey)
+{
+	return static_cast<QueueEffect>(sortKey >> EffectShift);
+}
+
+void RenderQueue::Clear()
+{
+	mPackets.clear();
+}
+
+void RenderQueue::Add(uint64_t sortKey, const RenderObject& renderObject, const Math::Matrix4& matWorld)
+{
+	DrawPacket& packet = mPackets.emplace_back();
+	packet.sortKey = sortKey;
+	packet.renderObject = &renderObject;
+	packet.matWorld = matWorld;
+}
+
+void RenderQueue::Sort()
+{
+	const size_t count = mPackets.size();
+	if (count < 2)
+	{
+		return;
+	}
+
+	// sort the keys with an index, the packets are moved once at the end
+	mEntries.resize(count);
+	mScratch.resize(count);
+	for (size_t i = 0; i < count; ++i)
+	{
+		mEntries[i] = { mPackets[i].sortKey, static_cast<uint32_t>(i) };
+	}
+
+	for (uint32_t shift = 0; shift < 64; shift += 8)
+	{
+		std::array<uint32_t, 256> offsets{};
+		for (const SortEntry& entry : mEntries)
+		{
+			++offsets[(entry.sortKey >> shift) & 0xff];
+		}
+		if (offsets[(mEntries[0].sortKey >> shift) & 0xff] == count)
+		{
+			continue;
+		}
+
+		uint32_t offset = 0;
+		for (uint32_t& digitOffset : offsets)
+		{
+			const uint32_t digitCount = digitOffset;
+			digitOffset = offset;
+			offset += digitCount;
+		}
+		for (const SortEntry& entry : mEntries)
+		{
+			mScratch[offsets[(entry.sortKey >> shift) & 0xff]++] = entry;
+		}
+		mEntries.swap(mScratch);
+	}
+
+	mSortedPackets.resize(count);
+	for (size_t i = 0; i < count; ++i)
+	{
+		mSortedPackets[i] = mPackets[mEntries[i].packetIndex];
+	}
+	mPackets.swap(mSortedPackets);
+}
+
+const std::vector<DrawPacket>& RenderQueue::GetPackets() const
+{
+	return mPackets;
+}
+
+size_t RenderQueue::Size() const
+{
+	return mPackets.size();
+}
+
+bool RenderQueue::Empty() const
+{
+	return mPackets.empty();
+}
@@ -46,25 +46,25 @@ void RenderTarget::Initialize(uint32_t width, uint32_t height, Format format)
 	desc.CPUAccessFlags = 0;
 	desc.MiscFlags = 0;
 
-	auto device = GraphicsSystem::Get()->GetDevice();
+	auto backend = GraphicsSystem::Get()->GetBackend();
 	ID3D11Texture2D* texture = nullptr;
-	HRESULT hr = device->CreateTexture2D(&desc, nullptr, &texture);
+	HRESULT hr = backend->CreateTexture2D(&desc, nullptr, &texture);
 	ASSERT(SUCCEEDED(hr), "RenderTarget: failed to create texture");
 
-	hr = device->CreateShaderResourceView(texture, nullptr, &mShaderResourceView);
+	hr = backend->CreateShaderResourceView(texture, nullptr, &mShaderResourceView);
 	ASSERT(SUCCEEDED(hr), "RenderTarget: failed to create shader resource view");
 
-	hr = device->CreateRenderTargetView(texture, nullptr, &mRenderTargetView);
+	hr = backend->CreateRenderTargetView(texture, nullptr, &mRenderTargetView);
 	ASSERT(SUCCEEDED(hr), "RenderTarget: failed to create render target view");
 
 	SafeRelease(texture);
 
 	desc.Format = DXGI_FORMAT_D24_UNORM_S8_UINT;
 	desc.BindFlags = D3D11_BIND_DEPTH_STENCIL;
-	hr = device->CreateTexture2D(&desc, nullptr, &texture);
+	hr = backend->CreateTexture2D(&desc, nullptr, &texture);
 	ASSERT(SUCCEEDED(hr), "RenderTarget: failed to create depth stencil texture");
 
-	hr = device->CreateDepthStencilView(texture, nullptr, &mDepthStencilView);
+	hr = backend->CreateDepthStencilView(texture, nullptr, &mDepthStencilView);
 	ASSERT(SUCCEEDED(hr), "RenderTarget: failed to create depth stencil view");
 
 	SafeRelease(texture);
@@ -87,25 +87,27 @@ void RenderTarget::Terminate()
 
 void RenderTarget::BeginRender(Color clearColor)
 {
-	auto context = GraphicsSystem::Get()->GetContext();
+	auto backend = GraphicsSystem::Get()->GetBackend();
 
 	// store the current versions
 	UINT numViewports = 1;
-	context->OMGetRenderTargets(1, &mOldRenderTargetView, &mOldDepthStencilView);
-	context->RSGetViewports(&numViewports, &mOldViewport);
+	backend->OMGetRenderTargets(1, &mOldRenderTargetView, &mOldDepthStencilView);
+	backend->RSGetViewports(&numViewports, &mOldViewport);
 
 	// apply render target versions
-	context->ClearRenderTargetView(mRenderTargetView, &clearColor.r);
-	context->ClearDepthStencilView(mDepthStencilView, D3D11_CLEAR_DEPTH, 1.0f, 0.0f);
-	context->OMSetRenderTargets(1, &mRenderTargetView, mDepthStencilView);
-	context->RSSetViewports(1, &mViewport);
+	backend->ClearRenderTargetView(mRenderTargetView, &clearColor.r);
+	backend->ClearDepthStencilView(mDepthStencilView, D3D11_CLEAR_DEPTH, 1.0f, 0);
+	backend->OMSetRenderTargets(1, &mRenderTargetView, mDepthStencilView);
+	backend->RSSetViewports(1, &mViewport);
+	// d3d unbinds the texture from every stage it was read in
+	GraphicsSystem::Get()->GetStateCache()->Forget(this);
 }
 
 void RenderTarget::EndRender()
 {
-	auto context = GraphicsSystem::Get()->GetContext();
-	context->OMSetRenderTargets(1, &mOldRenderTargetView, mOldDepthStencilView);
-	context->RSSetViewports(1, &mOldViewport);
+	auto backend = GraphicsSystem::Get()->GetBackend();
+	backend->OMSetRenderTargets(1, &mOldRenderTargetView, mOldDepthStencilView);
+	backend->RSSetViewports(1, &mOldViewport);
 	SafeRelease(mOldRenderTargetView);
 	SafeRelease(mOldDepthStencilView);
 }
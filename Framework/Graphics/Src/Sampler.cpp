@@ -59,24 +59,31 @@ void Sampler::Initialize(Filter filter, AddressMode addressMode)
 	desc.MinLOD = 0;
 	desc.MaxLOD = D3D11_FLOAT32_MAX;
 
-	auto device = GraphicsSystem::Get()->GetDevice();
-	HRESULT hr = device->CreateSamplerState(&desc, &mSampler);
+	auto backend = GraphicsSystem::Get()->GetBackend();
+	HRESULT hr = backend->CreateSamplerState(&desc, &mSampler);
 	ASSERT(SUCCEEDED(hr), "Sampler: failed to create sampler state");
 }
 
 void Sampler::Terminate()
 {
+	GraphicsSystem::Get()->GetStateCache()->Forget(this);
 	SafeRelease(mSampler);
 }
 
 void Sampler::BindVS(uint32_t slot) const
 {
-	auto context = GraphicsSystem::Get()->GetContext();
-	context->VSSetSamplers(slot, 1, &mSampler);
+	GraphicsSystem* gs = GraphicsSystem::Get();
+	if (gs->GetStateCache()->SetSampler(ShaderStage::Vertex, slot, this))
+	{
+		gs->GetBackend()->VSSetSamplers(slot, 1, &mSampler);
+	}
 }
 
 void Sampler::BindPS(uint32_t slot) const
 {
-	auto context = GraphicsSystem::Get()->GetContext();
-	context->PSSetSamplers(slot, 1, &mSampler);
+	GraphicsSystem* gs = GraphicsSystem::Get();
+	if (gs->GetStateCache()->SetSampler(ShaderStage::Pixel, slot, this))
+	{
+		gs->GetBackend()->PSSetSamplers(slot, 1, &mSampler);
+	}
 }
\ No newline at end of file
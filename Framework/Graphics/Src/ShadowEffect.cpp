@@ -10,7 +10,11 @@ using namespace ML_Engine::Graphics;
 void ShadowEffect::Initialize()
 {
 	std::filesystem::path shaderFile = L"../../Assets/Shaders/Shadow.fx";
-	mVertexShader.Initialize<Vertex>(shaderFile);
+	// the depth pass only reads positions, whatever else the meshes carry
+	mVertexShader.Initialize<VertexP>(shaderFile);
+	mPackedVertexShader.Initialize(shaderFile, VE_Position | VE_Packed);
+	mInstancedVertexShader.Initialize(shaderFile, VE_Position | VE_Instanced);
+	mInstancedPackedVertexShader.Initialize(shaderFile, VE_Position | VE_Packed | VE_Instanced);
 	mPixelShader.Initialize(shaderFile);
 	mTransformBuffer.Initialize();
 
@@ -27,6 +31,9 @@ void ShadowEffect::Terminate()
 	mDepthMapRenderTarget.Terminate();
 	mTransformBuffer.Terminate();
 	mPixelShader.Terminate();
+	mInstancedPackedVertexShader.Terminate();
+	mInstancedVertexShader.Terminate();
+	mPackedVertexShader.Terminate();
 	mVertexShader.Terminate();
 }
 void ShadowEffect::Begin()
@@ -45,29 +52,49 @@ void ShadowEffect::End()
 }
 void ShadowEffect::Render(const RenderObject& renderObject)
 {
-	const Math::Matrix4 matWorld = renderObject.transform.GetMatrix4();
+	const Math::Matrix4 matWorld = GetWorldMatrix(mTransformHierarchy, renderObject.transformId, renderObject.transform);
 	const Math::Matrix4 matView = mLightCamera.GetViewMatrix();
 	const Math::Matrix4 matProj = mLightCamera.GetProjectionMatrix();
 
 	TransformData data;
 	data.wvp = Math::Transpose(matWorld * matView * matProj);
+	data.positionScale = renderObject.positionScale;
+	data.positionOffset = renderObject.positionOffset;
 	mTransformBuffer.Update(data);
-	renderObject.meshBuffer.Render();
+	BindVertexShader(renderObject);
+	renderObject.meshBuffer.RenderPositions();
 }
 void ShadowEffect::Render(const RenderGroup& renderGroup)
 {
-	const Math::Matrix4 matWorld = renderGroup.transform.GetMatrix4();
+	const Math::Matrix4 matWorld = GetWorldMatrix(mTransformHierarchy, renderGroup.transformId, renderGroup.transform);
 	const Math::Matrix4 matView = mLightCamera.GetViewMatrix();
 	const Math::Matrix4 matProj = mLightCamera.GetProjectionMatrix();
 
 	TransformData data;
 	data.wvp = Math::Transpose(matWorld * matView * matProj);
-	mTransformBuffer.Update(data);
 	for (const RenderObject& renderObject : renderGroup.renderObjects)
 	{
-		renderObject.meshBuffer.Render();
+		data.positionScale = renderObject.positionScale;
+		data.positionOffset = renderObject.positionOffset;
+		mTransformBuffer.Update(data);
+		BindVertexShader(renderObject);
+		renderObject.meshBuffer.RenderPositions();
 	}
 }
+void ShadowEffect::RenderInstanced(const RenderObject& renderObject, const InstanceBuffer& instances)
+{
+	const Math::Matrix4 matView = mLightCamera.GetViewMatrix();
+	const Math::Matrix4 matProj = mLightCamera.GetProjectionMatrix();
+
+	// the world matrix comes with each instance
+	TransformData data;
+	data.wvp = Math::Transpose(matView * matProj);
+	data.positionScale = renderObject.positionScale;
+	data.positionOffset = renderObject.positionOffset;
+	mTransformBuffer.Update(data);
+	BindVertexShader(renderObject, true);
+	renderObject.meshBuffer.RenderPositionsInstanced(instances);
+}
 void ShadowEffect::DebugUI()
 {
 	if (ImGui::CollapsingHeader("Shadow Effect", ImGuiTreeNodeFlags_DefaultOpen))
@@ -96,6 +123,10 @@ void ShadowEffect::SetSize(float size)
 {
 	mSize = size;
 }
+void ShadowEffect::SetTransformHierarchy(const TransformHierarchy* hierarchy)
+{
+	mTransformHierarchy = hierarchy;
+}
 const Camera& ShadowEffect::GetLightCamera() const
 {
 	return mLightCamera;
@@ -104,6 +135,14 @@ const Texture& ShadowEffect::GetDepthMap() const
 {
 	return mDepthMapRenderTarget;
 }
+void ShadowEffect::BindVertexShader(const RenderObject& renderObject, bool instanced)
+{
+	const bool isPacked = (renderObject.vertexFormat & VE_Packed) != 0;
+	VertexShader& vertexShader = instanced
+		? (isPacked ? mInstancedPackedVertexShader : mInstancedVertexShader)
+		: (isPacked ? mPackedVertexShader : mVertexShader);
+	vertexShader.Bind();
+}
 void ShadowEffect::UpdateLightCamera()
 {
 	ASSERT(mDirectionalLight != nullptr, "ShadowEffect: no light set");
@@ -23,8 +23,8 @@ namespace
 		void Initialize(uint32_t maxVertexCount);
 		void Terminate();
 
-		void AddLine(const Vector3& v0, const Vector3& v1, const Color& color);
-		void AddFace(const Vector3& v0, const Vector3& v1, const Vector3& v2, const Color& color);
+		void AddLine(const Vector3& v0, const Vector3& v1, PackedColor color);
+		void AddFace(const Vector3& v0, const Vector3& v1, const Vector3& v2, PackedColor color);
 		void Render(const Camera& camera);
 	private:
 		VertexShader mVertexShader;
@@ -33,8 +33,9 @@ namespace
 		MeshBuffer mMeshBuffer;
 		BlendState mBlendState;
 
-		std::unique_ptr<VertexPC[]> mLineVertices;
-		std::unique_ptr<VertexPC[]> mFaceVertices;
+		// packed colors keep the per frame upload to 16 bytes a vertex
+		std::unique_ptr<VertexPCPacked[]> mLineVertices;
+		std::unique_ptr<VertexPCPacked[]> mFaceVertices;
 		uint32_t mLineVertexCount = 0;
 		uint32_t mFaceVertexCount = 0;
 		uint32_t mMaxVertexCount = 0;
@@ -43,14 +44,14 @@ namespace
 	void SimpleDrawImpl::Initialize(uint32_t maxVertexCount)
 	{
 		std::filesystem::path shaderPath = L"../../Assets/Shaders/SimpleDraw.fx";
-		mVertexShader.Initialize<VertexPC>(shaderPath);
+		mVertexShader.Initialize<VertexPCPacked>(shaderPath);
 		mPixelShader.Initialize(shaderPath);
 		mConstantBuffer.Initialize(sizeof(Matrix4));
-		mMeshBuffer.Initialize(nullptr, sizeof(VertexPC), maxVertexCount);
+		mMeshBuffer.Initialize(nullptr, sizeof(VertexPCPacked), maxVertexCount);
 		mBlendState.Initialize(BlendState::Mode::AlphaBlend);
 
-		mLineVertices = std::make_unique<VertexPC[]>(maxVertexCount);
-		mFaceVertices = std::make_unique<VertexPC[]>(maxVertexCount);
+		mLineVertices = std::make_unique<VertexPCPacked[]>(maxVertexCount);
+		mFaceVertices = std::make_unique<VertexPCPacked[]>(maxVertexCount);
 		mLineVertexCount = 0;
 		mFaceVertexCount = 0;
 		mMaxVertexCount = maxVertexCount;
@@ -63,7 +64,7 @@ namespace
 		mVertexShader.Terminate();
 		mBlendState.Terminate();
 	}
-	void SimpleDrawImpl::AddLine(const Vector3& v0, const Vector3& v1, const Color& color)
+	void SimpleDrawImpl::AddLine(const Vector3& v0, const Vector3& v1, PackedColor color)
 	{
 		if (mLineVertexCount + 2 <= mMaxVertexCount)
 		{
@@ -71,7 +72,7 @@ namespace
 			mLineVertices[mLineVertexCount++] = { v1, color };
 		}
 	}
-	void SimpleDrawImpl::AddFace(const Vector3& v0, const Vector3& v1, const Vector3& v2, const Color& color)
+	void SimpleDrawImpl::AddFace(const Vector3& v0, const Vector3& v1, const Vector3& v2, PackedColor color)
 	{
 		if (mFaceVertexCount + 3 <= mMaxVertexCount)
 		{
@@ -126,12 +127,12 @@ void SimpleDraw::StaticTerminate()
 
 void SimpleDraw::AddLine(const Math::Vector3& v0, const Math::Vector3& v1, const Color& color)
 {
-	sInstance->AddLine(v0, v1, color);
+	sInstance->AddLine(v0, v1, PackColor(color));
 }
 
 void SimpleDraw::AddFace(const Math::Vector3& v0, const Math::Vector3& v1, const Math::Vector3& v2, const Color& color)
 {
-	sInstance->AddFace(v0, v1, v2, color);
+	sInstance->AddFace(v0, v1, v2, PackColor(color));
 }
 
 void SimpleDraw::AddAABB(const Vector3& min, const Vector3& max, const Color& color)
@@ -141,6 +142,7 @@ void SimpleDraw::AddAABB(const Vector3& min, const Vector3& max, const Color& co
 
 void SimpleDraw::AddAABB(float minX, float minY, float minZ, float maxX, float maxY, float maxZ, const Color& color)
 {
+	const PackedColor packedColor = PackColor(color);
 	const Vector3 trf = { maxX, maxY, minZ };
 	const Vector3 brf = { maxX, minY, minZ };
 	const Vector3 tlf = { minX, maxY, minZ };
@@ -152,24 +154,24 @@ void SimpleDraw::AddAABB(float minX, float minY, float minZ, float maxX, float m
 	const Vector3 blb = { minX, minY, maxZ };
 	
 	// front
-	AddLine(trf, brf, color);
-	AddLine(brf, blf, color);
-	AddLine(blf, tlf, color);
-	AddLine(tlf, trf, color);
+	sInstance->AddLine(trf, brf, packedColor);
+	sInstance->AddLine(brf, blf, packedColor);
+	sInstance->AddLine(blf, tlf, packedColor);
+	sInstance->AddLine(tlf, trf, packedColor);
 
 	// back
-	AddLine(trb, brb, color);
-	AddLine(brb, blb, color);
-	AddLine(blb, tlb, color);
-	AddLine(tlb, trb, color);
+	sInstance->AddLine(trb, brb, packedColor);
+	sInstance->AddLine(brb, blb, packedColor);
+	sInstance->AddLine(blb, tlb, packedColor);
+	sInstance->AddLine(tlb, trb, packedColor);
 
 	// top
-	AddLine(trb, trf, color);
-	AddLine(tlb, tlf, color);
+	sInstance->AddLine(trb, trf, packedColor);
+	sInstance->AddLine(tlb, tlf, packedColor);
 
 	// bottom
-	AddLine(brb, brf, color);
-	AddLine(blb, blf, color);
+	sInstance->AddLine(brb, brf, packedColor);
+	sInstance->AddLine(blb, blf, packedColor);
 }
 
 void SimpleDraw::AddFilledAABB(const Vector3& min, const Vector3& max, const Color& color)
@@ -179,6 +181,7 @@ void SimpleDraw::AddFilledAABB(const Vector3& min, const Vector3& max, const Col
 
 void SimpleDraw::AddFilledAABB(float minX, float minY, float minZ, float maxX, float maxY, float maxZ, const Color& color)
 {
+	const PackedColor packedColor = PackColor(color);
 	const Vector3 trf = { maxX, maxY, minZ };
 	const Vector3 brf = { maxX, minY, minZ };
 	const Vector3 tlf = { minX, maxY, minZ };
@@ -190,32 +193,33 @@ void SimpleDraw::AddFilledAABB(float minX, float minY, float minZ, float maxX, f
 	const Vector3 blb = { minX, minY, maxZ };
 
 	// front
-	AddFace(trf, brf, blf, color);
-	AddFace(trf, blf, tlf, color);
+	sInstance->AddFace(trf, brf, blf, packedColor);
+	sInstance->AddFace(trf, blf, tlf, packedColor);
 
 	// back
-	AddFace(trb, tlb, blb, color);
-	AddFace(trb, blb, brb, color);
+	sInstance->AddFace(trb, tlb, blb, packedColor);
+	sInstance->AddFace(trb, blb, brb, packedColor);
 
 	// top
-	AddFace(trb, trf, tlf, color);
-	AddFace(trb, tlf, tlb, color);
+	sInstance->AddFace(trb, trf, tlf, packedColor);
+	sInstance->AddFace(trb, tlf, tlb, packedColor);
 
 	// bottom
-	AddFace(brb, blf, brf, color);
-	AddFace(brb, blb, blf, color);
+	sInstance->AddFace(brb, blf, brf, packedColor);
+	sInstance->AddFace(brb, blb, blf, packedColor);
 
 	// right
-	AddFace(trb, brb, brf, color);
-	AddFace(trb, brf, trf, color);
+	sInstance->AddFace(trb, brb, brf, packedColor);
+	sInstance->AddFace(trb, brf, trf, packedColor);
 
 	// left
-	AddFace(tlb, blf, blb, color);
-	AddFace(tlb, tlf, blf, color);
+	sInstance->AddFace(tlb, blf, blb, packedColor);
+	sInstance->AddFace(tlb, tlf, blf, packedColor);
 }
 
 void SimpleDraw::AddSphere(uint32_t slices, uint32_t rings, float radius, const Color& color, const Math::Vector3& origin)
 {
+	const PackedColor packedColor = PackColor(color);
 	Vector3 v0 = Vector3::Zero;
 	Vector3 v1 = Vector3::Zero;
 	
@@ -243,30 +247,32 @@ void SimpleDraw::AddSphere(uint32_t slices, uint32_t rings, float radius, const
 					radius * cos(phi0),
 					radius * cos(rot1) * sin(phi0)
 			};
-			AddLine(v0 + origin, v1 + origin, color);
+			sInstance->AddLine(v0 + origin, v1 + origin, packedColor);
 
 			v1 = {  radius * sin(rot0) * sin(phi1),
 					radius * cos(phi1),
 					radius * cos(rot0) * sin(phi1)
 			};
-			AddLine(v0 + origin, v1 + origin, color);
+			sInstance->AddLine(v0 + origin, v1 + origin, packedColor);
 		}
 	}
 }
 
 void SimpleDraw::AddGroundPlane(float size, const Color& color)
 {
+	const PackedColor packedColor = PackColor(color);
 	const float hs = size * 0.5f;
 	const uint32_t iSize = static_cast<uint32_t>(size);
 	for (uint32_t i = 0; i <= iSize; ++i)
 	{
-		AddLine({ i - hs, 0.0f, -hs }, { i - hs, 0.0f, hs }, color);
-		AddLine({ -hs, 0.0f, i - hs }, { hs, 0.0f, i - hs }, color);
+		sInstance->AddLine({ i - hs, 0.0f, -hs }, { i - hs, 0.0f, hs }, packedColor);
+		sInstance->AddLine({ -hs, 0.0f, i - hs }, { hs, 0.0f, i - hs }, packedColor);
 	}
 }
 
 void SimpleDraw::AddGroundCircle(uint32_t slices, float radius, const Color& color, const Math::Vector3& origin)
 {
+	const PackedColor packedColor = PackColor(color);
 	Vector3 v0 = Vector3::Zero;
 	Vector3 v1 = Vector3::Zero;
 	float horizRotation = (Constants::TwoPi / static_cast<float>(slices - 1));
@@ -288,7 +294,7 @@ void SimpleDraw::AddGroundCircle(uint32_t slices, float radius, const Color& col
 			0.0f,
 			radius * cos(rot1)
 		};
-		AddLine(v0, v1, color);
+		sInstance->AddLine(v0, v1, packedColor);
 	}
 }
 
@@ -3,11 +3,34 @@
 
 #include "VertexTypes.h"
 #include "Camera.h"
+#include "GraphicsSystem.h"
 #include "RenderObject.h"
 
 using namespace ML_Engine;
 using namespace ML_Engine::Graphics;
 
+namespace
+{
+	// culled runs of fewer triangles are drawn through, skipping them does not pay for another draw
+	constexpr uint32_t MinSkippedTriangles = 64;
+
+	// distance of the bounds centre along the view direction, 0 at the near plane and 1 at the far plane
+	float GetViewDepth(const Camera& camera, const Math::Sphere& bounds, const Math::Matrix4& matWorld)
+	{
+		const Math::Vector3 center = Math::TransformCoord(bounds.center, matWorld);
+		const float distance = Math::Dot(center - camera.GetPosition(), camera.GetDirection());
+		return (distance - camera.GetNearPlane()) / (camera.GetFarPlane() - camera.GetNearPlane());
+	}
+
+	// normals need the inverse transpose of the world matrix once it scales unevenly. World
+	// matrices have no projection, so the affine inverse does, and the buffer holds the
+	// transpose of what the shader multiplies by, which leaves the inverse itself
+	Math::Matrix4 GetNormalMatrix(const Math::Matrix4& matWorld)
+	{
+		return Math::InverseAffine(matWorld);
+	}
+}
+
 void StandardEffect::Initialize(const std::filesystem::path& path)
 {
 	// buffers
@@ -15,17 +38,27 @@ void StandardEffect::Initialize(const std::filesystem::path& path)
 	mLightBuffer.Initialize();
 	mMaterialBuffer.Initialize();
 	mSettingsBuffer.Initialize();
+	mInstanceMaterialBuffer.Initialize();
 
 	// other stuff
 	mVertexShader.Initialize<Vertex>(path);
+	mPackedVertexShader.Initialize<VertexPacked>(path);
+	mInstancedVertexShader.Initialize(path, Vertex::Format | VE_Instanced);
+	mInstancedPackedVertexShader.Initialize(path, VertexPacked::Format | VE_Instanced);
 	mPixelShader.Initialize(path);
+	mInstancedPixelShader.Initialize(path, VE_Instanced);
 	mSampler.Initialize(Sampler::Filter::Linear, Sampler::AddressMode::Wrap);
 }
 void StandardEffect::Terminate()
 {
 	mSampler.Terminate();
+	mInstancedPixelShader.Terminate();
 	mPixelShader.Terminate();
+	mInstancedPackedVertexShader.Terminate();
+	mInstancedVertexShader.Terminate();
+	mPackedVertexShader.Terminate();
 	mVertexShader.Terminate();
+	mInstanceMaterialBuffer.Terminate();
 	mSettingsBuffer.Terminate();
 	mMaterialBuffer.Terminate();
 	mLightBuffer.Terminate();
@@ -44,6 +77,14 @@ void StandardEffect::Begin()
 	mMaterialBuffer.BindPS(2);
 	mSettingsBuffer.BindVS(3);
 	mSettingsBuffer.BindPS(3);
+	mInstanceMaterialBuffer.BindPS(4);
+
+	mMeshletCullStats = MeshletCullStats();
+	mLodObjectCount = 0;
+	mLodTriangleCount = 0;
+	mFullTriangleCount = 0;
+	mInstancedDrawCount = 0;
+	mInstanceCount = 0;
 }
 void StandardEffect::End()
 {
@@ -54,7 +95,7 @@ void StandardEffect::End()
 }
 void StandardEffect::Render(const RenderObject& renderObject)
 {
-	const Math::Matrix4 matWorld = renderObject.transform.GetMatrix4();
+	const Math::Matrix4 matWorld = GetWorldMatrix(mTransformHierarchy, renderObject.transformId, renderObject.transform);
 	const Math::Matrix4 matView = mCamera->GetViewMatrix();
 	const Math::Matrix4 matProj = mCamera->GetProjectionMatrix();
 	const Math::Matrix4 matFinal = matWorld * matView * matProj;
@@ -62,7 +103,10 @@ void StandardEffect::Render(const RenderObject& renderObject)
 	TransformData data;
 	data.wvp = Math::Transpose(matFinal);
 	data.world = Math::Transpose(matWorld);
+	data.normalWorld = GetNormalMatrix(matWorld);
 	data.viewPosition = mCamera->GetPosition();
+	data.positionScale = renderObject.positionScale;
+	data.positionOffset = renderObject.positionOffset;
 	if (mShadowMap != nullptr && mSettingsData.useShadowMap > 0)
 	{
 		const Math::Matrix4 matLightView = mLightCamera->GetViewMatrix();
@@ -71,15 +115,9 @@ void StandardEffect::Render(const RenderObject& renderObject)
 		mShadowMap->BindPS(4);
 	}
 	mTransformBuffer.Update(data);
+	BindVertexShader(renderObject);
 
-	SettingsData settings;
-	settings.useDiffuseMap = (renderObject.diffuseMapId > 0 && mSettingsData.useDiffuseMap > 0) ? 1 : 0;
-	settings.useSpecMap = (renderObject.specMapId > 0 && mSettingsData.useSpecMap > 0) ? 1 : 0;
-	settings.useNormalMap = (renderObject.normalMapId > 0 && mSettingsData.useNormalMap > 0) ? 1 : 0;
-	settings.useBumpMap = (renderObject.bumpMapId > 0 && mSettingsData.useBumpMap > 0) ? 1 : 0;
-	settings.bumpWeight = mSettingsData.bumpWeight;
-	settings.useShadowMap = (mShadowMap != nullptr && mSettingsData.useShadowMap > 0) ? 1 : 0;
-	settings.depthBias = mSettingsData.depthBias;
+	const SettingsData settings = GetObjectSettings(renderObject);
 	mSettingsBuffer.Update(settings);
 
 	mLightBuffer.Update(*mDirectionalLight);
@@ -91,11 +129,11 @@ void StandardEffect::Render(const RenderObject& renderObject)
 	tm->BindPS(renderObject.normalMapId, 2);
 	tm->BindVS(renderObject.bumpMapId, 3);
 
-	renderObject.meshBuffer.Render();
+	RenderMeshBuffer(renderObject, matWorld, settings.useBumpMap > 0);
 }
 void StandardEffect::Render(const RenderGroup& renderGroup)
 {
-	const Math::Matrix4 matWorld = renderGroup.transform.GetMatrix4();
+	const Math::Matrix4 matWorld = GetWorldMatrix(mTransformHierarchy, renderGroup.transformId, renderGroup.transform);
 	const Math::Matrix4 matView = mCamera->GetViewMatrix();
 	const Math::Matrix4 matProj = mCamera->GetProjectionMatrix();
 	const Math::Matrix4 matFinal = matWorld * matView * matProj;
@@ -103,6 +141,7 @@ void StandardEffect::Render(const RenderGroup& renderGroup)
 	TransformData data;
 	data.wvp = Math::Transpose(matFinal);
 	data.world = Math::Transpose(matWorld);
+	data.normalWorld = GetNormalMatrix(matWorld);
 	data.viewPosition = mCamera->GetPosition();
 	if (mShadowMap != nullptr && mSettingsData.useShadowMap > 0)
 	{
@@ -111,32 +150,224 @@ void StandardEffect::Render(const RenderGroup& renderGroup)
 		data.lwvp = Math::Transpose(matWorld * matLightView * matLightProj);
 		mShadowMap->BindPS(4);
 	}
-	mTransformBuffer.Update(data);
 
 	mLightBuffer.Update(*mDirectionalLight);
 
 	TextureManager* tm = TextureManager::Get();
-	SettingsData settings;
-	settings.useShadowMap = (mShadowMap != nullptr && mSettingsData.useShadowMap > 0) ? 1 : 0;
-	settings.depthBias = mSettingsData.depthBias;
-	settings.bumpWeight = mSettingsData.bumpWeight;
-
 	for (const RenderObject& renderObject : renderGroup.renderObjects)
 	{
-		settings.useDiffuseMap = (renderObject.diffuseMapId > 0 && mSettingsData.useDiffuseMap > 0) ? 1 : 0;
-		settings.useSpecMap = (renderObject.specMapId > 0 && mSettingsData.useSpecMap > 0) ? 1 : 0;
-		settings.useNormalMap = (renderObject.normalMapId > 0 && mSettingsData.useNormalMap > 0) ? 1 : 0;
-		settings.useBumpMap = (renderObject.bumpMapId > 0 && mSettingsData.useBumpMap > 0) ? 1 : 0;
+		const SettingsData settings = GetObjectSettings(renderObject);
 		mSettingsBuffer.Update(settings);
 		mMaterialBuffer.Update(renderObject.material);
 
+		// each mesh has its own packed position bounds
+		data.positionScale = renderObject.positionScale;
+		data.positionOffset = renderObject.positionOffset;
+		mTransformBuffer.Update(data);
+		BindVertexShader(renderObject);
+
 		tm->BindPS(renderObject.diffuseMapId, 0);
 		tm->BindPS(renderObject.specMapId, 1);
 		tm->BindPS(renderObject.normalMapId, 2);
-		tm->BindPS(renderObject.bumpMapId, 3);
+		tm->BindVS(renderObject.bumpMapId, 3);
 
-		renderObject.meshBuffer.Render();
+		RenderMeshBuffer(renderObject, matWorld, settings.useBumpMap > 0);
+	}
+}
+void StandardEffect::Submit(RenderQueue& renderQueue, const RenderObject& renderObject) const
+{
+	const Math::Matrix4 matWorld = GetWorldMatrix(mTransformHierarchy, renderObject.transformId, renderObject.transform);
+	const float depth = GetViewDepth(*mCamera, renderObject.bounds, matWorld);
+	renderQueue.Add(RenderQueue::MakeSortKey(QueueEffect::Standard, GetShaderVariant(renderObject), renderObject, depth), renderObject, matWorld);
+}
+void StandardEffect::Submit(RenderQueue& renderQueue, const RenderGroup& renderGroup) const
+{
+	const Math::Matrix4 matWorld = GetWorldMatrix(mTransformHierarchy, renderGroup.transformId, renderGroup.transform);
+	for (const RenderObject& renderObject : renderGroup.renderObjects)
+	{
+		const float depth = GetViewDepth(*mCamera, renderObject.bounds, matWorld);
+		renderQueue.Add(RenderQueue::MakeSortKey(QueueEffect::Standard, GetShaderVariant(renderObject), renderObject, depth), renderObject, matWorld);
+	}
+}
+void StandardEffect::Render(const RenderQueue& renderQueue)
+{
+	const Math::Matrix4 matView = mCamera->GetViewMatrix();
+	const Math::Matrix4 matProj = mCamera->GetProjectionMatrix();
+	const bool useShadowMap = (mShadowMap != nullptr && mSettingsData.useShadowMap > 0);
+	if (useShadowMap)
+	{
+		mShadowMap->BindPS(4);
+	}
+	// the light is the same for every packet
+	mLightBuffer.Update(*mDirectionalLight);
+
+	// what the previous packet left bound, a texture id of 0 leaves its slot alone
+	uint32_t boundShaderVariant = UINT32_MAX;
+	SettingsData boundSettings;
+	Material boundMaterial;
+	bool buffersBound = false;
+	TextureId boundTextures[4] = {};
+
+	TextureManager* tm = TextureManager::Get();
+	for (const DrawPacket& packet : renderQueue.GetPackets())
+	{
+		if (RenderQueue::GetEffect(packet.sortKey) != QueueEffect::Standard)
+		{
+			continue;
+		}
+
+		const RenderObject& renderObject = *packet.renderObject;
+		TransformData data;
+		data.wvp = Math::Transpose(packet.matWorld * matView * matProj);
+		data.world = Math::Transpose(packet.matWorld);
+		data.normalWorld = GetNormalMatrix(packet.matWorld);
+		data.viewPosition = mCamera->GetPosition();
+		data.positionScale = renderObject.positionScale;
+		data.positionOffset = renderObject.positionOffset;
+		if (useShadowMap)
+		{
+			const Math::Matrix4 matLightView = mLightCamera->GetViewMatrix();
+			const Math::Matrix4 matLightProj = mLightCamera->GetProjectionMatrix();
+			data.lwvp = Math::Transpose(packet.matWorld * matLightView * matLightProj);
+		}
+		mTransformBuffer.Update(data);
+
+		const uint32_t shaderVariant = GetShaderVariant(renderObject);
+		if (shaderVariant != boundShaderVariant)
+		{
+			BindVertexShader(renderObject);
+			boundShaderVariant = shaderVariant;
+		}
+
+		// both structs are all 4 byte fields, there is no padding to compare
+		const SettingsData settings = GetObjectSettings(renderObject);
+		if (!buffersBound || memcmp(&settings, &boundSettings, sizeof(SettingsData)) != 0)
+		{
+			mSettingsBuffer.Update(settings);
+			boundSettings = settings;
+		}
+		if (!buffersBound || memcmp(&renderObject.material, &boundMaterial, sizeof(Material)) != 0)
+		{
+			mMaterialBuffer.Update(renderObject.material);
+			boundMaterial = renderObject.material;
+		}
+		buffersBound = true;
+
+		const TextureId textures[] = { renderObject.diffuseMapId, renderObject.specMapId, renderObject.normalMapId, renderObject.bumpMapId };
+		for (uint32_t slot = 0; slot < std::size(textures); ++slot)
+		{
+			if (textures[slot] == 0 || textures[slot] == boundTextures[slot])
+			{
+				continue;
+			}
+			// the bump map displaces vertices
+			if (slot == 3)
+			{
+				tm->BindVS(textures[slot], slot);
+			}
+			else
+			{
+				tm->BindPS(textures[slot], slot);
+			}
+			boundTextures[slot] = textures[slot];
+		}
+
+		RenderMeshBuffer(renderObject, packet.matWorld, settings.useBumpMap > 0);
+	}
+}
+void StandardEffect::RenderInstanced(const RenderObject& renderObject, const InstanceBuffer& instances)
+{
+	if (instances.GetInstanceCount() == 0)
+	{
+		return;
+	}
+
+	const Math::Matrix4 matView = mCamera->GetViewMatrix();
+	const Math::Matrix4 matProj = mCamera->GetProjectionMatrix();
+
+	// the instanced shaders apply the world matrix of each instance themselves
+	TransformData data;
+	data.wvp = Math::Transpose(matView * matProj);
+	data.world = Math::Matrix4::Identity;
+	data.viewPosition = mCamera->GetPosition();
+	data.positionScale = renderObject.positionScale;
+	data.positionOffset = renderObject.positionOffset;
+	if (mShadowMap != nullptr && mSettingsData.useShadowMap > 0)
+	{
+		const Math::Matrix4 matLightView = mLightCamera->GetViewMatrix();
+		const Math::Matrix4 matLightProj = mLightCamera->GetProjectionMatrix();
+		data.lwvp = Math::Transpose(matLightView * matLightProj);
+		mShadowMap->BindPS(4);
+	}
+	mTransformBuffer.Update(data);
+	BindVertexShader(renderObject, true);
+	mInstancedPixelShader.Bind();
+
+	const SettingsData settings = GetObjectSettings(renderObject);
+	mSettingsBuffer.Update(settings);
+	mLightBuffer.Update(*mDirectionalLight);
+	if (mInstanceMaterialCount > 0)
+	{
+		mInstanceMaterialBuffer.Update(mInstanceMaterials);
+	}
+	else
+	{
+		InstanceMaterialData materials;
+		std::fill(std::begin(materials.materials), std::end(materials.materials), renderObject.material);
+		mInstanceMaterialBuffer.Update(materials);
+	}
+
+	TextureManager* tm = TextureManager::Get();
+	tm->BindPS(renderObject.diffuseMapId, 0);
+	tm->BindPS(renderObject.specMapId, 1);
+	tm->BindPS(renderObject.normalMapId, 2);
+	tm->BindVS(renderObject.bumpMapId, 3);
+
+	renderObject.meshBuffer.RenderInstanced(instances);
+	++mInstancedDrawCount;
+	mInstanceCount += instances.GetInstanceCount();
+
+	// the other render paths leave the pixel shader from Begin() alone
+	mPixelShader.Bind();
+}
+void StandardEffect::SetInstanceMaterials(const Material* materials, uint32_t materialCount)
+{
+	ASSERT(materialCount <= MaxInstanceMaterials, "StandardEffect: at most %u instance materials", MaxInstanceMaterials);
+	std::copy(materials, materials + materialCount, mInstanceMaterials.materials);
+	mInstanceMaterialCount = materialCount;
+}
+void StandardEffect::BindVertexShader(const RenderObject& renderObject, bool instanced)
+{
+	const bool isPacked = (renderObject.vertexFormat & VE_Packed) != 0;
+	VertexShader& vertexShader = instanced
+		? (isPacked ? mInstancedPackedVertexShader : mInstancedVertexShader)
+		: (isPacked ? mPackedVertexShader : mVertexShader);
+	if (renderObject.meshBuffer.HasPositionStream())
+	{
+		vertexShader.BindSplit();
 	}
+	else
+	{
+		vertexShader.Bind();
+	}
+}
+uint32_t StandardEffect::GetShaderVariant(const RenderObject& renderObject)
+{
+	const uint32_t packed = ((renderObject.vertexFormat & VE_Packed) != 0) ? 1 : 0;
+	const uint32_t split = renderObject.meshBuffer.HasPositionStream() ? 2 : 0;
+	return packed | split;
+}
+StandardEffect::SettingsData StandardEffect::GetObjectSettings(const RenderObject& renderObject) const
+{
+	SettingsData settings;
+	settings.useDiffuseMap = (renderObject.diffuseMapId > 0 && mSettingsData.useDiffuseMap > 0) ? 1 : 0;
+	settings.useSpecMap = (renderObject.specMapId > 0 && mSettingsData.useSpecMap > 0) ? 1 : 0;
+	settings.useNormalMap = (renderObject.normalMapId > 0 && mSettingsData.useNormalMap > 0) ? 1 : 0;
+	settings.useBumpMap = (renderObject.bumpMapId > 0 && mSettingsData.useBumpMap > 0) ? 1 : 0;
+	settings.bumpWeight = mSettingsData.bumpWeight;
+	settings.useShadowMap = (mShadowMap != nullptr && mSettingsData.useShadowMap > 0) ? 1 : 0;
+	settings.depthBias = mSettingsData.depthBias;
+	return settings;
 }
 void StandardEffect::SetCamera(const Camera& camera)
 {
@@ -154,6 +385,59 @@ void StandardEffect::SetShadowMap(const Texture& shadowMap)
 {
 	mShadowMap = &shadowMap;
 }
+void StandardEffect::SetTransformHierarchy(const TransformHierarchy* hierarchy)
+{
+	mTransformHierarchy = hierarchy;
+}
+const MeshletCullStats& StandardEffect::GetMeshletCullStats() const
+{
+	return mMeshletCullStats;
+}
+void StandardEffect::RenderMeshBuffer(const RenderObject& renderObject, const Math::Matrix4& matWorld, bool useBumpMap)
+{
+	if (mUseLods && !renderObject.lods.empty())
+	{
+		const float screenHeight = static_cast<float>(GraphicsSystem::Get()->GetBackBufferHeight());
+		const uint32_t lod = LodSelector::Select(renderObject.lods, renderObject.bounds, matWorld, *mCamera, screenHeight, mLodPixelError);
+		const MeshLodRange& range = renderObject.lods[lod];
+		mFullTriangleCount += renderObject.lods[0].indexCount / 3;
+		mLodTriangleCount += range.indexCount / 3;
+		if (lod > 0)
+		{
+			++mLodObjectCount;
+			renderObject.meshBuffer.Render(range.indexOffset, range.indexCount);
+			return;
+		}
+	}
+
+	// bump mapping displaces vertices outside the meshlet bounds, draw those whole
+	if (!mCullMeshlets || useBumpMap || renderObject.meshlets.empty())
+	{
+		renderObject.meshBuffer.Render();
+		return;
+	}
+
+	mVisibleMeshlets.clear();
+	MeshletBuilder::Cull(renderObject.meshlets, matWorld, *mCamera, mVisibleMeshlets, &mMeshletCullStats);
+
+	// meshlets are stored back to back, merge neighbours and short culled gaps into one draw
+	size_t i = 0;
+	while (i < mVisibleMeshlets.size())
+	{
+		const Meshlet& first = renderObject.meshlets[mVisibleMeshlets[i]];
+		uint32_t endIndex = first.indexOffset + first.indexCount;
+		for (++i; i < mVisibleMeshlets.size(); ++i)
+		{
+			const Meshlet& next = renderObject.meshlets[mVisibleMeshlets[i]];
+			if (next.indexOffset - endIndex >= MinSkippedTriangles * 3)
+			{
+				break;
+			}
+			endIndex = next.indexOffset + next.indexCount;
+		}
+		renderObject.meshBuffer.Render(first.indexOffset, endIndex - first.indexOffset);
+	}
+}
 void StandardEffect::DebugUI()
 {
 	if (ImGui::CollapsingHeader("StandardEffect", ImGuiTreeNodeFlags_DefaultOpen))
@@ -185,5 +469,22 @@ void StandardEffect::DebugUI()
 			mSettingsData.useShadowMap = (useShadowMap) ? 1 : 0;
 		}
 		ImGui::DragFloat("DepthBias", &mSettingsData.depthBias, 0.00001f, 0.0f, 1.0f, "%.6f");
+		ImGui::Checkbox("CullMeshlets", &mCullMeshlets);
+		if (mCullMeshlets && mMeshletCullStats.meshletCount > 0)
+		{
+			ImGui::Text("Meshlets: %u, frustum culled %u, backface culled %u", mMeshletCullStats.meshletCount,
+				mMeshletCullStats.frustumCulled, mMeshletCullStats.backfaceCulled);
+			ImGui::Text("Triangles: %u of %u", mMeshletCullStats.visibleIndexCount / 3, mMeshletCullStats.totalIndexCount / 3);
+		}
+		ImGui::Checkbox("UseLods", &mUseLods);
+		if (mUseLods)
+		{
+			ImGui::DragFloat("LodPixelError", &mLodPixelError, 0.1f, 0.1f, 50.0f);
+			ImGui::Text("Lod objects: %u, triangles %u of %u", mLodObjectCount, mLodTriangleCount, mFullTriangleCount);
+		}
+		if (mInstancedDrawCount > 0)
+		{
+			ImGui::Text("Instanced draws: %u, instances %u", mInstancedDrawCount, mInstanceCount);
+		}
 	}
 }
\ No newline at end of file
@@ -2,7 +2,6 @@
 #include "Texture.h"
 
 #include "GraphicsSystem.h"
-#include <DirectXTK/Inc/WICTextureLoader.h>
 
 using namespace ML_Engine;
 using namespace ML_Engine::Graphics;
@@ -10,7 +9,11 @@ using namespace ML_Engine::Graphics;
 void Texture::UnbindPS(uint32_t slot)
 {
 	static ID3D11ShaderResourceView* dummy = nullptr;
-	GraphicsSystem::Get()->GetContext()->PSSetShaderResources(slot, 1, &dummy);
+	GraphicsSystem* gs = GraphicsSystem::Get();
+	if (gs->GetStateCache()->SetShaderResource(ShaderStage::Pixel, slot, nullptr))
+	{
+		gs->GetBackend()->PSSetShaderResources(slot, 1, &dummy);
+	}
 }
 
 Texture::~Texture()
@@ -21,40 +24,50 @@ Texture::~Texture()
 Texture::Texture(Texture&& rhs) noexcept
 	: mShaderResourceView(rhs.mShaderResourceView)
 {
+	// bindings follow the object, not the view
+	GraphicsSystem::Get()->GetStateCache()->Forget(&rhs);
 	rhs.mShaderResourceView = nullptr;
 }
 
 Texture& Texture::operator=(Texture&& rhs) noexcept
 {
-    mShaderResourceView = rhs.mShaderResourceView;
+	GraphicsStateCache* stateCache = GraphicsSystem::Get()->GetStateCache();
+	stateCache->Forget(this);
+	stateCache->Forget(&rhs);
+	mShaderResourceView = rhs.mShaderResourceView;
 	rhs.mShaderResourceView = nullptr;
 	return *this;
 }
 
 void Texture::Initialize(const std::filesystem::path& fileName)
 {
-	auto device = GraphicsSystem::Get()->GetDevice();
-	auto context = GraphicsSystem::Get()->GetContext();
-
-	HRESULT hr = DirectX::CreateWICTextureFromFile(device, context, fileName.c_str(), nullptr, &mShaderResourceView);
+	auto backend = GraphicsSystem::Get()->GetBackend();
+	HRESULT hr = backend->CreateTextureFromFile(fileName, &mShaderResourceView);
 	ASSERT(SUCCEEDED(hr), "Texture: failed to create texture %s", fileName.c_str());
 }
 
 void Texture::Terminate()
 {
+	GraphicsSystem::Get()->GetStateCache()->Forget(this);
 	SafeRelease(mShaderResourceView);
 }
 
 void Texture::BindVS(uint32_t slot) const
 {
-	auto context = GraphicsSystem::Get()->GetContext();
-	context->VSSetShaderResources(slot, 1, &mShaderResourceView);
+	GraphicsSystem* gs = GraphicsSystem::Get();
+	if (gs->GetStateCache()->SetShaderResource(ShaderStage::Vertex, slot, this))
+	{
+		gs->GetBackend()->VSSetShaderResources(slot, 1, &mShaderResourceView);
+	}
 }
 
 void Texture::BindPS(uint32_t slot) const
 {
-	auto context = GraphicsSystem::Get()->GetContext();
-	context->PSSetShaderResources(slot, 1, &mShaderResourceView);
+	GraphicsSystem* gs = GraphicsSystem::Get();
+	if (gs->GetStateCache()->SetShaderResource(ShaderStage::Pixel, slot, this))
+	{
+		gs->GetBackend()->PSSetShaderResources(slot, 1, &mShaderResourceView);
+	}
 }
 
 void* Texture::GetRawData() const
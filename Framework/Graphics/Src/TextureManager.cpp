@@ -32,7 +32,7 @@ TextureManager* TextureManager::Get()
 
 TextureManager::~TextureManager()
 {
-ASSERT(mInventory.empty(), "TextureManager: not all textures are cleared");
+	ASSERT(mInventory.Empty(), "TextureManager: not all textures are cleared");
 }
 
 void TextureManager::SetRootDirectory(const std::filesystem::path& root)
@@ -42,60 +42,60 @@ void TextureManager::SetRootDirectory(const std::filesystem::path& root)
 
 TextureId TextureManager::LoadTexture(const std::filesystem::path& fileName, bool useRootDir)
 {
-	const size_t textureId = std::filesystem::hash_value(fileName);
-	auto [iter, success] = mInventory.insert({ textureId, Entry()});
+	const std::filesystem::path filePath = (useRootDir) ? mRootDirectory / fileName : fileName;
+	std::string key = filePath.lexically_normal().generic_u8string();
+	auto [iter, success] = mIdsByPath.insert({ key, 0 });
 	if (success)
 	{
-		iter->second.texture = std::make_unique<Texture>();
-		iter->second.texture->Initialize((useRootDir) ? mRootDirectory / fileName : fileName);
-		iter->second.refCount = 1;
+		Entry entry;
+		entry.texture = std::make_unique<Texture>();
+		entry.texture->Initialize(filePath);
+		entry.filePath = std::move(key);
+		entry.refCount = 1;
+		iter->second = mInventory.Emplace(std::move(entry));
 	}
 	else
 	{
-		++iter->second.refCount;
+		++mInventory.Get(iter->second)->refCount;
 	}
-	return textureId;
+	return iter->second;
 }
 
 const Texture* TextureManager::GetTexture(TextureId id)
 {
-	auto iter = mInventory.find(id);
-	if (iter != mInventory.end())
-	{
-		return iter->second.texture.get();
-	}
-	return nullptr;
+	const Entry* entry = mInventory.Get(id);
+	return (entry != nullptr) ? entry->texture.get() : nullptr;
 }
 
 void TextureManager::ReleaseTexture(TextureId id)
 {
-	auto iter = mInventory.find(id);
-	if (iter != mInventory.end())
+	Entry* entry = mInventory.Get(id);
+	if (entry != nullptr)
 	{
-		--iter->second.refCount;
-		if (iter->second.refCount == 0)
+		--entry->refCount;
+		if (entry->refCount == 0)
 		{
-			iter->second.texture->Terminate();
-			iter->second.texture.release();
-			mInventory.erase(iter);
+			entry->texture->Terminate();
+			mIdsByPath.erase(entry->filePath);
+			mInventory.Remove(id);
 		}
 	}
 }
 
 void TextureManager::BindVS(TextureId id, uint32_t slot) const
 {
-	auto iter = mInventory.find(id);
-	if (iter != mInventory.end())
+	const Entry* entry = mInventory.Get(id);
+	if (entry != nullptr)
 	{
-		iter->second.texture->BindVS(slot);
+		entry->texture->BindVS(slot);
 	}
 }
 
 void TextureManager::BindPS(TextureId id, uint32_t slot) const
 {
-	auto iter = mInventory.find(id);
-	if (iter != mInventory.end())
+	const Entry* entry = mInventory.Get(id);
+	if (entry != nullptr)
 	{
-		iter->second.texture->BindPS(slot);
+		entry->texture->BindPS(slot);
 	}
 }
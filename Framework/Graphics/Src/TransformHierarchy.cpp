@@ -0,0 +1,270 @@
+#include "Precompiled.h"
+#include "TransformHierarchy.h"
+
+using namespace ML_Engine;
+using namespace ML_Engine::Graphics;
+
+TransformId TransformHierarchy::Create(TransformId parent)
+{
+	return Create(Transform(), parent);
+}
+
+TransformId TransformHierarchy::Create(const Transform& local, TransformId parent)
+{
+	ASSERT(parent == InvalidTransformId || IsValid(parent), "TransformHierarchy: invalid parent");
+
+	TransformId id = InvalidTransformId;
+	if (!mFreeIds.empty())
+	{
+		id = mFreeIds.back();
+		mFreeIds.pop_back();
+	}
+	else
+	{
+		id = static_cast<TransformId>(mIdToSlot.size());
+		mIdToSlot.push_back(InvalidSlot);
+		mParentId.push_back(InvalidTransformId);
+	}
+
+	// appending keeps parents before children, the depth order is restored on the next Update()
+	const uint32_t slot = static_cast<uint32_t>(mLocal.size());
+	mLocal.push_back(local);
+	mLocalMatrix.push_back(Math::Matrix4::Identity);
+	mWorld.push_back(Math::Matrix4::Identity);
+	mParentSlot.push_back(parent == InvalidTransformId ? InvalidSlot : mIdToSlot[parent]);
+	mDirty.push_back(1);
+	mSlotToId.push_back(id);
+
+	mIdToSlot[id] = slot;
+	mParentId[id] = parent;
+	mNeedsSort = true;
+	return id;
+}
+
+void TransformHierarchy::Destroy(TransformId id)
+{
+	ASSERT(IsValid(id), "TransformHierarchy: invalid id");
+	if (mNeedsSort)
+	{
+		Sort();
+	}
+
+	// parents come first, so one pass marks the whole subtree
+	const uint32_t count = static_cast<uint32_t>(mLocal.size());
+	std::vector<uint8_t> removed(count, 0);
+	removed[mIdToSlot[id]] = 1;
+	for (uint32_t i = mIdToSlot[id] + 1; i < count; ++i)
+	{
+		const uint32_t parent = mParentSlot[i];
+		removed[i] = (parent != InvalidSlot) ? removed[parent] : 0;
+	}
+
+	uint32_t write = 0;
+	for (uint32_t read = 0; read < count; ++read)
+	{
+		const TransformId nodeId = mSlotToId[read];
+		if (removed[read])
+		{
+			mIdToSlot[nodeId] = InvalidSlot;
+			mParentId[nodeId] = InvalidTransformId;
+			mFreeIds.push_back(nodeId);
+			continue;
+		}
+		mLocal[write] = mLocal[read];
+		mLocalMatrix[write] = mLocalMatrix[read];
+		mWorld[write] = mWorld[read];
+		mDirty[write] = mDirty[read];
+		mSlotToId[write] = nodeId;
+		mIdToSlot[nodeId] = write;
+		++write;
+	}
+	mLocal.resize(write);
+	mLocalMatrix.resize(write);
+	mWorld.resize(write);
+	mParentSlot.resize(write);
+	mDirty.resize(write);
+	mSlotToId.resize(write);
+
+	for (uint32_t i = 0; i < write; ++i)
+	{
+		const TransformId parent = mParentId[mSlotToId[i]];
+		mParentSlot[i] = (parent != InvalidTransformId) ? mIdToSlot[parent] : InvalidSlot;
+	}
+}
+
+void TransformHierarchy::Clear()
+{
+	mLocal.clear();
+	mLocalMatrix.clear();
+	mWorld.clear();
+	mParentSlot.clear();
+	mDirty.clear();
+	mSlotToId.clear();
+	mIdToSlot.clear();
+	mParentId.clear();
+	mFreeIds.clear();
+	mUpdateSlots.clear();
+	mUpdatedCount = 0;
+	mNeedsSort = false;
+}
+
+void TransformHierarchy::SetParent(TransformId id, TransformId parent)
+{
+	ASSERT(IsValid(id), "TransformHierarchy: invalid id");
+	ASSERT(parent == InvalidTransformId || IsValid(parent), "TransformHierarchy: invalid parent");
+	for (TransformId p = parent; p != InvalidTransformId; p = mParentId[p])
+	{
+		ASSERT(p != id, "TransformHierarchy: parenting would create a cycle");
+	}
+
+	const uint32_t slot = mIdToSlot[id];
+	mParentId[id] = parent;
+	mParentSlot[slot] = (parent != InvalidTransformId) ? mIdToSlot[parent] : InvalidSlot;
+	mDirty[slot] = 1;
+	mNeedsSort = true;
+}
+
+TransformId TransformHierarchy::GetParent(TransformId id) const
+{
+	ASSERT(IsValid(id), "TransformHierarchy: invalid id");
+	return mParentId[id];
+}
+
+void TransformHierarchy::SetLocal(TransformId id, const Transform& local)
+{
+	const uint32_t slot = GetSlot(id);
+	mLocal[slot] = local;
+	mDirty[slot] = 1;
+}
+
+const Transform& TransformHierarchy::GetLocal(TransformId id) const
+{
+	return mLocal[GetSlot(id)];
+}
+
+const Math::Matrix4& TransformHierarchy::GetWorldMatrix(TransformId id) const
+{
+	return mWorld[GetSlot(id)];
+}
+
+bool TransformHierarchy::IsValid(TransformId id) const
+{
+	return id < mIdToSlot.size() && mIdToSlot[id] != InvalidSlot;
+}
+
+size_t TransformHierarchy::Size() const
+{
+	return mLocal.size();
+}
+
+void TransformHierarchy::Update()
+{
+	if (mNeedsSort)
+	{
+		Sort();
+	}
+
+	// push dirty flags down, a parent is always visited before its children
+	const uint32_t count = static_cast<uint32_t>(mLocal.size());
+	mUpdateSlots.clear();
+	for (uint32_t i = 0; i < count; ++i)
+	{
+		const uint32_t parent = mParentSlot[i];
+		if (parent != InvalidSlot)
+		{
+			mDirty[i] |= mDirty[parent];
+		}
+		if (mDirty[i])
+		{
+			mUpdateSlots.push_back(i);
+		}
+	}
+
+	// local matrices are independent of each other
+	for (const uint32_t slot : mUpdateSlots)
+	{
+		mLocalMatrix[slot] = mLocal[slot].GetMatrix4();
+	}
+
+	// world = local * parent world, in depth order
+	for (const uint32_t slot : mUpdateSlots)
+	{
+		const uint32_t parent = mParentSlot[slot];
+		mWorld[slot] = (parent != InvalidSlot) ? mLocalMatrix[slot] * mWorld[parent] : mLocalMatrix[slot];
+		mDirty[slot] = 0;
+	}
+	mUpdatedCount = mUpdateSlots.size();
+}
+
+size_t TransformHierarchy::GetUpdatedCount() const
+{
+	return mUpdatedCount;
+}
+
+void TransformHierarchy::Sort()
+{
+	const uint32_t count = static_cast<uint32_t>(mLocal.size());
+
+	// depth per id, memoized walk up the parent chain
+	std::vector<uint32_t> depth(mIdToSlot.size(), InvalidSlot);
+	std::vector<TransformId> chain;
+	for (uint32_t i = 0; i < count; ++i)
+	{
+		TransformId id = mSlotToId[i];
+		while (id != InvalidTransformId && depth[id] == InvalidSlot)
+		{
+			chain.push_back(id);
+			id = mParentId[id];
+		}
+		uint32_t d = (id == InvalidTransformId) ? 0 : depth[id] + 1;
+		while (!chain.empty())
+		{
+			depth[chain.back()] = d++;
+			chain.pop_back();
+		}
+	}
+
+	std::vector<uint32_t> order(count);
+	for (uint32_t i = 0; i < count; ++i)
+	{
+		order[i] = i;
+	}
+	std::stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b)
+	{
+		return depth[mSlotToId[a]] < depth[mSlotToId[b]];
+	});
+
+	std::vector<Transform> local(count);
+	std::vector<Math::Matrix4> localMatrix(count);
+	std::vector<Math::Matrix4> world(count);
+	std::vector<uint8_t> dirty(count);
+	std::vector<TransformId> slotToId(count);
+	for (uint32_t i = 0; i < count; ++i)
+	{
+		const uint32_t from = order[i];
+		local[i] = mLocal[from];
+		localMatrix[i] = mLocalMatrix[from];
+		world[i] = mWorld[from];
+		dirty[i] = mDirty[from];
+		slotToId[i] = mSlotToId[from];
+		mIdToSlot[slotToId[i]] = i;
+	}
+	mLocal = std::move(local);
+	mLocalMatrix = std::move(localMatrix);
+	mWorld = std::move(world);
+	mDirty = std::move(dirty);
+	mSlotToId = std::move(slotToId);
+
+	for (uint32_t i = 0; i < count; ++i)
+	{
+		const TransformId parent = mParentId[mSlotToId[i]];
+		mParentSlot[i] = (parent != InvalidTransformId) ? mIdToSlot[parent] : InvalidSlot;
+	}
+	mNeedsSort = false;
+}
+
+uint32_t TransformHierarchy::GetSlot(TransformId id) const
+{
+	ASSERT(IsValid(id), "TransformHierarchy: invalid id");
+	return mIdToSlot[id];
+}
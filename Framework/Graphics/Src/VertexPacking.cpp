@@ -0,0 +1,274 @@
+#include "Precompiled.h"
+#include "VertexPacking.h"
+
+using namespace ML_Engine;
+using namespace ML_Engine::Graphics;
+
+namespace
+{
+	constexpr float UNorm16Max = 65535.0f;
+	constexpr float SNorm16Max = 32767.0f;
+
+	int16_t ToSNorm16(float value)
+	{
+		return static_cast<int16_t>(roundf(Math::Clamp(value, -1.0f, 1.0f) * SNorm16Max));
+	}
+
+	float FromSNorm16(int16_t value)
+	{
+		// -32768 and -32767 both decode to -1, as on the GPU
+		return Math::Max(static_cast<float>(value) / SNorm16Max, -1.0f);
+	}
+
+	uint16_t ToUNorm16(float value)
+	{
+		return static_cast<uint16_t>(roundf(Math::Clamp(value, 0.0f, 1.0f) * UNorm16Max));
+	}
+
+	float SignNotZero(float value)
+	{
+		return (value >= 0.0f) ? 1.0f : -1.0f;
+	}
+
+	// cosine between a direction and an octahedral grid point, in doubles because
+	// neighbouring grid points are closer together than float precision near 1
+	double OctahedralCosine(const Math::Vector3& direction, const int16_t encoded[2])
+	{
+		double x = Math::Max(encoded[0] / 32767.0, -1.0);
+		double y = Math::Max(encoded[1] / 32767.0, -1.0);
+		const double z = 1.0 - fabs(x) - fabs(y);
+		const double fold = Math::Max(-z, 0.0);
+		x += (x >= 0.0) ? -fold : fold;
+		y += (y >= 0.0) ? -fold : fold;
+		const double dot = x * direction.x + y * direction.y + z * direction.z;
+		const double lengthSqr = (x * x + y * y + z * z) * Math::MagnitudeSqr(direction);
+		return dot / sqrt(lengthSqr);
+	}
+}
+
+uint16_t VertexPacking::FloatToHalf(float value)
+{
+	uint32_t bits = 0;
+	memcpy(&bits, &value, sizeof(bits));
+	const uint16_t sign = static_cast<uint16_t>((bits >> 16) & 0x8000);
+	const uint32_t absBits = bits & 0x7fffffff;
+
+	if (absBits > 0x7f800000)
+	{
+		return sign | 0x7e00; // nan
+	}
+	if (absBits >= 0x47800000)
+	{
+		return sign | 0x7c00; // 65536 and up, the rounding below handles [65520, 65536)
+	}
+
+	const uint32_t exponent = absBits >> 23;
+	if (exponent < 113)
+	{
+		// below 2^-14, counts of 2^-24 in the denormal range
+		const uint32_t shift = 126 - exponent;
+		if (shift > 24)
+		{
+			return sign;
+		}
+		const uint32_t mantissa = (absBits & 0x7fffff) | 0x800000;
+		uint32_t half = mantissa >> shift;
+		const uint32_t remainder = mantissa & ((1u << shift) - 1);
+		const uint32_t halfway = 1u << (shift - 1);
+		if (remainder > halfway || (remainder == halfway && (half & 1) != 0))
+		{
+			++half;
+		}
+		return sign | static_cast<uint16_t>(half);
+	}
+
+	// rebias the exponent from 127 to 15, a carry out of the mantissa rounds up the exponent
+	uint32_t half = (absBits - 0x38000000) >> 13;
+	const uint32_t remainder = absBits & 0x1fff;
+	if (remainder > 0x1000 || (remainder == 0x1000 && (half & 1) != 0))
+	{
+		++half;
+	}
+	return sign | static_cast<uint16_t>(half);
+}
+
+float VertexPacking::HalfToFloat(uint16_t value)
+{
+	const uint32_t sign = static_cast<uint32_t>(value & 0x8000) << 16;
+	const uint32_t exponent = (value >> 10) & 0x1f;
+	const uint32_t mantissa = value & 0x3ff;
+
+	uint32_t bits = 0;
+	if (exponent == 0)
+	{
+		const float magnitude = ldexpf(static_cast<float>(mantissa), -24);
+		memcpy(&bits, &magnitude, sizeof(bits));
+		bits |= sign;
+	}
+	else if (exponent == 31)
+	{
+		bits = sign | 0x7f800000 | (mantissa << 13);
+	}
+	else
+	{
+		bits = sign | ((exponent + 112) << 23) | (mantissa << 13);
+	}
+
+	float result = 0.0f;
+	memcpy(&result, &bits, sizeof(result));
+	return result;
+}
+
+void VertexPacking::EncodeOctahedral(const Math::Vector3& direction, int16_t encoded[2])
+{
+	const float length = fabsf(direction.x) + fabsf(direction.y) + fabsf(direction.z);
+	if (length <= 0.0f)
+	{
+		encoded[0] = 0;
+		encoded[1] = 0;
+		return;
+	}
+
+	float x = direction.x / length;
+	float y = direction.y / length;
+	if (direction.z < 0.0f)
+	{
+		const float foldedX = (1.0f - fabsf(y)) * SignNotZero(x);
+		y = (1.0f - fabsf(x)) * SignNotZero(y);
+		x = foldedX;
+	}
+
+	// rounding each axis on its own is not always closest on the sphere, try the
+	// four neighbouring grid points and keep the one that decodes best
+	const float floorX = floorf(Math::Clamp(x, -1.0f, 1.0f) * SNorm16Max);
+	const float floorY = floorf(Math::Clamp(y, -1.0f, 1.0f) * SNorm16Max);
+	double bestDot = -2.0;
+	for (uint32_t i = 0; i < 4; ++i)
+	{
+		const int16_t candidate[2] = {
+			ToSNorm16((floorX + static_cast<float>(i & 1)) / SNorm16Max),
+			ToSNorm16((floorY + static_cast<float>(i >> 1)) / SNorm16Max) };
+		const double dot = OctahedralCosine(direction, candidate);
+		if (dot > bestDot)
+		{
+			bestDot = dot;
+			encoded[0] = candidate[0];
+			encoded[1] = candidate[1];
+		}
+	}
+}
+
+Math::Vector3 VertexPacking::DecodeOctahedral(const int16_t encoded[2])
+{
+	Math::Vector3 n;
+	n.x = FromSNorm16(encoded[0]);
+	n.y = FromSNorm16(encoded[1]);
+	n.z = 1.0f - fabsf(n.x) - fabsf(n.y);
+	const float fold = Math::Max(-n.z, 0.0f);
+	n.x += (n.x >= 0.0f) ? -fold : fold;
+	n.y += (n.y >= 0.0f) ? -fold : fold;
+	return Math::Normalize(n);
+}
+
+Math::Vector3 VertexPacking::GetPositionScale(const Math::AABB& positionBounds)
+{
+	return positionBounds.extend * 2.0f;
+}
+
+Math::Vector3 VertexPacking::GetPositionOffset(const Math::AABB& positionBounds)
+{
+	return positionBounds.center - positionBounds.extend;
+}
+
+VertexPacked VertexPacking::Pack(const Vertex& vertex, const Math::AABB& positionBounds, float bitangentSign)
+{
+	const Math::Vector3 scale = GetPositionScale(positionBounds);
+	const Math::Vector3 local = vertex.position - GetPositionOffset(positionBounds);
+
+	VertexPacked packed;
+	packed.position[0] = (scale.x > 0.0f) ? ToUNorm16(local.x / scale.x) : 0;
+	packed.position[1] = (scale.y > 0.0f) ? ToUNorm16(local.y / scale.y) : 0;
+	packed.position[2] = (scale.z > 0.0f) ? ToUNorm16(local.z / scale.z) : 0;
+	packed.position[3] = (bitangentSign >= 0.0f) ? 0xffff : 0;
+	EncodeOctahedral(vertex.normal, packed.normal);
+	EncodeOctahedral(vertex.tangent, packed.tangent);
+	packed.uvCoord[0] = FloatToHalf(vertex.uvCoord.x);
+	packed.uvCoord[1] = FloatToHalf(vertex.uvCoord.y);
+	return packed;
+}
+
+Vertex VertexPacking::Unpack(const VertexPacked& vertex, const Math::AABB& positionBounds)
+{
+	const Math::Vector3 scale = GetPositionScale(positionBounds);
+	const Math::Vector3 offset = GetPositionOffset(positionBounds);
+
+	Vertex unpacked;
+	unpacked.position.x = offset.x + (static_cast<float>(vertex.position[0]) / UNorm16Max) * scale.x;
+	unpacked.position.y = offset.y + (static_cast<float>(vertex.position[1]) / UNorm16Max) * scale.y;
+	unpacked.position.z = offset.z + (static_cast<float>(vertex.position[2]) / UNorm16Max) * scale.z;
+	unpacked.normal = DecodeOctahedral(vertex.normal);
+	unpacked.tangent = DecodeOctahedral(vertex.tangent);
+	unpacked.uvCoord.x = HalfToFloat(vertex.uvCoord[0]);
+	unpacked.uvCoord.y = HalfToFloat(vertex.uvCoord[1]);
+	return unpacked;
+}
+
+float VertexPacking::GetBitangentSign(const VertexPacked& vertex)
+{
+	return (vertex.position[3] >= 0x8000) ? 1.0f : -1.0f;
+}
+
+MeshPacked VertexPacking::PackMesh(const Mesh& mesh)
+{
+	MeshPacked packedMesh;
+	packedMesh.indices = mesh.indices;
+	if (mesh.vertices.empty())
+	{
+		return packedMesh;
+	}
+
+	packedMesh.positionBounds = Math::ComputeAABB(&mesh.vertices[0].position, mesh.vertices.size(), sizeof(Vertex));
+	packedMesh.vertices.reserve(mesh.vertices.size());
+	for (const Vertex& vertex : mesh.vertices)
+	{
+		packedMesh.vertices.push_back(Pack(vertex, packedMesh.positionBounds));
+	}
+	return packedMesh;
+}
+
+Mesh VertexPacking::UnpackMesh(const MeshPacked& mesh)
+{
+	Mesh unpackedMesh;
+	unpackedMesh.indices = mesh.indices;
+	unpackedMesh.vertices.reserve(mesh.vertices.size());
+	for (const VertexPacked& vertex : mesh.vertices)
+	{
+		unpackedMesh.vertices.push_back(Unpack(vertex, mesh.positionBounds));
+	}
+	return unpackedMesh;
+}
+
+VertexPacking::PackingError VertexPacking::MeasureError(const Mesh& mesh, const MeshPacked& packedMesh)
+{
+	ASSERT(mesh.vertices.size() == packedMesh.vertices.size(), "VertexPacking: meshes do not match");
+
+	auto Angle = [](const Math::Vector3& a, const Math::Vector3& b)
+	{
+		if (Math::MagnitudeSqr(a) <= 0.0f)
+		{
+			return 0.0f;
+		}
+		return acosf(Math::Clamp(Math::Dot(Math::Normalize(a), b), -1.0f, 1.0f)) * Math::Constants::RadToDeg;
+	};
+
+	PackingError error;
+	for (size_t i = 0; i < mesh.vertices.size(); ++i)
+	{
+		const Vertex& original = mesh.vertices[i];
+		const Vertex unpacked = Unpack(packedMesh.vertices[i], packedMesh.positionBounds);
+		error.position = Math::Max(error.position, Math::Magnitude(original.position - unpacked.position));
+		error.normalAngle = Math::Max(error.normalAngle, Math::Max(Angle(original.normal, unpacked.normal), Angle(original.tangent, unpacked.tangent)));
+		error.uvCoord = Math::Max(error.uvCoord, Math::Max(fabsf(original.uvCoord.x - unpacked.uvCoord.x), fabsf(original.uvCoord.y - unpacked.uvCoord.y)));
+	}
+	return error;
+}
@@ -2,6 +2,7 @@
 #include "VertexShader.h"
 
 #include "GraphicsSystem.h"
+#include "InstanceBuffer.h"
 #include "VertexTypes.h"
 
 using namespace ML_Engine;
@@ -11,42 +12,114 @@ namespace
 {
     std::vector<D3D11_INPUT_ELEMENT_DESC> GetVertexLayout(uint32_t format)
     {
+        // packed vertices are decoded by the input assembler where a DXGI format fits,
+        // the shaders finish the bounds and octahedral decode under PACKED_VERTEX
+        const bool isPacked = (format & VE_Packed) != 0;
+        // split layouts read positions from slot 0 and everything else from slot 1
+        const UINT attributeSlot = (format & VE_PositionStream) ? 1 : 0;
         std::vector<D3D11_INPUT_ELEMENT_DESC> vertexLayout;
         if (format & VE_Position)
         {
-            vertexLayout.push_back({ "POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 });
+            const DXGI_FORMAT positionFormat = isPacked ? DXGI_FORMAT_R16G16B16A16_UNORM : DXGI_FORMAT_R32G32B32_FLOAT;
+            vertexLayout.push_back({ "POSITION", 0, positionFormat, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 });
         }
         if (format & VE_Normal)
         {
-            vertexLayout.push_back({ "NORMAL", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 });
+            const DXGI_FORMAT normalFormat = isPacked ? DXGI_FORMAT_R16G16_SNORM : DXGI_FORMAT_R32G32B32_FLOAT;
+            vertexLayout.push_back({ "NORMAL", 0, normalFormat, attributeSlot, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 });
         }
         if (format & VE_Tangent)
         {
-            vertexLayout.push_back({ "TANGENT", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 });
+            const DXGI_FORMAT tangentFormat = isPacked ? DXGI_FORMAT_R16G16_SNORM : DXGI_FORMAT_R32G32B32_FLOAT;
+            vertexLayout.push_back({ "TANGENT", 0, tangentFormat, attributeSlot, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 });
         }
         if (format & VE_Color)
         {
-            vertexLayout.push_back({ "COLOR", 0, DXGI_FORMAT_R32G32B32A32_FLOAT, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 });
+            const DXGI_FORMAT colorFormat = (format & VE_PackedColor) ? DXGI_FORMAT_R8G8B8A8_UNORM : DXGI_FORMAT_R32G32B32A32_FLOAT;
+            vertexLayout.push_back({ "COLOR", 0, colorFormat, attributeSlot, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 });
         }
         if (format & VE_TexCoord)
         {
-            vertexLayout.push_back({ "TEXCOORD", 0, DXGI_FORMAT_R32G32_FLOAT, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 });
+            const DXGI_FORMAT texCoordFormat = isPacked ? DXGI_FORMAT_R16G16_FLOAT : DXGI_FORMAT_R32G32_FLOAT;
+            vertexLayout.push_back({ "TEXCOORD", 0, texCoordFormat, attributeSlot, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 });
+        }
+        if (format & VE_Instanced)
+        {
+            // InstanceData, the world matrix a row per element
+            for (UINT row = 0; row < 4; ++row)
+            {
+                vertexLayout.push_back({ "INSTANCE_WORLD", row, DXGI_FORMAT_R32G32B32A32_FLOAT, InstanceBuffer::Slot, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_INSTANCE_DATA, 1 });
+            }
+            vertexLayout.push_back({ "INSTANCE_MATERIAL", 0, DXGI_FORMAT_R32_UINT, InstanceBuffer::Slot, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_INSTANCE_DATA, 1 });
         }
 
         return vertexLayout;
     }
+
+    // What CreateInputLayout checks against the shader signature, done on the bytecode so
+    // every permutation gets checked at startup, under the null backend as well
+    bool MatchesInputSignature(ID3DBlob* shaderBlob, const std::vector<D3D11_INPUT_ELEMENT_DESC>& vertexLayout, const std::filesystem::path& shaderPath, uint32_t format)
+    {
+        ID3D11ShaderReflection* reflection = nullptr;
+        HRESULT hr = D3DReflect(shaderBlob->GetBufferPointer(), shaderBlob->GetBufferSize(), IID_PPV_ARGS(&reflection));
+        if (FAILED(hr))
+        {
+            LOG("VertexShader: %s format 0x%x can not be reflected", shaderPath.u8string().c_str(), format);
+            return false;
+        }
+
+        D3D11_SHADER_DESC shaderDesc = {};
+        reflection->GetDesc(&shaderDesc);
+        bool matches = true;
+        for (UINT i = 0; i < shaderDesc.InputParameters; ++i)
+        {
+            D3D11_SIGNATURE_PARAMETER_DESC parameter = {};
+            reflection->GetInputParameterDesc(i, &parameter);
+            if (parameter.SystemValueType != D3D_NAME_UNDEFINED)
+            {
+                continue; // generated by the input assembler, e.g. SV_VertexID
+            }
+            auto element = std::find_if(vertexLayout.begin(), vertexLayout.end(), [&](const D3D11_INPUT_ELEMENT_DESC& desc)
+            {
+                return _stricmp(desc.SemanticName, parameter.SemanticName) == 0 && desc.SemanticIndex == parameter.SemanticIndex;
+            });
+            if (element == vertexLayout.end())
+            {
+                LOG("VertexShader: %s format 0x%x reads %s%d, the input layout has no such element", shaderPath.u8string().c_str(), format, parameter.SemanticName, parameter.SemanticIndex);
+                matches = false;
+            }
+            // R32_UINT is the only integer format GetVertexLayout uses
+            else if ((parameter.ComponentType == D3D_REGISTER_COMPONENT_FLOAT32) == (element->Format == DXGI_FORMAT_R32_UINT))
+            {
+                LOG("VertexShader: %s format 0x%x reads %s%d as another component type than the input layout", shaderPath.u8string().c_str(), format, parameter.SemanticName, parameter.SemanticIndex);
+                matches = false;
+            }
+        }
+        SafeRelease(reflection);
+        return matches;
+    }
 }
 
 void VertexShader::Initialize(const std::filesystem::path& shaderPath, uint32_t format)
 {
-    auto device = GraphicsSystem::Get()->GetDevice();
+    auto backend = GraphicsSystem::Get()->GetBackend();
 
     DWORD shaderFlags = D3DCOMPILE_ENABLE_STRICTNESS | D3DCOMPILE_DEBUG;
     ID3DBlob* shaderBlob = nullptr;
     ID3DBlob* errorBlob = nullptr;
+    std::vector<D3D_SHADER_MACRO> defines;
+    if (format & VE_Packed)
+    {
+        defines.push_back({ "PACKED_VERTEX", "1" });
+    }
+    if (format & VE_Instanced)
+    {
+        defines.push_back({ "INSTANCED", "1" });
+    }
+    defines.push_back({ nullptr, nullptr });
     HRESULT hr = D3DCompileFromFile(
         shaderPath.c_str(),
-        nullptr,
+        defines.data(),
         D3D_COMPILE_STANDARD_FILE_INCLUDE,
         "VS", "vs_5_0",
         shaderFlags, 0,
@@ -58,38 +131,78 @@ void VertexShader::Initialize(const std::filesystem::path& shaderPath, uint32_t
     }
     ASSERT(SUCCEEDED(hr), "Failed to compile vertex shader");
 
-    hr = device->CreateVertexShader(
+    hr = backend->CreateVertexShader(
         shaderBlob->GetBufferPointer(),
         shaderBlob->GetBufferSize(),
-        nullptr,
         &mVertexShader);
     ASSERT(SUCCEEDED(hr), "Failed to create vertex shader");
     //=================================================================================
 
     // STATE WHAT THE VERTEX VARIABLES ARE
     std::vector<D3D11_INPUT_ELEMENT_DESC> vertexLayout = GetVertexLayout(format);
+    ASSERT(MatchesInputSignature(shaderBlob, vertexLayout, shaderPath, format), "VertexShader: %s does not match the input layout of format 0x%x", shaderPath.u8string().c_str(), format);
 
-    hr = device->CreateInputLayout(
+    hr = backend->CreateInputLayout(
         vertexLayout.data(),
         static_cast<UINT>(vertexLayout.size()),
         shaderBlob->GetBufferPointer(),
         shaderBlob->GetBufferSize(),
         &mInputLayout);
     ASSERT(SUCCEEDED(hr), "Failed to create input layout");
+
+    // the same shader over a mesh buffer with a separate position stream
+    const uint32_t attributes = VE_Normal | VE_Tangent | VE_Color | VE_TexCoord;
+    if ((format & VE_Position) != 0 && (format & attributes) != 0)
+    {
+        std::vector<D3D11_INPUT_ELEMENT_DESC> splitLayout = GetVertexLayout(format | VE_PositionStream);
+        hr = backend->CreateInputLayout(
+            splitLayout.data(),
+            static_cast<UINT>(splitLayout.size()),
+            shaderBlob->GetBufferPointer(),
+            shaderBlob->GetBufferSize(),
+            &mSplitInputLayout);
+        ASSERT(SUCCEEDED(hr), "Failed to create split input layout");
+        mHasSplitLayout = true;
+    }
     SafeRelease(shaderBlob);
     SafeRelease(errorBlob);
 }
 
 void VertexShader::Terminate()
 {
+    GraphicsSystem::Get()->GetStateCache()->Forget(this);
+    SafeRelease(mSplitInputLayout);
+    mHasSplitLayout = false;
     SafeRelease(mInputLayout);
     SafeRelease(mVertexShader);
 }
 
 void VertexShader::Bind()
 {
-    auto context = GraphicsSystem::Get()->GetContext();
+    GraphicsSystem* gs = GraphicsSystem::Get();
+    GraphicsStateCache* stateCache = gs->GetStateCache();
     // bind buffers
-    context->VSSetShader(mVertexShader, nullptr, 0);
-    context->IASetInputLayout(mInputLayout);
+    if (stateCache->SetVertexShader(this))
+    {
+        gs->GetBackend()->VSSetShader(mVertexShader);
+    }
+    if (stateCache->SetInputLayout(this, 0))
+    {
+        gs->GetBackend()->IASetInputLayout(mInputLayout);
+    }
+}
+
+void VertexShader::BindSplit()
+{
+    ASSERT(mHasSplitLayout, "VertexShader: format has no split layout");
+    GraphicsSystem* gs = GraphicsSystem::Get();
+    GraphicsStateCache* stateCache = gs->GetStateCache();
+    if (stateCache->SetVertexShader(this))
+    {
+        gs->GetBackend()->VSSetShader(mVertexShader);
+    }
+    if (stateCache->SetInputLayout(this, 1))
+    {
+        gs->GetBackend()->IASetInputLayout(mSplitInputLayout);
+    }
 }
\ No newline at end of file
@@ -0,0 +1,69 @@
+#pragma once
+
+#include "Vector3Stream.h"
+#include "QuaternionStream.h"
+
+namespace ML_Engine::Math
+{
+	struct Matrix4;
+	struct Frustum;
+
+	// Batch versions of the Vector3 functions in DWMath.h.
+	// Outputs are resized to match the input, and may alias the input.
+	void TransformCoord(const Vector3Stream& v, const Matrix4& m, Vector3Stream& result);
+	void TransformNormal(const Vector3Stream& v, const Matrix4& m, Vector3Stream& result);
+	void Normalize(const Vector3Stream& v, Vector3Stream& result);
+	void Cross(const Vector3Stream& a, const Vector3Stream& b, Vector3Stream& result);
+	// result must have room for a.Size() values
+	void Dot(const Vector3Stream& a, const Vector3Stream& b, float* result);
+
+	// AoS <-> SoA conversion.
+	// stride is the distance in bytes between consecutive vectors, so these can
+	// read and write a Vector3 member of an interleaved vertex array directly.
+	void LoadStream(const Vector3* src, size_t count, size_t stride, Vector3Stream& dst);
+	void StoreStream(const Vector3Stream& src, Vector3* dst, size_t stride);
+
+	inline void LoadStream(const Vector3* src, size_t count, Vector3Stream& dst)
+	{
+		LoadStream(src, count, sizeof(Vector3), dst);
+	}
+	inline void StoreStream(const Vector3Stream& src, Vector3* dst)
+	{
+		StoreStream(src, dst, sizeof(Vector3));
+	}
+
+	// Quaternion interpolation over N pairs, t holds one value per pair.
+	// All variants take the shortest path and return normalized quaternions.
+	// Errors are the rotation angle between the result and Quaternion::Slerp.
+	// Nlerp:          normalized lerp, error up to 0.15 rad for rotations 180 degrees apart
+	// NlerpCorrected: nlerp with t remapped by a fitted cubic, no trig, error below 1e-3 rad
+	// Slerp:          exact, evaluates acos/sin per pair
+	void Nlerp(const QuaternionStream& q0, const QuaternionStream& q1, const float* t, QuaternionStream& result);
+	void NlerpCorrected(const QuaternionStream& q0, const QuaternionStream& q1, const float* t, QuaternionStream& result);
+	void Slerp(const QuaternionStream& q0, const QuaternionStream& q1, const float* t, QuaternionStream& result);
+
+	// Same as above with one t shared by every pair
+	void Nlerp(const QuaternionStream& q0, const QuaternionStream& q1, float t, QuaternionStream& result);
+	void NlerpCorrected(const QuaternionStream& q0, const QuaternionStream& q1, float t, QuaternionStream& result);
+	void Slerp(const QuaternionStream& q0, const QuaternionStream& q1, float t, QuaternionStream& result);
+
+	// Batch Matrix4::MatrixRotationQuaternion, result must have room for q.Size() matrices
+	void MatrixRotationQuaternion(const QuaternionStream& q, Matrix4* result);
+
+	void LoadStream(const Quaternion* src, size_t count, QuaternionStream& dst);
+	void StoreStream(const QuaternionStream& src, Quaternion* dst);
+
+	// Bounding volumes as SoA, one center/extend (or radius) per volume.
+	// visible[i] is set to 1 when volume i is at least partly inside the frustum.
+	void Intersect(const Frustum& frustum, const Vector3Stream& centers, const Vector3Stream& extends, uint8_t* visible);
+	void Intersect(const Frustum& frustum, const Vector3Stream& centers, const float* radii, uint8_t* visible);
+	void TransformAABB(const Vector3Stream& centers, const Vector3Stream& extends, const Matrix4& m, Vector3Stream& resultCenters, Vector3Stream& resultExtends);
+
+	// Fast tier transcendentals over arrays, same error bounds as Math::Fast (FastMath.h).
+	// result may alias x.
+	void Sin(const float* x, float* result, size_t count);
+	void Cos(const float* x, float* result, size_t count);
+	void SinCos(const float* x, float* sinResult, float* cosResult, size_t count);
+	void Rsqrt(const float* x, float* result, size_t count);
+	void Acos(const float* x, float* result, size_t count);
+}
@@ -3,5 +3,6 @@
 #include <Core/Inc/Core.h>
 
 #include <cmath>
+#include <cstring>
 #include <numeric>
 #include <random>
\ No newline at end of file
@@ -7,7 +7,15 @@
 #include "Vector3.h"
 #include "Vector4.h"
 #include "Quaternion.h"
+#include "FastMath.h"
 #include "Matrix4.h"
+#include "SIMD.h"
+#include "Matrix4Scalar.h"
+#include "Matrix4SIMD.h"
+#include "Vector3Stream.h"
+#include "Geometry.h"
+#include "QuaternionStream.h"
+#include "BatchMath.h"
 
 namespace ML_Engine::Math
 {
@@ -64,12 +72,12 @@ namespace ML_Engine::Math
 
     inline float DistanceSqr(Vector3 a, Vector3 b)
     {
-        return abs((a.x - b.x) * (a.x - b.x) + (a.y - b.y) * (a.y - b.y) + (a.z - b.z) * (a.z - b.z));
+        return std::abs((a.x - b.x) * (a.x - b.x) + (a.y - b.y) * (a.y - b.y) + (a.z - b.z) * (a.z - b.z));
     }
 
     inline float Distance(Vector3 a, Vector3 b)
     {
-        return sqrt(abs((a.x - b.x) * (a.x - b.x) + (a.y - b.y) * (a.y - b.y) + (a.z - b.z) * (a.z - b.z)));
+        return sqrt(std::abs((a.x - b.x) * (a.x - b.x) + (a.y - b.y) * (a.y - b.y) + (a.z - b.z) * (a.z - b.z)));
     }
 
     inline Vector3 Normalize(Vector3 a)
@@ -105,14 +113,22 @@ namespace ML_Engine::Math
         return { x, y, z };
     }
 
+    inline Matrix4 Matrix4::operator*(const Matrix4& rhs) const
+    {
+#if ML_MATH_SIMD != ML_MATH_SIMD_SCALAR
+        return SIMD::Multiply(*this, rhs);
+#else
+        return Scalar::Multiply(*this, rhs);
+#endif
+    }
+
     inline Matrix4 Transpose(const Matrix4& m)
     {
-        return Matrix4(
-            m._11, m._21, m._31, m._41,
-            m._12, m._22, m._32, m._42,
-            m._13, m._23, m._33, m._43,
-            m._14, m._24, m._34, m._44
-        );
+#if ML_MATH_SIMD != ML_MATH_SIMD_SCALAR
+        return SIMD::Transpose(m);
+#else
+        return Scalar::Transpose(m);
+#endif
     }
 
     inline Matrix4 Matrix4::RotationAxis(const Vector3& axis, float rad)
@@ -121,8 +137,8 @@ namespace ML_Engine::Math
         const float x = u.x;
         const float y = u.y;
         const float z = u.z;
-        const float s = sin(rad);
-        const float c = cos(rad);
+        float s = 0.0f, c = 0.0f;
+        SinCos(rad, s, c);
 
         return {
             c + (x * x * (1.0f - c)),
@@ -146,43 +162,27 @@ namespace ML_Engine::Math
 
     inline float Determinant(const Matrix4& m)
     {
-        float det = 0.0f;
-        det += (m._11 * (m._22 * (m._33 * m._44 - (m._43 * m._34)) - m._23 * (m._32 * m._44 - (m._42 * m._34)) + m._24 * (m._32 * m._43 - (m._42 * m._33))));
-        det -= (m._12 * (m._21 * (m._33 * m._44 - (m._43 * m._34)) - m._23 * (m._31 * m._44 - (m._41 * m._34)) + m._24 * (m._31 * m._43 - (m._41 * m._33))));
-        det += (m._13 * (m._21 * (m._32 * m._44 - (m._42 * m._34)) - m._22 * (m._31 * m._44 - (m._41 * m._34)) + m._24 * (m._31 * m._42 - (m._41 * m._32))));
-        det -= (m._14 * (m._21 * (m._32 * m._43 - (m._42 * m._33)) - m._22 * (m._31 * m._43 - (m._41 * m._33)) + m._23 * (m._31 * m._42 - (m._41 * m._32))));
-
-        return det;
+#if ML_MATH_SIMD != ML_MATH_SIMD_SCALAR
+        return SIMD::Determinant(m);
+#else
+        return Scalar::Determinant(m);
+#endif
     }
     inline Matrix4 Adjoint(const Matrix4& m)
     {
-        return Matrix4(
-            +(m._22 * ((m._33 * m._44) - (m._43 * m._34)) - m._23 * ((m._32 * m._44) - (m._42 * m._34)) + m._24 * ((m._32 * m._43) - (m._42 * m._33))),
-            -(m._12 * ((m._33 * m._44) - (m._43 * m._34)) - m._13 * ((m._32 * m._44) - (m._42 * m._34)) + m._14 * ((m._32 * m._43) - (m._42 * m._33))),
-            +(m._12 * ((m._23 * m._44) - (m._43 * m._24)) - m._13 * ((m._22 * m._44) - (m._42 * m._24)) + m._14 * ((m._22 * m._43) - (m._42 * m._23))),
-            -(m._12 * ((m._23 * m._34) - (m._33 * m._24)) - m._13 * ((m._22 * m._34) - (m._32 * m._24)) + m._14 * ((m._22 * m._33) - (m._32 * m._23))),
-
-            -(m._21 * ((m._33 * m._44) - (m._43 * m._34)) - m._31 * ((m._23 * m._44) - (m._24 * m._43)) + m._41 * ((m._23 * m._34) - (m._24 * m._33))),
-            +(m._11 * ((m._33 * m._44) - (m._43 * m._34)) - m._13 * ((m._31 * m._44) - (m._41 * m._34)) + m._14 * ((m._31 * m._43) - (m._41 * m._33))),
-            -(m._11 * ((m._23 * m._44) - (m._43 * m._24)) - m._13 * ((m._21 * m._44) - (m._41 * m._24)) + m._14 * ((m._21 * m._43) - (m._41 * m._23))),
-            +(m._11 * ((m._23 * m._34) - (m._33 * m._24)) - m._13 * ((m._21 * m._34) - (m._31 * m._24)) + m._14 * ((m._21 * m._33) - (m._31 * m._23))),
-
-            +(m._21 * ((m._32 * m._44) - (m._42 * m._34)) - m._31 * ((m._22 * m._44) - (m._42 * m._24)) + m._41 * ((m._22 * m._34) - (m._32 * m._24))),
-            -(m._11 * ((m._32 * m._44) - (m._42 * m._34)) - m._31 * ((m._12 * m._44) - (m._42 * m._14)) + m._41 * ((m._12 * m._34) - (m._32 * m._14))),
-            +(m._11 * ((m._22 * m._44) - (m._42 * m._24)) - m._12 * ((m._21 * m._44) - (m._41 * m._24)) + m._14 * ((m._21 * m._42) - (m._41 * m._22))),
-            -(m._11 * ((m._22 * m._34) - (m._32 * m._24)) - m._21 * ((m._12 * m._34) - (m._32 * m._14)) + m._31 * ((m._12 * m._24) - (m._22 * m._14))),
-
-            -(m._21 * ((m._32 * m._43) - (m._42 * m._33)) - m._31 * ((m._22 * m._43) - (m._42 * m._23)) + m._41 * ((m._22 * m._33) - (m._32 * m._23))),
-            +(m._11 * ((m._32 * m._43) - (m._42 * m._33)) - m._12 * ((m._31 * m._43) - (m._41 * m._33)) + m._13 * ((m._31 * m._42) - (m._41 * m._32))),
-            -(m._11 * ((m._22 * m._43) - (m._42 * m._23)) - m._12 * ((m._21 * m._43) - (m._41 * m._23)) + m._13 * ((m._21 * m._42) - (m._41 * m._22))),
-            +(m._11 * ((m._22 * m._33) - (m._32 * m._23)) - m._12 * ((m._21 * m._33) - (m._31 * m._23)) + m._13 * ((m._21 * m._32) - (m._31 * m._22)))
-        );
+#if ML_MATH_SIMD != ML_MATH_SIMD_SCALAR
+        return SIMD::Adjoint(m);
+#else
+        return Scalar::Adjoint(m);
+#endif
     }
     inline Matrix4 Inverse(const Matrix4& m)
     {
-        const float determinant = Determinant(m);
-        const float invDet = 1.0f / determinant;
-        return Adjoint(m) * invDet;
+#if ML_MATH_SIMD != ML_MATH_SIMD_SCALAR
+        return SIMD::Inverse(m);
+#else
+        return Scalar::Inverse(m);
+#endif
     }
 
     inline Vector3 GetTranslation(const Matrix4& m)
@@ -209,4 +209,111 @@ namespace ML_Engine::Math
     {
         return { m._11, m._22, m._33 };
     }
+
+    // Matrix classification, from most general to most specific.
+    // Affine:      last column is (0, 0, 0, 1)
+    // TRS:         affine with mutually orthogonal basis rows (scale * rotation * translation)
+    // Orthonormal: TRS with unit length basis rows (rotation * translation)
+    enum class MatrixType
+    {
+        General,
+        Affine,
+        TRS,
+        Orthonormal
+    };
+
+    inline MatrixType Classify(const Matrix4& m, float epsilon = 1e-3f)
+    {
+        if (Abs(m._14) > epsilon || Abs(m._24) > epsilon || Abs(m._34) > epsilon || Abs(m._44 - 1.0f) > epsilon)
+        {
+            return MatrixType::General;
+        }
+
+        const Vector3 r = GetRight(m);
+        const Vector3 u = GetUp(m);
+        const Vector3 l = GetLook(m);
+        const float rr = MagnitudeSqr(r);
+        const float uu = MagnitudeSqr(u);
+        const float ll = MagnitudeSqr(l);
+        const auto orthogonal = [epsilon](const Vector3& a, float aa, const Vector3& b, float bb)
+        {
+            return Sqr(Dot(a, b)) <= Sqr(epsilon) * aa * bb;
+        };
+        if (rr <= 0.0f || uu <= 0.0f || ll <= 0.0f ||
+            !orthogonal(r, rr, u, uu) || !orthogonal(r, rr, l, ll) || !orthogonal(u, uu, l, ll))
+        {
+            return MatrixType::Affine;
+        }
+
+        if (Abs(rr - 1.0f) > epsilon || Abs(uu - 1.0f) > epsilon || Abs(ll - 1.0f) > epsilon)
+        {
+            return MatrixType::TRS;
+        }
+        return MatrixType::Orthonormal;
+    }
+
+    inline bool IsAffine(const Matrix4& m) { return Classify(m) != MatrixType::General; }
+    inline bool IsTRS(const Matrix4& m) { return Classify(m) >= MatrixType::TRS; }
+    inline bool IsOrthonormal(const Matrix4& m) { return Classify(m) == MatrixType::Orthonormal; }
+
+    // Inverse of a matrix with no projection, only the upper 3x3 is inverted
+    inline Matrix4 InverseAffine(const Matrix4& m)
+    {
+        ASSERT(IsAffine(m), "DWMath: InverseAffine called on a non affine matrix");
+
+        const float c11 = m._22 * m._33 - m._23 * m._32;
+        const float c12 = m._23 * m._31 - m._21 * m._33;
+        const float c13 = m._21 * m._32 - m._22 * m._31;
+        const float invDet = 1.0f / (m._11 * c11 + m._12 * c12 + m._13 * c13);
+
+        Matrix4 inv(
+            c11 * invDet, (m._13 * m._32 - m._12 * m._33) * invDet, (m._12 * m._23 - m._13 * m._22) * invDet, 0.0f,
+            c12 * invDet, (m._11 * m._33 - m._13 * m._31) * invDet, (m._13 * m._21 - m._11 * m._23) * invDet, 0.0f,
+            c13 * invDet, (m._12 * m._31 - m._11 * m._32) * invDet, (m._11 * m._22 - m._12 * m._21) * invDet, 0.0f,
+            0.0f, 0.0f, 0.0f, 1.0f);
+        const Vector3 t = -TransformNormal(GetTranslation(m), inv);
+        inv._41 = t.x;
+        inv._42 = t.y;
+        inv._43 = t.z;
+        return inv;
+    }
+
+    // Inverse of scale * rotation * translation, the basis rows are orthogonal
+    // so the 3x3 inverse is the transpose divided by each row's squared length
+    inline Matrix4 InverseTRS(const Matrix4& m)
+    {
+        ASSERT(IsTRS(m), "DWMath: InverseTRS called on a matrix with shear or projection");
+
+        const float sx = 1.0f / MagnitudeSqr(GetRight(m));
+        const float sy = 1.0f / MagnitudeSqr(GetUp(m));
+        const float sz = 1.0f / MagnitudeSqr(GetLook(m));
+
+        Matrix4 inv(
+            m._11 * sx, m._21 * sy, m._31 * sz, 0.0f,
+            m._12 * sx, m._22 * sy, m._32 * sz, 0.0f,
+            m._13 * sx, m._23 * sy, m._33 * sz, 0.0f,
+            0.0f, 0.0f, 0.0f, 1.0f);
+        const Vector3 t = -TransformNormal(GetTranslation(m), inv);
+        inv._41 = t.x;
+        inv._42 = t.y;
+        inv._43 = t.z;
+        return inv;
+    }
+
+    // Inverse of rotation * translation, such as a camera view matrix
+    inline Matrix4 InverseOrthonormal(const Matrix4& m)
+    {
+        ASSERT(IsOrthonormal(m), "DWMath: InverseOrthonormal called on a matrix that is not rotation/translation only");
+
+        Matrix4 inv(
+            m._11, m._21, m._31, 0.0f,
+            m._12, m._22, m._32, 0.0f,
+            m._13, m._23, m._33, 0.0f,
+            0.0f, 0.0f, 0.0f, 1.0f);
+        const Vector3 t = -TransformNormal(GetTranslation(m), inv);
+        inv._41 = t.x;
+        inv._42 = t.y;
+        inv._43 = t.z;
+        return inv;
+    }
 }
\ No newline at end of file
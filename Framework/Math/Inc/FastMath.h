@@ -0,0 +1,143 @@
+#pragma once
+
+#include "Constants.h"
+#include "SIMD.h"
+
+// Precision tiers for the transcendental functions.
+//
+// Exact:     Math::Sin, Cos, SinCos, Rsqrt, Acos. Thin wrappers over the C runtime.
+// Constexpr: Math::ConstSin, ConstCos, ConstSinCos. Polynomial versions accurate
+//            to float rounding (max abs error 2.5e-7 for |x| <= 1000), usable in
+//            constant expressions.
+// Fast:      Math::Fast::Sin, Cos, SinCos, Rsqrt, Acos. Lower degree polynomials
+//            and hardware estimates, max errors are listed on each function.
+// Batch:     array versions of the fast tier in BatchMath.h.
+//
+// The polynomial versions reduce the argument with a rounded multiple of 2 pi, so
+// accuracy degrades for very large angles; keep inputs in a sane range. The scalar
+// versions still return values in [-1, 1] for any finite angle.
+//
+// Matrix4::RotationX/Y/Z use the exact tier, ConstRotationX/Y/Z the constexpr one.
+namespace ML_Engine::Math
+{
+    inline float Sin(float x) { return sinf(x); }
+    inline float Cos(float x) { return cosf(x); }
+    inline void SinCos(float x, float& s, float& c) { s = sinf(x); c = cosf(x); }
+    inline float Rsqrt(float x) { return 1.0f / sqrtf(x); }
+    inline float Acos(float x) { return acosf(x); }
+
+    namespace Detail
+    {
+        // Reduces x to [-pi/2, pi/2] so that sin(x) == sin(r) and cos(x) == cosSign * cos(r)
+        constexpr float ReduceAngle(float x, float& cosSign)
+        {
+            // 2 pi split in two so k * TwoPiHi is exact for moderate k
+            constexpr float TwoPiHi = 6.28125f;
+            constexpr float TwoPiLo = 1.9353071795864769e-3f;
+            constexpr float InvTwoPi = 0.15915494309189535f;
+
+            // one pass for sane angles. Beyond that k * TwoPiHi is no longer exact and the
+            // remainder can still be many turns, so reduce again until it is within one
+            float r = x;
+            do
+            {
+                const float q = r * InvTwoPi;
+                // every float of this size is already a whole number, and too big for an int
+                const bool isWhole = q >= 8388608.0f || q <= -8388608.0f;
+                const float k = isWhole ? q : static_cast<float>(static_cast<int>(q >= 0.0f ? q + 0.5f : q - 0.5f));
+                r = (r - k * TwoPiHi) - k * TwoPiLo;
+            } while (r > Constants::Pi || r < -Constants::Pi);
+
+            // float pi is 8.7e-8 too big, Pi - r is exact here so add the difference back
+            constexpr float PiLo = -8.7422777e-8f;
+            cosSign = 1.0f;
+            if (r > Constants::HalfPi)
+            {
+                r = (Constants::Pi - r) + PiLo;
+                cosSign = -1.0f;
+            }
+            else if (r < -Constants::HalfPi)
+            {
+                r = (-Constants::Pi - r) - PiLo;
+                cosSign = -1.0f;
+            }
+            return r;
+        }
+    }
+
+    constexpr void ConstSinCos(float x, float& s, float& c)
+    {
+        float cosSign = 1.0f;
+        const float r = Detail::ReduceAngle(x, cosSign);
+        const float r2 = r * r;
+        // Taylor series to r^11 / r^12, the truncation error is below float precision on [-pi/2, pi/2]
+        s = r * (1.0f + r2 * (-1.6666667e-1f + r2 * (8.3333333e-3f + r2 * (-1.9841270e-4f + r2 * (2.7557319e-6f + r2 * -2.5052108e-8f)))));
+        c = cosSign * (1.0f + r2 * (-0.5f + r2 * (4.1666667e-2f + r2 * (-1.3888889e-3f + r2 * (2.4801587e-5f + r2 * (-2.7557319e-7f + r2 * 2.0876757e-9f))))));
+    }
+
+    constexpr float ConstSin(float x)
+    {
+        float s = 0.0f, c = 0.0f;
+        ConstSinCos(x, s, c);
+        return s;
+    }
+
+    constexpr float ConstCos(float x)
+    {
+        float s = 0.0f, c = 0.0f;
+        ConstSinCos(x, s, c);
+        return c;
+    }
+
+    namespace Fast
+    {
+        // max abs error 4e-6 for |x| <= 1000, also usable in constant expressions
+        constexpr void SinCos(float x, float& s, float& c)
+        {
+            float cosSign = 1.0f;
+            const float r = Detail::ReduceAngle(x, cosSign);
+            const float r2 = r * r;
+            s = r * (1.0f + r2 * (-1.6666667e-1f + r2 * (8.3333333e-3f + r2 * (-1.9841270e-4f + r2 * 2.7557319e-6f))));
+            c = cosSign * (1.0f + r2 * (-0.5f + r2 * (4.1666667e-2f + r2 * (-1.3888889e-3f + r2 * (2.4801587e-5f + r2 * -2.7557319e-7f)))));
+        }
+
+        constexpr float Sin(float x)
+        {
+            float s = 0.0f, c = 0.0f;
+            SinCos(x, s, c);
+            return s;
+        }
+
+        constexpr float Cos(float x)
+        {
+            float s = 0.0f, c = 0.0f;
+            SinCos(x, s, c);
+            return c;
+        }
+
+        // x > 0, max relative error 3e-7 (hardware estimate refined with one Newton step),
+        // 5e-6 on the scalar backend
+        inline float Rsqrt(float x)
+        {
+#if ML_MATH_SIMD != ML_MATH_SIMD_SCALAR
+            const float y = _mm_cvtss_f32(_mm_rsqrt_ss(_mm_set_ss(x)));
+#else
+            uint32_t i = 0;
+            std::memcpy(&i, &x, sizeof(float));
+            i = 0x5f375a86 - (i >> 1);
+            float y = 0.0f;
+            std::memcpy(&y, &i, sizeof(float));
+            y = y * (1.5f - 0.5f * x * y * y);
+#endif
+            return y * (1.5f - 0.5f * x * y * y);
+        }
+
+        // max abs error 7e-5 rad for x in [-1, 1] (Abramowitz and Stegun 4.4.45)
+        inline float Acos(float x)
+        {
+            const float a = (x < 0.0f) ? -x : x;
+            const float r = sqrtf(1.0f - a) * (1.5707288f + a * (-0.2121144f + a * (0.0742610f + a * -0.0187293f)));
+            return (x < 0.0f) ? Constants::Pi - r : r;
+        }
+    }
+}
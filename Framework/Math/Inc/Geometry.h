@@ -0,0 +1,105 @@
+#pragma once
+
+namespace ML_Engine::Math
+{
+	// Axis aligned box stored as center and half size
+	struct AABB
+	{
+		Vector3 center = Vector3::Zero;
+		Vector3 extend = Vector3::Zero;
+
+		static AABB FromMinMax(const Vector3& min, const Vector3& max)
+		{
+			return { (min + max) * 0.5f, (max - min) * 0.5f };
+		}
+
+		Vector3 GetMin() const { return center - extend; }
+		Vector3 GetMax() const { return center + extend; }
+	};
+
+	struct Sphere
+	{
+		Vector3 center = Vector3::Zero;
+		float radius = 0.0f;
+	};
+
+	// Points p on the plane satisfy Dot(normal, p) + distance == 0,
+	// the normal points to the positive (inside) half space
+	struct Plane
+	{
+		Vector3 normal = Vector3::YAxis;
+		float distance = 0.0f;
+
+		static Plane FromPointNormal(const Vector3& point, const Vector3& normal);
+		static Plane FromPoints(const Vector3& a, const Vector3& b, const Vector3& c);
+	};
+
+	struct Ray
+	{
+		Vector3 origin = Vector3::Zero;
+		Vector3 direction = Vector3::ZAxis;
+	};
+
+	// Oriented box, extend is the half size along the rotated axes
+	struct OBB
+	{
+		Vector3 center = Vector3::Zero;
+		Vector3 extend = Vector3::Zero;
+		Quaternion rotation = Quaternion::Identity;
+	};
+
+	struct Frustum
+	{
+		enum Side
+		{
+			Left,
+			Right,
+			Bottom,
+			Top,
+			Near,
+			Far,
+			Count
+		};
+		std::array<Plane, Side::Count> planes;
+
+		// Extracts the planes from a view * projection matrix, normals face inward
+		static Frustum FromMatrix(const Matrix4& viewProjection);
+	};
+
+	enum class Containment
+	{
+		Disjoint,
+		Intersects,
+		Contains
+	};
+
+	// construction
+	AABB ComputeAABB(const Vector3* points, size_t count, size_t stride = sizeof(Vector3));
+	Sphere ComputeSphere(const AABB& aabb);
+	AABB Merge(const AABB& a, const AABB& b);
+	AABB Merge(const AABB& aabb, const Vector3& point);
+	AABB TransformAABB(const AABB& aabb, const Matrix4& m);
+	OBB TransformOBB(const AABB& aabb, const Matrix4& m);
+	Plane NormalizePlane(const Plane& plane);
+	float DistanceToPlane(const Plane& plane, const Vector3& point);
+
+	// overlap tests
+	bool Intersect(const AABB& a, const AABB& b);
+	bool Intersect(const Sphere& a, const Sphere& b);
+	bool Intersect(const Frustum& frustum, const AABB& aabb);
+	bool Intersect(const Frustum& frustum, const Sphere& sphere);
+	bool Intersect(const Frustum& frustum, const OBB& obb);
+
+	// containment tests
+	bool Contains(const AABB& aabb, const Vector3& point);
+	bool Contains(const Sphere& sphere, const Vector3& point);
+	Containment Contains(const Frustum& frustum, const AABB& aabb);
+	Containment Contains(const Frustum& frustum, const Sphere& sphere);
+
+	// ray tests, distance is the ray parameter of the first hit (in units of direction)
+	bool Intersect(const Ray& ray, const AABB& aabb, float& distance);
+	bool Intersect(const Ray& ray, const Sphere& sphere, float& distance);
+	bool Intersect(const Ray& ray, const OBB& obb, float& distance);
+	bool Intersect(const Ray& ray, const Plane& plane, float& distance);
+	bool Intersect(const Ray& ray, const Vector3& a, const Vector3& b, const Vector3& c, float& distance);
+}
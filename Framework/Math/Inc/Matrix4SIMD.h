@@ -0,0 +1,203 @@
+#pragma once
+
+#include "SIMD.h"
+
+#if ML_MATH_SIMD != ML_MATH_SIMD_SCALAR
+
+// SSE/AVX implementations of the Matrix4 operations.
+// Matrices are row major with row vectors, so each row of the result is a
+// linear combination of the rows of rhs. All loads and stores are unaligned
+// so the Matrix4 layout does not change.
+namespace ML_Engine::Math::SIMD
+{
+    namespace Detail
+    {
+        template<int X, int Y, int Z, int W>
+        inline __m128 Swizzle(__m128 v)
+        {
+            return _mm_shuffle_ps(v, v, _MM_SHUFFLE(W, Z, Y, X));
+        }
+
+        template<int X, int Y, int Z, int W>
+        inline __m128 Shuffle(__m128 a, __m128 b)
+        {
+            return _mm_shuffle_ps(a, b, _MM_SHUFFLE(W, Z, Y, X));
+        }
+
+        // 2x2 row major matrix multiply a * b
+        inline __m128 Mat2Mul(__m128 a, __m128 b)
+        {
+            return _mm_add_ps(
+                _mm_mul_ps(a, Swizzle<0, 3, 0, 3>(b)),
+                _mm_mul_ps(Swizzle<1, 0, 3, 2>(a), Swizzle<2, 1, 2, 1>(b)));
+        }
+
+        // 2x2 row major matrix adjugate multiply adj(a) * b
+        inline __m128 Mat2AdjMul(__m128 a, __m128 b)
+        {
+            return _mm_sub_ps(
+                _mm_mul_ps(Swizzle<3, 3, 0, 0>(a), b),
+                _mm_mul_ps(Swizzle<1, 1, 2, 2>(a), Swizzle<2, 3, 0, 1>(b)));
+        }
+
+        // 2x2 row major matrix multiply adjugate a * adj(b)
+        inline __m128 Mat2MulAdj(__m128 a, __m128 b)
+        {
+            return _mm_sub_ps(
+                _mm_mul_ps(a, Swizzle<3, 0, 3, 0>(b)),
+                _mm_mul_ps(Swizzle<1, 0, 3, 2>(a), Swizzle<2, 1, 2, 1>(b)));
+        }
+
+        inline __m128 HorizontalSum(__m128 v)
+        {
+            const __m128 s = _mm_add_ps(v, Swizzle<1, 0, 3, 2>(v));
+            return _mm_add_ps(s, Swizzle<2, 3, 0, 1>(s));
+        }
+
+        // Computes the adjugate as four 2x2 blocks (already transposed into
+        // output order) and the determinant splatted across all lanes.
+        // Uses the block matrix form so no scalar cofactors are needed.
+        inline void AdjugateBlocks(const Matrix4& m, __m128 rows[4], __m128& det)
+        {
+            const __m128 r0 = _mm_loadu_ps(&m.v[0]);
+            const __m128 r1 = _mm_loadu_ps(&m.v[4]);
+            const __m128 r2 = _mm_loadu_ps(&m.v[8]);
+            const __m128 r3 = _mm_loadu_ps(&m.v[12]);
+
+            // sub matrices
+            const __m128 a = _mm_movelh_ps(r0, r1);
+            const __m128 b = _mm_movehl_ps(r1, r0);
+            const __m128 c = _mm_movelh_ps(r2, r3);
+            const __m128 d = _mm_movehl_ps(r3, r2);
+
+            // determinants of the sub matrices as (|A| |B| |C| |D|)
+            const __m128 detSub = _mm_sub_ps(
+                _mm_mul_ps(Shuffle<0, 2, 0, 2>(r0, r2), Shuffle<1, 3, 1, 3>(r1, r3)),
+                _mm_mul_ps(Shuffle<1, 3, 1, 3>(r0, r2), Shuffle<0, 2, 0, 2>(r1, r3)));
+            const __m128 detA = Swizzle<0, 0, 0, 0>(detSub);
+            const __m128 detB = Swizzle<1, 1, 1, 1>(detSub);
+            const __m128 detC = Swizzle<2, 2, 2, 2>(detSub);
+            const __m128 detD = Swizzle<3, 3, 3, 3>(detSub);
+
+            const __m128 dc = Mat2AdjMul(d, c);
+            const __m128 ab = Mat2AdjMul(a, b);
+
+            __m128 x = _mm_sub_ps(_mm_mul_ps(detD, a), Mat2Mul(b, dc));
+            __m128 w = _mm_sub_ps(_mm_mul_ps(detA, d), Mat2Mul(c, ab));
+            __m128 y = _mm_sub_ps(_mm_mul_ps(detB, c), Mat2MulAdj(d, ab));
+            __m128 z = _mm_sub_ps(_mm_mul_ps(detC, b), Mat2MulAdj(a, dc));
+
+            // |M| = |A||D| + |B||C| - tr((A#B)(D#C))
+            const __m128 tr = HorizontalSum(_mm_mul_ps(ab, Swizzle<0, 2, 1, 3>(dc)));
+            det = _mm_sub_ps(_mm_add_ps(_mm_mul_ps(detA, detD), _mm_mul_ps(detB, detC)), tr);
+
+            const __m128 sign = _mm_setr_ps(1.0f, -1.0f, -1.0f, 1.0f);
+            x = _mm_mul_ps(x, sign);
+            y = _mm_mul_ps(y, sign);
+            z = _mm_mul_ps(z, sign);
+            w = _mm_mul_ps(w, sign);
+
+            rows[0] = Shuffle<3, 1, 3, 1>(x, y);
+            rows[1] = Shuffle<2, 0, 2, 0>(x, y);
+            rows[2] = Shuffle<3, 1, 3, 1>(z, w);
+            rows[3] = Shuffle<2, 0, 2, 0>(z, w);
+        }
+
+        inline Matrix4 Store(const __m128 rows[4])
+        {
+            Matrix4 result;
+            _mm_storeu_ps(&result.v[0], rows[0]);
+            _mm_storeu_ps(&result.v[4], rows[1]);
+            _mm_storeu_ps(&result.v[8], rows[2]);
+            _mm_storeu_ps(&result.v[12], rows[3]);
+            return result;
+        }
+    }
+
+    inline Matrix4 Multiply(const Matrix4& lhs, const Matrix4& rhs)
+    {
+        Matrix4 result;
+#if ML_MATH_SIMD == ML_MATH_SIMD_AVX
+        // two rows of lhs per register, each rhs row duplicated in both lanes
+        const __m256 b0 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(&rhs.v[0]));
+        const __m256 b1 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(&rhs.v[4]));
+        const __m256 b2 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(&rhs.v[8]));
+        const __m256 b3 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(&rhs.v[12]));
+
+        const __m256 a01 = _mm256_loadu_ps(&lhs.v[0]);
+        const __m256 a23 = _mm256_loadu_ps(&lhs.v[8]);
+
+        __m256 r01 = _mm256_mul_ps(_mm256_shuffle_ps(a01, a01, 0x00), b0);
+        r01 = _mm256_add_ps(r01, _mm256_mul_ps(_mm256_shuffle_ps(a01, a01, 0x55), b1));
+        r01 = _mm256_add_ps(r01, _mm256_mul_ps(_mm256_shuffle_ps(a01, a01, 0xAA), b2));
+        r01 = _mm256_add_ps(r01, _mm256_mul_ps(_mm256_shuffle_ps(a01, a01, 0xFF), b3));
+
+        __m256 r23 = _mm256_mul_ps(_mm256_shuffle_ps(a23, a23, 0x00), b0);
+        r23 = _mm256_add_ps(r23, _mm256_mul_ps(_mm256_shuffle_ps(a23, a23, 0x55), b1));
+        r23 = _mm256_add_ps(r23, _mm256_mul_ps(_mm256_shuffle_ps(a23, a23, 0xAA), b2));
+        r23 = _mm256_add_ps(r23, _mm256_mul_ps(_mm256_shuffle_ps(a23, a23, 0xFF), b3));
+
+        _mm256_storeu_ps(&result.v[0], r01);
+        _mm256_storeu_ps(&result.v[8], r23);
+#else
+        const __m128 b0 = _mm_loadu_ps(&rhs.v[0]);
+        const __m128 b1 = _mm_loadu_ps(&rhs.v[4]);
+        const __m128 b2 = _mm_loadu_ps(&rhs.v[8]);
+        const __m128 b3 = _mm_loadu_ps(&rhs.v[12]);
+        for (int i = 0; i < 16; i += 4)
+        {
+            const __m128 a = _mm_loadu_ps(&lhs.v[i]);
+            __m128 r = _mm_mul_ps(Detail::Swizzle<0, 0, 0, 0>(a), b0);
+            r = _mm_add_ps(r, _mm_mul_ps(Detail::Swizzle<1, 1, 1, 1>(a), b1));
+            r = _mm_add_ps(r, _mm_mul_ps(Detail::Swizzle<2, 2, 2, 2>(a), b2));
+            r = _mm_add_ps(r, _mm_mul_ps(Detail::Swizzle<3, 3, 3, 3>(a), b3));
+            _mm_storeu_ps(&result.v[i], r);
+        }
+#endif
+        return result;
+    }
+
+    inline Matrix4 Transpose(const Matrix4& m)
+    {
+        __m128 rows[4] =
+        {
+            _mm_loadu_ps(&m.v[0]),
+            _mm_loadu_ps(&m.v[4]),
+            _mm_loadu_ps(&m.v[8]),
+            _mm_loadu_ps(&m.v[12])
+        };
+        _MM_TRANSPOSE4_PS(rows[0], rows[1], rows[2], rows[3]);
+        return Detail::Store(rows);
+    }
+
+    inline float Determinant(const Matrix4& m)
+    {
+        __m128 rows[4];
+        __m128 det;
+        Detail::AdjugateBlocks(m, rows, det);
+        return _mm_cvtss_f32(det);
+    }
+
+    inline Matrix4 Adjoint(const Matrix4& m)
+    {
+        __m128 rows[4];
+        __m128 det;
+        Detail::AdjugateBlocks(m, rows, det);
+        return Detail::Store(rows);
+    }
+
+    inline Matrix4 Inverse(const Matrix4& m)
+    {
+        __m128 rows[4];
+        __m128 det;
+        Detail::AdjugateBlocks(m, rows, det);
+        const __m128 invDet = _mm_div_ps(_mm_set1_ps(1.0f), det);
+        rows[0] = _mm_mul_ps(rows[0], invDet);
+        rows[1] = _mm_mul_ps(rows[1], invDet);
+        rows[2] = _mm_mul_ps(rows[2], invDet);
+        rows[3] = _mm_mul_ps(rows[3], invDet);
+        return Detail::Store(rows);
+    }
+}
+
+#endif
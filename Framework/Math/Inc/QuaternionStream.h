@@ -0,0 +1,46 @@
+#pragma once
+
+#include "Vector3Stream.h"
+
+namespace ML_Engine::Math
+{
+	// Structure of arrays storage for Quaternion data, padded like Vector3Stream
+	struct QuaternionStream
+	{
+		std::vector<float> x;
+		std::vector<float> y;
+		std::vector<float> z;
+		std::vector<float> w;
+
+		QuaternionStream() = default;
+		explicit QuaternionStream(size_t count) { Resize(count); }
+
+		void Resize(size_t count)
+		{
+			const size_t padded = (count + BatchWidth - 1) / BatchWidth * BatchWidth;
+			x.resize(padded, 0.0f);
+			y.resize(padded, 0.0f);
+			z.resize(padded, 0.0f);
+			w.resize(padded, 1.0f);
+			mSize = count;
+		}
+		void Clear()
+		{
+			x.clear();
+			y.clear();
+			z.clear();
+			w.clear();
+			mSize = 0;
+		}
+
+		size_t Size() const { return mSize; }
+		size_t PaddedSize() const { return x.size(); }
+		bool Empty() const { return mSize == 0; }
+
+		Quaternion Get(size_t i) const { return { x[i], y[i], z[i], w[i] }; }
+		void Set(size_t i, const Quaternion& q) { x[i] = q.x; y[i] = q.y; z[i] = q.z; w[i] = q.w; }
+
+	private:
+		size_t mSize = 0;
+	};
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+// Compile time selection of the math backend.
+// Define ML_MATH_SIMD to one of the values below to force a backend,
+// otherwise the widest instruction set enabled for the build is used.
+#define ML_MATH_SIMD_SCALAR 0
+#define ML_MATH_SIMD_SSE    1
+#define ML_MATH_SIMD_AVX    2
+
+#if !defined(ML_MATH_SIMD)
+    #if defined(__AVX__)
+        #define ML_MATH_SIMD ML_MATH_SIMD_AVX
+    #elif defined(_M_X64) || defined(__SSE2__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+        #define ML_MATH_SIMD ML_MATH_SIMD_SSE
+    #else
+        #define ML_MATH_SIMD ML_MATH_SIMD_SCALAR
+    #endif
+#endif
+
+#if ML_MATH_SIMD == ML_MATH_SIMD_AVX
+    #include <immintrin.h>
+#elif ML_MATH_SIMD == ML_MATH_SIMD_SSE
+    #include <emmintrin.h>
+#endif
+
+namespace ML_Engine::Math
+{
+    enum class SIMDBackend
+    {
+        Scalar,
+        SSE,
+        AVX
+    };
+
+    constexpr SIMDBackend GetSIMDBackend()
+    {
+#if ML_MATH_SIMD == ML_MATH_SIMD_AVX
+        return SIMDBackend::AVX;
+#elif ML_MATH_SIMD == ML_MATH_SIMD_SSE
+        return SIMDBackend::SSE;
+#else
+        return SIMDBackend::Scalar;
+#endif
+    }
+}
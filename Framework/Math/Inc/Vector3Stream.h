@@ -0,0 +1,48 @@
+#pragma once
+
+#include "SIMD.h"
+
+namespace ML_Engine::Math
+{
+	// Number of floats processed per iteration by the batch kernels
+	constexpr size_t BatchWidth = (ML_MATH_SIMD == ML_MATH_SIMD_AVX) ? 8 : 4;
+
+	// Structure of arrays storage for Vector3 data.
+	// Each component lives in its own array, padded to a multiple of BatchWidth
+	// so the batch kernels never need a scalar tail loop.
+	struct Vector3Stream
+	{
+		std::vector<float> x;
+		std::vector<float> y;
+		std::vector<float> z;
+
+		Vector3Stream() = default;
+		explicit Vector3Stream(size_t count) { Resize(count); }
+
+		void Resize(size_t count)
+		{
+			const size_t padded = (count + BatchWidth - 1) / BatchWidth * BatchWidth;
+			x.resize(padded, 0.0f);
+			y.resize(padded, 0.0f);
+			z.resize(padded, 0.0f);
+			mSize = count;
+		}
+		void Clear()
+		{
+			x.clear();
+			y.clear();
+			z.clear();
+			mSize = 0;
+		}
+
+		size_t Size() const { return mSize; }
+		size_t PaddedSize() const { return x.size(); }
+		bool Empty() const { return mSize == 0; }
+
+		Vector3 Get(size_t i) const { return { x[i], y[i], z[i] }; }
+		void Set(size_t i, const Vector3& v) { x[i] = v.x; y[i] = v.y; z[i] = v.z; }
+
+	private:
+		size_t mSize = 0;
+	};
+}
@@ -0,0 +1,580 @@
+#include "Precompiled.h"
+#include "DWMath.h"
+
+using namespace ML_Engine::Math;
+
+namespace
+{
+	// Thin wrapper over the register type of the selected backend so each
+	// kernel is written once and processes BatchWidth vectors per iteration.
+#if ML_MATH_SIMD == ML_MATH_SIMD_AVX
+	using Lane = __m256;
+	inline Lane Load(const float* p) { return _mm256_loadu_ps(p); }
+	inline void Store(float* p, Lane a) { _mm256_storeu_ps(p, a); }
+	inline Lane Splat(float f) { return _mm256_set1_ps(f); }
+	inline Lane Add(Lane a, Lane b) { return _mm256_add_ps(a, b); }
+	inline Lane Sub(Lane a, Lane b) { return _mm256_sub_ps(a, b); }
+	inline Lane Mul(Lane a, Lane b) { return _mm256_mul_ps(a, b); }
+	inline Lane Div(Lane a, Lane b) { return _mm256_div_ps(a, b); }
+	inline Lane Sqrt(Lane a) { return _mm256_sqrt_ps(a); }
+	inline Lane Abs(Lane a) { return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), a); }
+	inline Lane Sign(Lane a) { return _mm256_or_ps(_mm256_and_ps(_mm256_set1_ps(-0.0f), a), _mm256_set1_ps(1.0f)); }
+	inline Lane Min(Lane a, Lane b) { return _mm256_min_ps(a, b); }
+	inline Lane Round(Lane a) { return _mm256_round_ps(a, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC); }
+	inline Lane Greater(Lane a, Lane b) { return _mm256_cmp_ps(a, b, _CMP_GT_OQ); }
+	inline Lane Less(Lane a, Lane b) { return _mm256_cmp_ps(a, b, _CMP_LT_OQ); }
+	inline Lane Select(Lane mask, Lane a, Lane b) { return _mm256_blendv_ps(b, a, mask); }
+	inline Lane RsqrtEstimate(Lane a) { return _mm256_rsqrt_ps(a); }
+#elif ML_MATH_SIMD == ML_MATH_SIMD_SSE
+	using Lane = __m128;
+	inline Lane Load(const float* p) { return _mm_loadu_ps(p); }
+	inline void Store(float* p, Lane a) { _mm_storeu_ps(p, a); }
+	inline Lane Splat(float f) { return _mm_set1_ps(f); }
+	inline Lane Add(Lane a, Lane b) { return _mm_add_ps(a, b); }
+	inline Lane Sub(Lane a, Lane b) { return _mm_sub_ps(a, b); }
+	inline Lane Mul(Lane a, Lane b) { return _mm_mul_ps(a, b); }
+	inline Lane Div(Lane a, Lane b) { return _mm_div_ps(a, b); }
+	inline Lane Sqrt(Lane a) { return _mm_sqrt_ps(a); }
+	inline Lane Abs(Lane a) { return _mm_andnot_ps(_mm_set1_ps(-0.0f), a); }
+	inline Lane Sign(Lane a) { return _mm_or_ps(_mm_and_ps(_mm_set1_ps(-0.0f), a), _mm_set1_ps(1.0f)); }
+	inline Lane Min(Lane a, Lane b) { return _mm_min_ps(a, b); }
+	inline Lane Round(Lane a) { return _mm_cvtepi32_ps(_mm_cvtps_epi32(a)); }
+	inline Lane Greater(Lane a, Lane b) { return _mm_cmpgt_ps(a, b); }
+	inline Lane Less(Lane a, Lane b) { return _mm_cmplt_ps(a, b); }
+	inline Lane Select(Lane mask, Lane a, Lane b) { return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b)); }
+	inline Lane RsqrtEstimate(Lane a) { return _mm_rsqrt_ps(a); }
+#else
+	struct Lane { float f[BatchWidth]; };
+	inline Lane Load(const float* p) { Lane r; for (size_t i = 0; i < BatchWidth; ++i) r.f[i] = p[i]; return r; }
+	inline void Store(float* p, Lane a) { for (size_t i = 0; i < BatchWidth; ++i) p[i] = a.f[i]; }
+	inline Lane Splat(float f) { Lane r; for (size_t i = 0; i < BatchWidth; ++i) r.f[i] = f; return r; }
+	inline Lane Add(Lane a, Lane b) { for (size_t i = 0; i < BatchWidth; ++i) a.f[i] += b.f[i]; return a; }
+	inline Lane Sub(Lane a, Lane b) { for (size_t i = 0; i < BatchWidth; ++i) a.f[i] -= b.f[i]; return a; }
+	inline Lane Mul(Lane a, Lane b) { for (size_t i = 0; i < BatchWidth; ++i) a.f[i] *= b.f[i]; return a; }
+	inline Lane Div(Lane a, Lane b) { for (size_t i = 0; i < BatchWidth; ++i) a.f[i] /= b.f[i]; return a; }
+	inline Lane Sqrt(Lane a) { for (size_t i = 0; i < BatchWidth; ++i) a.f[i] = std::sqrt(a.f[i]); return a; }
+	inline Lane Abs(Lane a) { for (size_t i = 0; i < BatchWidth; ++i) a.f[i] = std::fabs(a.f[i]); return a; }
+	inline Lane Sign(Lane a) { for (size_t i = 0; i < BatchWidth; ++i) a.f[i] = std::copysign(1.0f, a.f[i]); return a; }
+	inline Lane Min(Lane a, Lane b) { for (size_t i = 0; i < BatchWidth; ++i) a.f[i] = std::min(a.f[i], b.f[i]); return a; }
+	inline Lane Round(Lane a) { for (size_t i = 0; i < BatchWidth; ++i) a.f[i] = std::nearbyint(a.f[i]); return a; }
+	inline Lane Greater(Lane a, Lane b) { for (size_t i = 0; i < BatchWidth; ++i) a.f[i] = (a.f[i] > b.f[i]) ? 1.0f : 0.0f; return a; }
+	inline Lane Less(Lane a, Lane b) { for (size_t i = 0; i < BatchWidth; ++i) a.f[i] = (a.f[i] < b.f[i]) ? 1.0f : 0.0f; return a; }
+	inline Lane Select(Lane mask, Lane a, Lane b) { for (size_t i = 0; i < BatchWidth; ++i) a.f[i] = (mask.f[i] != 0.0f) ? a.f[i] : b.f[i]; return a; }
+	inline Lane RsqrtEstimate(Lane a) { for (size_t i = 0; i < BatchWidth; ++i) a.f[i] = 1.0f / std::sqrt(a.f[i]); return a; }
+#endif
+
+	void Transform(const Vector3Stream& v, const Matrix4& m, Vector3Stream& result, bool translate)
+	{
+		result.Resize(v.Size());
+
+		const Lane m11 = Splat(m._11), m12 = Splat(m._12), m13 = Splat(m._13);
+		const Lane m21 = Splat(m._21), m22 = Splat(m._22), m23 = Splat(m._23);
+		const Lane m31 = Splat(m._31), m32 = Splat(m._32), m33 = Splat(m._33);
+		const Lane m41 = Splat(translate ? m._41 : 0.0f);
+		const Lane m42 = Splat(translate ? m._42 : 0.0f);
+		const Lane m43 = Splat(translate ? m._43 : 0.0f);
+
+		const size_t count = v.PaddedSize();
+		for (size_t i = 0; i < count; i += BatchWidth)
+		{
+			const Lane x = Load(&v.x[i]);
+			const Lane y = Load(&v.y[i]);
+			const Lane z = Load(&v.z[i]);
+			Store(&result.x[i], Add(Add(Add(Mul(x, m11), Mul(y, m21)), Mul(z, m31)), m41));
+			Store(&result.y[i], Add(Add(Add(Mul(x, m12), Mul(y, m22)), Mul(z, m32)), m42));
+			Store(&result.z[i], Add(Add(Add(Mul(x, m13), Mul(y, m23)), Mul(z, m33)), m43));
+		}
+	}
+
+	// Writes 1 for each lane with a non negative distance, without writing past count
+	void StoreVisible(Lane minDistance, size_t i, size_t count, uint8_t* visible)
+	{
+		float distances[BatchWidth];
+		Store(distances, minDistance);
+		const size_t last = std::min(i + BatchWidth, count);
+		for (size_t j = i; j < last; ++j)
+		{
+			visible[j] = distances[j - i] >= 0.0f ? 1 : 0;
+		}
+	}
+
+	enum class QuaternionBlend
+	{
+		Nlerp,
+		NlerpCorrected,
+		Slerp
+	};
+
+	// Loads BatchWidth values starting at i without reading past count
+	Lane LoadPartial(const float* p, size_t i, size_t count)
+	{
+		if (i + BatchWidth <= count)
+		{
+			return Load(p + i);
+		}
+		float tail[BatchWidth] = {};
+		for (size_t j = i; j < count; ++j)
+		{
+			tail[j - i] = p[j];
+		}
+		return Load(tail);
+	}
+
+	// Lane version of Fast::SinCos, see FastMath.h for the error bounds
+	void SinCosLane(Lane x, Lane& s, Lane& c)
+	{
+		const Lane k = Round(Mul(x, Splat(0.15915494309189535f)));
+		Lane r = Sub(Sub(x, Mul(k, Splat(6.28125f))), Mul(k, Splat(1.9353071795864769e-3f)));
+
+		const Lane high = Greater(r, Splat(Constants::HalfPi));
+		const Lane low = Less(r, Splat(-Constants::HalfPi));
+		r = Select(high, Sub(Splat(Constants::Pi), r), Select(low, Sub(Splat(-Constants::Pi), r), r));
+		const Lane cosSign = Select(high, Splat(-1.0f), Select(low, Splat(-1.0f), Splat(1.0f)));
+
+		const Lane r2 = Mul(r, r);
+		Lane sp = Splat(2.7557319e-6f);
+		sp = Add(Splat(-1.9841270e-4f), Mul(r2, sp));
+		sp = Add(Splat(8.3333333e-3f), Mul(r2, sp));
+		sp = Add(Splat(-1.6666667e-1f), Mul(r2, sp));
+		sp = Add(Splat(1.0f), Mul(r2, sp));
+		s = Mul(r, sp);
+
+		Lane cp = Splat(-2.7557319e-7f);
+		cp = Add(Splat(2.4801587e-5f), Mul(r2, cp));
+		cp = Add(Splat(-1.3888889e-3f), Mul(r2, cp));
+		cp = Add(Splat(4.1666667e-2f), Mul(r2, cp));
+		cp = Add(Splat(-0.5f), Mul(r2, cp));
+		cp = Add(Splat(1.0f), Mul(r2, cp));
+		c = Mul(cosSign, cp);
+	}
+
+	// Runs kernel over count floats, the last partial batch goes through a scratch buffer
+	template<class Kernel>
+	void ForEachBatch(const float* x, float* result, size_t count, Kernel kernel)
+	{
+		for (size_t i = 0; i < count; i += BatchWidth)
+		{
+			if (i + BatchWidth <= count)
+			{
+				Store(result + i, kernel(Load(x + i)));
+			}
+			else
+			{
+				float tail[BatchWidth];
+				Store(tail, kernel(LoadPartial(x, i, count)));
+				for (size_t j = i; j < count; ++j)
+				{
+					result[j] = tail[j - i];
+				}
+			}
+		}
+	}
+
+	void Interpolate(const QuaternionStream& q0, const QuaternionStream& q1, const float* t, bool uniformT, QuaternionBlend blend, QuaternionStream& result)
+	{
+		ASSERT(q0.Size() == q1.Size(), "BatchMath: stream sizes do not match");
+		result.Resize(q0.Size());
+
+		const Lane one = Splat(1.0f);
+		const Lane half = Splat(0.5f);
+		const size_t count = q0.Size();
+		for (size_t i = 0; i < q0.PaddedSize(); i += BatchWidth)
+		{
+			const Lane lt = uniformT ? Splat(*t) : LoadPartial(t, i, count);
+			const Lane x0 = Load(&q0.x[i]);
+			const Lane y0 = Load(&q0.y[i]);
+			const Lane z0 = Load(&q0.z[i]);
+			const Lane w0 = Load(&q0.w[i]);
+			Lane x1 = Load(&q1.x[i]);
+			Lane y1 = Load(&q1.y[i]);
+			Lane z1 = Load(&q1.z[i]);
+			Lane w1 = Load(&q1.w[i]);
+
+			// flip q1 into the same hemisphere as q0 to take the shortest path
+			const Lane dot = Add(Add(Mul(x0, x1), Mul(y0, y1)), Add(Mul(z0, z1), Mul(w0, w1)));
+			const Lane sign = Sign(dot);
+			const Lane d = Abs(dot);
+			x1 = Mul(x1, sign);
+			y1 = Mul(y1, sign);
+			z1 = Mul(z1, sign);
+			w1 = Mul(w1, sign);
+
+			Lane s0, s1;
+			if (blend == QuaternionBlend::Slerp)
+			{
+				float dots[BatchWidth], ts[BatchWidth], scale0[BatchWidth], scale1[BatchWidth];
+				Store(dots, d);
+				Store(ts, lt);
+				for (size_t j = 0; j < BatchWidth; ++j)
+				{
+					if (dots[j] > 0.999999f)
+					{
+						scale0[j] = 1.0f - ts[j];
+						scale1[j] = ts[j];
+					}
+					else
+					{
+						const float theta = acosf(dots[j]);
+						const float invSinTheta = 1.0f / sinf(theta);
+						scale0[j] = sinf(theta * (1.0f - ts[j])) * invSinTheta;
+						scale1[j] = sinf(theta * ts[j]) * invSinTheta;
+					}
+				}
+				s0 = Load(scale0);
+				s1 = Load(scale1);
+			}
+			else if (blend == QuaternionBlend::NlerpCorrected)
+			{
+				// Remaps t so the nlerp result tracks the constant angular velocity of slerp.
+				// Cubic in t whose coefficients are fitted as polynomials of the cosine
+				// between the quaternions (Kapoulkine, "Approximating slerp").
+				const Lane ca = Add(Splat(1.0904f), Mul(d, Add(Splat(-3.2452f), Mul(d, Sub(Splat(3.55645f), Mul(d, Splat(1.43519f)))))));
+				const Lane cb = Add(Splat(0.848013f), Mul(d, Add(Splat(-1.06021f), Mul(d, Splat(0.215638f)))));
+				const Lane tc = Sub(lt, half);
+				const Lane k = Add(Mul(ca, Mul(tc, tc)), cb);
+				const Lane ot = Add(lt, Mul(Mul(Mul(lt, tc), Sub(lt, one)), k));
+				s0 = Sub(one, ot);
+				s1 = ot;
+			}
+			else
+			{
+				s0 = Sub(one, lt);
+				s1 = lt;
+			}
+
+			const Lane x = Add(Mul(x0, s0), Mul(x1, s1));
+			const Lane y = Add(Mul(y0, s0), Mul(y1, s1));
+			const Lane z = Add(Mul(z0, s0), Mul(z1, s1));
+			const Lane w = Add(Mul(w0, s0), Mul(w1, s1));
+			const Lane invMag = Div(one, Sqrt(Add(Add(Mul(x, x), Mul(y, y)), Add(Mul(z, z), Mul(w, w)))));
+			Store(&result.x[i], Mul(x, invMag));
+			Store(&result.y[i], Mul(y, invMag));
+			Store(&result.z[i], Mul(z, invMag));
+			Store(&result.w[i], Mul(w, invMag));
+		}
+	}
+}
+
+void ML_Engine::Math::TransformCoord(const Vector3Stream& v, const Matrix4& m, Vector3Stream& result)
+{
+	Transform(v, m, result, true);
+}
+
+void ML_Engine::Math::TransformNormal(const Vector3Stream& v, const Matrix4& m, Vector3Stream& result)
+{
+	Transform(v, m, result, false);
+}
+
+void ML_Engine::Math::Normalize(const Vector3Stream& v, Vector3Stream& result)
+{
+	result.Resize(v.Size());
+
+	const Lane one = Splat(1.0f);
+	const size_t count = v.PaddedSize();
+	for (size_t i = 0; i < count; i += BatchWidth)
+	{
+		const Lane x = Load(&v.x[i]);
+		const Lane y = Load(&v.y[i]);
+		const Lane z = Load(&v.z[i]);
+		const Lane invMag = Div(one, Sqrt(Add(Add(Mul(x, x), Mul(y, y)), Mul(z, z))));
+		Store(&result.x[i], Mul(x, invMag));
+		Store(&result.y[i], Mul(y, invMag));
+		Store(&result.z[i], Mul(z, invMag));
+	}
+}
+
+void ML_Engine::Math::Cross(const Vector3Stream& a, const Vector3Stream& b, Vector3Stream& result)
+{
+	ASSERT(a.Size() == b.Size(), "BatchMath: stream sizes do not match");
+	result.Resize(a.Size());
+
+	const size_t count = a.PaddedSize();
+	for (size_t i = 0; i < count; i += BatchWidth)
+	{
+		const Lane ax = Load(&a.x[i]);
+		const Lane ay = Load(&a.y[i]);
+		const Lane az = Load(&a.z[i]);
+		const Lane bx = Load(&b.x[i]);
+		const Lane by = Load(&b.y[i]);
+		const Lane bz = Load(&b.z[i]);
+		Store(&result.x[i], Sub(Mul(ay, bz), Mul(az, by)));
+		Store(&result.y[i], Sub(Mul(az, bx), Mul(ax, bz)));
+		Store(&result.z[i], Sub(Mul(ax, by), Mul(ay, bx)));
+	}
+}
+
+void ML_Engine::Math::Dot(const Vector3Stream& a, const Vector3Stream& b, float* result)
+{
+	ASSERT(a.Size() == b.Size(), "BatchMath: stream sizes do not match");
+
+	// full batches go straight to the output, the last partial one is
+	// written to a scratch buffer so we never write past a.Size()
+	const size_t count = a.Size();
+	const size_t fullCount = count / BatchWidth * BatchWidth;
+	for (size_t i = 0; i < a.PaddedSize(); i += BatchWidth)
+	{
+		const Lane ax = Load(&a.x[i]);
+		const Lane ay = Load(&a.y[i]);
+		const Lane az = Load(&a.z[i]);
+		const Lane d = Add(Add(Mul(ax, Load(&b.x[i])), Mul(ay, Load(&b.y[i]))), Mul(az, Load(&b.z[i])));
+		if (i < fullCount)
+		{
+			Store(result + i, d);
+		}
+		else
+		{
+			float tail[BatchWidth];
+			Store(tail, d);
+			for (size_t j = i; j < count; ++j)
+			{
+				result[j] = tail[j - i];
+			}
+		}
+	}
+}
+
+void ML_Engine::Math::LoadStream(const Vector3* src, size_t count, size_t stride, Vector3Stream& dst)
+{
+	dst.Resize(count);
+	const uint8_t* bytes = reinterpret_cast<const uint8_t*>(src);
+	for (size_t i = 0; i < count; ++i)
+	{
+		const Vector3& v = *reinterpret_cast<const Vector3*>(bytes + (i * stride));
+		dst.x[i] = v.x;
+		dst.y[i] = v.y;
+		dst.z[i] = v.z;
+	}
+}
+
+void ML_Engine::Math::StoreStream(const Vector3Stream& src, Vector3* dst, size_t stride)
+{
+	uint8_t* bytes = reinterpret_cast<uint8_t*>(dst);
+	const size_t count = src.Size();
+	for (size_t i = 0; i < count; ++i)
+	{
+		Vector3& v = *reinterpret_cast<Vector3*>(bytes + (i * stride));
+		v.x = src.x[i];
+		v.y = src.y[i];
+		v.z = src.z[i];
+	}
+}
+
+void ML_Engine::Math::Nlerp(const QuaternionStream& q0, const QuaternionStream& q1, const float* t, QuaternionStream& result)
+{
+	Interpolate(q0, q1, t, false, QuaternionBlend::Nlerp, result);
+}
+
+void ML_Engine::Math::NlerpCorrected(const QuaternionStream& q0, const QuaternionStream& q1, const float* t, QuaternionStream& result)
+{
+	Interpolate(q0, q1, t, false, QuaternionBlend::NlerpCorrected, result);
+}
+
+void ML_Engine::Math::Slerp(const QuaternionStream& q0, const QuaternionStream& q1, const float* t, QuaternionStream& result)
+{
+	Interpolate(q0, q1, t, false, QuaternionBlend::Slerp, result);
+}
+
+void ML_Engine::Math::Nlerp(const QuaternionStream& q0, const QuaternionStream& q1, float t, QuaternionStream& result)
+{
+	Interpolate(q0, q1, &t, true, QuaternionBlend::Nlerp, result);
+}
+
+void ML_Engine::Math::NlerpCorrected(const QuaternionStream& q0, const QuaternionStream& q1, float t, QuaternionStream& result)
+{
+	Interpolate(q0, q1, &t, true, QuaternionBlend::NlerpCorrected, result);
+}
+
+void ML_Engine::Math::Slerp(const QuaternionStream& q0, const QuaternionStream& q1, float t, QuaternionStream& result)
+{
+	Interpolate(q0, q1, &t, true, QuaternionBlend::Slerp, result);
+}
+
+void ML_Engine::Math::MatrixRotationQuaternion(const QuaternionStream& q, Matrix4* result)
+{
+	const Lane one = Splat(1.0f);
+	const Lane two = Splat(2.0f);
+	const size_t count = q.Size();
+	for (size_t i = 0; i < q.PaddedSize(); i += BatchWidth)
+	{
+		const Lane x = Load(&q.x[i]);
+		const Lane y = Load(&q.y[i]);
+		const Lane z = Load(&q.z[i]);
+		const Lane w = Load(&q.w[i]);
+		const Lane x2 = Mul(two, x);
+		const Lane y2 = Mul(two, y);
+		const Lane z2 = Mul(two, z);
+		const Lane xx = Mul(x2, x), yy = Mul(y2, y), zz = Mul(z2, z);
+		const Lane xy = Mul(x2, y), xz = Mul(x2, z), yz = Mul(y2, z);
+		const Lane xw = Mul(x2, w), yw = Mul(y2, w), zw = Mul(z2, w);
+
+		float m[9][BatchWidth];
+		Store(m[0], Sub(Sub(one, yy), zz));
+		Store(m[1], Add(xy, zw));
+		Store(m[2], Sub(xz, yw));
+		Store(m[3], Sub(xy, zw));
+		Store(m[4], Sub(Sub(one, xx), zz));
+		Store(m[5], Add(yz, xw));
+		Store(m[6], Add(xz, yw));
+		Store(m[7], Sub(yz, xw));
+		Store(m[8], Sub(Sub(one, xx), yy));
+
+		const size_t last = Min(i + BatchWidth, count);
+		for (size_t j = i; j < last; ++j)
+		{
+			const size_t l = j - i;
+			result[j] = Matrix4(
+				m[0][l], m[1][l], m[2][l], 0.0f,
+				m[3][l], m[4][l], m[5][l], 0.0f,
+				m[6][l], m[7][l], m[8][l], 0.0f,
+				0.0f, 0.0f, 0.0f, 1.0f);
+		}
+	}
+}
+
+void ML_Engine::Math::LoadStream(const Quaternion* src, size_t count, QuaternionStream& dst)
+{
+	dst.Resize(count);
+	for (size_t i = 0; i < count; ++i)
+	{
+		dst.Set(i, src[i]);
+	}
+}
+
+void ML_Engine::Math::StoreStream(const QuaternionStream& src, Quaternion* dst)
+{
+	const size_t count = src.Size();
+	for (size_t i = 0; i < count; ++i)
+	{
+		dst[i] = src.Get(i);
+	}
+}
+
+void ML_Engine::Math::Intersect(const Frustum& frustum, const Vector3Stream& centers, const Vector3Stream& extends, uint8_t* visible)
+{
+	ASSERT(centers.Size() == extends.Size(), "BatchMath: stream sizes do not match");
+
+	const size_t count = centers.Size();
+	for (size_t i = 0; i < centers.PaddedSize(); i += BatchWidth)
+	{
+		const Lane cx = Load(&centers.x[i]);
+		const Lane cy = Load(&centers.y[i]);
+		const Lane cz = Load(&centers.z[i]);
+		const Lane ex = Load(&extends.x[i]);
+		const Lane ey = Load(&extends.y[i]);
+		const Lane ez = Load(&extends.z[i]);
+
+		// smallest signed distance of the box from any plane, negative means culled
+		Lane minDistance = Splat(std::numeric_limits<float>::max());
+		for (const Plane& plane : frustum.planes)
+		{
+			const Lane distance = Add(Add(Mul(cx, Splat(plane.normal.x)), Mul(cy, Splat(plane.normal.y))), Add(Mul(cz, Splat(plane.normal.z)), Splat(plane.distance)));
+			const Lane radius = Add(Add(Mul(ex, Splat(Abs(plane.normal.x))), Mul(ey, Splat(Abs(plane.normal.y)))), Mul(ez, Splat(Abs(plane.normal.z))));
+			minDistance = Min(minDistance, Add(distance, radius));
+		}
+		StoreVisible(minDistance, i, count, visible);
+	}
+}
+
+void ML_Engine::Math::Intersect(const Frustum& frustum, const Vector3Stream& centers, const float* radii, uint8_t* visible)
+{
+	const size_t count = centers.Size();
+	for (size_t i = 0; i < centers.PaddedSize(); i += BatchWidth)
+	{
+		const Lane cx = Load(&centers.x[i]);
+		const Lane cy = Load(&centers.y[i]);
+		const Lane cz = Load(&centers.z[i]);
+		const Lane r = LoadPartial(radii, i, count);
+
+		Lane minDistance = Splat(std::numeric_limits<float>::max());
+		for (const Plane& plane : frustum.planes)
+		{
+			const Lane distance = Add(Add(Mul(cx, Splat(plane.normal.x)), Mul(cy, Splat(plane.normal.y))), Add(Mul(cz, Splat(plane.normal.z)), Splat(plane.distance)));
+			minDistance = Min(minDistance, Add(distance, r));
+		}
+		StoreVisible(minDistance, i, count, visible);
+	}
+}
+
+void ML_Engine::Math::TransformAABB(const Vector3Stream& centers, const Vector3Stream& extends, const Matrix4& m, Vector3Stream& resultCenters, Vector3Stream& resultExtends)
+{
+	ASSERT(centers.Size() == extends.Size(), "BatchMath: stream sizes do not match");
+
+	TransformCoord(centers, m, resultCenters);
+
+	// the new half size is the old one through the absolute value of the 3x3
+	Matrix4 absM = m;
+	for (float& f : absM.v)
+	{
+		f = Abs(f);
+	}
+	TransformNormal(extends, absM, resultExtends);
+}
+
+void ML_Engine::Math::Sin(const float* x, float* result, size_t count)
+{
+	ForEachBatch(x, result, count, [](Lane v)
+	{
+		Lane s, c;
+		SinCosLane(v, s, c);
+		return s;
+	});
+}
+
+void ML_Engine::Math::Cos(const float* x, float* result, size_t count)
+{
+	ForEachBatch(x, result, count, [](Lane v)
+	{
+		Lane s, c;
+		SinCosLane(v, s, c);
+		return c;
+	});
+}
+
+void ML_Engine::Math::SinCos(const float* x, float* sinResult, float* cosResult, size_t count)
+{
+	for (size_t i = 0; i < count; i += BatchWidth)
+	{
+		Lane s, c;
+		SinCosLane(LoadPartial(x, i, count), s, c);
+		if (i + BatchWidth <= count)
+		{
+			Store(sinResult + i, s);
+			Store(cosResult + i, c);
+		}
+		else
+		{
+			float sinTail[BatchWidth], cosTail[BatchWidth];
+			Store(sinTail, s);
+			Store(cosTail, c);
+			for (size_t j = i; j < count; ++j)
+			{
+				sinResult[j] = sinTail[j - i];
+				cosResult[j] = cosTail[j - i];
+			}
+		}
+	}
+}
+
+void ML_Engine::Math::Rsqrt(const float* x, float* result, size_t count)
+{
+	ForEachBatch(x, result, count, [](Lane v)
+	{
+		// one Newton step on the hardware estimate
+		const Lane y = RsqrtEstimate(v);
+		return Mul(y, Sub(Splat(1.5f), Mul(Mul(Splat(0.5f), v), Mul(y, y))));
+	});
+}
+
+void ML_Engine::Math::Acos(const float* x, float* result, size_t count)
+{
+	ForEachBatch(x, result, count, [](Lane v)
+	{
+		const Lane a = Abs(v);
+		Lane p = Splat(-0.0187293f);
+		p = Add(Splat(0.0742610f), Mul(a, p));
+		p = Add(Splat(-0.2121144f), Mul(a, p));
+		p = Add(Splat(1.5707288f), Mul(a, p));
+		const Lane r = Mul(Sqrt(Sub(Splat(1.0f), a)), p);
+		return Select(Less(v, Splat(0.0f)), Sub(Splat(Constants::Pi), r), r);
+	});
+}
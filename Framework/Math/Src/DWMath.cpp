@@ -147,7 +147,8 @@ Quaternion Quaternion::Slerp(const Quaternion& q0, const Quaternion& q1, float t
     
     if (dot > 0.999999f)
     {
-        return Normalize(Lerp(q0, q1, t));
+        // nearly the same rotation, on the same side as q0 or the lerp passes through zero
+        return Normalize(Lerp(q0, q1 * q1Scale, t));
     }
 
     float theta = acosf(dot);
@@ -0,0 +1,367 @@
+#include "Precompiled.h"
+#include "DWMath.h"
+
+using namespace ML_Engine::Math;
+
+namespace
+{
+	// Distance of the box from the plane along the normal, and how far the box
+	// reaches along it (projected half size)
+	inline float ProjectedRadius(const Plane& plane, const Vector3& extend)
+	{
+		return Abs(plane.normal.x) * extend.x + Abs(plane.normal.y) * extend.y + Abs(plane.normal.z) * extend.z;
+	}
+
+	// Slab test against an axis aligned box centered at the origin
+	bool IntersectSlabs(const Vector3& origin, const Vector3& direction, const Vector3& extend, float& distance)
+	{
+		float tMin = 0.0f;
+		float tMax = std::numeric_limits<float>::max();
+		for (int i = 0; i < 3; ++i)
+		{
+			const float o = origin.v[i];
+			const float d = direction.v[i];
+			const float e = extend.v[i];
+			if (Abs(d) < 1e-8f)
+			{
+				// parallel to the slab, must start inside it
+				if (o < -e || o > e)
+				{
+					return false;
+				}
+				continue;
+			}
+
+			const float invD = 1.0f / d;
+			float t0 = (-e - o) * invD;
+			float t1 = (e - o) * invD;
+			if (t0 > t1)
+			{
+				std::swap(t0, t1);
+			}
+			tMin = Max(tMin, t0);
+			tMax = Min(tMax, t1);
+			if (tMin > tMax)
+			{
+				return false;
+			}
+		}
+		distance = tMin;
+		return true;
+	}
+}
+
+Plane Plane::FromPointNormal(const Vector3& point, const Vector3& normal)
+{
+	const Vector3 n = Normalize(normal);
+	return { n, -Dot(n, point) };
+}
+
+Plane Plane::FromPoints(const Vector3& a, const Vector3& b, const Vector3& c)
+{
+	return FromPointNormal(a, Cross(b - a, c - a));
+}
+
+Frustum Frustum::FromMatrix(const Matrix4& m)
+{
+	// Row vectors, so clip = v * m and each clip component is v dotted with a
+	// column of m. D3D clip space is -w <= x,y <= w and 0 <= z <= w.
+	const Vector4 c1 = { m._11, m._21, m._31, m._41 };
+	const Vector4 c2 = { m._12, m._22, m._32, m._42 };
+	const Vector4 c3 = { m._13, m._23, m._33, m._43 };
+	const Vector4 c4 = { m._14, m._24, m._34, m._44 };
+	const auto makePlane = [](const Vector4& p)
+	{
+		return NormalizePlane({ { p.x, p.y, p.z }, p.w });
+	};
+
+	Frustum frustum;
+	frustum.planes[Left] = makePlane(c4 + c1);
+	frustum.planes[Right] = makePlane(c4 - c1);
+	frustum.planes[Bottom] = makePlane(c4 + c2);
+	frustum.planes[Top] = makePlane(c4 - c2);
+	frustum.planes[Near] = makePlane(c3);
+	frustum.planes[Far] = makePlane(c4 - c3);
+	return frustum;
+}
+
+AABB ML_Engine::Math::ComputeAABB(const Vector3* points, size_t count, size_t stride)
+{
+	if (count == 0)
+	{
+		return {};
+	}
+
+	const uint8_t* bytes = reinterpret_cast<const uint8_t*>(points);
+	Vector3 min = points[0];
+	Vector3 max = points[0];
+	for (size_t i = 1; i < count; ++i)
+	{
+		const Vector3& p = *reinterpret_cast<const Vector3*>(bytes + (i * stride));
+		min = { Min(min.x, p.x), Min(min.y, p.y), Min(min.z, p.z) };
+		max = { Max(max.x, p.x), Max(max.y, p.y), Max(max.z, p.z) };
+	}
+	return AABB::FromMinMax(min, max);
+}
+
+Sphere ML_Engine::Math::ComputeSphere(const AABB& aabb)
+{
+	return { aabb.center, Magnitude(aabb.extend) };
+}
+
+AABB ML_Engine::Math::Merge(const AABB& a, const AABB& b)
+{
+	const Vector3 aMin = a.GetMin();
+	const Vector3 aMax = a.GetMax();
+	const Vector3 bMin = b.GetMin();
+	const Vector3 bMax = b.GetMax();
+	return AABB::FromMinMax(
+		{ Min(aMin.x, bMin.x), Min(aMin.y, bMin.y), Min(aMin.z, bMin.z) },
+		{ Max(aMax.x, bMax.x), Max(aMax.y, bMax.y), Max(aMax.z, bMax.z) });
+}
+
+AABB ML_Engine::Math::Merge(const AABB& aabb, const Vector3& point)
+{
+	const Vector3 min = aabb.GetMin();
+	const Vector3 max = aabb.GetMax();
+	return AABB::FromMinMax(
+		{ Min(min.x, point.x), Min(min.y, point.y), Min(min.z, point.z) },
+		{ Max(max.x, point.x), Max(max.y, point.y), Max(max.z, point.z) });
+}
+
+AABB ML_Engine::Math::TransformAABB(const AABB& aabb, const Matrix4& m)
+{
+	// the new half size is the old one through the absolute value of the 3x3
+	const Vector3& e = aabb.extend;
+	return {
+		TransformCoord(aabb.center, m),
+		{
+			Abs(m._11) * e.x + Abs(m._21) * e.y + Abs(m._31) * e.z,
+			Abs(m._12) * e.x + Abs(m._22) * e.y + Abs(m._32) * e.z,
+			Abs(m._13) * e.x + Abs(m._23) * e.y + Abs(m._33) * e.z
+		}
+	};
+}
+
+OBB ML_Engine::Math::TransformOBB(const AABB& aabb, const Matrix4& m)
+{
+	// assumes m is scale * rotation * translation
+	Vector3 right = GetRight(m);
+	Vector3 up = GetUp(m);
+	Vector3 look = GetLook(m);
+	const Vector3 scale = { Magnitude(right), Magnitude(up), Magnitude(look) };
+	right /= scale.x;
+	up /= scale.y;
+	look /= scale.z;
+	const Matrix4 rotation(
+		right.x, right.y, right.z, 0.0f,
+		up.x, up.y, up.z, 0.0f,
+		look.x, look.y, look.z, 0.0f,
+		0.0f, 0.0f, 0.0f, 1.0f);
+
+	OBB obb;
+	obb.center = TransformCoord(aabb.center, m);
+	obb.extend = { aabb.extend.x * scale.x, aabb.extend.y * scale.y, aabb.extend.z * scale.z };
+	obb.rotation = Quaternion::CreateFromRotationMatrix(rotation);
+	return obb;
+}
+
+Plane ML_Engine::Math::NormalizePlane(const Plane& plane)
+{
+	const float invMag = 1.0f / Magnitude(plane.normal);
+	return { plane.normal * invMag, plane.distance * invMag };
+}
+
+float ML_Engine::Math::DistanceToPlane(const Plane& plane, const Vector3& point)
+{
+	return Dot(plane.normal, point) + plane.distance;
+}
+
+bool ML_Engine::Math::Intersect(const AABB& a, const AABB& b)
+{
+	return Abs(a.center.x - b.center.x) <= (a.extend.x + b.extend.x)
+		&& Abs(a.center.y - b.center.y) <= (a.extend.y + b.extend.y)
+		&& Abs(a.center.z - b.center.z) <= (a.extend.z + b.extend.z);
+}
+
+bool ML_Engine::Math::Intersect(const Sphere& a, const Sphere& b)
+{
+	return DistanceSqr(a.center, b.center) <= Sqr(a.radius + b.radius);
+}
+
+bool ML_Engine::Math::Intersect(const Frustum& frustum, const AABB& aabb)
+{
+	for (const Plane& plane : frustum.planes)
+	{
+		if (DistanceToPlane(plane, aabb.center) + ProjectedRadius(plane, aabb.extend) < 0.0f)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+bool ML_Engine::Math::Intersect(const Frustum& frustum, const Sphere& sphere)
+{
+	for (const Plane& plane : frustum.planes)
+	{
+		if (DistanceToPlane(plane, sphere.center) < -sphere.radius)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+bool ML_Engine::Math::Intersect(const Frustum& frustum, const OBB& obb)
+{
+	const Matrix4 rotation = Matrix4::MatrixRotationQuaternion(obb.rotation);
+	const Vector3 axisX = GetRight(rotation) * obb.extend.x;
+	const Vector3 axisY = GetUp(rotation) * obb.extend.y;
+	const Vector3 axisZ = GetLook(rotation) * obb.extend.z;
+	for (const Plane& plane : frustum.planes)
+	{
+		const float radius = Abs(Dot(plane.normal, axisX)) + Abs(Dot(plane.normal, axisY)) + Abs(Dot(plane.normal, axisZ));
+		if (DistanceToPlane(plane, obb.center) + radius < 0.0f)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+bool ML_Engine::Math::Contains(const AABB& aabb, const Vector3& point)
+{
+	return Abs(point.x - aabb.center.x) <= aabb.extend.x
+		&& Abs(point.y - aabb.center.y) <= aabb.extend.y
+		&& Abs(point.z - aabb.center.z) <= aabb.extend.z;
+}
+
+bool ML_Engine::Math::Contains(const Sphere& sphere, const Vector3& point)
+{
+	return DistanceSqr(sphere.center, point) <= Sqr(sphere.radius);
+}
+
+Containment ML_Engine::Math::Contains(const Frustum& frustum, const AABB& aabb)
+{
+	Containment result = Containment::Contains;
+	for (const Plane& plane : frustum.planes)
+	{
+		const float distance = DistanceToPlane(plane, aabb.center);
+		const float radius = ProjectedRadius(plane, aabb.extend);
+		if (distance + radius < 0.0f)
+		{
+			return Containment::Disjoint;
+		}
+		if (distance - radius < 0.0f)
+		{
+			result = Containment::Intersects;
+		}
+	}
+	return result;
+}
+
+Containment ML_Engine::Math::Contains(const Frustum& frustum, const Sphere& sphere)
+{
+	Containment result = Containment::Contains;
+	for (const Plane& plane : frustum.planes)
+	{
+		const float distance = DistanceToPlane(plane, sphere.center);
+		if (distance < -sphere.radius)
+		{
+			return Containment::Disjoint;
+		}
+		if (distance < sphere.radius)
+		{
+			result = Containment::Intersects;
+		}
+	}
+	return result;
+}
+
+bool ML_Engine::Math::Intersect(const Ray& ray, const AABB& aabb, float& distance)
+{
+	return IntersectSlabs(ray.origin - aabb.center, ray.direction, aabb.extend, distance);
+}
+
+bool ML_Engine::Math::Intersect(const Ray& ray, const Sphere& sphere, float& distance)
+{
+	const Vector3 m = ray.origin - sphere.center;
+	const float a = MagnitudeSqr(ray.direction);
+	const float b = Dot(m, ray.direction);
+	const float c = MagnitudeSqr(m) - Sqr(sphere.radius);
+
+	// origin outside and pointing away
+	if (c > 0.0f && b > 0.0f)
+	{
+		return false;
+	}
+	const float discriminant = b * b - a * c;
+	if (discriminant < 0.0f)
+	{
+		return false;
+	}
+	distance = Max((-b - sqrtf(discriminant)) / a, 0.0f);
+	return true;
+}
+
+bool ML_Engine::Math::Intersect(const Ray& ray, const OBB& obb, float& distance)
+{
+	// move the ray into the box space, rotation only so distances are preserved
+	const Matrix4 toLocal = Matrix4::MatrixRotationQuaternion(Quaternion::Conjugate(obb.rotation));
+	const Vector3 origin = TransformNormal(ray.origin - obb.center, toLocal);
+	const Vector3 direction = TransformNormal(ray.direction, toLocal);
+	return IntersectSlabs(origin, direction, obb.extend, distance);
+}
+
+bool ML_Engine::Math::Intersect(const Ray& ray, const Plane& plane, float& distance)
+{
+	const float denom = Dot(plane.normal, ray.direction);
+	if (Abs(denom) < 1e-8f)
+	{
+		return false;
+	}
+	const float t = -DistanceToPlane(plane, ray.origin) / denom;
+	if (t < 0.0f)
+	{
+		return false;
+	}
+	distance = t;
+	return true;
+}
+
+bool ML_Engine::Math::Intersect(const Ray& ray, const Vector3& a, const Vector3& b, const Vector3& c, float& distance)
+{
+	// Moller-Trumbore, hits from both sides
+	const Vector3 edge0 = b - a;
+	const Vector3 edge1 = c - a;
+	const Vector3 p = Cross(ray.direction, edge1);
+	const float det = Dot(edge0, p);
+	if (Abs(det) < 1e-8f)
+	{
+		return false;
+	}
+
+	const float invDet = 1.0f / det;
+	const Vector3 s = ray.origin - a;
+	const float u = Dot(s, p) * invDet;
+	if (u < 0.0f || u > 1.0f)
+	{
+		return false;
+	}
+
+	const Vector3 q = Cross(s, edge0);
+	const float v = Dot(ray.direction, q) * invDet;
+	if (v < 0.0f || u + v > 1.0f)
+	{
+		return false;
+	}
+
+	const float t = Dot(edge1, q) * invDet;
+	if (t < 0.0f)
+	{
+		return false;
+	}
+	distance = t;
+	return true;
+}
@@ -0,0 +1,1232 @@
+// Microbenchmarks for the hot Math primitives.
+// -check instead compares the SIMD backend against the scalar reference and the trig
+// tiers against their documented error bounds, checks the Geometry tests against known answers,
+// and returns non-zero when a result is outside its tolerance. The Visual Studio build also
+// checks TransformHierarchy.
+//
+// Otherwise only depends on Core headers and the Math sources, so besides the Visual Studio
+// project it can be built anywhere with a C++17 compiler, e.g. from the repo root:
+//   g++ -std=c++17 -O2 -march=native -IFramework -IFramework/Math/Inc
+//       Tools/MathBenchmark/main.cpp Framework/Math/Src/*.cpp -o MathBenchmark
+// Add -DML_MATH_SIMD=0, 1 or 2 to check the scalar, SSE or AVX backend.
+//
+// Usage: MathBenchmark [-json <file>] [-filter <substring>] [-maxsize <n>] [-mintime <ms>]
+//        MathBenchmark -check
+
+#include <Math/Inc/DWMath.h>
+#include <Graphics/Inc/Transform.h>
+#if defined(_WIN32)
+#include <Graphics/Inc/TransformHierarchy.h>
+#endif
+
+#include <cstdio>
+#include <cstring>
+
+using namespace ML_Engine;
+using namespace ML_Engine::Graphics;
+using namespace ML_Engine::Math;
+
+using Clock = std::chrono::steady_clock;
+
+struct Arguments
+{
+	std::filesystem::path jsonFileName;
+	std::string filter;
+	size_t maxSize = 1 << 20;
+	double minTimeMs = 100.0;
+	bool check = false;
+};
+
+struct Result
+{
+	std::string name;
+	size_t size = 0;
+	size_t iterations = 0;
+	double nsPerOp = 0.0;
+	double opsPerSecond = 0.0;
+};
+
+// Written after every run so the optimizer cannot drop the work
+volatile float gSink = 0.0f;
+
+std::optional<Arguments> ParseArgs(int argc, char* argv[])
+{
+	Arguments args;
+	for (int i = 1; i < argc; ++i)
+	{
+		const bool hasValue = i + 1 < argc;
+		if (strcmp(argv[i], "-json") == 0 && hasValue)
+		{
+			args.jsonFileName = argv[++i];
+		}
+		else if (strcmp(argv[i], "-filter") == 0 && hasValue)
+		{
+			args.filter = argv[++i];
+		}
+		else if (strcmp(argv[i], "-maxsize") == 0 && hasValue)
+		{
+			args.maxSize = static_cast<size_t>(atoll(argv[++i]));
+		}
+		else if (strcmp(argv[i], "-mintime") == 0 && hasValue)
+		{
+			args.minTimeMs = atof(argv[++i]);
+		}
+		else if (strcmp(argv[i], "-check") == 0)
+		{
+			args.check = true;
+		}
+		else
+		{
+			return std::nullopt;
+		}
+	}
+	return args;
+}
+
+float RandomFloat(std::mt19937& rng, float min, float max)
+{
+	return std::uniform_real_distribution<float>(min, max)(rng);
+}
+
+Vector3 RandomVector3(std::mt19937& rng)
+{
+	return { RandomFloat(rng, -10.0f, 10.0f), RandomFloat(rng, -10.0f, 10.0f), RandomFloat(rng, -10.0f, 10.0f) };
+}
+
+Quaternion RandomQuaternion(std::mt19937& rng)
+{
+	return Quaternion::Normalize({ RandomFloat(rng, -1.0f, 1.0f), RandomFloat(rng, -1.0f, 1.0f), RandomFloat(rng, -1.0f, 1.0f), RandomFloat(rng, -1.0f, 1.0f) });
+}
+
+Transform RandomTransform(std::mt19937& rng)
+{
+	Transform transform;
+	transform.position = RandomVector3(rng);
+	transform.rotation = RandomQuaternion(rng);
+	transform.scale = { RandomFloat(rng, 0.5f, 2.0f), RandomFloat(rng, 0.5f, 2.0f), RandomFloat(rng, 0.5f, 2.0f) };
+	return transform;
+}
+
+// Inputs shared by all benchmarks of one batch size
+struct Data
+{
+	std::vector<Matrix4> matrices0;
+	std::vector<Matrix4> matrices1;
+	std::vector<Matrix4> rigidMatrices; // rotation and translation only
+	std::vector<Matrix4> matricesOut;
+	std::vector<Vector3> vectors0;
+	std::vector<Vector3> vectors1;
+	std::vector<Vector3> vectorsOut;
+	std::vector<Quaternion> quaternions0;
+	std::vector<Quaternion> quaternions1;
+	std::vector<Quaternion> quaternionsOut;
+	std::vector<Transform> transforms;
+	std::vector<float> t;
+	Vector3Stream stream0;
+	Vector3Stream stream1;
+	Vector3Stream streamOut;
+	QuaternionStream quaternionStream0;
+	QuaternionStream quaternionStream1;
+	QuaternionStream quaternionStreamOut;
+
+	void Initialize(size_t count)
+	{
+		std::mt19937 rng(1234);
+		matrices0.resize(count);
+		matrices1.resize(count);
+		rigidMatrices.resize(count);
+		matricesOut.resize(count);
+		vectors0.resize(count);
+		vectors1.resize(count);
+		vectorsOut.resize(count);
+		quaternions0.resize(count);
+		quaternions1.resize(count);
+		quaternionsOut.resize(count);
+		transforms.resize(count);
+		t.resize(count);
+		for (size_t i = 0; i < count; ++i)
+		{
+			transforms[i] = RandomTransform(rng);
+			matrices0[i] = transforms[i].GetMatrix4();
+			matrices1[i] = RandomTransform(rng).GetMatrix4();
+			Transform rigid = transforms[i];
+			rigid.scale = Vector3::One;
+			rigidMatrices[i] = rigid.GetMatrix4();
+			vectors0[i] = RandomVector3(rng);
+			vectors1[i] = RandomVector3(rng);
+			quaternions0[i] = RandomQuaternion(rng);
+			quaternions1[i] = RandomQuaternion(rng);
+			t[i] = RandomFloat(rng, 0.0f, 1.0f);
+		}
+		LoadStream(vectors0.data(), count, stream0);
+		LoadStream(vectors1.data(), count, stream1);
+		LoadStream(quaternions0.data(), count, quaternionStream0);
+		LoadStream(quaternions1.data(), count, quaternionStream1);
+	}
+};
+
+struct Benchmark
+{
+	const char* name;
+	// processes every element of the batch once, returns a value for gSink
+	std::function<float(Data&, size_t)> run;
+};
+
+const std::vector<Benchmark>& GetBenchmarks()
+{
+	static const std::vector<Benchmark> benchmarks =
+	{
+		{ "Matrix4::operator*", [](Data& d, size_t n)
+			{
+				for (size_t i = 0; i < n; ++i)
+				{
+					d.matricesOut[i] = d.matrices0[i] * d.matrices1[i];
+				}
+				return d.matricesOut[n - 1]._11;
+			}
+		},
+		{ "Inverse", [](Data& d, size_t n)
+			{
+				for (size_t i = 0; i < n; ++i)
+				{
+					d.matricesOut[i] = Inverse(d.matrices0[i]);
+				}
+				return d.matricesOut[n - 1]._11;
+			}
+		},
+		{ "InverseTRS", [](Data& d, size_t n)
+			{
+				for (size_t i = 0; i < n; ++i)
+				{
+					d.matricesOut[i] = InverseTRS(d.matrices0[i]);
+				}
+				return d.matricesOut[n - 1]._11;
+			}
+		},
+		{ "InverseAffine", [](Data& d, size_t n)
+			{
+				for (size_t i = 0; i < n; ++i)
+				{
+					d.matricesOut[i] = InverseAffine(d.matrices0[i]);
+				}
+				return d.matricesOut[n - 1]._11;
+			}
+		},
+		{ "InverseOrthonormal", [](Data& d, size_t n)
+			{
+				for (size_t i = 0; i < n; ++i)
+				{
+					d.matricesOut[i] = InverseOrthonormal(d.rigidMatrices[i]);
+				}
+				return d.matricesOut[n - 1]._11;
+			}
+		},
+		{ "Transform::GetMatrix4", [](Data& d, size_t n)
+			{
+				for (size_t i = 0; i < n; ++i)
+				{
+					d.matricesOut[i] = d.transforms[i].GetMatrix4();
+				}
+				return d.matricesOut[n - 1]._11;
+			}
+		},
+		{ "Normalize", [](Data& d, size_t n)
+			{
+				for (size_t i = 0; i < n; ++i)
+				{
+					d.vectorsOut[i] = Normalize(d.vectors0[i]);
+				}
+				return d.vectorsOut[n - 1].x;
+			}
+		},
+		{ "Cross", [](Data& d, size_t n)
+			{
+				for (size_t i = 0; i < n; ++i)
+				{
+					d.vectorsOut[i] = Cross(d.vectors0[i], d.vectors1[i]);
+				}
+				return d.vectorsOut[n - 1].x;
+			}
+		},
+		{ "TransformCoord", [](Data& d, size_t n)
+			{
+				const Matrix4& m = d.matrices0[0];
+				for (size_t i = 0; i < n; ++i)
+				{
+					d.vectorsOut[i] = TransformCoord(d.vectors0[i], m);
+				}
+				return d.vectorsOut[n - 1].x;
+			}
+		},
+		{ "Quaternion::Slerp", [](Data& d, size_t n)
+			{
+				for (size_t i = 0; i < n; ++i)
+				{
+					d.quaternionsOut[i] = Quaternion::Slerp(d.quaternions0[i], d.quaternions1[i], d.t[i]);
+				}
+				return d.quaternionsOut[n - 1].x;
+			}
+		},
+		{ "Quaternion::CreateFromRotationMatrix", [](Data& d, size_t n)
+			{
+				for (size_t i = 0; i < n; ++i)
+				{
+					d.quaternionsOut[i] = Quaternion::CreateFromRotationMatrix(d.matrices0[i]);
+				}
+				return d.quaternionsOut[n - 1].x;
+			}
+		},
+		// batch (SoA) versions of the above
+		{ "Batch::Normalize", [](Data& d, size_t n)
+			{
+				Normalize(d.stream0, d.streamOut);
+				return d.streamOut.x[n - 1];
+			}
+		},
+		{ "Batch::Cross", [](Data& d, size_t n)
+			{
+				Cross(d.stream0, d.stream1, d.streamOut);
+				return d.streamOut.x[n - 1];
+			}
+		},
+		{ "Batch::TransformCoord", [](Data& d, size_t n)
+			{
+				TransformCoord(d.stream0, d.matrices0[0], d.streamOut);
+				return d.streamOut.x[n - 1];
+			}
+		},
+		{ "Batch::Slerp", [](Data& d, size_t n)
+			{
+				Slerp(d.quaternionStream0, d.quaternionStream1, d.t.data(), d.quaternionStreamOut);
+				return d.quaternionStreamOut.x[n - 1];
+			}
+		},
+		{ "Batch::NlerpCorrected", [](Data& d, size_t n)
+			{
+				NlerpCorrected(d.quaternionStream0, d.quaternionStream1, d.t.data(), d.quaternionStreamOut);
+				return d.quaternionStreamOut.x[n - 1];
+			}
+		},
+		{ "Batch::MatrixRotationQuaternion", [](Data& d, size_t n)
+			{
+				MatrixRotationQuaternion(d.quaternionStream0, d.matricesOut.data());
+				return d.matricesOut[n - 1]._11;
+			}
+		}
+	};
+	return benchmarks;
+}
+
+// Largest difference from the reference results, relative to their magnitude once that is above 1
+struct CheckError
+{
+	const char* name;
+	float tolerance;
+	float maxError = 0.0f;
+
+	void Add(float value, double reference, double scale = 1.0)
+	{
+		const double error = std::isnan(value) ? std::numeric_limits<double>::infinity() : fabs(value - reference) / std::max(scale, 1.0);
+		maxError = std::max(maxError, static_cast<float>(error));
+	}
+
+	// reference must not be 0
+	void AddRelative(float value, double reference)
+	{
+		const double error = std::isnan(value) ? std::numeric_limits<double>::infinity() : fabs(value - reference) / fabs(reference);
+		maxError = std::max(maxError, static_cast<float>(error));
+	}
+
+	void Add(const Matrix4& value, const Matrix4& reference)
+	{
+		const float* v = &value._11;
+		const float* r = &reference._11;
+		float scale = 0.0f;
+		for (int i = 0; i < 16; ++i)
+		{
+			scale = std::max(scale, fabsf(r[i]));
+		}
+		for (int i = 0; i < 16; ++i)
+		{
+			Add(v[i], r[i], scale);
+		}
+	}
+
+	bool Report() const
+	{
+		const bool passed = maxError <= tolerance;
+		printf("%-40s max error %10.3g tolerance %10.3g %s\n", name, maxError, tolerance, passed ? "ok" : "FAILED");
+		return passed;
+	}
+};
+
+Matrix4 RandomMatrix4(std::mt19937& rng)
+{
+	Matrix4 m;
+	float* values = &m._11;
+	for (int i = 0; i < 16; ++i)
+	{
+		values[i] = RandomFloat(rng, -4.0f, 4.0f);
+	}
+	return m;
+}
+
+// Matrix4 operators, which dispatch to the SIMD backend, against Math::Scalar
+bool CheckMatrix4()
+{
+	constexpr int Count = 100000;
+	// the backends sum in a different order, so allow a few ulps of the largest term
+	CheckError multiply{ "Matrix4::operator*", 1.0e-6f };
+	CheckError transpose{ "Transpose", 0.0f };
+	CheckError determinant{ "Determinant", 4.0e-6f };
+	CheckError inverse{ "Inverse", 2.0e-5f };
+	CheckError identity{ "Inverse * m", 2.0e-5f };
+
+	std::mt19937 rng(1234);
+	for (int i = 0; i < Count; ++i)
+	{
+		// general matrices and the TRS ones the engine mostly builds
+		const Matrix4 a = (i % 2 == 0) ? RandomMatrix4(rng) : RandomTransform(rng).GetMatrix4();
+		const Matrix4 b = (i % 3 == 0) ? RandomMatrix4(rng) : RandomTransform(rng).GetMatrix4();
+
+		multiply.Add(a * b, Scalar::Multiply(a, b));
+		transpose.Add(Transpose(a), Scalar::Transpose(a));
+
+		// the determinant cancels down from products of four entries
+		const float* values = &a._11;
+		float scale = 0.0f;
+		for (int e = 0; e < 16; ++e)
+		{
+			scale = std::max(scale, fabsf(values[e]));
+		}
+		const float referenceDeterminant = Scalar::Determinant(a);
+		determinant.Add(Determinant(a), referenceDeterminant, scale * scale * scale * scale);
+
+		// ill conditioned inverses say nothing about the backend
+		if (fabsf(referenceDeterminant) < 0.1f * scale * scale * scale * scale)
+		{
+			continue;
+		}
+		const Matrix4 inv = Inverse(a);
+		inverse.Add(inv, Scalar::Inverse(a));
+		identity.Add(inv * a, Matrix4::Identity);
+	}
+
+	bool passed = true;
+	for (const CheckError* error : { &multiply, &transpose, &determinant, &inverse, &identity })
+	{
+		passed = error->Report() && passed;
+	}
+	return passed;
+}
+
+// The specialized inverses of DWMath.h on the matrices they are meant for, each inverse * m
+// against the identity
+bool CheckSpecializedInverses()
+{
+	constexpr int Count = 100000;
+	CheckError affine{ "InverseAffine * m", 2.0e-5f };
+	CheckError trs{ "InverseTRS * m", 2.0e-5f };
+	CheckError orthonormal{ "InverseOrthonormal * m", 2.0e-5f };
+	CheckError transformInverse{ "Transform::GetInverseMatrix4 * m", 2.0e-5f };
+
+	std::mt19937 rng(1234);
+	for (int i = 0; i < Count; ++i)
+	{
+		// any 3x3 and translation, skipping the ill conditioned ones as CheckMatrix4 does
+		Matrix4 a = RandomMatrix4(rng);
+		a._14 = 0.0f;
+		a._24 = 0.0f;
+		a._34 = 0.0f;
+		a._44 = 1.0f;
+		float scale = 0.0f;
+		for (const float value : { a._11, a._12, a._13, a._21, a._22, a._23, a._31, a._32, a._33 })
+		{
+			scale = std::max(scale, fabsf(value));
+		}
+		if (fabsf(Determinant(a)) >= 0.1f * scale * scale * scale)
+		{
+			affine.Add(InverseAffine(a) * a, Matrix4::Identity);
+		}
+
+		const Transform transform = RandomTransform(rng);
+		const Matrix4 m = transform.GetMatrix4();
+		trs.Add(InverseTRS(m) * m, Matrix4::Identity);
+		transformInverse.Add(transform.GetInverseMatrix4() * m, Matrix4::Identity);
+
+		Transform rigid = transform;
+		rigid.scale = Vector3::One;
+		const Matrix4 r = rigid.GetMatrix4();
+		orthonormal.Add(InverseOrthonormal(r) * r, Matrix4::Identity);
+	}
+
+	bool passed = true;
+	for (const CheckError* error : { &affine, &trs, &orthonormal, &transformInverse })
+	{
+		passed = error->Report() && passed;
+	}
+	return passed;
+}
+
+// The Vector3Stream kernels of BatchMath.h against the Vector3 functions of DWMath.h, per element
+bool CheckVector3Batch()
+{
+	// odd so the batch tails are covered
+	constexpr size_t Count = 100003;
+	std::mt19937 rng(1234);
+	std::vector<Vector3> a(Count), b(Count);
+	for (size_t i = 0; i < Count; ++i)
+	{
+		a[i] = RandomVector3(rng);
+		b[i] = RandomVector3(rng);
+	}
+	// a tiny and a huge vector for Normalize
+	a[1] = { 1.0e-15f, -2.0e-15f, 3.0e-15f };
+	a[2] = { 1.0e15f, 2.0e15f, -3.0e15f };
+	const Matrix4 m = RandomMatrix4(rng);
+
+	Vector3Stream streamA, streamB, result;
+	LoadStream(a.data(), Count, streamA);
+	LoadStream(b.data(), Count, streamB);
+
+	CheckError transformCoord{ "Batch::TransformCoord", 1.0e-6f };
+	CheckError transformNormal{ "Batch::TransformNormal", 1.0e-6f };
+	CheckError transformInPlace{ "Batch::TransformCoord in place", 0.0f };
+	CheckError normalize{ "Batch::Normalize", 1.0e-6f };
+	CheckError cross{ "Batch::Cross", 1.0e-6f };
+	CheckError dot{ "Batch::Dot", 1.0e-6f };
+	CheckError streams{ "LoadStream/StoreStream with stride", 0.0f };
+
+	// errors relative to the size of the terms, the kernels may round or contract differently
+	const auto Compare = [](CheckError& error, const Vector3& value, const Vector3& reference, double scale)
+	{
+		for (int k = 0; k < 3; ++k)
+		{
+			error.Add(value.v[k], reference.v[k], scale);
+		}
+	};
+	double matrixScale = 0.0;
+	for (const float* e = &m._11; e < &m._11 + 16; ++e)
+	{
+		matrixScale = std::max(matrixScale, static_cast<double>(fabsf(*e)));
+	}
+
+	TransformCoord(streamA, m, result);
+	for (size_t i = 0; i < Count; ++i)
+	{
+		const double scale = (Magnitude(a[i]) + 1.0) * matrixScale;
+		Compare(transformCoord, result.Get(i), TransformCoord(a[i], m), scale);
+	}
+	TransformNormal(streamA, m, result);
+	for (size_t i = 0; i < Count; ++i)
+	{
+		Compare(transformNormal, result.Get(i), TransformNormal(a[i], m), Magnitude(a[i]) * matrixScale);
+	}
+	Normalize(streamA, result);
+	for (size_t i = 0; i < Count; ++i)
+	{
+		Compare(normalize, result.Get(i), Normalize(a[i]), 1.0);
+	}
+	Cross(streamA, streamB, result);
+	for (size_t i = 0; i < Count; ++i)
+	{
+		Compare(cross, result.Get(i), Cross(a[i], b[i]), Magnitude(a[i]) * Magnitude(b[i]));
+	}
+	std::vector<float> dots(Count);
+	Dot(streamA, streamB, dots.data());
+	for (size_t i = 0; i < Count; ++i)
+	{
+		dot.Add(dots[i], Dot(a[i], b[i]), Magnitude(a[i]) * Magnitude(b[i]));
+	}
+
+	// outputs may alias the input
+	Vector3Stream inPlace = streamA;
+	TransformCoord(streamA, m, result);
+	TransformCoord(inPlace, m, inPlace);
+	for (size_t i = 0; i < Count; ++i)
+	{
+		Compare(transformInPlace, inPlace.Get(i), result.Get(i), 1.0);
+	}
+
+	// a Vector3 member of an interleaved vertex, as the mesh code uses it
+	struct Vertex
+	{
+		Vector3 position;
+		Vector3 normal;
+		float uv[2];
+	};
+	std::vector<Vertex> vertices(Count);
+	for (size_t i = 0; i < Count; ++i)
+	{
+		vertices[i].normal = a[i];
+	}
+	LoadStream(&vertices[0].normal, Count, sizeof(Vertex), result);
+	for (size_t i = 0; i < Count; ++i)
+	{
+		Compare(streams, result.Get(i), a[i], 1.0);
+		vertices[i].normal = Vector3::Zero;
+	}
+	StoreStream(result, &vertices[0].normal, sizeof(Vertex));
+	for (size_t i = 0; i < Count; ++i)
+	{
+		Compare(streams, vertices[i].normal, a[i], 1.0);
+		Compare(streams, vertices[i].position, Vector3::Zero, 1.0);
+	}
+
+	bool passed = true;
+	for (const CheckError* error : { &transformCoord, &transformNormal, &transformInPlace, &normalize, &cross, &dot, &streams })
+	{
+		passed = error->Report() && passed;
+	}
+	return passed;
+}
+
+// A 90 degree, square perspective projection from the origin looking down +z, as Camera builds it
+Frustum MakeTestFrustum(float nearPlane, float farPlane)
+{
+	const float q = farPlane / (farPlane - nearPlane);
+	const Matrix4 projection(
+		1.0f, 0.0f, 0.0f, 0.0f,
+		0.0f, 1.0f, 0.0f, 0.0f,
+		0.0f, 0.0f, q, 1.0f,
+		0.0f, 0.0f, -nearPlane * q, 0.0f);
+	return Frustum::FromMatrix(projection);
+}
+
+// Known answers for the Geometry.h tests, and the batch frustum and AABB kernels against
+// the scalar ones
+bool CheckGeometry()
+{
+	CheckError knownAnswers{ "Geometry known answers", 1.0e-5f };
+	CheckError frustumAABB{ "Batch::Intersect frustum/AABB", 0.0f };
+	CheckError frustumSphere{ "Batch::Intersect frustum/sphere", 0.0f };
+	CheckError transformAABB{ "Batch::TransformAABB", 1.0e-6f };
+
+	const auto Expect = [&](bool value, bool expected)
+	{
+		knownAnswers.Add(value ? 1.0f : 0.0f, expected ? 1.0 : 0.0);
+	};
+	const auto ExpectHit = [&](bool hit, float distance, float expected)
+	{
+		Expect(hit, true);
+		knownAnswers.Add(hit ? distance : std::numeric_limits<float>::quiet_NaN(), expected);
+	};
+
+	// the side planes are x = +-z and y = +-z, the near and far planes z = 1 and z = 100
+	const Frustum frustum = MakeTestFrustum(1.0f, 100.0f);
+	const float halfSqrt2 = 0.5f * sqrtf(2.0f);
+	knownAnswers.Add(frustum.planes[Frustum::Left].normal.x, halfSqrt2);
+	knownAnswers.Add(frustum.planes[Frustum::Left].normal.z, halfSqrt2);
+	knownAnswers.Add(DistanceToPlane(frustum.planes[Frustum::Left], { -10.0f, 0.0f, 10.0f }), 0.0);
+	knownAnswers.Add(DistanceToPlane(frustum.planes[Frustum::Top], { 0.0f, 10.0f, 10.0f }), 0.0);
+	knownAnswers.Add(DistanceToPlane(frustum.planes[Frustum::Near], { 0.0f, 0.0f, 3.0f }), 2.0);
+	// the far plane carries the rounding of q, relative to its distance
+	knownAnswers.Add(DistanceToPlane(frustum.planes[Frustum::Far], { 0.0f, 0.0f, 90.0f }), 10.0, 100.0);
+
+	Expect(Contains(frustum, Sphere{ { 0.0f, 0.0f, 10.0f }, 1.0f }) == Containment::Contains, true);
+	Expect(Contains(frustum, Sphere{ { 0.0f, 0.0f, 0.5f }, 1.0f }) == Containment::Intersects, true);
+	Expect(Contains(frustum, Sphere{ { 0.0f, 0.0f, -5.0f }, 1.0f }) == Containment::Disjoint, true);
+	Expect(Intersect(frustum, Sphere{ { 12.0f, 0.0f, 10.0f }, 1.0f }), false);
+	Expect(Intersect(frustum, Sphere{ { 10.5f, 0.0f, 10.0f }, 1.0f }), true);
+	Expect(Contains(frustum, AABB{ { 0.0f, 0.0f, 50.0f }, Vector3::One }) == Containment::Contains, true);
+	Expect(Contains(frustum, AABB{ { 0.0f, 0.0f, 100.0f }, Vector3::One }) == Containment::Intersects, true);
+	Expect(Contains(frustum, AABB{ { 200.0f, 0.0f, 50.0f }, Vector3::One }) == Containment::Disjoint, true);
+	// a box outside a side plane and one reaching across it
+	Expect(Intersect(frustum, AABB{ { 13.0f, 0.0f, 10.0f }, Vector3::One }), false);
+	Expect(Intersect(frustum, AABB{ { 11.5f, 0.0f, 10.0f }, Vector3::One }), true);
+	// in front of the near plane, turned 45 degrees about y a corner reaches sqrt(2) across it
+	const OBB obb{ { 0.0f, 0.0f, -0.2f }, Vector3::One, Quaternion::CreateFromAxisAngle(Vector3::YAxis, Constants::Pi * 0.25f) };
+	Expect(Intersect(frustum, obb), true);
+	Expect(Intersect(frustum, OBB{ obb.center, Vector3::One, Quaternion::Identity }), false);
+
+	const AABB unitBox{ Vector3::Zero, Vector3::One };
+	Expect(Intersect(unitBox, AABB{ { 2.0f, 0.0f, 0.0f }, Vector3::One }), true);
+	Expect(Intersect(unitBox, AABB{ { 2.5f, 0.0f, 0.0f }, Vector3::One }), false);
+	Expect(Intersect(Sphere{ Vector3::Zero, 1.0f }, Sphere{ { 0.0f, 2.5f, 0.0f }, 1.0f }), false);
+	Expect(Contains(unitBox, { 1.0f, -1.0f, 0.5f }), true);
+	Expect(Contains(Sphere{ Vector3::Zero, 1.0f }, { 0.8f, 0.8f, 0.0f }), false);
+
+	float distance = 0.0f;
+	bool hit = Intersect(Ray{ { -5.0f, 0.0f, 0.0f }, Vector3::XAxis }, unitBox, distance);
+	ExpectHit(hit, distance, 4.0f);
+	Expect(Intersect(Ray{ { -5.0f, 2.0f, 0.0f }, Vector3::XAxis }, unitBox, distance), false);
+	hit = Intersect(Ray{ { 0.5f, 0.0f, 0.0f }, Vector3::XAxis }, unitBox, distance);
+	ExpectHit(hit, distance, 0.0f);
+	hit = Intersect(Ray{ { 0.0f, 0.0f, -10.0f }, { 0.0f, 0.0f, 2.0f } }, Sphere{ Vector3::Zero, 2.0f }, distance);
+	ExpectHit(hit, distance, 4.0f);
+	Expect(Intersect(Ray{ { 0.0f, 0.0f, -10.0f }, { 0.0f, 0.0f, -1.0f } }, Sphere{ Vector3::Zero, 2.0f }, distance), false);
+	hit = Intersect(Ray{ { -5.0f, 0.0f, 0.0f }, Vector3::XAxis }, OBB{ Vector3::Zero, Vector3::One, obb.rotation }, distance);
+	ExpectHit(hit, distance, 5.0f - sqrtf(2.0f));
+	hit = Intersect(Ray{ { 0.0f, 5.0f, 0.0f }, { 0.0f, -1.0f, 0.0f } }, Plane{ Vector3::YAxis, 0.0f }, distance);
+	ExpectHit(hit, distance, 5.0f);
+	const Vector3 a = { -1.0f, -1.0f, 5.0f };
+	const Vector3 b = { 1.0f, -1.0f, 5.0f };
+	const Vector3 c = { 0.0f, 1.0f, 5.0f };
+	hit = Intersect(Ray{ Vector3::Zero, Vector3::ZAxis }, a, b, c, distance);
+	ExpectHit(hit, distance, 5.0f);
+	hit = Intersect(Ray{ { 0.0f, 0.0f, 10.0f }, { 0.0f, 0.0f, -1.0f } }, a, b, c, distance);
+	ExpectHit(hit, distance, 5.0f);
+	Expect(Intersect(Ray{ { 3.0f, 0.0f, 0.0f }, Vector3::ZAxis }, a, b, c, distance), false);
+
+	const AABB merged = Merge(AABB::FromMinMax(Vector3::Zero, Vector3::One), Vector3{ 2.0f, -1.0f, 0.0f });
+	for (int i = 0; i < 3; ++i)
+	{
+		knownAnswers.Add(merged.GetMin().v[i], Vector3{ 0.0f, -1.0f, 0.0f }.v[i]);
+		knownAnswers.Add(merged.GetMax().v[i], Vector3{ 2.0f, 1.0f, 1.0f }.v[i]);
+	}
+	const AABB turned = TransformAABB(AABB{ Vector3::Zero, { 1.0f, 2.0f, 3.0f } }, Matrix4::RotationY(Constants::HalfPi) * Matrix4::Translation({ 1.0f, 0.0f, 0.0f }));
+	for (int i = 0; i < 3; ++i)
+	{
+		knownAnswers.Add(turned.center.v[i], Vector3{ 1.0f, 0.0f, 0.0f }.v[i]);
+		knownAnswers.Add(turned.extend.v[i], Vector3{ 3.0f, 2.0f, 1.0f }.v[i]);
+	}
+
+	// random volumes in and around the frustum, an odd count so the batch tails are covered
+	constexpr size_t Count = 100003;
+	std::mt19937 rng(1234);
+	std::vector<AABB> boxes(Count);
+	std::vector<float> radii(Count);
+	Vector3Stream centers(Count), extends(Count);
+	for (size_t i = 0; i < Count; ++i)
+	{
+		const Vector3 center = { RandomFloat(rng, -150.0f, 150.0f), RandomFloat(rng, -150.0f, 150.0f), RandomFloat(rng, -20.0f, 120.0f) };
+		const Vector3 extend = { RandomFloat(rng, 0.0f, 10.0f), RandomFloat(rng, 0.0f, 10.0f), RandomFloat(rng, 0.0f, 10.0f) };
+		boxes[i] = { center, extend };
+		radii[i] = extend.x;
+		centers.Set(i, center);
+		extends.Set(i, extend);
+	}
+	std::vector<uint8_t> visibleBoxes(centers.PaddedSize());
+	std::vector<uint8_t> visibleSpheres(centers.PaddedSize());
+	Intersect(frustum, centers, extends, visibleBoxes.data());
+	Intersect(frustum, centers, radii.data(), visibleSpheres.data());
+	for (size_t i = 0; i < Count; ++i)
+	{
+		// the kernels sum in another order, so volumes touching a plane may go either way
+		float boxMargin = std::numeric_limits<float>::max();
+		float sphereMargin = std::numeric_limits<float>::max();
+		for (const Plane& plane : frustum.planes)
+		{
+			const float d = DistanceToPlane(plane, boxes[i].center);
+			const Vector3& e = boxes[i].extend;
+			boxMargin = std::min(boxMargin, d + fabsf(plane.normal.x) * e.x + fabsf(plane.normal.y) * e.y + fabsf(plane.normal.z) * e.z);
+			sphereMargin = std::min(sphereMargin, d + radii[i]);
+		}
+		if (fabsf(boxMargin) > 1.0e-3f)
+		{
+			frustumAABB.Add(visibleBoxes[i] != 0 ? 1.0f : 0.0f, Intersect(frustum, boxes[i]) ? 1.0 : 0.0);
+		}
+		if (fabsf(sphereMargin) > 1.0e-3f)
+		{
+			frustumSphere.Add(visibleSpheres[i] != 0 ? 1.0f : 0.0f, Intersect(frustum, Sphere{ boxes[i].center, radii[i] }) ? 1.0 : 0.0);
+		}
+	}
+
+	const Matrix4 m = RandomTransform(rng).GetMatrix4();
+	Vector3Stream resultCenters, resultExtends;
+	TransformAABB(centers, extends, m, resultCenters, resultExtends);
+	for (size_t i = 0; i < Count; ++i)
+	{
+		const AABB reference = TransformAABB(boxes[i], m);
+		const double scale = Magnitude(reference.center) + Magnitude(reference.extend);
+		for (int k = 0; k < 3; ++k)
+		{
+			transformAABB.Add(resultCenters.Get(i).v[k], reference.center.v[k], scale);
+			transformAABB.Add(resultExtends.Get(i).v[k], reference.extend.v[k], scale);
+		}
+	}
+
+	bool passed = true;
+	for (const CheckError* error : { &knownAnswers, &frustumAABB, &frustumSphere, &transformAABB })
+	{
+		passed = error->Report() && passed;
+	}
+	return passed;
+}
+
+// Rotation angle between two unit quaternions, q and -q are the same rotation
+double RotationAngle(const Quaternion& a, const Quaternion& b)
+{
+	double plus = 0.0, minus = 0.0;
+	for (const auto& [u, v] : { std::pair{ a.x, b.x }, std::pair{ a.y, b.y }, std::pair{ a.z, b.z }, std::pair{ a.w, b.w } })
+	{
+		plus += (static_cast<double>(u) + v) * (static_cast<double>(u) + v);
+		minus += (static_cast<double>(u) - v) * (static_cast<double>(u) - v);
+	}
+	// the chord between them on the unit sphere is 2 sin(angle / 4)
+	const double chord = std::sqrt(std::min(plus, minus));
+	return 4.0 * std::asin(std::min(chord * 0.5, 1.0));
+}
+
+// The batch quaternion interpolations against Quaternion::Slerp with the error bounds of
+// BatchMath.h, and the batch matrix conversion against Matrix4::MatrixRotationQuaternion
+bool CheckQuaternionBatch()
+{
+	constexpr size_t Count = 1000003;
+	std::vector<Quaternion> q0(Count);
+	std::vector<Quaternion> q1(Count);
+	std::vector<float> t(Count);
+	std::mt19937 rng(1234);
+	for (size_t i = 0; i < Count; ++i)
+	{
+		q0[i] = RandomQuaternion(rng);
+		// a quarter are nearly the same rotation, with either sign
+		if (i % 4 == 0)
+		{
+			const float sign = (i % 8 == 0) ? -1.0f : 1.0f;
+			const Quaternion offset = { RandomFloat(rng, -1.0f, 1.0f), RandomFloat(rng, -1.0f, 1.0f), RandomFloat(rng, -1.0f, 1.0f), RandomFloat(rng, -1.0f, 1.0f) };
+			q1[i] = Quaternion::Normalize((q0[i] + offset * 0.005f) * sign);
+		}
+		else
+		{
+			q1[i] = RandomQuaternion(rng);
+		}
+		t[i] = RandomFloat(rng, 0.0f, 1.0f);
+	}
+	// the ends and the middle exactly
+	t[1] = 0.0f;
+	t[2] = 1.0f;
+	t[3] = 0.5f;
+
+	QuaternionStream stream0, stream1, result;
+	LoadStream(q0.data(), Count, stream0);
+	LoadStream(q1.data(), Count, stream1);
+
+	CheckError nlerp{ "Batch::Nlerp (rad)", 0.15f };
+	CheckError nlerpCorrected{ "Batch::NlerpCorrected (rad)", 1.0e-3f };
+	CheckError slerp{ "Batch::Slerp (rad)", 1.0e-5f };
+	CheckError sharedT{ "Batch::NlerpCorrected shared t (rad)", 1.0e-3f };
+	CheckError matrices{ "Batch::MatrixRotationQuaternion", 1.0e-6f };
+
+	const auto Compare = [&](CheckError& error, auto interpolate)
+	{
+		interpolate();
+		for (size_t i = 0; i < Count; ++i)
+		{
+			error.Add(static_cast<float>(RotationAngle(result.Get(i), Quaternion::Slerp(q0[i], q1[i], t[i]))), 0.0);
+		}
+	};
+	Compare(nlerp, [&]() { Nlerp(stream0, stream1, t.data(), result); });
+	Compare(nlerpCorrected, [&]() { NlerpCorrected(stream0, stream1, t.data(), result); });
+	Compare(slerp, [&]() { Slerp(stream0, stream1, t.data(), result); });
+	for (const float shared : { 0.0f, 0.1f, 0.25f, 0.5f, 0.9f, 1.0f })
+	{
+		NlerpCorrected(stream0, stream1, shared, result);
+		for (size_t i = 0; i < Count; i += 7)
+		{
+			sharedT.Add(static_cast<float>(RotationAngle(result.Get(i), Quaternion::Slerp(q0[i], q1[i], shared))), 0.0);
+		}
+	}
+
+	std::vector<Matrix4> batchMatrices(Count);
+	MatrixRotationQuaternion(stream0, batchMatrices.data());
+	for (size_t i = 0; i < Count; ++i)
+	{
+		matrices.Add(batchMatrices[i], Matrix4::MatrixRotationQuaternion(q0[i]));
+	}
+
+	bool passed = true;
+	for (const CheckError* error : { &nlerp, &nlerpCorrected, &slerp, &sharedT, &matrices })
+	{
+		passed = error->Report() && passed;
+	}
+	return passed;
+}
+
+// The documented error bounds of FastMath.h and the batch versions, against std:: in double
+bool CheckFastMath()
+{
+	constexpr float MaxAngle = 1000.0f;
+	constexpr float RsqrtTolerance = (GetSIMDBackend() == SIMDBackend::Scalar) ? 5.0e-6f : 3.0e-7f;
+
+	// evenly spaced angles over the documented range, plus one full turn sampled densely
+	std::vector<float> angles;
+	for (int i = 0; i <= 4000000; ++i)
+	{
+		angles.push_back(-MaxAngle + (2.0f * MaxAngle) * (static_cast<float>(i) / 4000000.0f));
+	}
+	for (int i = 0; i <= 1000000; ++i)
+	{
+		angles.push_back(-Constants::Pi + Constants::TwoPi * (static_cast<float>(i) / 1000000.0f));
+	}
+	// every mantissa over two octaves covers both exponent parities, then a wide random range
+	std::vector<float> positives;
+	for (float x = 1.0f; x < 4.0f; x = std::nextafter(x, 5.0f))
+	{
+		positives.push_back(x);
+	}
+	std::mt19937 rng(1234);
+	for (int i = 0; i < 1000000; ++i)
+	{
+		positives.push_back(std::pow(10.0f, RandomFloat(rng, -30.0f, 30.0f)));
+	}
+	std::vector<float> cosines;
+	for (int i = 0; i <= 2000000; ++i)
+	{
+		cosines.push_back(-1.0f + 2.0f * (static_cast<float>(i) / 2000000.0f));
+	}
+
+	CheckError constSin{ "ConstSin", 2.5e-7f };
+	CheckError constCos{ "ConstCos", 2.5e-7f };
+	CheckError fastSin{ "Fast::Sin", 4.0e-6f };
+	CheckError fastCos{ "Fast::Cos", 4.0e-6f };
+	CheckError fastSinCos{ "Fast::SinCos", 4.0e-6f };
+	CheckError fastRsqrt{ "Fast::Rsqrt (relative)", RsqrtTolerance };
+	CheckError fastAcos{ "Fast::Acos", 7.0e-5f };
+	CheckError batchSin{ "Batch::Sin", 4.0e-6f };
+	CheckError batchCos{ "Batch::Cos", 4.0e-6f };
+	CheckError batchSinCos{ "Batch::SinCos", 4.0e-6f };
+	CheckError batchRsqrt{ "Batch::Rsqrt (relative)", RsqrtTolerance };
+	CheckError batchAcos{ "Batch::Acos", 7.0e-5f };
+
+	// odd sizes so the batch tails are covered too
+	angles.push_back(0.5f);
+	positives.push_back(0.5f);
+	cosines.push_back(0.5f);
+
+	std::vector<float> sines(angles.size());
+	std::vector<float> cosResults(angles.size());
+	std::vector<float> sinCosSines(angles.size());
+	std::vector<float> sinCosCosines(angles.size());
+	Math::Sin(angles.data(), sines.data(), angles.size());
+	Math::Cos(angles.data(), cosResults.data(), angles.size());
+	Math::SinCos(angles.data(), sinCosSines.data(), sinCosCosines.data(), angles.size());
+	for (size_t i = 0; i < angles.size(); ++i)
+	{
+		const float x = angles[i];
+		const double referenceSin = std::sin(static_cast<double>(x));
+		const double referenceCos = std::cos(static_cast<double>(x));
+		constSin.Add(ConstSin(x), referenceSin);
+		constCos.Add(ConstCos(x), referenceCos);
+		fastSin.Add(Fast::Sin(x), referenceSin);
+		fastCos.Add(Fast::Cos(x), referenceCos);
+		float s = 0.0f, c = 0.0f;
+		Fast::SinCos(x, s, c);
+		fastSinCos.Add(s, referenceSin);
+		fastSinCos.Add(c, referenceCos);
+		batchSin.Add(sines[i], referenceSin);
+		batchCos.Add(cosResults[i], referenceCos);
+		batchSinCos.Add(sinCosSines[i], referenceSin);
+		batchSinCos.Add(sinCosCosines[i], referenceCos);
+	}
+
+	std::vector<float> rsqrts(positives.size());
+	Math::Rsqrt(positives.data(), rsqrts.data(), positives.size());
+	for (size_t i = 0; i < positives.size(); ++i)
+	{
+		const double reference = 1.0 / std::sqrt(static_cast<double>(positives[i]));
+		fastRsqrt.AddRelative(Fast::Rsqrt(positives[i]), reference);
+		batchRsqrt.AddRelative(rsqrts[i], reference);
+	}
+
+	std::vector<float> acoses(cosines.size());
+	Math::Acos(cosines.data(), acoses.data(), cosines.size());
+	for (size_t i = 0; i < cosines.size(); ++i)
+	{
+		const double reference = std::acos(static_cast<double>(cosines[i]));
+		fastAcos.Add(Fast::Acos(cosines[i]), reference);
+		batchAcos.Add(acoses[i], reference);
+	}
+
+	// the runtime rotation builders use the exact tier, the constexpr ones the polynomial
+	CheckError rotation{ "Matrix4::RotationX/Y/Z", 0.0f };
+	CheckError constRotation{ "Matrix4::ConstRotationX/Y/Z", 2.5e-7f };
+	for (size_t i = 0; i < angles.size(); i += 97)
+	{
+		const float x = angles[i];
+		const float s = sinf(x);
+		const float c = cosf(x);
+		rotation.Add(Matrix4::RotationX(x), Matrix4(1.0f, 0.0f, 0.0f, 0.0f, 0.0f, c, s, 0.0f, 0.0f, -s, c, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f));
+		rotation.Add(Matrix4::RotationY(x), Matrix4(c, 0.0f, -s, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, s, 0.0f, c, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f));
+		rotation.Add(Matrix4::RotationZ(x), Matrix4(c, s, 0.0f, 0.0f, -s, c, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f));
+		constRotation.Add(Matrix4::ConstRotationX(x), Matrix4::RotationX(x));
+		constRotation.Add(Matrix4::ConstRotationY(x), Matrix4::RotationY(x));
+		constRotation.Add(Matrix4::ConstRotationZ(x), Matrix4::RotationZ(x));
+	}
+	constexpr Matrix4 quarterTurn = Matrix4::ConstRotationZ(Constants::HalfPi);
+	constRotation.Add(quarterTurn, Matrix4::RotationZ(Constants::HalfPi));
+
+	// time accumulated angles grow without bound, past the documented range only the
+	// range of the result is promised, up to the largest float
+	CheckError largeAngles{ "ConstSinCos/Fast::SinCos |x| > 1000", 0.0f };
+	for (float x = 1000.0f; x < std::numeric_limits<float>::max() / 1.5f; x *= 1.5f)
+	{
+		for (const float angle : { x, -x, std::nextafter(x, 0.0f) })
+		{
+			float s = 0.0f, c = 0.0f;
+			ConstSinCos(angle, s, c);
+			largeAngles.Add(std::max({ fabsf(s), fabsf(c), 1.0f }), 1.0);
+			Fast::SinCos(angle, s, c);
+			largeAngles.Add(std::max({ fabsf(s), fabsf(c), 1.0f }), 1.0);
+			rotation.Add(Matrix4::RotationY(angle)._11, cosf(angle));
+		}
+	}
+
+	bool passed = true;
+	for (const CheckError* error : { &constSin, &constCos, &fastSin, &fastCos, &fastSinCos, &fastRsqrt, &fastAcos,
+		&batchSin, &batchCos, &batchSinCos, &batchRsqrt, &batchAcos, &rotation, &constRotation, &largeAngles })
+	{
+		passed = error->Report() && passed;
+	}
+	return passed;
+}
+
+#if defined(_WIN32)
+// TransformHierarchy against world matrices multiplied out by hand, through reparenting,
+// destroying subtrees and id reuse. The hierarchy is part of the Graphics library, which
+// needs the Windows SDK, so this check only runs in the Visual Studio build.
+bool CheckTransformHierarchy()
+{
+	constexpr int NodeCount = 1000;
+	constexpr int StepCount = 200;
+	CheckError world{ "TransformHierarchy world matrices", 1.0e-5f };
+	bool structurePassed = true;
+	auto Expect = [&](bool condition, const char* what)
+	{
+		if (!condition)
+		{
+			printf("TransformHierarchy: %s FAILED\n", what);
+			structurePassed = false;
+		}
+	};
+
+	// reference parents and locals indexed by id, world = local * parent world
+	std::vector<TransformId> parents;
+	std::vector<Transform> locals;
+	std::function<Matrix4(TransformId)> GetReference = [&](TransformId id)
+	{
+		const Matrix4 local = locals[id].GetMatrix4();
+		return (parents[id] != InvalidTransformId) ? local * GetReference(parents[id]) : local;
+	};
+	auto IsInSubtree = [&](TransformId id, TransformId root)
+	{
+		for (TransformId p = id; p != InvalidTransformId; p = parents[p])
+		{
+			if (p == root)
+			{
+				return true;
+			}
+		}
+		return false;
+	};
+
+	std::mt19937 rng(1234);
+	TransformHierarchy hierarchy;
+	std::vector<TransformId> alive;
+	for (int i = 0; i < NodeCount; ++i)
+	{
+		// a third of the nodes are roots, the rest hang under an earlier node
+		const TransformId parent = (i % 3 == 0) ? InvalidTransformId : alive[std::uniform_int_distribution<size_t>(0, alive.size() - 1)(rng)];
+		const Transform local = RandomTransform(rng);
+		const TransformId id = hierarchy.Create(local, parent);
+		Expect(id == static_cast<TransformId>(i), "new ids are dense");
+		parents.push_back(parent);
+		locals.push_back(local);
+		alive.push_back(id);
+	}
+	hierarchy.Update();
+	Expect(hierarchy.GetUpdatedCount() == NodeCount, "the first update computes every node");
+	hierarchy.Update();
+	Expect(hierarchy.GetUpdatedCount() == 0, "clean nodes keep their matrix");
+
+	for (int step = 0; step < StepCount; ++step)
+	{
+		const TransformId id = alive[std::uniform_int_distribution<size_t>(0, alive.size() - 1)(rng)];
+		switch (step % 4)
+		{
+		case 0:
+		{
+			// only the node and its subtree are recomputed
+			locals[id] = RandomTransform(rng);
+			hierarchy.SetLocal(id, locals[id]);
+			hierarchy.Update();
+			const size_t subtreeSize = std::count_if(alive.begin(), alive.end(), [&](TransformId node) { return IsInSubtree(node, id); });
+			Expect(hierarchy.GetUpdatedCount() == subtreeSize, "a dirty node updates its subtree only");
+			break;
+		}
+		case 1:
+		{
+			// under any node outside its own subtree, often one created after it
+			const TransformId parent = alive[std::uniform_int_distribution<size_t>(0, alive.size() - 1)(rng)];
+			if (!IsInSubtree(parent, id))
+			{
+				parents[id] = parent;
+				hierarchy.SetParent(id, parent);
+				Expect(hierarchy.GetParent(id) == parent, "SetParent");
+			}
+			hierarchy.Update();
+			break;
+		}
+		case 2:
+		{
+			// the subtree goes with it, the ids are handed out again
+			std::vector<TransformId> removed;
+			for (const TransformId node : alive)
+			{
+				if (IsInSubtree(node, id))
+				{
+					removed.push_back(node);
+				}
+			}
+			hierarchy.Destroy(id);
+			for (const TransformId node : removed)
+			{
+				Expect(!hierarchy.IsValid(node), "Destroy removes the subtree");
+				alive.erase(std::find(alive.begin(), alive.end(), node));
+			}
+			Expect(hierarchy.Size() == alive.size(), "Size after Destroy");
+			for (size_t i = 0; i < removed.size(); ++i)
+			{
+				const TransformId parent = alive.empty() ? InvalidTransformId : alive[std::uniform_int_distribution<size_t>(0, alive.size() - 1)(rng)];
+				const Transform local = RandomTransform(rng);
+				const TransformId newId = hierarchy.Create(local, parent);
+				Expect(std::find(removed.begin(), removed.end(), newId) != removed.end(), "destroyed ids are reused");
+				parents[newId] = parent;
+				locals[newId] = local;
+				alive.push_back(newId);
+			}
+			hierarchy.Update();
+			break;
+		}
+		default:
+		{
+			// back to a root
+			parents[id] = InvalidTransformId;
+			hierarchy.SetParent(id, InvalidTransformId);
+			hierarchy.Update();
+			break;
+		}
+		}
+
+		for (const TransformId node : alive)
+		{
+			world.Add(hierarchy.GetWorldMatrix(node), GetReference(node));
+		}
+	}
+
+	Expect(hierarchy.Size() == alive.size(), "Size");
+	printf("%-40s %s\n", "TransformHierarchy structure", structurePassed ? "ok" : "FAILED");
+	return world.Report() && structurePassed;
+}
+#endif
+
+Result RunBenchmark(const Benchmark& benchmark, Data& data, size_t size, double minTimeMs)
+{
+	// warm up caches and the branch predictor before timing
+	gSink = gSink + benchmark.run(data, size);
+
+	size_t iterations = 0;
+	double elapsedNs = 0.0;
+	size_t batch = 1;
+	while (elapsedNs < minTimeMs * 1.0e6)
+	{
+		const auto start = Clock::now();
+		for (size_t i = 0; i < batch; ++i)
+		{
+			gSink = gSink + benchmark.run(data, size);
+		}
+		elapsedNs += std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+		iterations += batch;
+		batch *= 2;
+	}
+
+	Result result;
+	result.name = benchmark.name;
+	result.size = size;
+	result.iterations = iterations;
+	result.nsPerOp = elapsedNs / (static_cast<double>(iterations) * size);
+	result.opsPerSecond = 1.0e9 / result.nsPerOp;
+	return result;
+}
+
+const char* GetBackendName()
+{
+	switch (GetSIMDBackend())
+	{
+	case SIMDBackend::AVX: return "avx";
+	case SIMDBackend::SSE: return "sse";
+	default: break;
+	}
+	return "scalar";
+}
+
+bool SaveJson(const std::filesystem::path& fileName, const std::vector<Result>& results)
+{
+	FILE* file = nullptr;
+	file = fopen(fileName.u8string().c_str(), "w");
+	if (file == nullptr)
+	{
+		return false;
+	}
+
+	fprintf(file, "{\n");
+	fprintf(file, "  \"backend\": \"%s\",\n", GetBackendName());
+	fprintf(file, "  \"results\": [\n");
+	for (size_t i = 0; i < results.size(); ++i)
+	{
+		const Result& r = results[i];
+		fprintf(file, "    { \"name\": \"%s\", \"size\": %zu, \"iterations\": %zu, \"ns_per_op\": %.4f, \"ops_per_sec\": %.1f }%s\n",
+			r.name.c_str(), r.size, r.iterations, r.nsPerOp, r.opsPerSecond, (i + 1 < results.size()) ? "," : "");
+	}
+	fprintf(file, "  ]\n");
+	fprintf(file, "}\n");
+	fclose(file);
+	return true;
+}
+
+int main(int argc, char* argv[])
+{
+	const std::optional<Arguments> argOpt = ParseArgs(argc, argv);
+	if (!argOpt.has_value())
+	{
+		printf("Usage: MathBenchmark [-json <file>] [-filter <substring>] [-maxsize <n>] [-mintime <ms>]\n");
+		printf("       MathBenchmark -check\n");
+		return -1;
+	}
+	const Arguments& args = argOpt.value();
+
+	printf("Math backend: %s\n", GetBackendName());
+	if (args.check)
+	{
+		bool passed = CheckMatrix4();
+		passed = CheckSpecializedInverses() && passed;
+		passed = CheckFastMath() && passed;
+		passed = CheckVector3Batch() && passed;
+		passed = CheckQuaternionBatch() && passed;
+		passed = CheckGeometry() && passed;
+#if defined(_WIN32)
+		passed = CheckTransformHierarchy() && passed;
+#endif
+		printf("%s\n", passed ? "All checks passed" : "Checks FAILED");
+		return passed ? 0 : -1;
+	}
+	printf("%-40s %10s %12s %14s\n", "benchmark", "size", "ns/op", "Mops/s");
+
+	std::vector<Result> results;
+	Data data;
+	for (size_t size = 1; size <= args.maxSize; size *= 16)
+	{
+		data.Initialize(size);
+		for (const Benchmark& benchmark : GetBenchmarks())
+		{
+			if (!args.filter.empty() && std::string(benchmark.name).find(args.filter) == std::string::npos)
+			{
+				continue;
+			}
+			const Result result = RunBenchmark(benchmark, data, size, args.minTimeMs);
+			printf("%-40s %10zu %12.3f %14.2f\n", result.name.c_str(), result.size, result.nsPerOp, result.opsPerSecond / 1.0e6);
+			results.push_back(result);
+		}
+	}
+
+	if (!args.jsonFileName.empty())
+	{
+		if (!SaveJson(args.jsonFileName, results))
+		{
+			printf("Error: failed to open file %s for saving\n", args.jsonFileName.u8string().c_str());
+			return -1;
+		}
+		printf("Results saved to %s\n", args.jsonFileName.u8string().c_str());
+	}
+	return 0;
+}
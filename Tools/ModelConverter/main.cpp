@@ -0,0 +1,462 @@
+// Converts between the text .model/.material pair and the binary .modelbin, the
+// direction follows the extension of the output file, or is the opposite of the input
+// without one. -optimize, -lods and -meshlets re-cook models that were imported without
+// them, so ModelManager does not have to build them at load time. -benchmark instead times loading
+// every input with the fscanf reference loader, the parallel text loader and the binary
+// loader, decoding the meshes and keeping them as stored the way ModelManager loads them,
+// writing the .modelbin first when it is missing, and checks they all agree.
+// -stress copies every input under copies new names and loads them all at once through
+// ModelManager::LoadModelAsync from several threads, checking each against a plain load,
+// then releases them all under a reduced memory budget to check the eviction order.
+//
+// Usage: ModelConverter [-optimize] [-lods <count>] [-meshlets] <inputFileName> [<outputFileName>]
+//        ModelConverter -benchmark <iterations> <fileName>...
+//        ModelConverter -stress <copies> <fileName>...
+
+#include <Inc/ML_Engine.h>
+
+#include <cstdio>
+
+using namespace ML_Engine;
+using namespace ML_Engine::Graphics;
+
+using Clock = std::chrono::steady_clock;
+
+struct Arguments
+{
+	std::vector<std::filesystem::path> fileNames;
+	std::filesystem::path outputFileName;
+	uint32_t benchmarkIterations = 0;
+	uint32_t stressCopies = 0;
+	uint32_t lodCount = 0;
+	bool optimize = false;
+	bool meshlets = false;
+};
+
+std::optional<Arguments> ParseArgs(int argc, char* argv[])
+{
+	Arguments args;
+	int i = 1;
+	const bool benchmark = (i + 1 < argc && strcmp(argv[i], "-benchmark") == 0);
+	const bool stress = (i + 1 < argc && strcmp(argv[i], "-stress") == 0);
+	if (benchmark || stress)
+	{
+		const uint32_t count = std::max(atoi(argv[i + 1]), 1);
+		(benchmark ? args.benchmarkIterations : args.stressCopies) = count;
+		i += 2;
+		for (; i < argc; ++i)
+		{
+			args.fileNames.push_back(argv[i]);
+		}
+		return args.fileNames.empty() ? std::nullopt : std::optional<Arguments>(args);
+	}
+
+	for (; i < argc && argv[i][0] == '-'; ++i)
+	{
+		if (strcmp(argv[i], "-optimize") == 0)
+		{
+			args.optimize = true;
+		}
+		else if (strcmp(argv[i], "-lods") == 0 && i + 1 < argc)
+		{
+			args.lodCount = std::max(atoi(argv[++i]), 1);
+		}
+		else if (strcmp(argv[i], "-meshlets") == 0)
+		{
+			args.meshlets = true;
+		}
+		else
+		{
+			return std::nullopt;
+		}
+	}
+
+	const int remaining = argc - i;
+	if (remaining < 1 || remaining > 2)
+	{
+		return std::nullopt;
+	}
+	args.fileNames.push_back(argv[i]);
+	if (remaining == 2)
+	{
+		args.outputFileName = argv[i + 1];
+	}
+	return args;
+}
+
+bool IsBinary(const std::filesystem::path& fileName)
+{
+	return fileName.extension() == ".modelbin";
+}
+
+void LoadText(const std::filesystem::path& fileName, Model& model)
+{
+	ModelIO::LoadModel(fileName, model);
+	ModelIO::LoadMaterial(fileName, model);
+}
+
+bool IsSameMesh(const Model::MeshData& a, const Model::MeshData& b)
+{
+	if (a.materialIndex != b.materialIndex || a.packed != b.packed || a.splitStreams != b.splitStreams ||
+		a.mesh.indices != b.mesh.indices || a.mesh.vertices.size() != b.mesh.vertices.size() ||
+		a.meshlets.size() != b.meshlets.size() || a.lods.size() != b.lods.size() ||
+		a.positionStream != b.positionStream || a.attributeStream != b.attributeStream ||
+		a.indexStream != b.indexStream || a.indexSize != b.indexSize || a.indexRanges.size() != b.indexRanges.size())
+	{
+		return false;
+	}
+	if (!a.indexRanges.empty() && memcmp(a.indexRanges.data(), b.indexRanges.data(), a.indexRanges.size() * sizeof(MeshLodRange)) != 0)
+	{
+		return false;
+	}
+	// bitwise, both loaders have to produce the same floats
+	if (!a.mesh.vertices.empty() && memcmp(a.mesh.vertices.data(), b.mesh.vertices.data(), a.mesh.vertices.size() * sizeof(Vertex)) != 0)
+	{
+		return false;
+	}
+	if (!a.meshlets.empty() && memcmp(a.meshlets.data(), b.meshlets.data(), a.meshlets.size() * sizeof(Meshlet)) != 0)
+	{
+		return false;
+	}
+	for (size_t l = 0; l < a.lods.size(); ++l)
+	{
+		if (a.lods[l].indices != b.lods[l].indices || a.lods[l].error != b.lods[l].error)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+bool IsSameModel(const Model& a, const Model& b)
+{
+	if (a.meshData.size() != b.meshData.size() || a.materialData.size() != b.materialData.size())
+	{
+		return false;
+	}
+	for (size_t m = 0; m < a.meshData.size(); ++m)
+	{
+		if (!IsSameMesh(a.meshData[m], b.meshData[m]))
+		{
+			return false;
+		}
+	}
+	for (size_t m = 0; m < a.materialData.size(); ++m)
+	{
+		const Model::MaterialData& materialA = a.materialData[m];
+		const Model::MaterialData& materialB = b.materialData[m];
+		if (memcmp(&materialA.material, &materialB.material, sizeof(Material)) != 0 ||
+			materialA.diffuseMapName != materialB.diffuseMapName || materialA.specMapName != materialB.specMapName ||
+			materialA.normalMapName != materialB.normalMapName || materialA.bumpMapName != materialB.bumpMapName)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+uintmax_t GetFileSize(std::filesystem::path fileName, const char* extension)
+{
+	std::error_code error;
+	const uintmax_t size = std::filesystem::file_size(fileName.replace_extension(extension), error);
+	return error ? 0 : size;
+}
+
+// fastest of iterations runs, in milliseconds
+double Time(uint32_t iterations, const std::function<void()>& load)
+{
+	double best = std::numeric_limits<double>::max();
+	for (uint32_t i = 0; i < iterations; ++i)
+	{
+		const Clock::time_point start = Clock::now();
+		load();
+		best = std::min(best, std::chrono::duration<double, std::milli>(Clock::now() - start).count());
+	}
+	return best;
+}
+
+void Benchmark(const std::filesystem::path& fileName, uint32_t iterations)
+{
+	Model textModel;
+	LoadText(fileName, textModel);
+	if (textModel.meshData.empty())
+	{
+		printf("%s: no text model\n", fileName.u8string().c_str());
+		return;
+	}
+	if (GetFileSize(fileName, "modelbin") == 0)
+	{
+		ModelIO::SaveModelBinary(fileName, textModel);
+	}
+
+	Model binaryModel;
+	if (!ModelIO::LoadModelBinary(fileName, binaryModel))
+	{
+		printf("%s: could not load the binary model\n", fileName.u8string().c_str());
+		return;
+	}
+	// decoding the stored blocks later has to give what decoding while loading gives, only
+	// the split streams of interleaved meshes are extra
+	Model storedModel;
+	ModelIO::LoadModelBinary(fileName, storedModel, false);
+	for (Model::MeshData& meshData : storedModel.meshData)
+	{
+		ModelIO::DecodeMesh(meshData);
+		if (!meshData.splitStreams)
+		{
+			meshData.positionStream.clear();
+			meshData.attributeStream.clear();
+		}
+	}
+	Model referenceModel;
+	ModelIO::LoadModelReference(fileName, referenceModel);
+	ModelIO::LoadMaterial(fileName, referenceModel);
+
+	const double referenceTime = Time(iterations, [&]()
+	{
+		Model model;
+		ModelIO::LoadModelReference(fileName, model);
+	});
+	const double textTime = Time(iterations, [&]()
+	{
+		Model model;
+		ModelIO::LoadModel(fileName, model);
+	});
+	const double binaryTime = Time(iterations, [&]()
+	{
+		Model model;
+		ModelIO::LoadModelBinary(fileName, model);
+	});
+	const double storedTime = Time(iterations, [&]()
+	{
+		Model model;
+		ModelIO::LoadModelBinary(fileName, model, false);
+	});
+	// what an upload straight from the mapping costs before the driver copy
+	std::filesystem::path binaryFileName = fileName;
+	binaryFileName.replace_extension("modelbin");
+	volatile uint32_t sink = 0;
+	const double mapTime = Time(iterations, [&]()
+	{
+		ModelFile file;
+		file.Open(binaryFileName);
+		for (uint32_t m = 0; m < file.GetMeshCount(); ++m)
+		{
+			const ModelFileMesh& mesh = file.GetMesh(m);
+			const uint8_t* indices = static_cast<const uint8_t*>(file.GetIndices(m));
+			sink = sink + static_cast<const uint8_t*>(file.GetVertices(m))[0] + ((mesh.indexCount > 0) ? indices[mesh.indexCount * mesh.indexSize - 1] : 0);
+		}
+	});
+
+	size_t vertexCount = 0;
+	for (const Model::MeshData& meshData : textModel.meshData)
+	{
+		vertexCount += meshData.mesh.vertices.size();
+	}
+	const uintmax_t textSize = GetFileSize(fileName, "model");
+	auto MegabytesPerSecond = [textSize](double milliseconds)
+	{
+		return (static_cast<double>(textSize) / (1024.0 * 1024.0)) / (milliseconds / 1000.0);
+	};
+	printf("%s: %zu meshes, %zu vertices\n", fileName.filename().u8string().c_str(), textModel.meshData.size(), vertexCount);
+	printf("  text matches fscanf: %s, binary matches text: %s, stored matches binary: %s\n",
+		IsSameModel(referenceModel, textModel) ? "yes" : "NO", IsSameModel(textModel, binaryModel) ? "yes" : "NO",
+		IsSameModel(binaryModel, storedModel) ? "yes" : "NO");
+	printf("  fscanf %9ju bytes %9.3f ms %8.1f MB/s\n", textSize, referenceTime, MegabytesPerSecond(referenceTime));
+	printf("  text   %9ju bytes %9.3f ms %8.1f MB/s (%.1fx)\n", textSize, textTime, MegabytesPerSecond(textTime), referenceTime / textTime);
+	printf("  binary %9ju bytes %9.3f ms (%.1fx)\n", GetFileSize(fileName, "modelbin"), binaryTime, referenceTime / binaryTime);
+	printf("  stored                 %9.3f ms (%.1fx)\n", storedTime, referenceTime / storedTime);
+	printf("  mapped                 %9.3f ms (%.1fx)\n", mapTime, referenceTime / mapTime);
+}
+
+bool StressAsyncLoading(const std::vector<std::filesystem::path>& fileNames, uint32_t copies)
+{
+	constexpr uint32_t RequestThreadCount = 4;
+
+	// every copy gets its own path, and with it its own ModelId
+	const std::filesystem::path stressDirectory = std::filesystem::temp_directory_path() / "ModelConverterStress";
+	std::filesystem::remove_all(stressDirectory);
+	std::filesystem::create_directories(stressDirectory);
+	std::vector<std::filesystem::path> copyNames;
+	std::vector<size_t> sourceIndices;
+	for (size_t f = 0; f < fileNames.size(); ++f)
+	{
+		for (uint32_t c = 0; c < copies; ++c)
+		{
+			std::filesystem::path copyName = fileNames[f].stem();
+			copyName += "_" + std::to_string(c) + ".model";
+			std::filesystem::path source = fileNames[f];
+			std::filesystem::copy_file(source.replace_extension("model"), stressDirectory / copyName);
+			std::filesystem::copy_file(source.replace_extension("material"), std::filesystem::path(stressDirectory / copyName).replace_extension("material"));
+			copyNames.push_back(copyName);
+			sourceIndices.push_back(f);
+		}
+	}
+
+	// what each copy has to come out as, loaded from the same directory because texture
+	// names resolve next to the model
+	std::vector<const Model*> expected;
+	ModelManager referenceManager;
+	referenceManager.SetRootDirectory(stressDirectory);
+	Clock::time_point start = Clock::now();
+	for (size_t f = 0; f < fileNames.size(); ++f)
+	{
+		expected.push_back(referenceManager.GetModel(referenceManager.LoadModel(copyNames[f * copies])));
+	}
+	const double syncTime = std::chrono::duration<double, std::milli>(Clock::now() - start).count() * copies;
+
+	// every thread asks for every copy in its own order, so requests for the same model race
+	ModelManager manager;
+	manager.SetRootDirectory(stressDirectory);
+	start = Clock::now();
+	std::vector<std::thread> requestThreads;
+	for (uint32_t t = 0; t < RequestThreadCount; ++t)
+	{
+		requestThreads.emplace_back([&manager, &copyNames, t]()
+		{
+			const size_t count = copyNames.size();
+			for (size_t i = 0; i < count; ++i)
+			{
+				const size_t rotated = (i + t * count / RequestThreadCount) % count;
+				manager.LoadModelAsync(copyNames[(t % 2 == 0) ? rotated : count - 1 - rotated]);
+			}
+		});
+	}
+	for (std::thread& thread : requestThreads)
+	{
+		thread.join();
+	}
+	const double requestTime = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+	uint32_t mismatches = 0;
+	std::vector<ModelId> modelIds;
+	for (size_t i = 0; i < copyNames.size(); ++i)
+	{
+		const ModelId modelId = modelIds.emplace_back(manager.GetModelId(copyNames[i]));
+		manager.WaitForModel(modelId);
+		const Model* model = manager.GetModel(modelId);
+		if (!manager.IsReady(modelId) || model == nullptr || !IsSameModel(*expected[sourceIndices[i]], *model))
+		{
+			printf("  %s: does not match\n", copyNames[i].u8string().c_str());
+			++mismatches;
+		}
+	}
+	const double asyncTime = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+	printf("%zu models from %u threads: requests %.3f ms, all resident %.3f ms, one at a time %.3f ms\n",
+		copyNames.size(), RequestThreadCount, requestTime, asyncTime, syncTime);
+	printf("  %zu of %zu match\n", copyNames.size() - mismatches, copyNames.size());
+
+	// with room for half of them, releasing everything keeps the last released half cached
+	const size_t residentUsage = manager.GetMemoryUsage();
+	manager.SetMemoryBudget(residentUsage / 2);
+	for (const ModelId modelId : modelIds)
+	{
+		for (uint32_t t = 0; t < RequestThreadCount; ++t)
+		{
+			manager.ReleaseModel(modelId);
+		}
+	}
+	const size_t releasedUsage = manager.GetMemoryUsage();
+	const bool lastCached = manager.GetModel(modelIds.back()) != nullptr;
+	bool firstEvicted = copyNames.size() < 2 || manager.GetModel(modelIds.front()) == nullptr;
+	if (copyNames.size() >= 2)
+	{
+		// loading it again reuses a freed slot, the stale id must not reach the new model
+		const ModelId reloadedId = manager.LoadModel(copyNames.front());
+		firstEvicted = firstEvicted && reloadedId != modelIds.front() && manager.GetModel(modelIds.front()) == nullptr;
+		manager.ReleaseModel(reloadedId);
+	}
+	manager.SetMemoryBudget(0);
+	const bool evicted = manager.GetMemoryUsage() == 0;
+	printf("  resident %.2f MB, released under a %.2f MB budget %.2f MB, last released cached: %s, first evicted: %s, all evicted: %s\n",
+		residentUsage / (1024.0 * 1024.0), (residentUsage / 2) / (1024.0 * 1024.0), releasedUsage / (1024.0 * 1024.0),
+		lastCached ? "yes" : "NO", firstEvicted ? "yes" : "NO", evicted ? "yes" : "NO");
+
+	std::filesystem::remove_all(stressDirectory);
+	return mismatches == 0 && releasedUsage <= residentUsage / 2 && lastCached && firstEvicted && evicted;
+}
+
+int main(int argc, char* argv[])
+{
+	const std::optional<Arguments> argOpt = ParseArgs(argc, argv);
+	if (!argOpt.has_value())
+	{
+		printf("Usage: ModelConverter [-optimize] [-lods <count>] [-meshlets] <inputFileName> [<outputFileName>]\n");
+		printf("       ModelConverter -benchmark <iterations> <fileName>...\n");
+		printf("       ModelConverter -stress <copies> <fileName>...\n");
+		return -1;
+	}
+
+	const Arguments& args = argOpt.value();
+	if (args.stressCopies > 0)
+	{
+		return StressAsyncLoading(args.fileNames, args.stressCopies) ? 0 : -1;
+	}
+	if (args.benchmarkIterations > 0)
+	{
+		for (const std::filesystem::path& fileName : args.fileNames)
+		{
+			Benchmark(fileName, args.benchmarkIterations);
+		}
+		return 0;
+	}
+
+	const std::filesystem::path& inputFileName = args.fileNames[0];
+	Model model;
+	printf("Loading %s...\n", inputFileName.u8string().c_str());
+	if (IsBinary(inputFileName))
+	{
+		ModelIO::LoadModelBinary(inputFileName, model);
+	}
+	else
+	{
+		LoadText(inputFileName, model);
+	}
+	if (model.meshData.empty())
+	{
+		printf("Failed to load %s\n", inputFileName.u8string().c_str());
+		return -1;
+	}
+
+	for (Model::MeshData& meshData : model.meshData)
+	{
+		if (args.optimize)
+		{
+			printf("Optimizing Mesh...\n");
+			MeshOptimizer::Optimize(meshData.mesh);
+			// reordered vertices, the saved file is written from the mesh
+			meshData.positionStream.clear();
+			meshData.attributeStream.clear();
+		}
+		if (args.lodCount > 0)
+		{
+			printf("Building Lods...\n");
+			meshData.lods = MeshSimplifier::BuildLods(meshData.mesh, args.lodCount);
+		}
+		if (args.meshlets)
+		{
+			printf("Building Meshlets...\n");
+			meshData.meshlets = MeshletBuilder::Build(meshData.mesh);
+			printf("  %zu meshlets\n", meshData.meshlets.size());
+		}
+	}
+
+	const std::filesystem::path& outputFileName = args.outputFileName.empty() ? inputFileName : args.outputFileName;
+	const bool binaryOutput = args.outputFileName.empty() ? !IsBinary(inputFileName) : IsBinary(outputFileName);
+	if (binaryOutput)
+	{
+		printf("Saving Binary Model...\n");
+		ModelIO::SaveModelBinary(outputFileName, model);
+	}
+	else
+	{
+		printf("Saving Model...\n");
+		ModelIO::SaveModel(outputFileName, model);
+		printf("Saving Material...\n");
+		ModelIO::SaveMaterial(outputFileName, model);
+	}
+
+	printf("Conversion Complete\n");
+	return 0;
+}
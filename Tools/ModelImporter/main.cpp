@@ -15,16 +15,41 @@ struct Arguments
 	std::filesystem::path inputFileName;
 	std::filesystem::path outputFileName;
 	float scale = 1.0f;
+	bool optimize = false;
+	float weldEpsilon = -1.0f;
+	bool meshlets = false;
+	bool split16 = false;
+	bool packed = false;
+	bool streams = false;
+	uint32_t lodCount = 0;
+	std::vector<std::filesystem::path> cullFileNames;
+	bool checkPacking = false;
 };
 
 std::optional<Arguments> ParsArgs(int argc, char* argv[])
 {
+	// -packing checks the vertex packing round trips
+	if (argc == 2 && strcmp(argv[1], "-packing") == 0)
+	{
+		Arguments args;
+		args.checkPacking = true;
+		return args;
+	}
+
 	if (argc < 3)
 	{
 		return std::nullopt;
 	}
 
-	// .. .. .. .. .. -scale 0.1 <inputFileName> <outputFileName>
+	// -cull <fileName>... checks the meshlets of already imported models
+	if (strcmp(argv[1], "-cull") == 0)
+	{
+		Arguments args;
+		args.cullFileNames.assign(argv + 2, argv + argc);
+		return args;
+	}
+
+	// .. .. .. .. .. -scale 0.1 -weld 0.0001 -optimize -lods 3 -meshlets -split16 -packed -streams <inputFileName> <outputFileName>
 	Arguments args;
 	args.inputFileName = argv[argc - 2];
 	args.outputFileName = argv[argc - 1];
@@ -35,6 +60,36 @@ std::optional<Arguments> ParsArgs(int argc, char* argv[])
 			args.scale = atof(argv[i + 1]);
 			++i;
 		}
+		else if (strcmp(argv[i], "-weld") == 0)
+		{
+			args.weldEpsilon = static_cast<float>(atof(argv[i + 1]));
+			++i;
+		}
+		else if (strcmp(argv[i], "-optimize") == 0)
+		{
+			args.optimize = true;
+		}
+		else if (strcmp(argv[i], "-lods") == 0)
+		{
+			args.lodCount = static_cast<uint32_t>(atoi(argv[i + 1]));
+			++i;
+		}
+		else if (strcmp(argv[i], "-meshlets") == 0)
+		{
+			args.meshlets = true;
+		}
+		else if (strcmp(argv[i], "-split16") == 0)
+		{
+			args.split16 = true;
+		}
+		else if (strcmp(argv[i], "-packed") == 0)
+		{
+			args.packed = true;
+		}
+		else if (strcmp(argv[i], "-streams") == 0)
+		{
+			args.streams = true;
+		}
 	}
 	return args;
 }
@@ -66,6 +121,11 @@ Color ToColor(const aiColor3D& c)
 	};
 }
 
+void PrintCacheStats(const char* pass, const MeshOptimizer::VertexCacheStats& stats)
+{
+	printf("  %-14s ACMR %.3f ATVR %.3f\n", pass, stats.acmr, stats.atvr);
+}
+
 void ExportEmbeddedTexture(const aiTexture* texture, const Arguments& args, const std::filesystem::path& fileName)
 {
 	printf("Extracting embedded texture %s\n", fileName.u8string().c_str());
@@ -157,6 +217,269 @@ std::string FindTexture(const aiScene* scene, const aiMaterial* aiMaterial, aiTe
 	return textureName.filename().u8string();
 }
 
+bool CheckVertexPacking()
+{
+	// half a step of rounding plus float error in the decode
+	constexpr double MaxPositionErrorSteps = 0.52;
+	constexpr double MaxOctahedralErrorDegrees = 0.04;
+
+	// every finite half decodes and encodes back to itself, nan stays nan
+	uint32_t halfMismatches = 0;
+	for (uint32_t h = 0; h <= 0xffff; ++h)
+	{
+		const uint16_t half = static_cast<uint16_t>(h);
+		const float value = VertexPacking::HalfToFloat(half);
+		const bool isNan = (half & 0x7c00) == 0x7c00 && (half & 0x3ff) != 0;
+		const uint16_t encoded = VertexPacking::FloatToHalf(value);
+		if (isNan ? !std::isnan(value) || (encoded & 0x7fff) <= 0x7c00 : encoded != half)
+		{
+			++halfMismatches;
+		}
+	}
+
+	// floats across the half range encode to the nearest half, ties to the even one
+	uint32_t roundingMismatches = 0;
+	for (uint32_t bits = 0; bits < 0x47800000; bits += 0x3f)
+	{
+		float value = 0.0f;
+		memcpy(&value, &bits, sizeof(value));
+		const uint16_t half = VertexPacking::FloatToHalf(value);
+		if (half == 0x7c00)
+		{
+			// 65520 is halfway to the next step past 65504 and rounds to infinity
+			roundingMismatches += (value < 65520.0f) ? 1 : 0;
+			continue;
+		}
+		const double error = fabs(static_cast<double>(VertexPacking::HalfToFloat(half)) - value);
+		for (const uint16_t neighbour : { static_cast<uint16_t>(half - 1), static_cast<uint16_t>(half + 1) })
+		{
+			if (half == 0 && neighbour == 0xffff)
+			{
+				continue;
+			}
+			const double neighbourError = fabs(static_cast<double>(VertexPacking::HalfToFloat(neighbour)) - value);
+			if (neighbourError < error || (neighbourError == error && (half & 1) != 0))
+			{
+				++roundingMismatches;
+			}
+		}
+	}
+
+	// directions spread evenly over the sphere, plus the axes and the octahedron edges
+	constexpr uint32_t DirectionCount = 1000000;
+	std::vector<Vector3> directions;
+	const float goldenAngle = Constants::Pi * (3.0f - sqrtf(5.0f));
+	for (uint32_t i = 0; i < DirectionCount; ++i)
+	{
+		const float z = 1.0f - 2.0f * (static_cast<float>(i) + 0.5f) / DirectionCount;
+		const float radius = sqrtf(Max(1.0f - z * z, 0.0f));
+		const float angle = goldenAngle * static_cast<float>(i);
+		directions.push_back({ radius * cosf(angle), radius * sinf(angle), z });
+	}
+	for (float x = -1.0f; x <= 1.0f; x += 1.0f)
+	{
+		for (float y = -1.0f; y <= 1.0f; y += 1.0f)
+		{
+			for (float z = -1.0f; z <= 1.0f; z += 1.0f)
+			{
+				if (x != 0.0f || y != 0.0f || z != 0.0f)
+				{
+					directions.push_back(Normalize({ x, y, z }));
+				}
+			}
+		}
+	}
+	double maxAngle = 0.0;
+	for (const Vector3& direction : directions)
+	{
+		int16_t encoded[2];
+		VertexPacking::EncodeOctahedral(direction, encoded);
+		const Vector3 decoded = VertexPacking::DecodeOctahedral(encoded);
+		const double dot = static_cast<double>(direction.x) * decoded.x + static_cast<double>(direction.y) * decoded.y + static_cast<double>(direction.z) * decoded.z;
+		maxAngle = std::max(maxAngle, acos(std::clamp(dot, -1.0, 1.0)) * 180.0 / 3.14159265358979);
+	}
+
+	// positions round to the nearest unorm16 step of their mesh bounds
+	std::mt19937 rng(1234);
+	std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+	double maxSteps = 0.0;
+	for (uint32_t b = 0; b < 1000; ++b)
+	{
+		const float size = powf(10.0f, 2.0f * unit(rng));
+		AABB bounds;
+		bounds.extend = { size * (1.25f + 0.75f * unit(rng)), size * (1.25f + 0.75f * unit(rng)), size * (1.25f + 0.75f * unit(rng)) };
+		bounds.center = { size * 4.0f * unit(rng), size * 4.0f * unit(rng), size * 4.0f * unit(rng) };
+		const Vector3 step = VertexPacking::GetPositionScale(bounds) / 65535.0f;
+		for (uint32_t i = 0; i < 1000; ++i)
+		{
+			Vertex vertex;
+			vertex.position = bounds.center + Vector3(bounds.extend.x * unit(rng), bounds.extend.y * unit(rng), bounds.extend.z * unit(rng));
+			const Vertex unpacked = VertexPacking::Unpack(VertexPacking::Pack(vertex, bounds), bounds);
+			maxSteps = std::max(maxSteps, static_cast<double>(fabsf(unpacked.position.x - vertex.position.x) / step.x));
+			maxSteps = std::max(maxSteps, static_cast<double>(fabsf(unpacked.position.y - vertex.position.y) / step.y));
+			maxSteps = std::max(maxSteps, static_cast<double>(fabsf(unpacked.position.z - vertex.position.z) / step.z));
+		}
+	}
+
+	// and the whole mesh path the importer reports on
+	Mesh mesh = MeshBuilder::CreateSphere(64, 64, 2.0f);
+	const MeshPacked packedMesh = VertexPacking::PackMesh(mesh);
+	const VertexPacking::PackingError meshError = VertexPacking::MeasureError(mesh, packedMesh);
+	const Vector3 meshStep = VertexPacking::GetPositionScale(packedMesh.positionBounds) / 65535.0f;
+	const float maxMeshPosition = static_cast<float>(MaxPositionErrorSteps) * Magnitude(meshStep);
+	// half floats step by 2^-11 on [0.5, 1), uvs of the sphere stay in [0, 1]
+	const float maxMeshUV = ldexpf(1.0f, -12);
+	const bool meshPassed = meshError.position <= maxMeshPosition && meshError.normalAngle <= MaxOctahedralErrorDegrees && meshError.uvCoord <= maxMeshUV;
+
+	printf("half round trip mismatches %u, rounding mismatches %u\n", halfMismatches, roundingMismatches);
+	printf("octahedral max error %.5f degrees over %zu directions (limit %.5f)\n", maxAngle, directions.size(), MaxOctahedralErrorDegrees);
+	printf("position max error %.3f steps (limit %.3f)\n", maxSteps, MaxPositionErrorSteps);
+	printf("sphere position %g (limit %g), normal %.5f degrees, uv %g (limit %g)\n",
+		meshError.position, maxMeshPosition, meshError.normalAngle, meshError.uvCoord, maxMeshUV);
+	return halfMismatches == 0 && roundingMismatches == 0 && maxAngle <= MaxOctahedralErrorDegrees && maxSteps <= MaxPositionErrorSteps && meshPassed;
+}
+
+// whether any part of the triangle is inside the frustum, by clipping it against every plane
+bool IsInFrustum(const Frustum& frustum, const Vector3& a, const Vector3& b, const Vector3& c)
+{
+	std::vector<Vector3> polygon = { a, b, c };
+	std::vector<Vector3> clipped;
+	for (const Plane& plane : frustum.planes)
+	{
+		clipped.clear();
+		for (size_t i = 0; i < polygon.size(); ++i)
+		{
+			const Vector3& p0 = polygon[i];
+			const Vector3& p1 = polygon[(i + 1) % polygon.size()];
+			const float d0 = Dot(plane.normal, p0) + plane.distance;
+			const float d1 = Dot(plane.normal, p1) + plane.distance;
+			if (d0 >= 0.0f)
+			{
+				clipped.push_back(p0);
+			}
+			if ((d0 >= 0.0f) != (d1 >= 0.0f))
+			{
+				clipped.push_back(p0 + (p1 - p0) * (d0 / (d0 - d1)));
+			}
+		}
+		polygon.swap(clipped);
+		if (polygon.empty())
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+bool CheckMeshletCulling(const std::vector<std::filesystem::path>& fileNames)
+{
+	// a regression floor well below what the character models reach
+	constexpr double MinRejectedTriangles = 0.05;
+
+	bool passed = true;
+	for (const std::filesystem::path& fileName : fileNames)
+	{
+		Model model;
+		ModelIO::LoadModel(fileName, model);
+		if (model.meshData.empty())
+		{
+			printf("%s: no model\n", fileName.u8string().c_str());
+			passed = false;
+			continue;
+		}
+
+		// use the meshlets of the file, the same way ModelManager does
+		constexpr float maxFloat = std::numeric_limits<float>::max();
+		Vector3 minPoint = { maxFloat, maxFloat, maxFloat };
+		Vector3 maxPoint = { -maxFloat, -maxFloat, -maxFloat };
+		size_t meshletCount = 0;
+		for (Model::MeshData& meshData : model.meshData)
+		{
+			if (meshData.meshlets.empty())
+			{
+				meshData.meshlets = MeshletBuilder::Build(meshData.mesh);
+			}
+			meshletCount += meshData.meshlets.size();
+			for (const Vertex& vertex : meshData.mesh.vertices)
+			{
+				minPoint = { Min(minPoint.x, vertex.position.x), Min(minPoint.y, vertex.position.y), Min(minPoint.z, vertex.position.z) };
+				maxPoint = { Max(maxPoint.x, vertex.position.x), Max(maxPoint.y, vertex.position.y), Max(maxPoint.z, vertex.position.z) };
+			}
+		}
+		const Vector3 center = (minPoint + maxPoint) * 0.5f;
+		const float radius = Magnitude(maxPoint - minPoint) * 0.5f;
+
+		// eight views orbiting the model and one close up of the upper half
+		std::vector<Camera> views(9);
+		for (size_t v = 0; v < views.size(); ++v)
+		{
+			Camera& camera = views[v];
+			camera.SetAspectRatio(16.0f / 9.0f);
+			if (v < 8)
+			{
+				const float angle = Constants::TwoPi * static_cast<float>(v) / 8.0f;
+				camera.SetPosition(center + Vector3(sinf(angle), 0.25f, -cosf(angle)) * (radius * 2.5f));
+				camera.SetLookAt(center);
+			}
+			else
+			{
+				const Vector3 target = center + Vector3(0.0f, radius * 0.5f, 0.0f);
+				camera.SetPosition(target + Vector3(0.0f, 0.0f, -radius * 0.8f));
+				camera.SetLookAt(target);
+			}
+		}
+
+		size_t totalTriangles = 0;
+		size_t rejectedTriangles = 0;
+		size_t falseCulls = 0;
+		std::vector<uint32_t> visible;
+		std::vector<bool> isVisible;
+		for (const Camera& camera : views)
+		{
+			const Frustum frustum = camera.GetFrustum();
+			const Vector3& eye = camera.GetPosition();
+			for (const Model::MeshData& meshData : model.meshData)
+			{
+				visible.clear();
+				MeshletCullStats stats;
+				MeshletBuilder::Cull(meshData.meshlets, Matrix4::Identity, camera, visible, &stats);
+				totalTriangles += stats.totalIndexCount / 3;
+				rejectedTriangles += (stats.totalIndexCount - stats.visibleIndexCount) / 3;
+
+				// no front facing triangle inside the frustum may be in a rejected meshlet
+				isVisible.assign(meshData.meshlets.size(), false);
+				for (const uint32_t index : visible)
+				{
+					isVisible[index] = true;
+				}
+				const std::vector<Vertex>& vertices = meshData.mesh.vertices;
+				const std::vector<uint32_t>& indices = meshData.mesh.indices;
+				for (size_t m = 0; m < meshData.meshlets.size(); ++m)
+				{
+					const Meshlet& meshlet = meshData.meshlets[m];
+					for (uint32_t i = 0; i < meshlet.indexCount && !isVisible[m]; i += 3)
+					{
+						const Vector3& a = vertices[indices[meshlet.indexOffset + i]].position;
+						const Vector3& b = vertices[indices[meshlet.indexOffset + i + 1]].position;
+						const Vector3& c = vertices[indices[meshlet.indexOffset + i + 2]].position;
+						const bool frontFacing = Dot(a - eye, Cross(b - a, c - a)) < 0.0f;
+						if (frontFacing && IsInFrustum(frustum, a, b, c))
+						{
+							++falseCulls;
+						}
+					}
+				}
+			}
+		}
+
+		const double rejected = (totalTriangles > 0) ? static_cast<double>(rejectedTriangles) / totalTriangles : 0.0;
+		printf("%s: %zu meshlets, %.1f%% of triangles rejected over %zu views, %zu visible triangles culled\n",
+			fileName.filename().u8string().c_str(), meshletCount, rejected * 100.0, views.size(), falseCulls);
+		passed = passed && falseCulls == 0 && rejected >= MinRejectedTriangles;
+	}
+	return passed;
+}
+
 int main(int argc, char* argv[])
 {
 	const auto argOpt = ParsArgs(argc, argv);
@@ -166,8 +489,17 @@ int main(int argc, char* argv[])
 		return -1;
 	}
 
-	printf("Begin Import\n");
 	const Arguments& args = argOpt.value();
+	if (args.checkPacking)
+	{
+		return CheckVertexPacking() ? 0 : -1;
+	}
+	if (!args.cullFileNames.empty())
+	{
+		return CheckMeshletCulling(args.cullFileNames) ? 0 : -1;
+	}
+
+	printf("Begin Import\n");
 
 	// use assimp
 	Assimp::Importer importer;
@@ -232,6 +564,79 @@ int main(int argc, char* argv[])
 					mesh.indices.push_back(aiFace.mIndices[i]);
 				}
 			}
+
+			if (args.weldEpsilon >= 0.0f)
+			{
+				printf("Welding Vertices...\n");
+				MeshOptimizer::WeldSettings settings;
+				settings.positionEpsilon = args.weldEpsilon;
+				settings.normalEpsilon = args.weldEpsilon;
+				settings.tangentEpsilon = args.weldEpsilon;
+				settings.uvEpsilon = args.weldEpsilon;
+				const size_t removed = MeshOptimizer::WeldVertices(mesh, settings);
+				printf("  removed %zu of %u vertices\n", removed, numVertices);
+			}
+
+			// meshes too large for 16 bit indices become several meshes with the same material
+			const size_t firstPart = model.meshData.size() - 1;
+			if (args.split16 && mesh.vertices.size() > MaxIndex16VertexCount)
+			{
+				printf("Splitting Mesh...\n");
+				MeshOptimizer::OptimizeVertexCache(mesh.indices.data(), mesh.indices.size(), mesh.vertices.size());
+				std::vector<Mesh> parts = MeshOptimizer::SplitMesh(mesh);
+				printf("  %zu parts\n", parts.size());
+				const uint32_t materialIndex = meshData.materialIndex;
+				mesh = std::move(parts[0]);
+				for (size_t p = 1; p < parts.size(); ++p)
+				{
+					Model::MeshData& partData = model.meshData.emplace_back();
+					partData.materialIndex = materialIndex;
+					partData.mesh = std::move(parts[p]);
+				}
+			}
+
+			for (size_t p = firstPart; p < model.meshData.size(); ++p)
+			{
+				Model::MeshData& part = model.meshData[p];
+				if (args.optimize)
+				{
+					printf("Optimizing Mesh...\n");
+					const MeshOptimizer::Report report = MeshOptimizer::Optimize(part.mesh);
+					PrintCacheStats("original", report.original);
+					PrintCacheStats("vertex cache", report.afterVertexCache);
+					PrintCacheStats("overdraw", report.afterOverdraw);
+					PrintCacheStats("vertex fetch", report.afterVertexFetch);
+				}
+
+				if (args.lodCount > 0)
+				{
+					printf("Building Lods...\n");
+					part.lods = MeshSimplifier::BuildLods(part.mesh, args.lodCount);
+					for (const MeshLod& lod : part.lods)
+					{
+						printf("  %zu triangles, error %f\n", lod.indices.size() / 3, lod.error);
+					}
+				}
+
+				if (args.meshlets)
+				{
+					printf("Building Meshlets...\n");
+					part.meshlets = MeshletBuilder::Build(part.mesh);
+					printf("  %zu meshlets\n", part.meshlets.size());
+				}
+
+				if (args.packed)
+				{
+					printf("Packing Vertices...\n");
+					part.packed = true;
+					const VertexPacking::PackingError error = VertexPacking::MeasureError(part.mesh, VertexPacking::PackMesh(part.mesh));
+					printf("  %zu -> %zu bytes, error position %f normal %f deg uv %f\n",
+						part.mesh.vertices.size() * sizeof(Vertex), part.mesh.vertices.size() * sizeof(VertexPacked),
+						error.position, error.normalAngle, error.uvCoord);
+				}
+
+				part.splitStreams = args.streams;
+			}
 		}
 	}
 
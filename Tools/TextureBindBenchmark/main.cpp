@@ -0,0 +1,240 @@
+// Times the texture binds StandardEffect::Render makes per object, three BindPS and one
+// BindVS, for a scene of objects through the real TextureManager on the null backend.
+// BaselineTextureManager below is the lookup TextureManager used before its slot map
+// handles, hash_value(path) ids in an unordered_map, binding its own Texture objects the
+// same way, so the two passes differ only in how an id finds its texture. Both load every
+// texture under the texture directory and give each object four of them at random, and
+// both must issue the same number of backend binds.
+//
+// Usage: TextureBindBenchmark [-objects <count>] [-frames <count>] [<textureDirectory>]
+
+#include <Inc/ML_Engine.h>
+
+#include <cstdio>
+
+using namespace ML_Engine;
+using namespace ML_Engine::Graphics;
+
+using Clock = std::chrono::steady_clock;
+
+struct Arguments
+{
+	std::filesystem::path textureDirectory = L"../../Assets/Textures";
+	uint32_t objectCount = 10000;
+	uint32_t frameCount = 100;
+};
+
+std::optional<Arguments> ParseArgs(int argc, char* argv[])
+{
+	Arguments args;
+	int i = 1;
+	for (; i < argc && argv[i][0] == '-'; ++i)
+	{
+		if (strcmp(argv[i], "-objects") == 0 && i + 1 < argc)
+		{
+			args.objectCount = std::max(atoi(argv[++i]), 1);
+		}
+		else if (strcmp(argv[i], "-frames") == 0 && i + 1 < argc)
+		{
+			args.frameCount = std::max(atoi(argv[++i]), 1);
+		}
+		else
+		{
+			return std::nullopt;
+		}
+	}
+	if (i + 1 < argc)
+	{
+		return std::nullopt;
+	}
+	if (i < argc)
+	{
+		args.textureDirectory = argv[i];
+	}
+	return args;
+}
+
+// TextureManager as it was with hash_value ids, trimmed to what the bind path needs
+class BaselineTextureManager final
+{
+public:
+	using TextureId = std::size_t;
+
+	~BaselineTextureManager()
+	{
+		ASSERT(mInventory.empty(), "BaselineTextureManager: not all textures are cleared");
+	}
+
+	TextureId LoadTexture(const std::filesystem::path& fileName)
+	{
+		const size_t textureId = std::filesystem::hash_value(fileName);
+		auto [iter, success] = mInventory.insert({ textureId, Entry() });
+		if (success)
+		{
+			iter->second.texture = std::make_unique<Texture>();
+			iter->second.texture->Initialize(fileName);
+			iter->second.refCount = 1;
+		}
+		else
+		{
+			++iter->second.refCount;
+		}
+		return textureId;
+	}
+
+	void ReleaseTexture(TextureId id)
+	{
+		auto iter = mInventory.find(id);
+		if (iter != mInventory.end())
+		{
+			--iter->second.refCount;
+			if (iter->second.refCount == 0)
+			{
+				iter->second.texture->Terminate();
+				mInventory.erase(iter);
+			}
+		}
+	}
+
+	void BindVS(TextureId id, uint32_t slot) const
+	{
+		auto iter = mInventory.find(id);
+		if (iter != mInventory.end())
+		{
+			iter->second.texture->BindVS(slot);
+		}
+	}
+
+	void BindPS(TextureId id, uint32_t slot) const
+	{
+		auto iter = mInventory.find(id);
+		if (iter != mInventory.end())
+		{
+			iter->second.texture->BindPS(slot);
+		}
+	}
+
+private:
+	struct Entry
+	{
+		std::unique_ptr<Texture> texture;
+		uint32_t refCount = 0;
+	};
+	std::unordered_map<TextureId, Entry> mInventory;
+};
+
+// the four texture ids of a RenderObject
+template <class Id>
+struct ObjectTextures
+{
+	Id diffuseMapId = 0;
+	Id specMapId = 0;
+	Id normalMapId = 0;
+	Id bumpMapId = 0;
+};
+
+struct PassResult
+{
+	double nsPerObject = 0.0;
+	uint32_t bindCount = 0;
+};
+
+// the binds of StandardEffect::Render, timed one frame at a time, best frame wins
+template <class Manager, class Id>
+PassResult TimeBinds(const Manager& manager, const std::vector<ObjectTextures<Id>>& objects, uint32_t frameCount)
+{
+	GraphicsSystem* gs = GraphicsSystem::Get();
+	PassResult result;
+	double bestMs = std::numeric_limits<double>::max();
+	for (uint32_t frame = 0; frame < frameCount; ++frame)
+	{
+		gs->BeginRender();
+		const Clock::time_point start = Clock::now();
+		for (const ObjectTextures<Id>& object : objects)
+		{
+			manager.BindPS(object.diffuseMapId, 0);
+			manager.BindPS(object.specMapId, 1);
+			manager.BindPS(object.normalMapId, 2);
+			manager.BindVS(object.bumpMapId, 3);
+		}
+		const double ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+		bestMs = std::min(bestMs, ms);
+		result.bindCount = gs->GetBackend()->GetFrameStats().GetCount(GraphicsCommand::BindTexture);
+		gs->EndRender();
+	}
+	result.nsPerObject = bestMs * 1.0e6 / objects.size();
+	return result;
+}
+
+int main(int argc, char* argv[])
+{
+	const std::optional<Arguments> argOpt = ParseArgs(argc, argv);
+	if (!argOpt.has_value())
+	{
+		printf("Usage: TextureBindBenchmark [-objects <count>] [-frames <count>] [<textureDirectory>]\n");
+		return -1;
+	}
+	const Arguments& args = argOpt.value();
+
+	std::vector<std::filesystem::path> fileNames;
+	std::error_code error;
+	for (const auto& entry : std::filesystem::recursive_directory_iterator(args.textureDirectory, error))
+	{
+		const std::string extension = entry.path().extension().u8string();
+		if (entry.is_regular_file() && (extension == ".png" || extension == ".jpg" || extension == ".dds"))
+		{
+			fileNames.push_back(entry.path());
+		}
+	}
+	if (fileNames.empty())
+	{
+		printf("No textures under %s\n", args.textureDirectory.u8string().c_str());
+		return -1;
+	}
+
+	GraphicsSystem::StaticInitializeHeadless(1280, 720);
+	TextureManager::StaticInitialize(args.textureDirectory);
+	TextureManager* tm = TextureManager::Get();
+	BaselineTextureManager baseline;
+
+	std::vector<TextureId> textureIds;
+	std::vector<BaselineTextureManager::TextureId> baselineIds;
+	for (const std::filesystem::path& fileName : fileNames)
+	{
+		textureIds.push_back(tm->LoadTexture(fileName, false));
+		baselineIds.push_back(baseline.LoadTexture(fileName));
+	}
+
+	// random picks defeat the state cache, so every bind reaches the backend
+	std::mt19937 rng(1234);
+	std::uniform_int_distribution<size_t> pick(0, fileNames.size() - 1);
+	std::vector<ObjectTextures<TextureId>> objects(args.objectCount);
+	std::vector<ObjectTextures<BaselineTextureManager::TextureId>> baselineObjects(args.objectCount);
+	for (uint32_t i = 0; i < args.objectCount; ++i)
+	{
+		const size_t diffuse = pick(rng), spec = pick(rng), normal = pick(rng), bump = pick(rng);
+		objects[i] = { textureIds[diffuse], textureIds[spec], textureIds[normal], textureIds[bump] };
+		baselineObjects[i] = { baselineIds[diffuse], baselineIds[spec], baselineIds[normal], baselineIds[bump] };
+	}
+
+	const PassResult hashed = TimeBinds(baseline, baselineObjects, args.frameCount);
+	const PassResult handles = TimeBinds(*tm, objects, args.frameCount);
+	printf("%zu textures, %u objects, best of %u frames\n", fileNames.size(), args.objectCount, args.frameCount);
+	printf("  hash_value ids  %8.2f ns per object, %u backend binds\n", hashed.nsPerObject, hashed.bindCount);
+	printf("  slot map ids    %8.2f ns per object, %u backend binds (%.2fx)\n", handles.nsPerObject, handles.bindCount, hashed.nsPerObject / handles.nsPerObject);
+
+	for (size_t i = 0; i < fileNames.size(); ++i)
+	{
+		tm->ReleaseTexture(textureIds[i]);
+		baseline.ReleaseTexture(baselineIds[i]);
+	}
+	TextureManager::StaticTerminate();
+	GraphicsSystem::StaticTerminate();
+
+	if (hashed.bindCount != handles.bindCount)
+	{
+		printf("Binds do not match\n");
+		return -1;
+	}
+	return 0;
+}
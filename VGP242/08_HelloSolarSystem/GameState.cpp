@@ -94,17 +94,34 @@ void GameState::Initialize()
 	mPluto.textureId = TextureManager::Get()->LoadTexture(L"planets/pluto.jpg");
 	mMoon.textureId = TextureManager::Get()->LoadTexture(L"planets/pluto.jpg");
 
-    // assign starting positions
-    mMercury.matWorld = Math::Matrix4::Translation({ 0.0f, 0.0f, 2.0f });
-	mVenus.matWorld = Math::Matrix4::Translation({ 0.0f, 0.0f, 3.5f });
-    mEarth.matWorld = Math::Matrix4::Translation({ 0.0f, 0.0f, 5.0f });
-    mMars.matWorld = Math::Matrix4::Translation({ 0.0f, 0.0f, 6.5f });
-	mJupiter.matWorld = Math::Matrix4::Translation({ 0.0f, 0.0f, 8.0f });
-	mSaturn.matWorld = Math::Matrix4::Translation({ 0.0f, 0.0f, 9.5f });
-	mUranus.matWorld = Math::Matrix4::Translation({ 0.0f, 0.0f, 11.0f });
-	mNeptune.matWorld = Math::Matrix4::Translation({ 0.0f, 0.0f, 12.5f });
-	mPluto.matWorld = Math::Matrix4::Translation({ 0.0f, 0.0f, 14.0f });
-	mMoon.matWorld = mEarth.matWorld * Math::Matrix4::Translation({ 0.0f, 0.0f, 0.8f });
+    // build the hierarchy, the moon follows the earth
+    mSpace.transformId = mTransforms.Create();
+    mSun.transformId = mTransforms.Create();
+    mSun.spinSpeed = 0.005f;
+    auto AddPlanet = [&](Object& planet, float distance, float spinSpeed, float orbitSpeed)
+    {
+        Transform local;
+        local.position = { 0.0f, 0.0f, distance };
+        planet.orbitId = mTransforms.Create();
+        planet.transformId = mTransforms.Create(local, planet.orbitId);
+        planet.spinSpeed = spinSpeed;
+        planet.orbitSpeed = orbitSpeed;
+    };
+    AddPlanet(mMercury, 2.0f, 0.1f, 0.4787f);
+    AddPlanet(mVenus, 3.5f, 0.05f, 0.3502f);
+    AddPlanet(mEarth, 5.0f, 0.174533f, 0.2978f);
+    AddPlanet(mMars, 6.5f, 0.2f, 0.24077f);
+    AddPlanet(mJupiter, 8.0f, 0.5f, 0.1307f);
+    AddPlanet(mSaturn, 9.5f, 0.3f, 0.0969f);
+    AddPlanet(mUranus, 11.0f, 0.1f, 0.0681f);
+    AddPlanet(mNeptune, 12.5f, 0.05f, 0.0543f);
+    AddPlanet(mPluto, 14.0f, 0.008f, 0.0474f);
+
+    Transform moonLocal;
+    moonLocal.position = { 0.0f, 0.0f, 0.8f };
+    mMoon.transformId = mTransforms.Create(moonLocal, mEarth.transformId);
+    mMoon.spinSpeed = 0.02355f;
+    mTransforms.Update();
 
     constexpr uint32_t size = 512;
     mRenderTarget.Initialize(size, size, RenderTarget::Format::RGBA_U32);
@@ -112,6 +129,7 @@ void GameState::Initialize()
 void GameState::Terminate()
 {
     mRenderTarget.Terminate();
+    mTransforms.Clear();
 
 	TextureManager::Get()->ReleaseTexture(mSpace.textureId);
     TextureManager::Get()->ReleaseTexture(mSun.textureId);
@@ -162,66 +180,61 @@ void GameState::Update(float deltaTime)
     SimpleDraw::AddGroundCircle(60, 14.0f, Colors::DarkGray, { 0.0f, 0.0f, 0.0f });
     }
 
-    // local rotation
-    mSun.matWorld = Math::Matrix4::RotationY((0.005f + gPlanetRotationSpeed) * deltaTime) * mSun.matWorld;
-    mMercury.matWorld = Math::Matrix4::RotationY((0.1f + gPlanetRotationSpeed) * deltaTime) * mMercury.matWorld;
-	mVenus.matWorld = Math::Matrix4::RotationY((0.05f + gPlanetRotationSpeed) * deltaTime) * mVenus.matWorld;
-	mEarth.matWorld = Math::Matrix4::RotationY((0.174533f + gPlanetRotationSpeed) * deltaTime) * mEarth.matWorld;
-	mMars.matWorld = Math::Matrix4::RotationY((0.2f + gPlanetRotationSpeed) * deltaTime) * mMars.matWorld;
-	mJupiter.matWorld = Math::Matrix4::RotationY((0.5f + gPlanetRotationSpeed) * deltaTime) * mJupiter.matWorld;
-	mSaturn.matWorld = Math::Matrix4::RotationY((0.3f + gPlanetRotationSpeed) * deltaTime) * mSaturn.matWorld;
-	mUranus.matWorld = Math::Matrix4::RotationY((0.1f + gPlanetRotationSpeed) * deltaTime) * mUranus.matWorld;
-	mNeptune.matWorld = Math::Matrix4::RotationY((0.05f + gPlanetRotationSpeed) * deltaTime) * mNeptune.matWorld;
-	mPluto.matWorld = Math::Matrix4::RotationY((0.008f + gPlanetRotationSpeed) * deltaTime) * mPluto.matWorld;
-    mMoon.matWorld = Math::Matrix4::RotationY((0.02355f + gPlanetRotationSpeed) * deltaTime) * mMoon.matWorld;
-
-    // rotate around the sun
-	mMercury.matWorld = mMercury.matWorld * Math::Matrix4::RotationY((0.4787f + gOrbitalRotationSpeed) * deltaTime);
-	mVenus.matWorld = mVenus.matWorld * Math::Matrix4::RotationY((0.3502f + gOrbitalRotationSpeed) * deltaTime);
-    mEarth.matWorld = mEarth.matWorld * Math::Matrix4::RotationY((0.2978f + gOrbitalRotationSpeed) * deltaTime);
-	mMars.matWorld = mMars.matWorld * Math::Matrix4::RotationY((0.24077f + gOrbitalRotationSpeed) * deltaTime);
-	mJupiter.matWorld = mJupiter.matWorld * Math::Matrix4::RotationY((0.1307f + gOrbitalRotationSpeed) * deltaTime);
-	mSaturn.matWorld = mSaturn.matWorld * Math::Matrix4::RotationY((0.0969f + gOrbitalRotationSpeed) * deltaTime);
-	mUranus.matWorld = mUranus.matWorld * Math::Matrix4::RotationY((0.0681f + gOrbitalRotationSpeed) * deltaTime);
-	mNeptune.matWorld = mNeptune.matWorld * Math::Matrix4::RotationY((0.0543f + gOrbitalRotationSpeed) * deltaTime);
-	mPluto.matWorld = mPluto.matWorld * Math::Matrix4::RotationY((0.0474f + gOrbitalRotationSpeed) * deltaTime);
-    mMoon.matWorld = Math::Matrix4::RotationY((0.0103f + gOrbitalRotationSpeed) * deltaTime) * Math::Matrix4::Translation({ 0.0f, 0.0f, 0.8f }) * mEarth.matWorld;
+    // angles are kept in one turn so the rotations stay accurate however long it runs
+    auto Turn = [&](TransformId id, float& angle, float speed)
+    {
+        angle = fmodf(angle + speed * deltaTime, Math::Constants::TwoPi);
+        Transform local = mTransforms.GetLocal(id);
+        local.rotation = Math::Quaternion::CreateFromAxisAngle(Math::Vector3::YAxis, angle);
+        mTransforms.SetLocal(id, local);
+    };
+    for (Object* object : { &mSun, &mMercury, &mVenus, &mEarth, &mMars, &mJupiter, &mSaturn, &mUranus, &mNeptune, &mPluto, &mMoon })
+    {
+        // local rotation
+        Turn(object->transformId, object->spinAngle, object->spinSpeed + gPlanetRotationSpeed);
+        // rotate around the sun
+        if (object->orbitId != InvalidTransformId)
+        {
+            Turn(object->orbitId, object->orbitAngle, object->orbitSpeed + gOrbitalRotationSpeed);
+        }
+    }
+    mTransforms.Update();
 
     Math::Vector3 targetPosition = Math::Vector3::Zero;
     switch (gCurrentTarget)
     {
     case CameraTarget::Sun:
-        targetPosition = Math::GetTranslation(mSun.matWorld);
+        targetPosition = Math::GetTranslation(mTransforms.GetWorldMatrix(mSun.transformId));
         break;
     case CameraTarget::Mercury:
-        targetPosition = Math::GetTranslation(mMercury.matWorld);
+        targetPosition = Math::GetTranslation(mTransforms.GetWorldMatrix(mMercury.transformId));
         break;
     case CameraTarget::Venus:
-        targetPosition = Math::GetTranslation(mVenus.matWorld);
+        targetPosition = Math::GetTranslation(mTransforms.GetWorldMatrix(mVenus.transformId));
         break;
     case CameraTarget::Earth:
-        targetPosition = Math::GetTranslation(mEarth.matWorld);
+        targetPosition = Math::GetTranslation(mTransforms.GetWorldMatrix(mEarth.transformId));
         break;
     case CameraTarget::Mars:
-        targetPosition = Math::GetTranslation(mMars.matWorld);
+        targetPosition = Math::GetTranslation(mTransforms.GetWorldMatrix(mMars.transformId));
         break;
     case CameraTarget::Jupiter:
-        targetPosition = Math::GetTranslation(mJupiter.matWorld);
+        targetPosition = Math::GetTranslation(mTransforms.GetWorldMatrix(mJupiter.transformId));
         break;
     case CameraTarget::Saturn:
-        targetPosition = Math::GetTranslation(mSaturn.matWorld);
+        targetPosition = Math::GetTranslation(mTransforms.GetWorldMatrix(mSaturn.transformId));
         break;
     case CameraTarget::Uranus:
-        targetPosition = Math::GetTranslation(mUranus.matWorld);
+        targetPosition = Math::GetTranslation(mTransforms.GetWorldMatrix(mUranus.transformId));
         break;
     case CameraTarget::Neptune:
-        targetPosition = Math::GetTranslation(mNeptune.matWorld);
+        targetPosition = Math::GetTranslation(mTransforms.GetWorldMatrix(mNeptune.transformId));
         break;
     case CameraTarget::Pluto:
-        targetPosition = Math::GetTranslation(mPluto.matWorld);
+        targetPosition = Math::GetTranslation(mTransforms.GetWorldMatrix(mPluto.transformId));
         break;
     case CameraTarget::Moon:
-        targetPosition = Math::GetTranslation(mMoon.matWorld);
+        targetPosition = Math::GetTranslation(mTransforms.GetWorldMatrix(mMoon.transformId));
         break;
     }
 	
@@ -291,7 +304,7 @@ void GameState::RenderObject(const Object& object, const Camera& camera)
 {
     const Math::Matrix4 matView = camera.GetViewMatrix();
     const Math::Matrix4 matProj = camera.GetProjectionMatrix();
-    const Math::Matrix4 matFinal = object.matWorld * matView * matProj;
+    const Math::Matrix4 matFinal = mTransforms.GetWorldMatrix(object.transformId) * matView * matProj;
     const Math::Matrix4 wvp = Math::Transpose(matFinal);
     mTransformBuffer.Update(&wvp);
 
@@ -356,37 +369,37 @@ void GameState::DebugUI()
         switch (gCurrentTarget)
         {
         case CameraTarget::Sun:
-            targetPosition = Math::GetTranslation(mSun.matWorld);
+            targetPosition = Math::GetTranslation(mTransforms.GetWorldMatrix(mSun.transformId));
             break;
         case CameraTarget::Mercury:
-			targetPosition = Math::GetTranslation(mMercury.matWorld);
+			targetPosition = Math::GetTranslation(mTransforms.GetWorldMatrix(mMercury.transformId));
 			break;
 		case CameraTarget::Venus:
-			targetPosition = Math::GetTranslation(mVenus.matWorld);
+			targetPosition = Math::GetTranslation(mTransforms.GetWorldMatrix(mVenus.transformId));
 			break;
         case CameraTarget::Earth:
-            targetPosition = Math::GetTranslation(mEarth.matWorld);
+            targetPosition = Math::GetTranslation(mTransforms.GetWorldMatrix(mEarth.transformId));
             break;
 		case CameraTarget::Mars:
-			targetPosition = Math::GetTranslation(mMars.matWorld);
+			targetPosition = Math::GetTranslation(mTransforms.GetWorldMatrix(mMars.transformId));
 			break;
 		case CameraTarget::Jupiter:
-			targetPosition = Math::GetTranslation(mJupiter.matWorld);
+			targetPosition = Math::GetTranslation(mTransforms.GetWorldMatrix(mJupiter.transformId));
 			break;
 		case CameraTarget::Saturn:
-			targetPosition = Math::GetTranslation(mSaturn.matWorld);
+			targetPosition = Math::GetTranslation(mTransforms.GetWorldMatrix(mSaturn.transformId));
 			break;
 		case CameraTarget::Uranus:
-			targetPosition = Math::GetTranslation(mUranus.matWorld);
+			targetPosition = Math::GetTranslation(mTransforms.GetWorldMatrix(mUranus.transformId));
 			break;
 		case CameraTarget::Neptune:
-			targetPosition = Math::GetTranslation(mNeptune.matWorld);
+			targetPosition = Math::GetTranslation(mTransforms.GetWorldMatrix(mNeptune.transformId));
 			break;
 		case CameraTarget::Pluto:
-			targetPosition = Math::GetTranslation(mPluto.matWorld);
+			targetPosition = Math::GetTranslation(mTransforms.GetWorldMatrix(mPluto.transformId));
 			break;
 		case CameraTarget::Moon:
-			targetPosition = Math::GetTranslation(mMoon.matWorld);
+			targetPosition = Math::GetTranslation(mTransforms.GetWorldMatrix(mMoon.transformId));
 			break;
         }
 
@@ -14,7 +14,13 @@ public:
 private:
 	struct Object
 	{
-		ML_Engine::Math::Matrix4 matWorld = ML_Engine::Math::Matrix4::Identity;
+		ML_Engine::Graphics::TransformId transformId = ML_Engine::Graphics::InvalidTransformId;
+		// planets are children of a pivot at the sun which turns them around it
+		ML_Engine::Graphics::TransformId orbitId = ML_Engine::Graphics::InvalidTransformId;
+		float spinSpeed = 0.0f;
+		float orbitSpeed = 0.0f;
+		float spinAngle = 0.0f;
+		float orbitAngle = 0.0f;
 		ML_Engine::Graphics::MeshBuffer meshBuffer;
 		ML_Engine::Graphics::TextureId textureId = 0;
 	};
@@ -31,6 +37,9 @@ private:
 	ML_Engine::Graphics::PixelShader mPixelShader;
 	ML_Engine::Graphics::Sampler mSampler;
 
+	// world matrices of every object, only the ones that moved are recomputed
+	ML_Engine::Graphics::TransformHierarchy mTransforms;
+
 	// render object
 	Object mSpace;
 	Object mSun;
@@ -14,19 +14,26 @@ void GameState::Initialize()
     mDirectionalLight.diffuse = { 0.7f, 0.7f, 0.7f, 1.0f };
     mDirectionalLight.specular = { 0.9f, 0.9f, 0.9f, 1.0f };
 
-    mCharacter.Initialize("Character01/Character01.model");
-    mCharacter02.Initialize("Character02/Character02.model");
-    mCharacter03.Initialize("Character03/Character03.model");
+    mCharacter.InitializeAsync("Character01/Character01.model");
+    mCharacter02.InitializeAsync("Character02/Character02.model");
+    mCharacter03.InitializeAsync("Character03/Character03.model");
+    if (GraphicsSystem::Get()->IsHeadless())
+    {
+        // headless runs are compared between builds, so every frame draws the real models
+        for (RenderGroup* character : { &mCharacter, &mCharacter02, &mCharacter03 })
+        {
+            ModelManager::Get()->WaitForModel(character->modelId);
+            character->Update();
+        }
+    }
 
     Mesh groundMesh = MeshBuilder::CreatePlane(10, 10, 1.0f);
     mGround.meshBuffer.Initialize(groundMesh);
     mGround.diffuseMapId = TextureManager::Get()->LoadTexture("misc/concrete.jpg");
 
-    Mesh cubeMesh = MeshBuilder::CreateSphere(20, 20, 1.0f);
-	mSphere01.meshBuffer.Initialize(cubeMesh);
-
+    // instanced draws always use the full mesh, no lods
     Mesh sphereMesh = MeshBuilder::CreateSphere(20, 20, 1.0f);
-	mSphere02.meshBuffer.Initialize(sphereMesh);
+    mSphere.InitializeMesh(sphereMesh);
 
 
     std::filesystem::path shaderFile = L"../../Assets/Shaders/Standard.fx";
@@ -43,10 +50,21 @@ void GameState::Initialize()
     mCharacter.transform.position = { 0.0f, 0.0f, 0.0f };
     mCharacter02.transform.position = { 2.5f, 0.0f, 0.0f };
     mCharacter03.transform.position = { -2.5f, 0.0f, 0.0f };
-
-    // move cube and sphere
-	mSphere01.transform.position = { 2.0f, 2.0f, -2.0f };
-	mSphere02.transform.position = { -4.0f, 3.0f, -2.0f };
+    for (RenderGroup* character : { &mCharacter, &mCharacter02, &mCharacter03 })
+    {
+        character->transformId = mTransforms.Create(character->transform);
+    }
+    mTransforms.Update();
+    mStandardEffect.SetTransformHierarchy(&mTransforms);
+    mShadowEffect.SetTransformHierarchy(&mTransforms);
+
+    // place the spheres
+    const InstanceData sphereInstances[] = {
+        { Math::Matrix4::Translation({ 2.0f, 2.0f, -2.0f }), 0 },
+        { Math::Matrix4::Translation({ -4.0f, 3.0f, -2.0f }), 0 }
+    };
+    mSphereInstances.Initialize(static_cast<uint32_t>(std::size(sphereInstances)));
+    mSphereInstances.Update(sphereInstances, static_cast<uint32_t>(std::size(sphereInstances)));
 }
 void GameState::Terminate()
 {
@@ -55,13 +73,20 @@ void GameState::Terminate()
     mCharacter03.Terminate();
     mCharacter02.Terminate();
     mCharacter.Terminate();
-    mSphere01.Terminate();
-    mSphere02.Terminate();
+    mTransforms.Clear();
+    mSphereInstances.Terminate();
+    mSphere.Terminate();
     mGround.Terminate();
 }
 void GameState::Update(float deltaTime)
 {
     UpdateCamera(deltaTime);
+
+    // the characters show a placeholder until their models finish loading
+    mCharacter.Update();
+    mCharacter02.Update();
+    mCharacter03.Update();
+    mTransforms.Update();
 }
 void GameState::Render()
 {
@@ -69,17 +94,28 @@ void GameState::Render()
 		mShadowEffect.Render(mCharacter);
 		mShadowEffect.Render(mCharacter02);
 		mShadowEffect.Render(mCharacter03);
-		mShadowEffect.Render(mSphere01);
-		mShadowEffect.Render(mSphere02);
+		mShadowEffect.RenderInstanced(mSphere, mSphereInstances);
 	mShadowEffect.End();
 
     mStandardEffect.Begin();
+    if (mUseRenderQueue)
+    {
+        mRenderQueue.Clear();
+        mStandardEffect.Submit(mRenderQueue, mCharacter);
+        mStandardEffect.Submit(mRenderQueue, mCharacter02);
+        mStandardEffect.Submit(mRenderQueue, mCharacter03);
+        mStandardEffect.Submit(mRenderQueue, mGround);
+        mRenderQueue.Sort();
+        mStandardEffect.Render(mRenderQueue);
+    }
+    else
+    {
         mStandardEffect.Render(mCharacter);
         mStandardEffect.Render(mCharacter02);
         mStandardEffect.Render(mCharacter03);
-		mStandardEffect.Render(mSphere01);
-		mStandardEffect.Render(mSphere02);
         mStandardEffect.Render(mGround);
+    }
+    mStandardEffect.RenderInstanced(mSphere, mSphereInstances);
     mStandardEffect.End();
 }
 
@@ -123,8 +159,25 @@ void GameState::DebugUI()
 		ImGui::DragFloat("Shininess#Material", &material.shininess, 0.1f, 0.1f, 1000.f);
     }
 
+    if (ImGui::CollapsingHeader("Render Queue", ImGuiTreeNodeFlags_DefaultOpen))
+    {
+        ImGui::Checkbox("UseRenderQueue", &mUseRenderQueue);
+        // the scene is drawn by now, the debug ui is not
+        const GraphicsStats& stats = GraphicsSystem::Get()->GetBackend()->GetFrameStats();
+        ImGui::Text("Draws: %u, binds: %u, buffer updates: %u", stats.GetDrawCount(), stats.GetBindCount(), stats.GetCount(GraphicsCommand::UpdateBuffer));
+        GraphicsStateCache* stateCache = GraphicsSystem::Get()->GetStateCache();
+        bool useStateCache = stateCache->IsEnabled();
+        if (ImGui::Checkbox("UseStateCache", &useStateCache))
+        {
+            stateCache->SetEnabled(useStateCache);
+        }
+        const StateCacheStats& cacheStats = stateCache->GetFrameStats();
+        ImGui::Text("State calls issued: %u, filtered: %u", cacheStats.GetIssuedCount(), cacheStats.GetFilteredCount());
+    }
+
     mStandardEffect.DebugUI();
     mShadowEffect.DebugUI();
+    ModelManager::Get()->DebugUI();
     ImGui::End();
 }
 
@@ -17,13 +17,19 @@ private:
 	ML_Engine::Graphics::Camera mCamera;
 	ML_Engine::Graphics::DirectionalLight mDirectionalLight;
 
+	// the characters read their cached world matrix from here in both passes
+	ML_Engine::Graphics::TransformHierarchy mTransforms;
 	ML_Engine::Graphics::RenderGroup mCharacter;
 	ML_Engine::Graphics::RenderGroup mCharacter02;
 	ML_Engine::Graphics::RenderGroup mCharacter03;
-	ML_Engine::Graphics::RenderObject mSphere01;
-	ML_Engine::Graphics::RenderObject mSphere02;
+	// one sphere mesh drawn at every instance
+	ML_Engine::Graphics::RenderObject mSphere;
+	ML_Engine::Graphics::InstanceBuffer mSphereInstances;
 	ML_Engine::Graphics::RenderObject mGround;
 
 	ML_Engine::Graphics::StandardEffect mStandardEffect;
 	ML_Engine::Graphics::ShadowEffect mShadowEffect;
+
+	ML_Engine::Graphics::RenderQueue mRenderQueue;
+	bool mUseRenderQueue = true;
 };
\ No newline at end of file
@@ -2,10 +2,19 @@
 
 using namespace ML_Engine;
 
-int WINAPI WinMain(HINSTANCE instance, HINSTANCE, LPSTR, int)
+int WINAPI WinMain(HINSTANCE instance, HINSTANCE, LPSTR cmdLine, int)
 {
 	AppConfig config;
 	config.appName = L"Hello Shadow";
+
+	// "-headless <frames>" runs without a window or gpu and saves the frame stats
+	uint32_t frameCount = 0;
+	if (sscanf_s(cmdLine, "-headless %u", &frameCount) == 1)
+	{
+		config.headless = true;
+		config.maxFrameCount = frameCount;
+		config.frameStatsFile = "HelloShadowStats.json";
+	}
 	
 	App& myApp = MainApp();
 	myApp.AddState<GameState>("GameState");